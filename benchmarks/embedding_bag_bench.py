@@ -0,0 +1,70 @@
+"""Measures embedding_bag compile time and step time as the number of bags grows.
+
+Usage: python benchmarks/embedding_bag_bench.py [--mode sum|mean|max]
+"""
+
+import argparse
+import time
+
+import torch
+import torch.nn.functional as F
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+
+
+def compile_time_ms():
+  data = met.metric_data('CompileTime')
+  return data[1] / 1e6 if data else 0.0
+
+
+def bench(num_bags, bag_size, num_embeddings, dim, mode, backward, repeats):
+  device = torch_xla.device()
+  weight = torch.randn(
+      num_embeddings, dim, device=device, requires_grad=backward)
+  indices = torch.randint(
+      0, num_embeddings, (num_bags * bag_size,), device=device)
+  offsets = torch.arange(0, num_bags * bag_size, bag_size, device=device)
+
+  def step():
+    out = F.embedding_bag(indices, weight, offsets, mode=mode)
+    if backward:
+      out.sum().backward()
+      return weight.grad
+    return out
+
+  met.clear_all()
+  step()
+  torch_xla.sync()
+  xm.wait_device_ops()
+  compile_ms = compile_time_ms()
+
+  start = time.perf_counter()
+  for _ in range(repeats):
+    step()
+    torch_xla.sync()
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / repeats
+  return compile_ms, step_ms
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--mode', default='sum', choices=['sum', 'mean', 'max'])
+  parser.add_argument('--bag-size', type=int, default=16)
+  parser.add_argument('--num-embeddings', type=int, default=100000)
+  parser.add_argument('--dim', type=int, default=64)
+  parser.add_argument('--backward', action='store_true')
+  parser.add_argument('--repeats', type=int, default=10)
+  args = parser.parse_args()
+
+  print('num_bags,compile_ms,step_ms')
+  for num_bags in [64, 256, 1024, 4096, 16384, 65536]:
+    compile_ms, step_ms = bench(num_bags, args.bag_size, args.num_embeddings,
+                                args.dim, args.mode, args.backward,
+                                args.repeats)
+    print(f'{num_bags},{compile_ms:.2f},{step_ms:.3f}')
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,83 @@
+"""Compares the fused linear cross entropy with the unfused matmul + loss.
+
+Reports the step time of a forward and backward pass and the peak device
+memory of each, across vocabulary sizes. The peak memory of the device never
+goes down within a process, so each configuration runs in its own process.
+
+Usage: python benchmarks/linear_cross_entropy_bench.py [--tokens 8192]
+"""
+
+import argparse
+import subprocess
+import sys
+import time
+
+import torch
+import torch.nn.functional as F
+import torch_xla
+import torch_xla.core.xla_model as xm
+from torch_xla.experimental.linear_cross_entropy import linear_cross_entropy
+
+
+def peak_memory_mb(device):
+  info = xm.get_memory_info(device)
+  return info.get('peak_bytes_used', info.get('bytes_used', 0)) / 2**20
+
+
+def bench(tokens, hidden_size, vocab, fused, vocab_block, dtype, repeats):
+  device = torch_xla.device()
+  hidden = torch.randn(
+      tokens, hidden_size, dtype=dtype, device=device, requires_grad=True)
+  weight = torch.randn(
+      vocab, hidden_size, dtype=dtype, device=device, requires_grad=True)
+  target = torch.randint(0, vocab, (tokens,), device=device)
+
+  def step():
+    if fused:
+      loss = linear_cross_entropy(
+          hidden, weight, target, vocab_block=vocab_block)
+    else:
+      loss = F.cross_entropy((hidden @ weight.T).float(), target)
+    loss.backward()
+    torch_xla.sync()
+
+  step()
+  xm.wait_device_ops()
+
+  start = time.perf_counter()
+  for _ in range(repeats):
+    step()
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / repeats
+  return step_ms, peak_memory_mb(device)
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--tokens', type=int, default=8192)
+  parser.add_argument('--hidden', type=int, default=2048)
+  parser.add_argument('--vocab_block', type=int, default=8192)
+  parser.add_argument('--dtype', default='bfloat16')
+  parser.add_argument('--repeats', type=int, default=10)
+  # Runs a single configuration, in the process spawned for it.
+  parser.add_argument('--vocab', type=int, default=None)
+  parser.add_argument('--fused', type=int, default=None)
+  args = parser.parse_args()
+
+  if args.vocab is not None:
+    step_ms, peak_mb = bench(args.tokens, args.hidden, args.vocab,
+                             bool(args.fused), args.vocab_block,
+                             getattr(torch, args.dtype), args.repeats)
+    print(f'{args.vocab},{bool(args.fused)},{step_ms:.3f},{peak_mb:.1f}')
+    return
+
+  print('vocab,fused,step_ms,peak_mb', flush=True)
+  for vocab in [32768, 131072]:
+    for fused in [0, 1]:
+      command = [sys.executable, __file__] + sys.argv[1:]
+      command += ['--vocab', str(vocab), '--fused', str(fused)]
+      subprocess.run(command, check=True)
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,99 @@
+"""Compares batched NMS with a per-image torchvision loop.
+
+The per-image path runs `torchvision.ops.batched_nms` on the valid boxes of
+each image, which needs the `nms` experiment and compiles a graph per
+distinct box count. The batched path handles all images in one static shape
+graph.
+
+Usage: XLA_EXPERIMENTAL=nms python benchmarks/nms_bench.py [--batch 8]
+"""
+
+import argparse
+import time
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental.batched_nms import batched_nms
+
+
+def make_inputs(batch, n, num_classes, device):
+  boxes = torch.rand(batch, n, 4) * 1000
+  boxes[..., 2:] += boxes[..., :2] * 0.1
+  scores = torch.rand(batch, n)
+  classes = torch.randint(0, num_classes, (batch, n), dtype=torch.int32)
+  valid_counts = torch.randint(n // 2, n + 1, (batch,), dtype=torch.int32)
+  return [t.to(device) for t in (boxes, scores, classes, valid_counts)]
+
+
+def per_image_step(boxes, scores, classes, valid_counts, max_output_size):
+  import torchvision
+  results = []
+  for b, n in enumerate(valid_counts.cpu().tolist()):
+    keep = torchvision.ops.batched_nms(boxes[b, :n], scores[b, :n],
+                                       classes[b, :n], 0.5)
+    results.append(keep[:max_output_size])
+  return results
+
+
+def batched_step(boxes, scores, classes, valid_counts, max_output_size,
+                 tile_size):
+  return batched_nms(
+      boxes,
+      scores,
+      0.5,
+      max_output_size,
+      classes=classes,
+      valid_counts=valid_counts,
+      tile_size=tile_size)
+
+
+def compile_count():
+  data = met.metric_data('CompileTime')
+  return data[0] if data else 0
+
+
+def bench(step, make_step_inputs, repeats):
+  # Every step draws new valid counts, as consecutive serving batches would.
+  step(*make_step_inputs())
+  torch_xla.sync()
+  xm.wait_device_ops()
+  compiles = compile_count()
+  start = time.perf_counter()
+  for _ in range(repeats):
+    step(*make_step_inputs())
+    torch_xla.sync()
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / repeats
+  return step_ms, compile_count() - compiles
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--batch', type=int, default=8)
+  parser.add_argument('--classes', type=int, default=80)
+  parser.add_argument('--max-output', type=int, default=100)
+  parser.add_argument('--tile-size', type=int, default=512)
+  parser.add_argument('--repeats', type=int, default=10)
+  args = parser.parse_args()
+
+  device = torch_xla.device()
+  paths = {
+      'per_image':
+          lambda *inputs: per_image_step(*inputs, args.max_output),
+      'batched':
+          lambda *inputs: batched_step(*inputs, args.max_output,
+                                       args.tile_size),
+  }
+  print('n,path,step_ms,compiles')
+  for n in [1000, 5000, 20000]:
+    for name, step in paths.items():
+      step_ms, compiles = bench(
+          step, lambda: make_inputs(args.batch, n, args.classes, device),
+          args.repeats)
+      print(f'{n},{name},{step_ms:.3f},{compiles}')
+
+
+if __name__ == '__main__':
+  main()
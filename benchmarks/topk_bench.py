@@ -0,0 +1,53 @@
+"""Measures topk and kthvalue step time across the dimension size and k.
+
+Usage: python benchmarks/topk_bench.py [--op topk|kthvalue] [--recall 0.95]
+"""
+
+import argparse
+import time
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+
+def bench(n, k, rows, op, recall, repeats):
+  device = torch_xla.device()
+  x = torch.randn(rows, n, device=device)
+
+  def step():
+    if op == 'kthvalue':
+      return torch.kthvalue(x, k, dim=-1)
+    if recall < 1.0:
+      return torch_xla._XLAC._xla_approx_topk(x, k, -1, True, recall)
+    return torch.topk(x, k, dim=-1)
+
+  step()
+  torch_xla.sync()
+  xm.wait_device_ops()
+
+  start = time.perf_counter()
+  for _ in range(repeats):
+    step()
+    torch_xla.sync()
+  xm.wait_device_ops()
+  return (time.perf_counter() - start) * 1000 / repeats
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--op', default='topk', choices=['topk', 'kthvalue'])
+  parser.add_argument('--rows', type=int, default=8)
+  parser.add_argument('--recall', type=float, default=1.0)
+  parser.add_argument('--repeats', type=int, default=20)
+  args = parser.parse_args()
+
+  print('n,k,step_ms')
+  for n in [1024, 32768, 131072]:
+    for k in [1, 8, 64, 512]:
+      step_ms = bench(n, k, args.rows, args.op, args.recall, args.repeats)
+      print(f'{n},{k},{step_ms:.3f}')
+
+
+if __name__ == '__main__':
+  main()
@@ -268,12 +268,21 @@ torch::lazy::Value GetTensorIrValue(const at::Tensor& tensor,
 
 std::vector<torch_xla::runtime::ComputationClient::DataPtr> Execute(
     absl::Span<const torch::lazy::Value> roots,
-    const torch::lazy::BackendDevice& device) {
-  LoweringContext lowering_ctx("Execute", device);
+    const torch::lazy::BackendDevice& device, size_t lowering_threads) {
+  std::vector<const torch::lazy::Node*> root_nodes;
+  std::vector<torch::lazy::Output> outputs;
   for (auto node : roots) {
-    xla::XlaOp root = lowering_ctx.GetOutputOp(
-        torch::lazy::Output(node.node.get(), node.index));
-    lowering_ctx.AddResult(root);
+    root_nodes.push_back(node.node.get());
+    outputs.emplace_back(node.node.get(), node.index);
+  }
+  torch::lazy::Util::EmissionMap emission_map;
+  std::vector<const torch::lazy::Node*> post_order =
+      torch::lazy::Util::ComputePostOrder(root_nodes, &emission_map);
+  LoweringContext lowering_ctx("Execute", device, post_order,
+                               std::move(emission_map), outputs,
+                               lowering_threads);
+  for (const torch::lazy::Output& output : outputs) {
+    lowering_ctx.AddResult(lowering_ctx.GetOutputOp(output));
   }
 
   xla::XlaComputation computation = GetValueOrThrow(lowering_ctx.BuildXla());
@@ -316,8 +325,8 @@ std::vector<at::Tensor> Fetch(
 
 std::vector<at::Tensor> ExecuteAndFetch(
     absl::Span<const torch::lazy::Value> roots,
-    const torch::lazy::BackendDevice& device) {
-  auto results = Execute(roots, device);
+    const torch::lazy::BackendDevice& device, size_t lowering_threads) {
+  auto results = Execute(roots, device, lowering_threads);
   return Fetch(results);
 }
 
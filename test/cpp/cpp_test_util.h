@@ -90,9 +90,11 @@ std::string GetTensorHloGraph(at::Tensor tensor);
 torch::lazy::Value GetTensorIrValue(const at::Tensor& tensor,
                                     const torch::lazy::BackendDevice& device);
 
+// Lowers, compiles and runs the graph of roots. When lowering_threads is
+// greater than one, independent regions of the graph are lowered in parallel.
 std::vector<torch_xla::runtime::ComputationClient::DataPtr> Execute(
     absl::Span<const torch::lazy::Value> roots,
-    const torch::lazy::BackendDevice& device);
+    const torch::lazy::BackendDevice& device, size_t lowering_threads = 1);
 
 std::vector<at::Tensor> Fetch(
     absl::Span<const torch_xla::runtime::ComputationClient::DataPtr>
@@ -100,7 +102,7 @@ std::vector<at::Tensor> Fetch(
 
 std::vector<at::Tensor> ExecuteAndFetch(
     absl::Span<const torch::lazy::Value> roots,
-    const torch::lazy::BackendDevice& device);
+    const torch::lazy::BackendDevice& device, size_t lowering_threads = 1);
 
 void AssertBackward(const torch::Tensor& xla_output,
                     const std::vector<torch::Tensor>& xla_inputs,
@@ -705,6 +705,42 @@ TEST_F(AtenXlaTensorTest, TestTopK) {
   }
 }
 
+TEST_F(AtenXlaTensorTest, TestKthValueLargeDim) {
+  torch::Tensor a = torch::rand({3, 200}, torch::TensorOptions(torch::kFloat));
+  for (int k : {1, 7, 100, 194, 200}) {
+    for (int dim : {0, 1}) {
+      if (k > a.size(dim)) {
+        continue;
+      }
+      auto b = torch::kthvalue(a, k, dim, /*keepdim=*/false);
+      ForEachDevice([&](const torch::Device& device) {
+        torch::Tensor xla_a = CopyToDevice(a, device);
+        auto xla_b = torch::kthvalue(xla_a, k, dim, /*keepdim=*/false);
+        AllClose(std::get<0>(b), std::get<0>(xla_b));
+        AllEqual(std::get<1>(b), std::get<1>(xla_b));
+      });
+    }
+  }
+}
+
+TEST_F(AtenXlaTensorTest, TestTopKLargeDim) {
+  torch::Tensor a =
+      torch::rand({2, 300, 3}, torch::TensorOptions(torch::kFloat));
+  for (int k : {1, 8, 37, 150}) {
+    for (int dim : {1, -2}) {
+      for (bool largest : {false, true}) {
+        auto b = torch::topk(a, k, dim, largest, /*sorted=*/true);
+        ForEachDevice([&](const torch::Device& device) {
+          torch::Tensor xla_a = CopyToDevice(a, device);
+          auto xla_b = torch::topk(xla_a, k, dim, largest, /*sorted=*/true);
+          AllClose(std::get<0>(b), std::get<0>(xla_b));
+          AllEqual(std::get<1>(b), std::get<1>(xla_b));
+        });
+      }
+    }
+  }
+}
+
 TEST_F(AtenXlaTensorTest, TestSort) {
   torch::Tensor a = torch::rand({4, 5, 3}, torch::TensorOptions(torch::kFloat));
   for (int k = 1; k <= 3; ++k) {
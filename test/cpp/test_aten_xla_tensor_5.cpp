@@ -288,6 +288,84 @@ TEST_F(AtenXlaTensorTest, TestEmbeddingBag) {
   });
 }
 
+TEST_F(AtenXlaTensorTest, TestEmbeddingBagModes) {
+  torch::Tensor weight =
+      torch::rand({32, 4}, torch::TensorOptions(torch::kFloat));
+  torch::Tensor indices =
+      torch::randint(0, 31, {12}, torch::TensorOptions(torch::kLong));
+  // Includes an empty bag and a trailing empty bag.
+  torch::Tensor offsets =
+      torch::tensor({0, 3, 3, 7, 12}, torch::TensorOptions(torch::kLong));
+  for (int64_t mode : {0, 1, 2}) {
+    for (bool include_last_offset : {false, true}) {
+      for (int64_t padding_idx : {-1, 5}) {
+        torch::Tensor padded = indices.clone();
+        padded[4] = 5;
+        torch::Tensor result = std::get<0>(torch::embedding_bag(
+            weight, padded, offsets, /*scale_grad_by_freq=*/false, mode,
+            /*sparse=*/false, /*per_sample_weights=*/{}, include_last_offset,
+            padding_idx));
+        ForEachDevice([&](const torch::Device& device) {
+          torch::Tensor xla_result = std::get<0>(torch::embedding_bag(
+              CopyToDevice(weight, device), CopyToDevice(padded, device),
+              CopyToDevice(offsets, device), /*scale_grad_by_freq=*/false,
+              mode, /*sparse=*/false, /*per_sample_weights=*/{},
+              include_last_offset, padding_idx));
+          AllClose(result, xla_result);
+        });
+      }
+    }
+  }
+  ExpectCounterNotChanged("aten::.*", cpp_test::GetIgnoredCounters());
+  ExpectCounterChanged("xla::_embedding_bag_forward_only",
+                       cpp_test::GetIgnoredCounters());
+}
+
+TEST_F(AtenXlaTensorTest, TestEmbeddingBagPerSampleWeights) {
+  torch::Tensor weight =
+      torch::rand({32, 4}, torch::TensorOptions(torch::kFloat));
+  torch::Tensor indices =
+      torch::randint(0, 31, {10}, torch::TensorOptions(torch::kLong));
+  torch::Tensor offsets = torch::arange(0, 10, 3);
+  torch::Tensor per_sample_weights =
+      torch::rand({10}, torch::TensorOptions(torch::kFloat));
+  torch::Tensor result = std::get<0>(torch::embedding_bag(
+      weight, indices, offsets, /*scale_grad_by_freq=*/false, /*mode=*/0,
+      /*sparse=*/false, per_sample_weights));
+  ForEachDevice([&](const torch::Device& device) {
+    torch::Tensor xla_result = std::get<0>(torch::embedding_bag(
+        CopyToDevice(weight, device), CopyToDevice(indices, device),
+        CopyToDevice(offsets, device), /*scale_grad_by_freq=*/false,
+        /*mode=*/0, /*sparse=*/false,
+        CopyToDevice(per_sample_weights, device)));
+    AllClose(result, xla_result);
+  });
+}
+
+TEST_F(AtenXlaTensorTest, TestEmbeddingBagBackward) {
+  torch::Tensor indices =
+      torch::randint(0, 15, {12}, torch::TensorOptions(torch::kLong));
+  torch::Tensor offsets =
+      torch::tensor({0, 3, 3, 7}, torch::TensorOptions(torch::kLong));
+  for (int64_t mode : {0, 1, 2}) {
+    auto testfn =
+        [&](const std::vector<torch::Tensor>& inputs) -> torch::Tensor {
+      return std::get<0>(
+          torch::embedding_bag(inputs[0], inputs[1], inputs[2],
+                               /*scale_grad_by_freq=*/false, mode));
+    };
+    ForEachDevice([&](const torch::Device& device) {
+      TestBackward({torch::rand({16, 4}, torch::TensorOptions(torch::kFloat)
+                                             .requires_grad(true)),
+                    indices, offsets},
+                   device, testfn);
+    });
+    ExpectCounterNotChanged("aten::.*", cpp_test::GetIgnoredCounters());
+    ExpectCounterChanged("xla::_embedding_bag_backward",
+                         cpp_test::GetIgnoredCounters());
+  }
+}
+
 TEST_F(AtenXlaTensorTest, TestOneHot) {
   int num_classes = 5;
   torch::Tensor input =
@@ -1,26 +1,60 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
+#include <vector>
 
 #include "test/cpp/cpp_test_util.h"
 #include "test/cpp/torch_xla_test.h"
+#include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/data_ops.h"
+#include "torch_xla/csrc/elementwise.h"
+#include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/ir.h"
 #include "torch_xla/csrc/lowering_context.h"
 #include "torch_xla/csrc/ops/arithmetic_ir_ops.h"
 #include "torch_xla/csrc/ops/dynamic_ir.h"
 #include "torch_xla/csrc/ops/expand.h"
+#include "torch_xla/csrc/ops/infer_output_shape.h"
 #include "torch_xla/csrc/ops/nonzero.h"
 #include "torch_xla/csrc/ops/ops.h"
+#include "torch_xla/csrc/ops/permute.h"
 #include "torch_xla/csrc/ops/scalar.h"
 #include "torch_xla/csrc/ops/select.h"
+#include "torch_xla/csrc/ops/sum.h"
 #include "torch_xla/csrc/ops/unselect.h"
 #include "torch_xla/csrc/ops/update_slice.h"
+#include "torch_xla/csrc/reduction.h"
+#include "torch_xla/csrc/runtime/tf_logging.h"
+#include "torch_xla/csrc/status.h"
 
 namespace torch_xla {
 namespace cpp_test {
 
 class IrTest : public TorchXlaTest {};
 
+namespace {
+
+// Builds num_chains independent chains of elementwise operations over the same
+// tensor, each chain with chain_length nodes.
+std::vector<torch::lazy::Value> MakeIndependentChains(
+    const torch::lazy::Value& input, size_t num_chains, size_t chain_length) {
+  std::vector<torch::lazy::Value> roots;
+  for (size_t i = 0; i < num_chains; ++i) {
+    torch::lazy::Value value = input;
+    torch::lazy::Value scalar(ScalarOp(1.0 + 0.01 * i, xla::F32), 0);
+    for (size_t j = 0; j < chain_length; j += 2) {
+      value = value * scalar;
+      value = value - input;
+    }
+    roots.push_back(value);
+  }
+  return roots;
+}
+
+}  // namespace
+
 TEST_F(IrTest, TestScalarCreate) {
   torch::lazy::NodePtr scalar = ScalarOp(1.0, xla::F32);
   ASSERT_TRUE(scalar != nullptr);
@@ -361,5 +395,140 @@ TEST_F(IrTest, TestSizeDivNodeDynamicByZero) {
   EXPECT_THROW(dim_node_div->getDynamicValue(), std::runtime_error);
 }
 
+TEST_F(IrTest, TestParallelLowering) {
+  ForEachDevice([&](const torch::lazy::BackendDevice& device) {
+    at::Tensor a = at::rand({4, 8}, at::TensorOptions(at::kFloat));
+    at::Tensor b = at::rand({4, 8}, at::TensorOptions(at::kFloat));
+    torch::lazy::Value v_a = GetTensorIrValue(a, device);
+    torch::lazy::Value v_b = GetTensorIrValue(b, device);
+    std::vector<torch::lazy::Value> roots =
+        MakeIndependentChains(v_a, /*num_chains=*/6, /*chain_length=*/8);
+    // Roots shared by several regions, and roots which are graph leaves.
+    roots.push_back(roots[0]);
+    roots.push_back(v_b);
+    roots.push_back(v_a + v_b);
+
+    std::vector<at::Tensor> expected = ExecuteAndFetch(roots, device);
+    std::vector<at::Tensor> results =
+        ExecuteAndFetch(roots, device, /*lowering_threads=*/4);
+    ASSERT_EQ(results.size(), expected.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+      AllClose(results[i], expected[i]);
+    }
+  });
+}
+
+TEST_F(IrTest, TestParallelLoweringBenchmark) {
+  torch::lazy::BackendDevice device = bridge::GetDefaultDevice();
+  at::Tensor a = at::rand({4, 8}, at::TensorOptions(at::kFloat));
+  torch::lazy::Value v_a = GetTensorIrValue(a, device);
+  std::vector<torch::lazy::Value> roots =
+      MakeIndependentChains(v_a, /*num_chains=*/1000, /*chain_length=*/100);
+  std::vector<torch::lazy::Output> outputs;
+  std::vector<const torch::lazy::Node*> root_nodes;
+  for (const torch::lazy::Value& root : roots) {
+    outputs.emplace_back(root.node.get(), root.index);
+    root_nodes.push_back(root.node.get());
+  }
+
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    torch::lazy::Util::EmissionMap emission_map;
+    std::vector<const torch::lazy::Node*> post_order =
+        torch::lazy::Util::ComputePostOrder(root_nodes, &emission_map);
+    auto start = std::chrono::steady_clock::now();
+    LoweringContext lowering_ctx("Benchmark", device, post_order,
+                                 std::move(emission_map), outputs,
+                                 num_threads);
+    for (const torch::lazy::Output& output : outputs) {
+      lowering_ctx.AddResult(lowering_ctx.GetOutputOp(output));
+    }
+    GetValueOrThrow(lowering_ctx.BuildXla());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    TF_LOG(INFO) << "Lowered " << post_order.size() << " nodes with "
+                 << num_threads << " threads in " << elapsed.count() << " ms";
+    EXPECT_EQ(lowering_ctx.GetParametersData().size(), 1);
+  }
+}
+
+TEST_F(IrTest, TestClosedFormShapes) {
+  xla::Shape f32_shape = xla::ShapeUtil::MakeShape(xla::F32, {4, 1, 3});
+  xla::Shape s32_shape = xla::ShapeUtil::MakeShape(xla::S32, {5, 1});
+
+  EXPECT_EQ(InferBroadcastShape(f32_shape, s32_shape, xla::PRED),
+            InferOutputShape({f32_shape, s32_shape},
+                             [](absl::Span<const xla::XlaOp> operands) {
+                               return BuildComparisonOp(
+                                   at::aten::lt, operands[0], operands[1]);
+                             }));
+  for (bool keep : {false, true}) {
+    EXPECT_EQ(InferReduceShape(f32_shape, {0, 2}, keep, xla::F32),
+              InferOutputShape({f32_shape},
+                               [&](absl::Span<const xla::XlaOp> operands) {
+                                 return BuildMaxInDims(operands[0], {0, 2},
+                                                       keep);
+                               }));
+  }
+  EXPECT_EQ(InferTransposeShape(f32_shape, {2, 0, 1}),
+            InferOutputShape({f32_shape},
+                             [](absl::Span<const xla::XlaOp> operands) {
+                               return xla::Transpose(operands[0], {2, 0, 1});
+                             }));
+  EXPECT_EQ(InferSliceShape(f32_shape, {1, 0, 1}, {2, 1, 2}),
+            InferOutputShape({f32_shape},
+                             [](absl::Span<const xla::XlaOp> operands) {
+                               return xla::Slice(operands[0], {1, 0, 1},
+                                                 {3, 1, 3}, {1, 1, 1});
+                             }));
+  EXPECT_EQ(InferSqueezeShape(f32_shape, 1),
+            InferOutputShape({f32_shape},
+                             [](absl::Span<const xla::XlaOp> operands) {
+                               return SqueezeTrivialDimension(operands[0], 1);
+                             }));
+  EXPECT_EQ(InferSqueezeShape(f32_shape, -1),
+            InferOutputShape({f32_shape},
+                             [](absl::Span<const xla::XlaOp> operands) {
+                               return SqueezeAllTrivialDimensions(operands[0]);
+                             }));
+  EXPECT_EQ(InferExpandShape(f32_shape, {2, 4, 5, 3}),
+            InferOutputShape({f32_shape},
+                             [](absl::Span<const xla::XlaOp> operands) {
+                               return BuildExpand(operands[0], {2, 4, 5, 3});
+                             }));
+  EXPECT_THROW(InferExpandShape(f32_shape, {4, 2, 2}), std::exception);
+}
+
+TEST_F(IrTest, TestShapeInferenceBenchmark) {
+  // Every iteration uses new shapes, so that none of the nodes hits the shape
+  // cache and all of them go through shape inference.
+  const int64_t kNumIterations = 2000;
+  torch::lazy::Value scalar(ScalarOp(1.0, xla::F32), 0);
+  auto start = std::chrono::steady_clock::now();
+  size_t num_nodes = 0;
+  for (int64_t i = 0; i < kNumIterations; ++i) {
+    torch::lazy::Value expanded(
+        torch_xla::MakeNode<Expand>(scalar, std::vector<int64_t>{i + 1, 8, 4}),
+        0);
+    torch::lazy::Value permuted(
+        torch_xla::MakeNode<Permute>(expanded, std::vector<int64_t>{2, 0, 1}),
+        0);
+    torch::lazy::Value summed(
+        torch_xla::MakeNode<Sum>(permuted, std::vector<int64_t>{1},
+                                 /*keep_reduced_dimensions=*/false,
+                                 /*dtype=*/std::nullopt),
+        0);
+    torch::lazy::Value compared(ComparisonOp(at::aten::gt, summed, scalar), 0);
+    EXPECT_EQ(GetXlaShape(compared),
+              xla::ShapeUtil::MakeShape(xla::PRED, {4, 8}));
+    num_nodes += 4;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  TF_LOG(INFO) << "Created " << num_nodes << " IR nodes in "
+               << elapsed.count() / 1000 << " ms ("
+               << num_nodes * 1000000 / std::max<int64_t>(elapsed.count(), 1)
+               << " nodes/s)";
+}
+
 }  // namespace cpp_test
 }  // namespace torch_xla
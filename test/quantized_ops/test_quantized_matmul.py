@@ -8,6 +8,8 @@ import torch_xla.core.xla_model as xm
 import torch_xla.experimental.xla_quantized_matmul
 from torch_xla import runtime as xr
 from torch_xla.experimental.xla_quantized_matmul import XlaQuantizedLinear
+from torch_xla.experimental.xla_quantized_matmul import (
+    pack_int4, weight_only_quantized_matmul)
 from torch.ao.quantization.utils import determine_qparams
 
 torch.manual_seed(123456)
@@ -285,6 +287,47 @@ class QuantizedTest(parameterized.TestCase):
           self.assertGreater(
               self._calc_cosine_dist(out_quant_xla.cpu(), out_quant), 0.999999)
 
+  @parameterized.product(
+      n_bit=[4, 8], block_size=[-1, 4], is_symmetric=[True, False])
+  def test_weight_only_quantized_matmul(self, n_bit, block_size, is_symmetric):
+    with torch.no_grad():
+      m = M(16, 8)
+      w_int, scaler, zero_point = m.weight_quantization_rtn(
+          m.linear,
+          n_bits=n_bit,
+          block_size=block_size,
+          quant_method=torch.per_channel_symmetric
+          if is_symmetric else torch.per_channel_affine)
+      x = torch.randn(2, 3, 16)
+      expected = torch.ops.xla.quantized_matmul(
+          x, w_int, scaler, zero_point, block_size=block_size)
+      self.assertGreater(self._calc_cosine_dist(m(x), expected), 0.99)
+
+      w = pack_int4(w_int) if n_bit == 4 else w_int
+      to_device = lambda t: None if t is None else t.to(device)
+      out = weight_only_quantized_matmul(
+          x.to(device),
+          w.to(device),
+          scaler.to(device),
+          to_device(zero_point),
+          bits=n_bit,
+          block_size=block_size)
+      self.assertEqual(out.shape, expected.shape)
+      self.assertTrue(torch.allclose(out.cpu(), expected, atol=1e-4))
+
+  def test_weight_only_quantized_matmul_keeps_weight_packed(self):
+    with torch.no_grad():
+      x = torch.randn(3, 8, dtype=torch.bfloat16).to(device)
+      w = torch.randint(-128, 127, (16, 4), dtype=torch.int8).to(device)
+      scaler = torch.randn(16, dtype=torch.bfloat16).to(device)
+      out = weight_only_quantized_matmul(x, w, scaler, bits=4)
+      self.assertEqual(out.shape, (3, 16))
+      hlo = torch_xla._XLAC._get_xla_tensors_hlo([out])
+      # The packed [16, 4] weight is the only weight parameter and it is
+      # unpacked in the graph.
+      self.assertIn('s8[16,4]', hlo)
+      self.assertTrue(re.search(r'bf16.*dot', hlo) is not None)
+
 
 if __name__ == '__main__':
   unittest.main()
@@ -188,7 +188,7 @@ function run_xla_op_tests1 {
 
   run_test "$_TEST_DIR/test_python_ops.py"
   run_test "$_TEST_DIR/test_ops.py"
-  run_test "$_TEST_DIR/test_metrics.py"
+  XLA_RECOMPILATION_HISTORY=8 run_test "$_TEST_DIR/test_metrics.py"
   if [ -f "/tmp/metrics.txt" ]; then
     rm /tmp/metrics.txt
   fi
@@ -227,6 +227,8 @@ function run_xla_op_tests2 {
   run_test "$_TEST_DIR/test_assume_pure_spmd.py"
   run_test "$_TEST_DIR/test_assume_pure_torch.py"
   run_test "$_TEST_DIR/test_dynamic_shapes_detector.py"
+  XLA_FALLBACK_HOST_CALLBACK=1 run_test "$_TEST_DIR/test_fallback_host_callback.py"
+  run_test "$_TEST_DIR/test_host_offload.py"
 }
 
 function run_xla_op_tests3 {
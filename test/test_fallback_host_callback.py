@@ -0,0 +1,84 @@
+import os
+import sys
+import unittest
+
+# Must be set before the runtime is initialized.
+os.environ.setdefault('XLA_FALLBACK_HOST_CALLBACK', '1')
+
+import torch
+import torch_xla
+import torch_xla.debug.metrics as met
+
+
+def _num_executions():
+  data = met.metric_data('ExecuteTime')
+  return data[0] if data else 0
+
+
+class FallbackHostCallbackTest(unittest.TestCase):
+
+  def test_fallback_does_not_break_graph(self):
+    x = torch.rand(16, 16)
+    xla_x = x.to('xla')
+    torch_xla.sync()
+    met.clear_all()
+
+    xla_y = torch.special.i1(xla_x * 2) + 1
+    self.assertEqual(met.executed_fallback_ops(), ['aten::special_i1'])
+    self.assertEqual(met.counter_value('FallbackHostCallback'), 1)
+    # The fallback operation is part of the pending graph, so nothing should
+    # have been executed or transferred so far.
+    self.assertEqual(_num_executions(), 0)
+    self.assertIsNone(met.metric_data('TransferFromDeviceTime'))
+
+    torch_xla.sync()
+    self.assertEqual(_num_executions(), 1)
+    torch.testing.assert_close(xla_y.cpu(), torch.special.i1(x * 2) + 1)
+
+  def test_fallback_with_scalar_arguments(self):
+    x = torch.rand(8, 4) + 0.5
+    xla_x = x.to('xla')
+    met.clear_all()
+    # Non-tensor arguments are part of the host callback, so each call must
+    # run with its own value.
+    xla_y = torch.polygamma(1, xla_x)
+    xla_z = torch.polygamma(2, xla_x)
+    self.assertEqual(met.counter_value('FallbackHostCallback'), 2)
+    torch.testing.assert_close(xla_y.cpu(), torch.polygamma(1, x))
+    torch.testing.assert_close(xla_z.cpu(), torch.polygamma(2, x))
+
+  def test_fallback_with_close_float_arguments(self):
+    # The two max values print the same with the default precision.
+    x = torch.tensor([2.0000002, 1.5])
+    xla_x = x.to('xla')
+    xla_y = torch.histc(xla_x, bins=2, min=0.0, max=2.0)
+    xla_z = torch.histc(xla_x, bins=2, min=0.0, max=2.0000005)
+    expected_y = torch.histc(x, bins=2, min=0.0, max=2.0)
+    expected_z = torch.histc(x, bins=2, min=0.0, max=2.0000005)
+    self.assertFalse(torch.equal(expected_y, expected_z))
+    torch.testing.assert_close(xla_y.cpu(), expected_y)
+    torch.testing.assert_close(xla_z.cpu(), expected_z)
+
+  def test_cached_graph_reuses_callback(self):
+    x = torch.rand(4, 4)
+    for _ in range(2):
+      xla_y = torch.special.i1(x.to('xla'))
+      torch_xla.sync()
+    met.clear_all()
+    xla_y = torch.special.i1(x.to('xla'))
+    torch_xla.sync()
+    self.assertFalse(met.counter_value('UncachedCompile'))
+    torch.testing.assert_close(xla_y.cpu(), torch.special.i1(x))
+
+  def test_data_dependent_fallback(self):
+    # nonzero has a data dependent output shape, so it must keep running
+    # through the regular CPU fallback.
+    met.clear_all()
+    x = torch.tensor([0, 1, 0, 2], device='xla')
+    self.assertEqual(torch.nonzero(x).cpu().flatten().tolist(), [1, 3])
+    self.assertFalse(met.counter_value('FallbackHostCallback'))
+
+
+if __name__ == '__main__':
+  test = unittest.main(exit=False)
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -62,14 +62,59 @@ class TestHloMetaData(unittest.TestCase):
     torch.manual_seed(42)
     self.pre_test_tensor_type = torch.get_default_dtype()
     self.pre_test_ir_debug = torch_xla._XLAC._get_ir_debug()
+    self.pre_test_metadata_level = torch_xla._XLAC._get_hlo_metadata_level()
     torch.set_default_tensor_type(torch.FloatTensor)
     torch_xla._XLAC._set_ir_debug(True)
     super(TestHloMetaData, self).setUp()
 
   def tearDown(self):
     super(TestHloMetaData, self).tearDown()
+    torch_xla._XLAC._set_hlo_metadata_level(self.pre_test_metadata_level)
     torch_xla._XLAC._set_ir_debug(self.pre_test_ir_debug)
 
+  def _lowered_metadata(self, level):
+    torch_xla._XLAC._set_hlo_metadata_level(level)
+    layer = torch.nn.Linear(4, 2).to(device='xla')
+    out = layer(torch.rand(4, 4, device='xla'))
+    ctx = torch_xla._XLAC.lowering.LoweringContext()
+    ctx.build([out])
+    metadata = []
+    for c in json.loads(ctx.hlo_json())["computations"]:
+      for op in c.get("instructions", []):
+        metadata.append(op.get("metadata", {}))
+    return metadata
+
+  def test_metadata_level_none(self):
+    met.clear_all()
+    metadata = self._lowered_metadata("none")
+    self.assertFalse(any(metadata))
+    self.assertFalse(met.counter_value("HloMetadataFrames"))
+    self.assertIsNone(met.metric_data("HloMetadataTime"))
+
+  def test_metadata_level_op_type(self):
+    met.clear_all()
+    metadata = self._lowered_metadata("op_type")
+    self.assertTrue(any(m.get("opType") == "aten__addmm" for m in metadata))
+    self.assertFalse(any("stackFrameId" in m for m in metadata))
+    self.assertFalse(met.counter_value("HloMetadataFrames"))
+    self.assertEqual(met.metric_data("HloMetadataTime")[0], 1)
+
+  def test_metadata_level_full(self):
+    met.clear_all()
+    metadata = self._lowered_metadata("full")
+    self.assertTrue(any("stackFrameId" in m for m in metadata))
+    self.assertGreater(met.counter_value("HloMetadataFrames"), 0)
+    self.assertEqual(met.metric_data("HloMetadataTime")[0], 1)
+
+  def test_metadata_level_is_part_of_graph_hash(self):
+    device = torch_xla.device()
+    t = torch.rand(4, 4, device=device)
+    torch_xla._XLAC._set_hlo_metadata_level("none")
+    no_metadata_hash = torch_xla._XLAC._get_graph_hash([t + 1])
+    torch_xla._XLAC._set_hlo_metadata_level("op_type")
+    op_type_hash = torch_xla._XLAC._get_graph_hash([t + 1])
+    self.assertNotEqual(no_metadata_hash, op_type_hash)
+
   def test_metadata(self):
     layer1 = torch.nn.Linear(4, 4)
     nl1 = torch.nn.ReLU()
@@ -0,0 +1,90 @@
+import sys
+import unittest
+
+import torch
+import torch_xla
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import host_offload
+
+
+class MemoryPlacementTest(unittest.TestCase):
+
+  def test_placement_is_lowered_as_annotation(self):
+    x = torch.rand(4, 4, device='xla')
+    y = host_offload.place_to_device(host_offload.place_to_host(x * 2))
+    self.assertIn('xla::memory_placement',
+                  torch_xla._XLAC._get_xla_tensors_text([y]))
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo([y])
+    self.assertEqual(
+        hlo.count('custom_call_target="annotate_device_placement"'), 2)
+    self.assertIn('_xla_buffer_placement="pinned_host"', hlo)
+    self.assertIn('_xla_buffer_placement="device"', hlo)
+
+  def test_placement_is_part_of_graph_hash(self):
+    x = torch.rand(4, 4, device='xla')
+    to_host = torch_xla._XLAC._get_graph_hash(
+        [host_offload.place_to_host(x + 1)])
+    to_device = torch_xla._XLAC._get_graph_hash(
+        [host_offload.place_to_device(x + 1)])
+    self.assertNotEqual(to_host, to_device)
+
+
+class HostOffloadTest(unittest.TestCase):
+
+  def setUp(self):
+    self.kind = host_offload.host_memory_kind()
+    if self.kind is None:
+      self.skipTest('the device has no host memory space')
+
+  def test_memory_kinds(self):
+    kinds = host_offload.memory_kinds()
+    self.assertIn(self.kind, kinds[1:])
+
+  def test_offload_and_load(self):
+    x = torch.rand(8, 8)
+    xla_x = x.to('xla') * 2
+    host_offload.offload([xla_x])
+    self.assertEqual(host_offload.memory_kind(xla_x), self.kind)
+    torch.testing.assert_close(xla_x.cpu(), x * 2)
+    host_offload.load([xla_x])
+    self.assertEqual(host_offload.memory_kind(xla_x), '')
+    torch.testing.assert_close(xla_x.cpu(), x * 2)
+
+  def test_graph_reads_offloaded_data(self):
+    x = torch.rand(8, 8)
+    xla_x = x.to('xla')
+    host_offload.offload([xla_x])
+    met.clear_all()
+    xla_y = xla_x @ xla_x + 1
+    torch_xla.sync()
+    torch.testing.assert_close(xla_y.cpu(), x @ x + 1)
+    # The offloaded data stays in host memory, and is not donated.
+    self.assertEqual(host_offload.memory_kind(xla_x), self.kind)
+    torch.testing.assert_close(xla_x.cpu(), x)
+
+  def test_offload_optimizer_state(self):
+
+    def train(offload):
+      torch.manual_seed(0)
+      model = torch.nn.Linear(8, 8).to('xla')
+      optimizer = torch.optim.Adam(model.parameters(), lr=0.1)
+      for _ in range(3):
+        optimizer.zero_grad()
+        model(torch.ones(4, 8, device='xla')).sum().backward()
+        optimizer.step()
+        torch_xla.sync()
+        if offload:
+          host_offload.offload_optimizer_state(optimizer)
+      return model, optimizer
+
+    model, _ = train(offload=False)
+    offloaded_model, optimizer = train(offload=True)
+    for state in optimizer.state.values():
+      self.assertEqual(host_offload.memory_kind(state['exp_avg']), self.kind)
+    torch.testing.assert_close(offloaded_model.weight.cpu(),
+                               model.weight.cpu())
+
+
+if __name__ == '__main__':
+  test = unittest.main(exit=False)
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -33,6 +33,11 @@ alias_with_buffer_donor_config_context = create_xla_config_context(
     torch_xla._XLAC._xla_get_enable_alias_with_buffer_donor_config,
 )
 
+auto_buffer_donation_context = create_xla_config_context(
+    torch_xla._XLAC._xla_set_auto_buffer_donation,
+    torch_xla._XLAC._xla_get_auto_buffer_donation,
+)
+
 
 # TODO(alanwaketan): add test for views.
 class InputOutputAliasesTest(parameterized.TestCase):
@@ -330,6 +335,52 @@ class InputOutputAliasesTest(parameterized.TestCase):
       torch_xla.sync()
       self.assertTrue(torch_xla._XLAC._get_buffer_donation(t0))
 
+  def test_auto_buffer_donation(self):
+    with auto_buffer_donation_context(True):
+      xla_device = torch_xla.device()
+      t0 = torch.randn(4, 2, 2).to(xla_device)
+      t1 = torch.randn(4, 2, 2).to(xla_device)
+      torch_xla.sync()
+      met.clear_all()
+      t0 *= 2
+      t1 += 2
+      # Syncing without resetting the tensor state does not donate as a step
+      # barrier would, so both donations come from the liveness analysis.
+      torch_xla._XLAC._xla_sync_multi([t0, t1], [str(xla_device)], True, False)
+
+      self.assertEqual(met.metric_data("InputOutputAliasCount")[1], 2.0)
+      self.assertEqual(met.metric_data("DonatedBufferBytes")[1], 2 * 16 * 4)
+
+  def test_auto_buffer_donation_pending_reader(self):
+    with auto_buffer_donation_context(True):
+      xla_device = torch_xla.device()
+      t0 = torch.tensor([1], device=xla_device)
+      t1 = torch.tensor([2], device=xla_device)
+      torch_xla.sync()
+      met.clear_all()
+
+      # The pending graph of t2, which is not synced, still reads the old
+      # buffer of t1, so only t0 is donated.
+      t2 = t1 * 3
+      t0.add_(1)
+      t1.add_(1)
+      torch_xla._XLAC._xla_sync_multi([t0, t1], [str(xla_device)], True, False)
+
+      self.assertEqual(met.metric_data("InputOutputAliasCount")[1], 1.0)
+      self.assertEqual(t2.item(), 6)
+      self.assertEqual(t1.item(), 3)
+
+  def test_auto_buffer_donation_disabled(self):
+    with auto_buffer_donation_context(False):
+      xla_device = torch_xla.device()
+      t0 = torch.randn(4, 2, 2).to(xla_device)
+      torch_xla.sync()
+      met.clear_all()
+      t0 *= 2
+      torch_xla._XLAC._xla_sync_multi([t0], [str(xla_device)], True, False)
+
+      self.assertIsNone(met.metric_data("DonatedBufferBytes"))
+
   def test_no_op_sync_keep_buffer_donation(self):
     xla_device = torch_xla.device()
     input = torch.randn(5, 5).to(xla_device)
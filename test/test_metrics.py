@@ -1,4 +1,6 @@
+import json
 import os
+import tempfile
 import time
 
 import torch
@@ -285,6 +287,260 @@ class MetricsTest(unittest.TestCase):
       self.assertEqual(
           set(ops), {"aten::nonzero", "aten::median", "torchvision::nms"})
 
+  def test_get_fallback_ops_time(self):
+    met.clear_all()
+    t1 = torch.tensor(100, device=torch_xla.device())
+    t2 = t1 * 2
+    t2.item()
+    times = met.executed_fallback_ops_time()
+    self.assertEqual(list(times.keys()), ["aten::_local_scalar_dense"])
+    self.assertGreater(times["aten::_local_scalar_dense"], 0)
+    self.assertIn("FallbackTime.aten::_local_scalar_dense", met.metric_names())
+
+  @unittest.skipIf(
+      XLAExperimentalContains("nms"), "nms is lowered with XLA_EXPERIMENTAL")
+  def test_fallback_batches_transfers(self):
+    import torchvision
+    N = 10
+    boxes = torch.rand(N, 4, device=torch_xla.device())
+    boxes[:, 2:] += boxes[:, :2]
+    scores = torch.rand(N, device=torch_xla.device())
+    torch_xla.sync()
+    met.clear_all()
+    keep = torchvision.ops.nms(boxes, scores, 0.5)
+    self.assertEqual(met.executed_fallback_ops(), ["torchvision::nms"])
+    # Both boxes and scores are fetched with a single transfer, and the result
+    # is uploaded with a single transfer.
+    self.assertEqual(met.metric_data("TransferFromDeviceTime")[0], 1)
+    self.assertEqual(met.metric_data("TransferToDeviceTime")[0], 1)
+    self.assertEqual(keep.device.type, "xla")
+
+  def test_computation_stats(self):
+    xla_device = torch_xla.device()
+    t1 = torch.randn(128, 64, device=xla_device)
+    t2 = torch.randn(64, 32, device=xla_device)
+    torch_xla.sync()
+    out = t1 @ t2
+    graph_hash = torch_xla._XLAC._get_graph_hash([out])
+    self.assertIsNone(met.computation_stats(graph_hash))
+    torch_xla.sync()
+    stats = met.computation_stats(graph_hash)
+    self.assertIsNotNone(stats)
+    self.assertEqual(stats['argument_size_in_bytes'], (128 * 64 + 64 * 32) * 4)
+    self.assertEqual(stats['output_size_in_bytes'], 128 * 32 * 4)
+    self.assertGreaterEqual(stats['flops'], 2 * 128 * 64 * 32)
+
+  def test_buffer_tracker(self):
+    import torch_xla.debug.buffer_tracker as buffer_tracker
+    xla_device = torch_xla.device()
+    buffer_tracker.enable()
+    try:
+      before = buffer_tracker.snapshot()
+      t1 = torch.randn(256, 256).to(xla_device)
+      t2 = t1 * 2
+      torch_xla.sync()
+      holders = buffer_tracker.diff(before, buffer_tracker.snapshot())
+      sites = {holder.site: holder for holder in holders}
+      self.assertIn('TransferToDevice', sites)
+      self.assertEqual(sites['TransferToDevice'].size_in_bytes, 256 * 256 * 4)
+      graph_sites = [site for site in sites if site.startswith('graph ')]
+      self.assertEqual(len(graph_sites), 1)
+      # Freed buffers are no longer reported. Only cached scalars remain.
+      del t1, t2
+      holders = buffer_tracker.diff(before, buffer_tracker.snapshot())
+      self.assertLess(
+          sum(holder.size_in_bytes for holder in holders), 256 * 256 * 4)
+    finally:
+      buffer_tracker.disable()
+    self.assertEqual(buffer_tracker.snapshot().buffers, [])
+
+  def test_buffer_tracker_frames(self):
+    import torch_xla.debug.buffer_tracker as buffer_tracker
+    buffer_tracker.enable(capture_frames=True)
+    try:
+      t1 = torch.randn(8).to(torch_xla.device())
+      sites = [holder.site for holder in buffer_tracker.top_holders()]
+      self.assertTrue(
+          any('test_buffer_tracker_frames' in site for site in sites), sites)
+    finally:
+      buffer_tracker.disable()
+
+  def test_event_log(self):
+    import torch_xla.debug.event_log as event_log
+    xla_device = torch_xla.device()
+    with tempfile.TemporaryDirectory() as tmpdir:
+      path = os.path.join(tmpdir, 'events.jsonl')
+      event_log.enable(path)
+      self.assertEqual(event_log.path(), path)
+      try:
+        t1 = torch.ones(17, 23).to(xla_device)
+        for _ in range(2):
+          t2 = t1 @ t1.T + 3
+          torch_xla.sync()
+        (t2 * 5).sum().item()
+      finally:
+        event_log.disable()
+      self.assertEqual(event_log.path(), '')
+      events = event_log.read(path)
+      report = event_log.report(path)
+
+    step_events = [event for event in events if event['reason'] == 'mark_step']
+    self.assertEqual([event['type'] for event in step_events],
+                     ['compile', 'execute', 'execute'])
+    self.assertEqual([event['cache'] for event in step_events],
+                     ['miss', 'miss', 'memory'])
+    self.assertGreater(step_events[0]['compile_time_us'], 0)
+    self.assertGreaterEqual(step_events[1]['input_bytes'], 17 * 23 * 4)
+    self.assertGreaterEqual(step_events[1]['output_bytes'], 17 * 17 * 4)
+    item_events = [event for event in events if event['reason'] == 'item']
+    self.assertEqual([event['type'] for event in item_events],
+                     ['compile', 'execute'])
+    for event in step_events + item_events:
+      self.assertIn('test_event_log', event['frame'])
+      self.assertTrue(event['device'])
+    self.assertIn('CompiledBy: mark_step at test_event_log', report)
+    self.assertIn('CompiledBy: item at test_event_log', report)
+
+  def test_event_log_dynamo_execute(self):
+    import torch_xla.debug.event_log as event_log
+    xla_device = torch_xla.device()
+    compiled = torch.compile(lambda t: t @ t.T + 3, backend='openxla')
+    t = torch.ones(17, 23, device=xla_device)
+    compiled(t)
+    with tempfile.TemporaryDirectory() as tmpdir:
+      path = os.path.join(tmpdir, 'events.jsonl')
+      event_log.enable(path)
+      try:
+        compiled(t).cpu()
+      finally:
+        event_log.disable()
+      events = event_log.read(path)
+
+    execute_events = [
+        event for event in events
+        if event['type'] == 'execute' and event['cache'] == 'memory'
+    ]
+    self.assertGreaterEqual(len(execute_events), 1)
+    self.assertGreaterEqual(execute_events[0]['output_bytes'], 17 * 17 * 4)
+
+  def test_event_log_analysis(self):
+    import torch_xla.debug.event_log as event_log
+    xla_device = torch_xla.device()
+    event_log.enable()
+    try:
+      t = torch.ones(7, 11, device=xla_device)
+      for _ in range(2):
+        for _ in range(3):
+          t = t * 2
+          t.sum().item()
+        torch_xla.sync()
+      findings = event_log.analyze()
+    finally:
+      event_log.disable()
+    sync_findings = [f for f in findings if f['analyzer'] == 'SyncInLoop']
+    self.assertEqual(len(sync_findings), 1)
+    self.assertIn('test_event_log_analysis', sync_findings[0]['description'])
+    self.assertIn('6 times during 2 steps', sync_findings[0]['description'])
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+      path = os.path.join(tmpdir, 'events.jsonl')
+      with open(path, 'w') as f:
+        for i in range(3):
+          f.write(
+              json.dumps({
+                  'type': 'compile',
+                  'graph_hash': str(i),
+                  'frame': 'train (train.py:10)',
+                  'compile_time_us': 1000000,
+                  'recompiled_node': 'f32[] prim::Constant, value=0.%d' % i,
+              }) + '\n')
+        f.write(
+            json.dumps({
+                'type': 'compile',
+                'graph_hash': 'padded',
+                'frame': 'eval (train.py:20)',
+                'compile_time_us': 1000,
+                'input_bytes': 4 << 20,
+                'output_bytes': 4 << 20,
+                'padding_bytes': 6 << 20,
+            }) + '\n')
+        f.write(
+            json.dumps({
+                'type': 'execute',
+                'graph_hash': 'padded',
+                'execute_time_us': 1000,
+            }) + '\n')
+      findings = event_log.analyze(path)
+      report = event_log.analysis_report(path)
+    self.assertEqual([f['analyzer'] for f in findings],
+                     ['ScalarConstantRecompile', 'OversizedPadding'])
+    self.assertEqual(findings[0]['estimated_cost_us'], 3000000)
+    self.assertEqual(findings[1]['estimated_cost_us'], 750)
+    self.assertIn('1. [ScalarConstantRecompile]', report)
+    self.assertIn('2. [OversizedPadding]', report)
+
+  def test_scalar_pool(self):
+    xla_device = torch_xla.device()
+    torch_xla._XLAC._xla_set_scalar_pool(True)
+    try:
+      t = torch.ones(5, 3, device=xla_device)
+      torch_xla.sync()
+      met.clear_all()
+      for lr in (0.125, 0.25, 0.375, 0.5):
+        out = t * lr + 2.5
+        torch_xla.sync()
+        self.assertTrue(
+            torch.allclose(out.cpu(), torch.full((5, 3), lr + 2.5)))
+    finally:
+      torch_xla._XLAC._xla_set_scalar_pool(False)
+    # The learning rate is a constant at the first step, and a parameter once
+    # it changed. The stable 2.5 stays a constant.
+    self.assertEqual(met.counter_value('ScalarPoolPromotions'), 1)
+    self.assertEqual(met.counter_value('ScalarPoolParameters'), 3)
+    self.assertGreaterEqual(met.counter_value('ScalarPoolConstants'), 5)
+    self.assertEqual(met.counter_value('ScalarPoolTransfers'), 3)
+    self.assertEqual(met.metric_data('CompileTime')[0], 2)
+
+  @unittest.skipIf(
+      os.environ.get('XLA_RECOMPILATION_HISTORY', '0') == '0',
+      'The recompilation tracker is off without XLA_RECOMPILATION_HISTORY')
+  def test_recompilation_diffs(self):
+    xla_device = torch_xla.device()
+    met.clear_recompilation_diffs()
+    for size in (29, 31):
+      t = torch.zeros(13, size).to(xla_device)
+      t = t.exp() + 1
+      torch_xla.sync()
+    diffs = met.recompilation_diffs()
+    self.assertEqual(len(diffs), 1)
+    diff = diffs[0]
+    self.assertEqual(diff['num_nodes'], diff['nearest_num_nodes'])
+    self.assertIn('f32[13,31]', diff['node'])
+    self.assertIn('f32[13,29]', diff['nearest_node'])
+    self.assertIn(diff['nearest_graph_hash'], diff['report'])
+    met.clear_recompilation_diffs()
+    self.assertEqual(met.recompilation_diffs(), [])
+
+  def test_step_breakdown(self):
+    xla_device = torch_xla.device()
+    t = torch.ones(19, 37).to(xla_device)
+    for _ in range(3):
+      t = (t * 2).tanh()
+      torch_xla.sync()
+    t.cpu()
+    steps = met.step_breakdown()
+    self.assertGreaterEqual(len(steps), 3)
+    last_steps = steps[-3:]
+    for step in last_steps:
+      self.assertGreater(step['step_time'], 0)
+      self.assertGreaterEqual(step['tracing'], 0)
+    # The first step compiles the graph, and the next ones hit the cache.
+    self.assertGreater(last_steps[0]['compile'], 0)
+    self.assertGreater(last_steps[0]['lowering'], 0)
+    self.assertEqual(last_steps[-1]['compile'], 0)
+    self.assertIn('StepExecuteWaitTime', met.metric_names())
+    self.assertIn('bound', met.step_breakdown_report())
+
 
 if __name__ == '__main__':
   test = unittest.main()
@@ -54,6 +54,10 @@ import torch_xla.utils.serialization as xser
 import torch_xla.core.xla_model as xm
 import torch_xla.core.functions as xf
 import torch_xla.debug.profiler as xp
+from torch_xla.experimental import dynamic_padding
+from torch_xla.experimental.linear_cross_entropy import linear_cross_entropy
+from torch_xla.experimental import row_sparse
+from torch_xla.experimental.batched_nms import batched_nms
 import unittest
 import test_utils
 
@@ -436,6 +440,65 @@ class TestDynamicShape(test_utils.XlaTestCase):
     t2 = torch.nonzero(t1.int()).float()
     torch_xla.sync()
 
+  def test_nonzero_padded(self):
+    x = torch.tensor((0, 1, 2, 0, 3, 4), device='xla')
+    indices, count = dynamic_padding.nonzero(x)
+    self.assertEqual(count.item(), 4)
+    self.assertEqual(indices.shape, (4, 1))
+    self.assertEqual(indices.cpu(), torch.nonzero(x.cpu()))
+    indices, count = dynamic_padding.nonzero(x, bound=6)
+    self.assertEqual(indices.shape, (6, 1))
+    self.assertEqual(indices[:count.item()].cpu(), torch.nonzero(x.cpu()))
+    self.assertEqual(indices[4:].cpu(), torch.zeros(2, 1, dtype=indices.dtype))
+
+  def test_masked_select_padded(self):
+    x = torch.tensor((0, 5, 2, 0, 3, 4), device='xla')
+    values, count = dynamic_padding.masked_select(x, x.ge(2), bound=8)
+    self.assertEqual(count.item(), 4)
+    self.assertEqual(values.shape, (8,))
+    self.assertEqual(values[:4].cpu(), torch.tensor((5, 2, 3, 4)))
+    self.assertEqual(
+        dynamic_padding.masked_sum(values, count).item(), 5 + 2 + 3 + 4)
+    self.assertEqual(dynamic_padding.masked_max(values, count).item(), 5)
+
+  def test_padded_bound_below_count(self):
+    x = torch.tensor((1., 2., 3., 4., 5., 6.), device='xla')
+    values, count = dynamic_padding.masked_select(x, x.ge(2), bound=3)
+    self.assertEqual(count.item(), 3)
+    self.assertEqual(values.cpu(), torch.tensor((2., 3., 4.)))
+    self.assertEqual(dynamic_padding.masked_mean(values, count).item(), 3.)
+    indices, count = dynamic_padding.nonzero(x, bound=2)
+    self.assertEqual(count.item(), 2)
+    values, count = dynamic_padding.unique(x, bound=4)
+    self.assertEqual(count.item(), 4)
+
+  def test_unique_padded(self):
+    x = torch.tensor((3, 1, 3, 7, 1, 1), device='xla')
+    values, count = dynamic_padding.unique(x)
+    self.assertEqual(count.item(), 3)
+    self.assertEqual(values.shape, (4,))
+    self.assertEqual(values[:3].cpu(), torch.tensor((1, 3, 7)))
+
+  def test_padded_size_reused(self):
+    met.clear_all()
+    for n in (5, 6, 7):
+      x = torch.zeros(16, device='xla')
+      x[:n] = 1
+      indices, count = dynamic_padding.nonzero(x)
+      self.assertEqual(indices.shape, (8, 1))
+      self.assertEqual(count.item(), n)
+    self.assertEqual(met.counter_value('DynamicPaddingRecompilesAvoided'), 2)
+
+  def test_approx_topk(self):
+    x = torch.rand(4, 1000)
+    values, indices = torch_xla._XLAC._xla_approx_topk(
+        x.to('xla'), 10, 1, True, 0.95)
+    self.assertEqual(values.shape, (4, 10))
+    self.assertEqual(indices.shape, (4, 10))
+    # Every value returned must be at its reported index, even when the
+    # approximation misses some of the exact top-k values.
+    self.assertEqual(x.gather(1, indices.cpu()), values.cpu())
+
 
 class TestOptimizationBarrier(test_utils.XlaTestCase):
 
@@ -1837,6 +1900,60 @@ class TestAtenXlaTensor(test_utils.XlaTestCase):
     t2 = torch.randn(5, 5, device=device)
     self.assertTrue(torch.allclose(t1.cpu(), t2.cpu()))
 
+  def test_rng_reproducible_across_graph_splits(self):
+    device = torch_xla.device()
+
+    def draw(split):
+      torch_xla.manual_seed(12345)
+      results = []
+      for i in range(4):
+        results.append(torch.rand(8, device=device))
+        if split and i % 2 == 0:
+          torch_xla.sync()
+      torch_xla.sync()
+      return [t.cpu() for t in results]
+
+    unsplit = draw(split=False)
+    split = draw(split=True)
+    for t1, t2 in zip(unsplit, split):
+      self.assertTrue(torch.equal(t1, t2))
+    self.assertFalse(torch.equal(unsplit[0], unsplit[1]))
+
+  def test_rng_seeds_are_independent(self):
+    device = torch_xla.device()
+    torch_xla.manual_seed(12345)
+    tensors = [torch.rand(8, device=device) for _ in range(3)]
+    ir = torch_xla._XLAC._get_xla_tensors_text(tensors)
+    # Every random op derives its seed from the base seed, rather than from
+    # the seed of the previous op.
+    self.assertEqual(ir.count('xla::rng_seed'), 3)
+    for offset in range(3):
+      self.assertIn(f'offset={offset}', ir)
+    torch_xla.sync()
+
+  def test_rng_close_seeds_share_no_draws(self):
+    device = torch_xla.device()
+
+    def draw(seed):
+      torch_xla.manual_seed(seed)
+      tensors = [torch.rand(8, device=device) for _ in range(4)]
+      torch_xla.sync()
+      return set(torch.cat(tensors).cpu().tolist())
+
+    # The sequence of a seed must not be the sequence of the next seed shifted
+    # by some random ops.
+    self.assertFalse(draw(12345) & draw(12346))
+
+  def test_rng_state_restores_sequence(self):
+    device = torch_xla.device()
+    torch_xla.manual_seed(12345)
+    torch.rand(8, device=device)
+    state = xm.get_rng_state()
+    t1 = torch.rand(8, device=device)
+    xm.set_rng_state(state)
+    t2 = torch.rand(8, device=device)
+    self.assertTrue(torch.equal(t1.cpu(), t2.cpu()))
+
   def test_cached_addcdiv(self):
     xla_device = torch_xla.device()
     met.clear_all()
@@ -3191,6 +3308,264 @@ class TestActivationCheckpoint(test_utils.XlaTestCase):
       self.assertEqual(opt_barrier.count("f32[128]"), 2)
       self.assertEqual(opt_barrier.count("f32[64,64]"), 2)
 
+  def test_auto_rematerialization(self):
+
+    def fn(x, w):
+      a = torch.relu(x)
+      b = a @ w
+      for _ in range(4):
+        b = torch.tanh(b @ w)
+      return b * a
+
+    device = torch_xla.device()
+    x = torch.randn(64, 64)
+    w = torch.randn(64, 64)
+    expected = fn(x, w)
+    torch_xla._XLAC._xla_set_rematerialization_budget(1)
+    try:
+      met.clear_all()
+      actual = fn(x.to(device), w.to(device))
+      torch_xla.sync()
+    finally:
+      torch_xla._XLAC._xla_set_rematerialization_budget(0)
+    # The relu output is recomputed for the final multiplication.
+    self.assertEqual(met.metric_data('RematerializedNodes')[1], 1)
+    self.assertGreater(met.metric_data('RematerializationSavedBytes')[1], 0)
+    self.assertEqual(actual, expected, prec=1e-3)
+
+
+class TestScaledDotProductAttention(test_utils.XlaTestCase):
+
+  def _run_attention(self, query, key, value, **kwargs):
+    # The CPU math kernel is the decomposed matmul/softmax reference.
+    inputs = [t.clone().requires_grad_() for t in (query, key, value)]
+    expected = F.scaled_dot_product_attention(*inputs, **kwargs)
+    expected.sum().backward()
+    expected_grads = [t.grad for t in inputs]
+
+    device = torch_xla.device()
+    kwargs = {
+        name: arg.to(device) if isinstance(arg, torch.Tensor) else arg
+        for name, arg in kwargs.items()
+    }
+    xla_inputs = [
+        t.to(device).detach().requires_grad_() for t in (query, key, value)
+    ]
+    met.clear_all()
+    output = F.scaled_dot_product_attention(*xla_inputs, **kwargs)
+    output.sum().backward()
+    self.assertIn('xla::scaled_dot_product_attention', met.counter_names())
+    self.assertNotIn('ScaledDotProductAttentionFallback', met.counter_names())
+    self.assertEqual(output.cpu(), expected, prec=1e-4)
+    for grad, expected_grad in zip(xla_inputs, expected_grads):
+      self.assertEqual(grad.grad.cpu(), expected_grad, prec=1e-4)
+
+  def test_sdpa(self):
+    # More keys than a single block, and not a multiple of the block size.
+    query = torch.randn(2, 3, 16, 8)
+    key = torch.randn(2, 3, 1100, 8)
+    value = torch.randn(2, 3, 1100, 4)
+    self._run_attention(query, key, value)
+    self._run_attention(query, key, value, scale=0.3)
+
+  def test_sdpa_causal(self):
+    query = torch.randn(2, 64, 16)
+    key = torch.randn(2, 1030, 16)
+    value = torch.randn(2, 1030, 16)
+    self._run_attention(query, key, value, is_causal=True)
+
+  def test_sdpa_padding_mask(self):
+    query = torch.randn(2, 4, 32, 8)
+    key = torch.randn(2, 4, 700, 8)
+    value = torch.randn(2, 4, 700, 8)
+    mask = torch.ones(2, 1, 1, 700, dtype=torch.bool)
+    mask[0, :, :, 600:] = False
+    mask[1, :, :, 100:] = False
+    self._run_attention(query, key, value, attn_mask=mask)
+
+  def test_sdpa_additive_mask(self):
+    query = torch.randn(3, 24, 8)
+    key = torch.randn(3, 40, 8)
+    value = torch.randn(3, 40, 8)
+    mask = torch.randn(24, 40)
+    self._run_attention(query, key, value, attn_mask=mask)
+
+  def test_sdpa_fully_masked_row(self):
+    query = torch.randn(2, 6, 8)
+    key = torch.randn(2, 20, 8)
+    value = torch.randn(2, 20, 8)
+    mask = torch.ones(6, 20, dtype=torch.bool)
+    mask[2] = False
+    # The reference leaves out the query row which attends to no key, so its
+    # query gradient stays zero.
+    rows = [0, 1, 3, 4, 5]
+    inputs = [t.clone().requires_grad_() for t in (query, key, value)]
+    expected = F.scaled_dot_product_attention(
+        inputs[0][:, rows], inputs[1], inputs[2], attn_mask=mask[rows])
+    expected.sum().backward()
+
+    device = torch_xla.device()
+    xla_inputs = [
+        t.to(device).detach().requires_grad_() for t in (query, key, value)
+    ]
+    output = F.scaled_dot_product_attention(
+        *xla_inputs, attn_mask=mask.to(device))
+    output.sum().backward()
+    output = output.cpu()
+    self.assertEqual(output[:, 2], torch.zeros(2, 8))
+    self.assertEqual(output[:, rows], expected, prec=1e-4)
+    for grad, expected_input in zip(xla_inputs, inputs):
+      self.assertFalse(grad.grad.cpu().isnan().any())
+      self.assertEqual(grad.grad.cpu(), expected_input.grad, prec=1e-4)
+
+  def test_sdpa_dropout_fallback(self):
+    device = torch_xla.device()
+    query = torch.randn(2, 8, 4, device=device)
+    met.clear_all()
+    F.scaled_dot_product_attention(query, query, query, dropout_p=0.5)
+    self.assertIn('ScaledDotProductAttentionFallback', met.counter_names())
+
+
+class TestLinearCrossEntropy(test_utils.XlaTestCase):
+
+  def _run_loss(self, hidden, weight, target, **kwargs):
+    inputs = [t.clone().requires_grad_() for t in (hidden, weight)]
+    expected = F.cross_entropy(inputs[0] @ inputs[1].T, target, **kwargs)
+    expected.sum().backward()
+
+    device = torch_xla.device()
+    xla_inputs = [
+        t.to(device).detach().requires_grad_() for t in (hidden, weight)
+    ]
+    loss = linear_cross_entropy(
+        *xla_inputs, target.to(device), vocab_block=64, **kwargs)
+    loss.sum().backward()
+    self.assertEqual(loss.cpu(), expected, prec=1e-4)
+    for grad, expected_grad in zip(xla_inputs, inputs):
+      self.assertEqual(grad.grad.cpu(), expected_grad.grad, prec=1e-4)
+
+  def test_linear_cross_entropy(self):
+    # The vocabulary is not a multiple of the block size.
+    hidden = torch.randn(32, 16)
+    weight = torch.randn(200, 16)
+    target = torch.randint(0, 200, (32,))
+    for reduction in ('mean', 'sum', 'none'):
+      self._run_loss(hidden, weight, target, reduction=reduction)
+
+  def test_linear_cross_entropy_ignore_index(self):
+    hidden = torch.randn(32, 16)
+    weight = torch.randn(150, 16)
+    target = torch.randint(0, 150, (32,))
+    target[::3] = -100
+    self._run_loss(hidden, weight, target)
+    target[::3] = 7
+    self._run_loss(hidden, weight, target, ignore_index=7)
+
+  def test_linear_cross_entropy_batch_dims(self):
+    device = torch_xla.device()
+    hidden = torch.randn(2, 8, 16)
+    weight = torch.randn(100, 16)
+    target = torch.randint(0, 100, (2, 8))
+    expected = F.cross_entropy(
+        (hidden @ weight.T).transpose(1, 2), target, reduction='none')
+    loss = linear_cross_entropy(
+        hidden.to(device),
+        weight.to(device),
+        target.to(device),
+        reduction='none')
+    self.assertEqual(loss.cpu(), expected, prec=1e-4)
+
+
+class TestRowSparse(test_utils.XlaTestCase):
+
+  def _dense_grad(self, indices, weight, grad_output, padding_idx=None):
+    weight = weight.clone().requires_grad_()
+    F.embedding(indices, weight, padding_idx).backward(grad_output)
+    return weight.grad
+
+  def test_embedding_grad(self):
+    device = torch_xla.device()
+    weight = torch.randn(50, 8)
+    indices = torch.randint(0, 50, (4, 16))
+    grad_output = torch.randn(4, 16, 8)
+    for padding_idx in (None, 3):
+      indices[0, :4] = 3
+      xla_weight = weight.to(device).requires_grad_()
+      out = row_sparse.embedding(indices.to(device), xla_weight, padding_idx)
+      out.backward(grad_output.to(device))
+      self.assertIsNone(xla_weight.grad)
+      grad = xla_weight.row_sparse_grad
+      expected = self._dense_grad(indices, weight, grad_output, padding_idx)
+      self.assertEqual(grad.densify().cpu(), expected, prec=1e-4)
+      unique = torch.unique(indices)
+      if padding_idx is not None:
+        unique = unique[unique != padding_idx]
+      self.assertEqual(grad.count.item(), unique.numel())
+      self.assertEqual(grad.rows.cpu()[:unique.numel()], unique)
+
+  def test_embedding_grad_accumulates(self):
+    device = torch_xla.device()
+    weight = torch.randn(30, 4)
+    indices = [torch.randint(0, 30, (12,)) for _ in range(2)]
+    xla_weight = weight.to(device).requires_grad_()
+    expected = torch.zeros_like(weight)
+    for step_indices in indices:
+      grad_output = torch.randn(12, 4)
+      row_sparse.embedding(step_indices.to(device),
+                           xla_weight).backward(grad_output.to(device))
+      expected += self._dense_grad(step_indices, weight, grad_output)
+    self.assertEqual(
+        xla_weight.row_sparse_grad.densify().cpu(), expected, prec=1e-4)
+    row_sparse.zero_grad(xla_weight)
+    self.assertIsNone(xla_weight.row_sparse_grad)
+
+  def test_coalesce_drops_out_of_range_rows(self):
+    device = torch_xla.device()
+    rows = torch.tensor([4, -1, 2, 9, 4, 10])
+    values = torch.arange(6, dtype=torch.float32).reshape(6, 1)
+    grad = row_sparse.coalesce(rows.to(device), values.to(device), num_rows=10)
+    self.assertEqual(grad.count.item(), 3)
+    self.assertEqual(grad.rows.cpu(), torch.tensor([2, 4, 9, 10, 10, 10]))
+    self.assertEqual(grad.values.cpu()[:3],
+                     torch.tensor([[2.0], [4.0], [3.0]]))
+
+  def test_sgd_step(self):
+    device = torch_xla.device()
+    weight = torch.randn(40, 8)
+    indices = torch.randint(0, 40, (20,))
+    grad_output = torch.randn(20, 8)
+    xla_weight = weight.to(device).requires_grad_()
+    row_sparse.embedding(indices.to(device),
+                         xla_weight).backward(grad_output.to(device))
+    row_sparse.sgd_step_(xla_weight, xla_weight.row_sparse_grad, lr=0.1)
+    expected = weight - 0.1 * self._dense_grad(indices, weight, grad_output)
+    self.assertEqual(xla_weight.detach().cpu(), expected, prec=1e-4)
+
+  def test_adam_step(self):
+    device = torch_xla.device()
+    weight = torch.randn(40, 8)
+    indices = torch.randint(0, 40, (20,))
+    grad_output = torch.randn(20, 8)
+    sparse_weight = torch.nn.Parameter(weight.clone())
+    optimizer = torch.optim.SparseAdam([sparse_weight], lr=0.01)
+    F.embedding(indices, sparse_weight, sparse=True).backward(grad_output)
+    optimizer.step()
+
+    xla_weight = weight.to(device).requires_grad_()
+    exp_avg = torch.zeros_like(xla_weight)
+    exp_avg_sq = torch.zeros_like(xla_weight)
+    row_sparse.embedding(indices.to(device),
+                         xla_weight).backward(grad_output.to(device))
+    row_sparse.adam_step_(
+        xla_weight,
+        exp_avg,
+        exp_avg_sq,
+        xla_weight.row_sparse_grad,
+        step=1,
+        lr=0.01)
+    self.assertEqual(xla_weight.detach().cpu(), sparse_weight.detach(),
+                     prec=1e-4)
+
 
 # These tests were extracted and adapted from torchvision.
 # Source: vision/test/test_ops.py
@@ -3271,6 +3646,59 @@ class TestNMS(test_utils.XlaTestCase):
     self.runAtenTest((boxes, scores), fn)
 
 
+class TestBatchedNMS(test_utils.XlaTestCase):
+
+  def _random_boxes(self, batch, n):
+    boxes = torch.rand(batch, n, 4) * 100
+    boxes[..., 2:] += boxes[..., :2]
+    return boxes
+
+  def _check(self, boxes, scores, classes, valid_counts, iou, max_output_size,
+             tile_size):
+    import torchvision
+    device = torch_xla.device()
+    indices, counts = batched_nms(
+        boxes.to(device),
+        scores.to(device),
+        iou,
+        max_output_size,
+        classes=classes.to(device),
+        valid_counts=valid_counts.to(device),
+        tile_size=tile_size)
+    indices = indices.cpu()
+    counts = counts.cpu()
+    for b in range(boxes.shape[0]):
+      n = valid_counts[b].item()
+      keep = torchvision.ops.batched_nms(boxes[b, :n], scores[b, :n],
+                                         classes[b, :n], iou)
+      keep = keep[:max_output_size].to(torch.int32)
+      self.assertEqual(counts[b].item(), keep.numel())
+      self.assertEqual(indices[b, :keep.numel()], keep)
+      self.assertTrue((indices[b, keep.numel():] == -1).all())
+
+  def test_batched_nms(self):
+    torch.random.manual_seed(0)
+    boxes = self._random_boxes(3, 300)
+    scores = torch.rand(3, 300)
+    classes = torch.randint(0, 4, (3, 300), dtype=torch.int32)
+    valid_counts = torch.tensor([300, 120, 0], dtype=torch.int32)
+    for iou in (0.2, 0.5):
+      # The box count is not a multiple of the tile size.
+      self._check(boxes, scores, classes, valid_counts, iou, 100, 64)
+      self._check(boxes, scores, classes, valid_counts, iou, 400, 512)
+
+  def test_batched_nms_class_agnostic(self):
+    device = torch_xla.device()
+    boxes = torch.tensor([[[0, 0, 10, 10], [1, 1, 10, 10], [20, 20, 30, 30]]],
+                         dtype=torch.float)
+    scores = torch.tensor([[0.9, 0.8, 0.7]])
+    indices, counts = batched_nms(
+        boxes.to(device), scores.to(device), 0.5, max_output_size=4)
+    self.assertEqual(indices.cpu(),
+                     torch.tensor([[0, 2, -1, -1]], dtype=torch.int32))
+    self.assertEqual(counts.cpu(), torch.tensor([2], dtype=torch.int32))
+
+
 class TestHelperFunction(test_utils.XlaTestCase):
 
   def test_repeat_truncated(self):
@@ -161,6 +161,7 @@ allowed_opinfo = get_allowed_ops_map(
     AllowedOpInfoEntry('nn.functional.hardshrink'),
     AllowedOpInfoEntry('nn.functional.hardtanh'),
     AllowedOpInfoEntry('nn.functional.gelu'),
+    AllowedOpInfoEntry('nn.functional.embedding_bag'),
     AllowedOpInfoEntry('nn.functional.relu6'),
     AllowedOpInfoEntry('mm'),
     AllowedOpInfoEntry('mode'),
@@ -383,10 +384,6 @@ allowed_opinfo = get_allowed_ops_map(
 )
 
 allowed_fallback_opinfo = get_allowed_ops_map(
-    AllowedFallbackOpInfoEntry(
-        'nn.functional.embedding_bag',
-        fallback_ops={"aten::_embedding_bag"},
-    ),
     AllowedFallbackOpInfoEntry(
         'unique',
         fallback_ops={"aten::_unique2"},
@@ -189,6 +189,112 @@ class TestSyncFreeAdam(TestSyncFreeOptimizerBase):
     self._test_adam_optimizer_helper(syncfree.AdamW, torch.optim.AdamW)
 
 
+class TestForeachOptimizerStep(unittest.TestCase):
+
+  def _make_tensors(self, device):
+    shapes = [(3, 4), (5,), (2, 3, 2), ()]
+    return [torch.randn(shape).to(device) for shape in shapes]
+
+  def _assert_all_close(self, tensors, ref_tensors):
+    for t, t_ref in zip(tensors, ref_tensors):
+      np.testing.assert_allclose(
+          t.cpu().numpy(), t_ref.cpu().numpy(), rtol=1e-5, atol=1e-6)
+
+  def _test_adam(self, pack, found_inf_value, amsgrad, use_adamw):
+    device = torch_xla.device()
+    torch.manual_seed(0)
+    params = self._make_tensors(device)
+    grads = self._make_tensors(device)
+    found_inf = torch.tensor(found_inf_value).to(device)
+    states = []
+    for _ in range(2):
+      steps = [torch.zeros_like(found_inf) for _ in params]
+      exp_avgs = [torch.zeros_like(p) for p in params]
+      exp_avg_sqs = [torch.zeros_like(p) for p in params]
+      max_exp_avg_sqs = [torch.zeros_like(p) for p in params]
+      states.append((steps, [p.clone() for p in params], exp_avgs, exp_avg_sqs,
+                     max_exp_avg_sqs))
+    kwargs = dict(
+        beta1=0.9,
+        beta2=0.99,
+        lr=1e-2,
+        weight_decay=0.1,
+        eps=1e-8,
+        amsgrad=amsgrad,
+        maximize=False,
+        use_adamw=use_adamw)
+    for _ in range(3):
+      syncfree._functional.adam_step(
+          found_inf, *states[0][:2], grads, *states[0][2:], pack=pack, **kwargs)
+      syncfree._functional.adam_step(
+          found_inf, *states[1][:2], grads, *states[1][2:], foreach=False,
+          **kwargs)
+      torch_xla.sync()
+    for tensors, ref_tensors in zip(states[0], states[1]):
+      self._assert_all_close(tensors, ref_tensors)
+
+  def _test_sgd(self, pack, found_inf_value, momentum):
+    device = torch_xla.device()
+    torch.manual_seed(0)
+    params = self._make_tensors(device)
+    grads = self._make_tensors(device)
+    found_inf = torch.tensor(found_inf_value).to(device)
+    states = []
+    for _ in range(2):
+      steps = [torch.zeros_like(found_inf) for _ in params]
+      states.append((steps, [p.clone() for p in params], [None] * len(params)))
+    kwargs = dict(
+        weight_decay=0.1,
+        momentum=momentum,
+        lr=1e-2,
+        dampening=0.1,
+        nesterov=False,
+        maximize=False)
+    for _ in range(3):
+      syncfree._functional.sgd_step(
+          found_inf, *states[0][:2], grads, states[0][2], pack=pack, **kwargs)
+      syncfree._functional.sgd_step(
+          found_inf, *states[1][:2], grads, states[1][2], foreach=False,
+          **kwargs)
+      torch_xla.sync()
+    for tensors, ref_tensors in zip(states[0], states[1]):
+      self._assert_all_close(tensors, ref_tensors)
+
+  def test_adam(self):
+    for pack in [False, True]:
+      for found_inf_value in [0.0, 1.0]:
+        for amsgrad in [False, True]:
+          for use_adamw in [False, True]:
+            self._test_adam(pack, found_inf_value, amsgrad, use_adamw)
+
+  def test_sgd(self):
+    for pack in [False, True]:
+      for found_inf_value in [0.0, 1.0]:
+        for momentum in [0.0, 0.5]:
+          self._test_sgd(pack, found_inf_value, momentum)
+
+  def test_single_node(self):
+    device = torch_xla.device()
+    params = self._make_tensors(device)
+    grads = self._make_tensors(device)
+    found_inf = torch.tensor(0.0).to(device)
+    steps = [torch.zeros_like(found_inf) for _ in params]
+    syncfree._functional.sgd_step(
+        found_inf,
+        steps,
+        params,
+        grads, [None] * len(params),
+        weight_decay=0.0,
+        momentum=0.0,
+        lr=1e-2,
+        dampening=0.0,
+        nesterov=False,
+        maximize=False)
+    ir = torch_xla._XLAC._get_xla_tensors_text(params)
+    self.assertEqual(ir.count('xla::foreach_sgd_optimizer_step'), 1)
+    self.assertNotIn('xla::sgd_optimizer_step', ir)
+
+
 if __name__ == "__main__":
   test = unittest.main(verbosity=FLAGS.verbosity, exit=False)
   sys.exit(0 if test.result.wasSuccessful() else 1)
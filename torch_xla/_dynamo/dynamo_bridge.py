@@ -83,8 +83,9 @@ class GraphInputMatcher:
           str_device = str(traced_xla_value.device)
           inp = torch_xla._XLAC._get_base_seed_as_tensor(str_device)
           # update random seed here to avoid random operations always return
-          # the same result. The seed update logic is the same as
-          # `torch_xla.sync()` in https://github.com/pytorch/pytorch/blob/6af6b8f728426fb7551630e28148c0017fa501bc/torch/csrc/lazy/core/lazy_graph_executor.cpp#L144C18-L144C51
+          # the same result. The random ops of the graph derive their seeds
+          # from this base seed and their counter offsets. The next base comes
+          # from the LCG update from https://github.com/pytorch/pytorch/blob/6af6b8f728426fb7551630e28148c0017fa501bc/torch/csrc/lazy/core/lazy_graph_executor.cpp#L144C18-L144C51
           # Note: don't do `inp.item()` here since it will trigger a transferFromDevice
           xm.set_rng_state(
               (1012031 + torch_xla._XLAC._xla_get_rng_seed() * 7012063) %
@@ -8,10 +8,22 @@ def adam_step(found_inf: Tensor, state_steps: List[Tensor],
               params: List[Tensor], grads: List[Tensor], exp_avgs: List[Tensor],
               exp_avg_sqs: List[Tensor], max_exp_avg_sqs: List[Tensor], *,
               amsgrad: bool, beta1: float, beta2: float, lr: float,
-              weight_decay: float, eps: float, maximize: bool, use_adamw: bool):
+              weight_decay: float, eps: float, maximize: bool, use_adamw: bool,
+              foreach: bool = True, pack: bool = False):
   r"""Functional API that performs PT-XLA sync-free Adam/AdamW algorithm computation
+
+  With `foreach`, all the params are updated by a single fused op. With `pack`
+  as well, params of the same dtype are updated as one flat buffer.
    """
 
+  if foreach:
+    if params:
+      torch_xla._XLAC._xla_foreach_adam_optimizer_step_(
+          found_inf, state_steps, params, grads, exp_avgs, exp_avg_sqs,
+          max_exp_avg_sqs, beta1, beta2, lr, weight_decay, eps, amsgrad,
+          maximize, use_adamw, pack)
+    return
+
   for i, param in enumerate(params):
     grad = grads[i]
     exp_avg = exp_avgs[i]
@@ -29,17 +41,28 @@ def sgd_step(found_inf: Tensor, state_steps: List[Tensor], params: List[Tensor],
              d_p_list: List[Tensor],
              momentum_buffer_list: List[Optional[Tensor]], *,
              weight_decay: float, momentum: float, lr: float, dampening: float,
-             nesterov: bool, maximize: bool):
+             nesterov: bool, maximize: bool, foreach: bool = True,
+             pack: bool = False):
   r"""Functional API that performs PT-XLA sync-free SGD algorithm computation.
+
+  With `foreach`, all the params are updated by a single fused op. With `pack`
+  as well, params of the same dtype are updated as one flat buffer.
         """
 
+  for i, d_p in enumerate(d_p_list):
+    if momentum_buffer_list[i] is None:
+      momentum_buffer_list[i] = torch.clone(d_p).detach()
+
+  if foreach:
+    if params:
+      torch_xla._XLAC._xla_foreach_sgd_optimizer_step_(
+          found_inf, state_steps, params, momentum_buffer_list, d_p_list,
+          weight_decay, momentum, lr, dampening, nesterov, maximize, pack)
+    return
+
   for i, param in enumerate(params):
-    d_p = d_p_list[i]
-    buf = momentum_buffer_list[i]
-    step = state_steps[i]
-    if buf is None:
-      buf = torch.clone(d_p).detach()
-      momentum_buffer_list[i] = buf
-    torch_xla._XLAC._xla_sgd_optimizer_step_(found_inf, step, param, buf, d_p,
-                                             weight_decay, momentum, lr,
-                                             dampening, nesterov, maximize)
+    torch_xla._XLAC._xla_sgd_optimizer_step_(found_inf, state_steps[i], param,
+                                             momentum_buffer_list[i],
+                                             d_p_list[i], weight_decay,
+                                             momentum, lr, dampening, nesterov,
+                                             maximize)
@@ -228,6 +228,57 @@ torch::autograd::variable_list MaxPool3dAutogradFunction::backward(
   return grad_inputs;
 }
 
+torch::Tensor ScaledDotProductAttentionAutogradFunction::forward(
+    torch::autograd::AutogradContext* ctx, torch::Tensor query,
+    torch::Tensor key, torch::Tensor value, torch::Tensor attn_mask,
+    bool is_causal, double scale) {
+  ctx->saved_data["is_causal"] = is_causal;
+  ctx->saved_data["scale"] = scale;
+  XLATensorPtr xla_mask;
+  if (attn_mask.defined()) {
+    xla_mask = bridge::GetXlaTensor(attn_mask);
+  }
+  std::tuple<XLATensorPtr, XLATensorPtr> outputs =
+      tensor_methods::scaled_dot_product_attention(
+          bridge::GetXlaTensor(query), bridge::GetXlaTensor(key),
+          bridge::GetXlaTensor(value), xla_mask, is_causal, scale);
+  torch::Tensor output = bridge::AtenFromXlaTensor(std::get<0>(outputs));
+  // Only the per row log-sum-exp is kept for the backward, which rebuilds the
+  // attention probabilities block by block.
+  torch::Tensor logsumexp = bridge::AtenFromXlaTensor(std::get<1>(outputs));
+  ctx->save_for_backward({query, key, value, attn_mask, output, logsumexp});
+  return output;
+}
+
+torch::autograd::variable_list
+ScaledDotProductAttentionAutogradFunction::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::variable_list grad_output) {
+  bool is_causal = ctx->saved_data["is_causal"].toBool();
+  double scale = ctx->saved_data["scale"].toDouble();
+  torch::autograd::variable_list saved = ctx->get_saved_variables();
+  XLATensorPtr xla_mask;
+  if (saved[3].defined()) {
+    xla_mask = bridge::GetXlaTensor(saved[3]);
+  }
+  std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> grads =
+      tensor_methods::scaled_dot_product_attention_backward(
+          bridge::GetXlaTensor(grad_output[0]), bridge::GetXlaTensor(saved[0]),
+          bridge::GetXlaTensor(saved[1]), bridge::GetXlaTensor(saved[2]),
+          xla_mask, bridge::GetXlaTensor(saved[4]),
+          bridge::GetXlaTensor(saved[5]), is_causal, scale);
+
+  torch::Tensor undef;
+  torch::autograd::variable_list grad_inputs = {
+      bridge::AtenFromXlaTensor(std::get<0>(grads)),
+      bridge::AtenFromXlaTensor(std::get<1>(grads)),
+      bridge::AtenFromXlaTensor(std::get<2>(grads)),
+      undef,
+      undef,
+      undef};
+  return grad_inputs;
+}
+
 torch::Tensor max_pool2d_forward(torch::Tensor self,
                                  torch::IntArrayRef kernel_size,
                                  torch::IntArrayRef stride,
@@ -46,6 +46,18 @@ struct MaxPool3dAutogradFunction
       torch::autograd::variable_list grad_output);
 };
 
+struct ScaledDotProductAttentionAutogradFunction
+    : public torch::autograd::Function<
+          ScaledDotProductAttentionAutogradFunction> {
+  static torch::Tensor forward(torch::autograd::AutogradContext* ctx,
+                               torch::Tensor query, torch::Tensor key,
+                               torch::Tensor value, torch::Tensor attn_mask,
+                               bool is_causal, double scale);
+  static torch::autograd::variable_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::variable_list grad_output);
+};
+
 torch::Tensor max_pool2d_forward(torch::Tensor self,
                                  torch::IntArrayRef kernel_size,
                                  torch::IntArrayRef stride,
@@ -5,18 +5,26 @@
 #include <ATen/ops/_to_cpu.h>
 #include <torch/csrc/utils/device_lazy_init.h>
 
+#include <map>
+#include <numeric>
 #include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "torch_xla/csrc/aten_cuda_functions.h"
+#include "torch_xla/csrc/aten_host_callback_fallback.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/dl_convertor.h"
 #include "torch_xla/csrc/function_call_tracker.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/event_log.h"
 #include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/runtime.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
+#include "torch_xla/csrc/tensor_util.h"
 #include "torch_xla/csrc/xla_graph_executor.h"
 
 namespace torch_xla {
@@ -33,25 +41,74 @@ static std::unordered_set<std::string> _force_fallback_on_cpu{
     "aten::_local_scalar_dense",
 };
 
-// TODO(jwtan): Replace this with torch::lazy::Counter. We need
-// _fallback_counters to remain as torch_xla::runtime::metrics::Counter to
-// support torch_xla::runtime::metrics::CreatePerformanceReport(). For more
-// information, see NOTE: [TORCH_LAZY_COUNTER v.s. XLA_COUNTER].
-static std::unordered_map<std::string, ::torch_xla::runtime::metrics::Counter*>
-    _fallback_counters;
+// Statistics tracked for each operation that runs in fallback mode.
+struct FallbackOpStats {
+  // TODO(jwtan): Replace this with torch::lazy::Counter. We need the counter
+  // to remain as torch_xla::runtime::metrics::Counter to support
+  // torch_xla::runtime::metrics::CreatePerformanceReport(). For more
+  // information, see NOTE: [TORCH_LAZY_COUNTER v.s. XLA_COUNTER].
+  ::torch_xla::runtime::metrics::Counter* counter;
+  // Wall time spent running the operation in fallback mode, including the
+  // device synchronization and the data transfers.
+  ::torch_xla::runtime::metrics::Metric* time;
+};
+
+// Fallback statistics keyed by the operator handle, so that the hot path does
+// not need to build the operator name string. The map is only ever appended
+// to, and std::unordered_map never invalidates references to its elements,
+// so the returned references stay valid after the lock is released.
+static std::shared_mutex _fallback_lock;
+static std::unordered_map<c10::OperatorHandle, FallbackOpStats>
+    _fallback_stats;
+
+static const FallbackOpStats& GetFallbackOpStats(
+    const c10::OperatorHandle& op) {
+  {
+    std::shared_lock<std::shared_mutex> lock(_fallback_lock);
+    auto it = _fallback_stats.find(op);
+    if (it != _fallback_stats.end()) {
+      return it->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(_fallback_lock);
+  auto it = _fallback_stats.find(op);
+  if (it == _fallback_stats.end()) {
+    std::string name = c10::toString(op.operator_name());
+    FallbackOpStats stats{
+        new ::torch_xla::runtime::metrics::Counter(name),
+        new ::torch_xla::runtime::metrics::Metric(
+            absl::StrCat("FallbackTime.", name),
+            ::torch_xla::runtime::metrics::MetricFnTime)};
+    it = _fallback_stats.emplace(op, stats).first;
+  }
+  return it->second;
+}
 
 // Get all the executed fallback operations.
 // In other words, get all of them whose counters are not zero.
 std::vector<std::string> GetFallbackOperations() {
+  std::shared_lock<std::shared_mutex> lock(_fallback_lock);
   std::vector<std::string> fallback;
-  for (auto const& pair : _fallback_counters) {
-    if (pair.second->Value() != 0) {
-      fallback.push_back(pair.first);
+  for (auto const& pair : _fallback_stats) {
+    if (pair.second.counter->Value() != 0) {
+      fallback.push_back(c10::toString(pair.first.operator_name()));
     }
   }
   return fallback;
 }
 
+std::map<std::string, double> GetFallbackOperationTimes() {
+  std::shared_lock<std::shared_mutex> lock(_fallback_lock);
+  std::map<std::string, double> times;
+  for (auto const& pair : _fallback_stats) {
+    if (pair.second.counter->Value() != 0) {
+      times.emplace(c10::toString(pair.first.operator_name()),
+                    pair.second.time->Accumulator());
+    }
+  }
+  return times;
+}
+
 // Most of the functions for the CUDA fallback are a modified version of
 // PyTorch's at::native::cpu_fallback function.
 //
@@ -99,6 +156,14 @@ bool UseOpenXLAFallbackOnCUDA(const c10::OperatorHandle& op) {
          has_cuda_kernel && dont_force_fallback_on_cpu;
 }
 
+// Decide whether to run CPU fallback operations with batched transfers (see
+// xla_cpu_fallback below), instead of PyTorch's at::native::cpu_fallback.
+static bool UseBatchedCPUFallback() {
+  static const bool use_batched =
+      runtime::sys_util::GetEnvBool("XLA_BATCHED_CPU_FALLBACK", true);
+  return use_batched;
+}
+
 struct DeviceInfo {
   DeviceInfo(c10::Device device, c10::DeviceIndex i = -1)
       : common_device(device), index(i) {}
@@ -422,19 +487,327 @@ void cuda_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack,
   }
 }
 
+// Moves all the XLA tensors in the given list to CPU. Differently from
+// at::native::cpu_fallback, which materializes each argument on its own, all
+// tensors are synchronized within the same graph and fetched with a single
+// device-to-host transfer.
+static std::vector<at::Tensor> to_cpu_batched(
+    absl::Span<const at::Tensor> tensors) {
+  std::vector<at::Tensor> cpu_tensors(tensors.begin(), tensors.end());
+  std::vector<at::Tensor> xla_tensors;
+  std::vector<size_t> xla_indices;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    if (is_valid_xla_tensor(tensors[i])) {
+      xla_tensors.push_back(tensors[i]);
+      xla_indices.push_back(i);
+    }
+  }
+  if (xla_tensors.empty()) {
+    return cpu_tensors;
+  }
+  std::vector<at::Tensor> transferred =
+      bridge::XlaCreateTensorList(xla_tensors);
+  for (size_t i = 0; i < xla_indices.size(); ++i) {
+    cpu_tensors[xla_indices[i]] = std::move(transferred[i]);
+  }
+  return cpu_tensors;
+}
+
+// Uploads the given CPU tensors to the XLA device with a single host-to-device
+// transfer, and wraps the resulting device data into XLA tensors.
+static std::vector<at::Tensor> to_xla_batched(
+    const std::vector<at::Tensor>& cpu_tensors,
+    const torch::lazy::BackendDevice& device) {
+  std::vector<at::Tensor> contiguous_tensors;
+  contiguous_tensors.reserve(cpu_tensors.size());
+  for (const at::Tensor& tensor : cpu_tensors) {
+    contiguous_tensors.push_back(tensor.contiguous());
+  }
+  std::vector<torch::lazy::BackendDataPtr> handles = CreateTensorsData(
+      contiguous_tensors,
+      std::vector<std::string>(cpu_tensors.size(), device.toString()));
+  std::vector<at::Tensor> xla_tensors;
+  xla_tensors.reserve(handles.size());
+  for (size_t i = 0; i < handles.size(); ++i) {
+    xla_tensors.push_back(bridge::AtenFromXlaTensor(XLATensor::Create(
+        std::move(handles[i]), cpu_tensors[i].scalar_type())));
+  }
+  return xla_tensors;
+}
+
+// Former 'cpu_fallback' from PyTorch.
+// Changes:
+//
+//   1. All XLA tensor arguments (including the ones inside TensorList and
+//      optional TensorList arguments) are moved to CPU with a single transfer.
+//
+//   2. All the results, and the updated contents of the mutated XLA inputs,
+//      are moved back to the XLA device with a single transfer.
+//
+//   3. View operators are always rejected, since XLA should take care of all
+//      view ops after functionalization.
+//
+void xla_cpu_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
+  auto& schema_args = op.schema().arguments();
+  const auto num_arguments = schema_args.size();
+  auto arguments = torch::jit::last(stack, num_arguments);
+  const auto arguments_begin = stack->size() - num_arguments;
+
+  // Flat list of all the tensors to be moved to CPU. Each argument records the
+  // [begin, end) range of its tensors within this list.
+  std::vector<at::Tensor> flat_args;
+  std::vector<int> tensor_args_indices;
+  std::vector<size_t> tensor_args_offsets;
+  std::vector<int> tensorlist_args_indices;
+  std::vector<std::pair<size_t, size_t>> tensorlist_args_ranges;
+  std::vector<int> opt_tensorlist_args_indices;
+  std::vector<std::vector<std::optional<at::Tensor>>> opt_tensorlist_args;
+  std::vector<std::vector<std::pair<size_t, size_t>>> opt_tensorlist_args_map;
+
+  std::optional<c10::Device> tgt_device = std::nullopt;
+
+  // Step 1: Collect all tensor inputs, so that we can move them to CPU at once.
+  for (const auto idx : c10::irange(arguments.size())) {
+    const auto& ivalue = arguments[idx];
+    if (ivalue.isTensor()) {
+      tensor_args_indices.push_back(idx);
+      tensor_args_offsets.push_back(flat_args.size());
+      flat_args.push_back(ivalue.toTensor());
+    } else if (ivalue.isTensorList()) {
+      size_t begin = flat_args.size();
+      for (const at::Tensor& tensor : ivalue.toTensorList().vec()) {
+        flat_args.push_back(tensor);
+      }
+      tensorlist_args_indices.push_back(idx);
+      tensorlist_args_ranges.emplace_back(begin, flat_args.size());
+    } else if (ivalue.isOptionalTensorList()) {
+      auto opt_tensors = ivalue.toOptionalTensorList().vec();
+      // Pairs of (position within the list, position within flat_args).
+      std::vector<std::pair<size_t, size_t>> positions;
+      for (auto i : c10::irange(opt_tensors.size())) {
+        if (!opt_tensors[i].has_value() || !opt_tensors[i]->defined()) continue;
+        positions.emplace_back(i, flat_args.size());
+        flat_args.push_back(*opt_tensors[i]);
+      }
+      opt_tensorlist_args_indices.push_back(idx);
+      opt_tensorlist_args.push_back(std::move(opt_tensors));
+      opt_tensorlist_args_map.push_back(std::move(positions));
+    } else if (ivalue.isDevice()) {
+      tgt_device = ivalue.toDevice();
+      (*stack)[arguments_begin + idx] = c10::IValue(c10::Device(at::kCPU));
+    }
+  }
+
+  std::vector<at::Tensor> flat_cpu_args = to_cpu_batched(flat_args);
+
+  for (const auto i : c10::irange(tensor_args_indices.size())) {
+    (*stack)[arguments_begin + tensor_args_indices[i]] =
+        c10::IValue(flat_cpu_args[tensor_args_offsets[i]]);
+  }
+  std::vector<c10::List<at::Tensor>> tensorlist_cpu_args;
+  for (const auto i : c10::irange(tensorlist_args_indices.size())) {
+    auto [begin, end] = tensorlist_args_ranges[i];
+    c10::List<at::Tensor> cpu_list(std::vector<at::Tensor>(
+        flat_cpu_args.begin() + begin, flat_cpu_args.begin() + end));
+    tensorlist_cpu_args.push_back(cpu_list);
+    (*stack)[arguments_begin + tensorlist_args_indices[i]] =
+        c10::IValue(std::move(cpu_list));
+  }
+  for (const auto i : c10::irange(opt_tensorlist_args_indices.size())) {
+    auto opt_tensors = opt_tensorlist_args[i];
+    for (const auto& [list_pos, flat_pos] : opt_tensorlist_args_map[i]) {
+      opt_tensors[list_pos] = flat_cpu_args[flat_pos];
+    }
+    (*stack)[arguments_begin + opt_tensorlist_args_indices[i]] =
+        c10::IValue(opt_tensors);
+  }
+
+  // Step 2: Call the underlying CPU implementation of the operator.
+  op.redispatchBoxed(c10::DispatchKeySet(c10::DispatchKey::CPU), stack);
+
+  // Outputs are moved to the device given by the operation's Device argument
+  // or, if there is none, to the device of the first defined tensor argument.
+  if (!tgt_device.has_value()) {
+    auto it = std::find_if(flat_args.begin(), flat_args.end(),
+                           [](const at::Tensor& t) { return t.defined(); });
+    if (it != flat_args.end()) {
+      tgt_device = it->device();
+    }
+  }
+  std::optional<torch::lazy::BackendDevice> xla_device =
+      bridge::GetXlaDevice(tgt_device);
+
+  // Step 3: Collect the updated contents of the mutated XLA inputs. They are
+  // uploaded together with the outputs in step 4.
+  //
+  // Both the uploaded CPU tensors, and the original XLA tensors they should be
+  // written to, are stored at the same position of these lists.
+  std::vector<at::Tensor> upload_cpu_tensors;
+  std::vector<at::Tensor> mutated_xla_tensors;
+  auto collect_mutated = [&](const at::Tensor& xla_tensor,
+                             const at::Tensor& cpu_tensor) {
+    if (is_valid_xla_tensor(xla_tensor)) {
+      mutated_xla_tensors.push_back(xla_tensor);
+      upload_cpu_tensors.push_back(cpu_tensor);
+    }
+  };
+  for (const auto i : c10::irange(tensor_args_indices.size())) {
+    const c10::AliasInfo* alias_info =
+        schema_args[tensor_args_indices[i]].alias_info();
+    if (alias_info != nullptr && alias_info->isWrite()) {
+      size_t offset = tensor_args_offsets[i];
+      collect_mutated(flat_args[offset], flat_cpu_args[offset]);
+    }
+  }
+  for (const auto i : c10::irange(tensorlist_args_indices.size())) {
+    const c10::AliasInfo* alias_info =
+        schema_args[tensorlist_args_indices[i]].alias_info();
+    if (alias_info != nullptr && alias_info->isWrite()) {
+      auto [begin, end] = tensorlist_args_ranges[i];
+      for (size_t pos = begin; pos < end; ++pos) {
+        collect_mutated(flat_args[pos], flat_cpu_args[pos]);
+      }
+    }
+  }
+  const size_t num_mutated = mutated_xla_tensors.size();
+
+  // Step 4: Convert any CPU output tensors back to the original input device.
+  // For mutable alias'd outputs, we also need to take special care
+  // to move the ORIGINAL input tensor back onto the stack, in place of
+  // the temporary CPU output tensor that we created.
+  //
+  // See [CPU Fallback Does Not Handle View Operators]
+  const auto& schema_returns = op.schema().returns();
+  const auto& num_returns = schema_returns.size();
+  auto returns = torch::jit::last(stack, num_returns);
+  const auto returns_begin = stack->size() - num_returns;
+
+  // Copy-case outputs, as pairs of (return index, position within the
+  // returned TensorList, or -1 for tensor returns).
+  std::vector<std::pair<size_t, int64_t>> copy_outputs;
+  for (const auto idx : c10::irange(returns.size())) {
+    const c10::AliasInfo* alias_info = schema_returns[idx].alias_info();
+    if (alias_info != nullptr && alias_info->isWrite()) {
+      // Case (1): mutable alias case.
+      // Move the input ivalue directly onto the stack in place of
+      // the existing cpu output tensor.
+      bool found_alias = false;
+      if (returns[idx].isTensor() && returns[idx].toTensor().defined()) {
+        for (const auto i : c10::irange(tensor_args_indices.size())) {
+          auto input_tensor_idx = tensor_args_indices[i];
+          const auto& input_tensor = flat_cpu_args[tensor_args_offsets[i]];
+          const c10::AliasInfo* input_alias_info =
+              schema_args[input_tensor_idx].alias_info();
+          if (input_tensor.defined() && (alias_info == input_alias_info ||
+                                         (input_alias_info != nullptr &&
+                                          *alias_info == *input_alias_info))) {
+            (*stack)[returns_begin + idx] =
+                c10::IValue(flat_args[tensor_args_offsets[i]]);
+            found_alias = true;
+            break;
+          }
+        }
+      } else if (returns[idx].isTensorList() &&
+                 validate_tensor_list(returns[idx].toTensorList())) {
+        for (const auto i : c10::irange(tensorlist_args_indices.size())) {
+          auto input_tensor_idx = tensorlist_args_indices[i];
+          const c10::AliasInfo* input_alias_info =
+              schema_args[input_tensor_idx].alias_info();
+          auto [begin, end] = tensorlist_args_ranges[i];
+          c10::List<at::Tensor> input_list(std::vector<at::Tensor>(
+              flat_args.begin() + begin, flat_args.begin() + end));
+          if (validate_tensor_list(input_list) &&
+              (alias_info == input_alias_info ||
+               (input_alias_info != nullptr &&
+                *alias_info == *input_alias_info))) {
+            (*stack)[returns_begin + idx] = c10::IValue(input_list);
+            found_alias = true;
+            break;
+          }
+        }
+      }
+      TORCH_CHECK(
+          found_alias, "The operator ", op.schema().operator_name(),
+          " appears to have invalid alias information. ",
+          "Found a return tensor argument with a mismatched mutable alias: ",
+          schema_returns[idx]);
+    } else {
+      if (alias_info != nullptr && !alias_info->isWrite()) {
+        // Case (3): immutable alias (view) case.
+        TORCH_CHECK(
+            false, "The operator ", op.schema().operator_name(),
+            " appears to be a view operator, ",
+            "but it has no implementation for the backend \"xla\". ",
+            "View operators don't support ",
+            "since the tensor's storage cannot be shared across devices.");
+      }
+      // Case (2): copy case.
+      if (returns[idx].isTensor() && returns[idx].toTensor().defined()) {
+        copy_outputs.emplace_back(idx, -1);
+        upload_cpu_tensors.push_back(returns[idx].toTensor());
+      } else if (returns[idx].isTensorList() &&
+                 validate_tensor_list(returns[idx].toTensorList())) {
+        const auto& cpu_tensors = returns[idx].toTensorList().vec();
+        for (const auto i : c10::irange(cpu_tensors.size())) {
+          copy_outputs.emplace_back(idx, i);
+          upload_cpu_tensors.push_back(cpu_tensors[i]);
+        }
+      }
+    }
+  }
+
+  if (upload_cpu_tensors.empty()) {
+    return;
+  }
+
+  std::vector<at::Tensor> results;
+  if (xla_device.has_value()) {
+    results = to_xla_batched(upload_cpu_tensors, *xla_device);
+  } else {
+    // The outputs are not targeting the XLA device. Only the mutated XLA
+    // inputs need to be uploaded, each one back to its own device.
+    for (size_t i = 0; i < upload_cpu_tensors.size(); ++i) {
+      results.push_back(
+          i < num_mutated
+              ? bridge::CreateXlaTensor(
+                    upload_cpu_tensors[i],
+                    bridge::GetXlaDevice(mutated_xla_tensors[i]))
+              : (tgt_device.has_value() ? upload_cpu_tensors[i].to(*tgt_device)
+                                        : upload_cpu_tensors[i]));
+    }
+  }
+
+  std::vector<size_t> mutated_indices(num_mutated);
+  std::iota(mutated_indices.begin(), mutated_indices.end(), 0);
+  bridge::XlaUpdateTensors(mutated_xla_tensors,
+                           absl::MakeConstSpan(results).first(num_mutated),
+                           mutated_indices);
+
+  for (size_t i = 0; i < copy_outputs.size(); ++i) {
+    auto [idx, list_pos] = copy_outputs[i];
+    at::Tensor& result = results[num_mutated + i];
+    if (list_pos < 0) {
+      (*stack)[returns_begin + idx] = c10::IValue(result);
+    } else {
+      c10::List<at::Tensor> list = (*stack)[returns_begin + idx].toTensorList();
+      list.set(list_pos, result);
+      (*stack)[returns_begin + idx] = c10::IValue(list);
+    }
+  }
+}
+
 void xla_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   XLA_FN_TRACK(3);
-  const auto name = c10::toString(op.operator_name());
 
   // Manually applying the XLA_COUNTER macro.
   // We need to do it ourselves and explicitly keep a mapping of counters
   // because this boxed fallback kernel is used by multiple operators,
   // and the macro stamps out a static Counter object with a fixed name
   // at the code location that it was called.
-  if (_fallback_counters.find(name) == _fallback_counters.end()) {
-    _fallback_counters[name] = new ::torch_xla::runtime::metrics::Counter(name);
-  }
-  _fallback_counters[name]->AddValue(1);
+  const FallbackOpStats& stats = GetFallbackOpStats(op);
+  stats.counter->AddValue(1);
+  ::torch_xla::runtime::metrics::TimedSection timed(stats.time);
+  runtime::EventLog::ScopedReason scoped_reason("fallback");
 
   auto& args = op.schema().arguments();
   auto arguments = torch::jit::last(stack, args.size());
@@ -447,8 +820,14 @@ void xla_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
     }
   }
 
+  if (UseHostCallbackFallback() && TryHostCallbackFallback(op, stack)) {
+    return;
+  }
+
   if (UseOpenXLAFallbackOnCUDA(op)) {
     cuda_fallback(op, stack, true);
+  } else if (UseBatchedCPUFallback()) {
+    xla_cpu_fallback(op, stack);
   } else {
     // Call the actual boxed CPU fallback.
     // Set error_on_views as XLA should take care
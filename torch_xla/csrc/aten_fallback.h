@@ -3,12 +3,20 @@
 
 #include <ATen/native/CPUFallback.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace torch_xla {
 
 void xla_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack);
 
 std::vector<std::string> GetFallbackOperations();
 
+// Returns the total time, in nanoseconds, spent running each of the executed
+// fallback operations.
+std::map<std::string, double> GetFallbackOperationTimes();
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_ATEN_CPU_FALLBACK_H_
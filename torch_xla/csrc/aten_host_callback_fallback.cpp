@@ -0,0 +1,289 @@
+#include "torch_xla/csrc/aten_host_callback_fallback.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/dtype.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/runtime/tf_logging.h"
+#include "torch_xla/csrc/tensor_methods.h"
+#include "torch_xla/csrc/tensor_util.h"
+#include "xla/service/custom_call_status.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+
+namespace torch_xla {
+namespace {
+
+static const char* const kHostCallbackTarget = "xla_fallback_host_callback";
+
+// Custom call API version whose CPU signature carries the opaque payload and a
+// status object, as FallbackHostCallback expects.
+static const xla::CustomCallApiVersion kHostCallbackApiVersion =
+    xla::CustomCallApiVersion::API_VERSION_STATUS_RETURNING_UNIFIED;
+
+// Everything needed to run a fallback operation on host buffers.
+struct HostCallbackDescriptor {
+  explicit HostCallbackDescriptor(c10::OperatorHandle op) : op(std::move(op)) {}
+
+  c10::OperatorHandle op;
+  // Operation arguments, where tensor arguments are left as placeholders to be
+  // replaced by the input buffers.
+  std::vector<c10::IValue> arguments;
+  // Positions of the tensor arguments within `arguments`.
+  std::vector<size_t> tensor_indices;
+  std::vector<std::vector<int64_t>> input_sizes;
+  // Element types of the input buffers, and the types expected by the CPU
+  // kernel. They differ when the device stores a downcasted type.
+  std::vector<at::ScalarType> input_buffer_types;
+  std::vector<at::ScalarType> input_types;
+  std::vector<std::vector<int64_t>> output_sizes;
+  std::vector<at::ScalarType> output_buffer_types;
+};
+
+// Descriptors are keyed by the hash of the operation and its arguments, which
+// is also the payload of the custom call. Since the same key is generated for
+// every trace of the same call, descriptors are registered once and keep
+// serving cached executables.
+class HostCallbackRegistry {
+ public:
+  static HostCallbackRegistry* Get() {
+    static HostCallbackRegistry* registry = new HostCallbackRegistry();
+    return registry;
+  }
+
+  void Register(const std::string& key,
+                std::shared_ptr<const HostCallbackDescriptor> descriptor) {
+    std::lock_guard<std::mutex> lock(lock_);
+    descriptors_.emplace(key, std::move(descriptor));
+  }
+
+  std::shared_ptr<const HostCallbackDescriptor> Find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = descriptors_.find(key);
+    return it != descriptors_.end() ? it->second : nullptr;
+  }
+
+ private:
+  std::mutex lock_;
+  std::unordered_map<std::string,
+                     std::shared_ptr<const HostCallbackDescriptor>>
+      descriptors_;
+};
+
+void SetFailure(XlaCustomCallStatus* status, const std::string& message) {
+  XlaCustomCallStatusSetFailure(status, message.c_str(), message.size());
+}
+
+// Entry point invoked by the CPU runtime, for every host callback custom call
+// in the executed program.
+void FallbackHostCallback(void* out, const void** in, const char* opaque,
+                          size_t opaque_len, XlaCustomCallStatus* status) {
+  std::string key(opaque, opaque_len);
+  std::shared_ptr<const HostCallbackDescriptor> descriptor =
+      HostCallbackRegistry::Get()->Find(key);
+  if (descriptor == nullptr) {
+    SetFailure(status, "Unknown fallback host callback: " + key);
+    return;
+  }
+  try {
+    torch::jit::Stack stack(descriptor->arguments);
+    for (size_t i = 0; i < descriptor->tensor_indices.size(); ++i) {
+      at::Tensor input = at::from_blob(
+          const_cast<void*>(in[i]), descriptor->input_sizes[i],
+          at::TensorOptions().dtype(descriptor->input_buffer_types[i]));
+      stack[descriptor->tensor_indices[i]] =
+          input.to(descriptor->input_types[i]);
+    }
+    descriptor->op.redispatchBoxed(c10::DispatchKeySet(c10::DispatchKey::CPU),
+                                   &stack);
+
+    size_t num_outputs = descriptor->output_sizes.size();
+    XLA_CHECK_EQ(stack.size(), num_outputs);
+    // Tuple results receive an array with one buffer per element.
+    void** output_buffers =
+        num_outputs == 1 ? &out : reinterpret_cast<void**>(out);
+    for (size_t i = 0; i < num_outputs; ++i) {
+      at::from_blob(
+          output_buffers[i], descriptor->output_sizes[i],
+          at::TensorOptions().dtype(descriptor->output_buffer_types[i]))
+          .copy_(stack[i].toTensor());
+    }
+  } catch (const std::exception& ex) {
+    SetFailure(status, ex.what());
+  }
+}
+
+void RegisterHostCallbackTarget() {
+  static std::once_flag once;
+  std::call_once(once, []() {
+    runtime::GetComputationClientOrDie()->RegisterCustomCall(
+        kHostCallbackTarget, reinterpret_cast<void*>(&FallbackHostCallback),
+        "Host");
+  });
+}
+
+bool IsDeviceSupported(const torch::lazy::BackendDevice& device) {
+  return static_cast<XlaDeviceType>(device.type()) == XlaDeviceType::CPU;
+}
+
+// Computes the output tensors metadata by running the Meta kernel of the
+// operation. Returns false if that is not possible.
+bool InferOutputs(const c10::OperatorHandle& op,
+                  const HostCallbackDescriptor& descriptor,
+                  std::vector<at::Tensor>* outputs) {
+  if (!op.hasKernelForDispatchKey(c10::DispatchKey::Meta)) {
+    return false;
+  }
+  torch::jit::Stack meta_stack(descriptor.arguments);
+  for (size_t i = 0; i < descriptor.tensor_indices.size(); ++i) {
+    meta_stack[descriptor.tensor_indices[i]] =
+        at::empty(descriptor.input_sizes[i],
+                  at::TensorOptions()
+                      .dtype(descriptor.input_types[i])
+                      .device(c10::kMeta));
+  }
+  try {
+    op.redispatchBoxed(c10::DispatchKeySet(c10::DispatchKey::Meta),
+                       &meta_stack);
+  } catch (const std::exception& ex) {
+    // Meta kernels registered from Python raise Python errors, which are not
+    // c10::Error.
+    TF_VLOG(3) << "Unable to infer the output shapes of " << op.schema()
+               << ": " << ex.what();
+    return false;
+  }
+  for (const c10::IValue& result : meta_stack) {
+    if (!result.isTensor() || !result.toTensor().defined() ||
+        !c10::asIntArrayRefSlowOpt(result.toTensor().sym_sizes())) {
+      return false;
+    }
+    outputs->push_back(result.toTensor());
+  }
+  return !outputs->empty();
+}
+
+}  // namespace
+
+bool UseHostCallbackFallback() {
+  static const bool use_host_callback =
+      runtime::sys_util::GetEnvBool("XLA_FALLBACK_HOST_CALLBACK", false);
+  return use_host_callback;
+}
+
+bool TryHostCallbackFallback(const c10::OperatorHandle& op,
+                             torch::jit::Stack* stack) {
+  const c10::FunctionSchema& schema = op.schema();
+  for (const c10::Argument& ret : schema.returns()) {
+    if (ret.alias_info() != nullptr ||
+        ret.type()->kind() != c10::TypeKind::TensorType) {
+      return false;
+    }
+  }
+  for (const c10::Argument& arg : schema.arguments()) {
+    if (arg.alias_info() != nullptr) {
+      return false;
+    }
+  }
+
+  const size_t num_arguments = schema.arguments().size();
+  auto arguments = torch::jit::last(stack, num_arguments);
+  auto descriptor = std::make_shared<HostCallbackDescriptor>(op);
+  descriptor->arguments.reserve(num_arguments);
+
+  std::vector<XLATensorPtr> inputs;
+  std::optional<torch::lazy::BackendDevice> device;
+  torch::lazy::hash_t hash = torch::lazy::MHash(
+      kHostCallbackTarget, c10::toString(schema.operator_name()));
+  for (size_t idx = 0; idx < arguments.size(); ++idx) {
+    const c10::IValue& ivalue = arguments[idx];
+    if (ivalue.isTensor() && ivalue.toTensor().defined()) {
+      XLATensorPtr xla_tensor = bridge::TryGetXlaTensor(ivalue.toTensor());
+      if (!xla_tensor || (device && xla_tensor->GetDevice() != *device)) {
+        return false;
+      }
+      device = xla_tensor->GetDevice();
+      xla::Shape shape = xla_tensor->shape().get();
+      std::vector<int64_t> sizes(shape.dimensions().begin(),
+                                 shape.dimensions().end());
+      descriptor->tensor_indices.push_back(idx);
+      descriptor->input_buffer_types.push_back(
+          TorchTypeFromXlaType(shape.element_type()));
+      descriptor->input_types.push_back(xla_tensor->dtype());
+      hash = torch::lazy::HashCombine(
+          hash, torch::lazy::MHash(sizes, descriptor->input_types.back()));
+      descriptor->input_sizes.push_back(std::move(sizes));
+      descriptor->arguments.emplace_back();
+      inputs.push_back(std::move(xla_tensor));
+    } else if (ivalue.isTensor() || ivalue.isTensorList() ||
+               ivalue.isOptionalTensorList() || ivalue.isDevice()) {
+      // Undefined tensors, tensor lists and devices are not supported.
+      return false;
+    } else {
+      // Floating point values are hashed by their bits, since printing rounds
+      // them, which would share one descriptor between close values.
+      if (ivalue.isDouble()) {
+        hash = torch::lazy::HashCombine(
+            hash, torch::lazy::MHash(ivalue.toDouble()));
+      } else if (ivalue.isDoubleList()) {
+        hash = torch::lazy::HashCombine(
+            hash, torch::lazy::MHash(ivalue.toDoubleVector()));
+      } else {
+        std::stringstream ss;
+        ss << std::setprecision(std::numeric_limits<double>::max_digits10)
+           << ivalue;
+        hash = torch::lazy::HashCombine(hash, torch::lazy::MHash(ss.str()));
+      }
+      descriptor->arguments.push_back(ivalue);
+    }
+  }
+  if (inputs.empty() || !IsDeviceSupported(*device)) {
+    return false;
+  }
+
+  std::vector<at::Tensor> meta_outputs;
+  if (!InferOutputs(op, *descriptor, &meta_outputs)) {
+    return false;
+  }
+  std::vector<std::vector<int64_t>> output_sizes;
+  std::vector<at::ScalarType> output_types;
+  for (const at::Tensor& output : meta_outputs) {
+    output_sizes.push_back(output.sizes().vec());
+    output_types.push_back(output.scalar_type());
+    descriptor->output_buffer_types.push_back(TorchTypeFromXlaType(
+        MakeXlaPrimitiveType(output.scalar_type(), &*device)));
+  }
+  descriptor->output_sizes = output_sizes;
+
+  RegisterHostCallbackTarget();
+  std::string key = torch::lazy::HashToString(hash);
+  HostCallbackRegistry::Get()->Register(key, std::move(descriptor));
+
+  std::vector<XLATensorPtr> results = tensor_methods::custom_call(
+      inputs, kHostCallbackTarget, output_sizes, output_types,
+      /*has_side_effect=*/false, /*backend_config=*/key,
+      kHostCallbackApiVersion, /*frontend_attributes=*/{});
+  TORCH_LAZY_COUNTER("FallbackHostCallback", 1);
+
+  torch::jit::drop(stack, num_arguments);
+  for (const XLATensorPtr& result : results) {
+    torch::jit::push(stack, bridge::AtenFromXlaTensor(result));
+  }
+  return true;
+}
+
+}  // namespace torch_xla
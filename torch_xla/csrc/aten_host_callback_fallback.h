@@ -0,0 +1,25 @@
+#ifndef XLA_TORCH_XLA_CSRC_ATEN_HOST_CALLBACK_FALLBACK_H_
+#define XLA_TORCH_XLA_CSRC_ATEN_HOST_CALLBACK_FALLBACK_H_
+
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/stack.h>
+
+namespace torch_xla {
+
+// Whether fallback operations should be lowered as host callbacks, controlled
+// by the XLA_FALLBACK_HOST_CALLBACK environment variable. Only supported on the
+// PJRT CPU runtime, where the compiled program runs on the host.
+bool UseHostCallbackFallback();
+
+// Tries to run the fallback operation as a host callback inside the compiled
+// program, instead of materializing its inputs. On success, the operation
+// arguments on the stack are replaced by lazy XLA tensors representing its
+// results, and true is returned. Returns false, leaving the stack untouched,
+// if the operation is not eligible, e.g. because its output shapes can't be
+// computed ahead of time with a Meta kernel, or because it mutates its inputs.
+bool TryHostCallbackFallback(const c10::OperatorHandle& op,
+                             torch::jit::Stack* stack);
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_ATEN_HOST_CALLBACK_FALLBACK_H_
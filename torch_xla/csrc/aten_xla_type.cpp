@@ -41,6 +41,7 @@
 #include "torch_xla/csrc/ops/view.h"
 #include "torch_xla/csrc/pooling.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/event_log.h"
 #include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/util.h"
@@ -427,6 +428,91 @@ void DoBinaryOpOut(const at::Tensor& self, const at::Tensor& other,
   bin_op_out(operands.first, operands.second, out_tensor);
 }
 
+// Per sample weights are only valid in sum mode. Other cases go through the
+// fallback, which raises the proper error.
+bool IsEmbeddingBagSupported(
+    int64_t mode, const std::optional<at::Tensor>& per_sample_weights) {
+  return mode == 0 ||
+         !(per_sample_weights.has_value() && per_sample_weights->defined());
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> DoEmbeddingBag(
+    const at::Tensor& weight, const at::Tensor& indices,
+    const at::Tensor& offsets, int64_t mode,
+    const std::optional<at::Tensor>& per_sample_weights,
+    bool include_last_offset, int64_t padding_idx) {
+  auto indices_tensor = bridge::GetXlaTensor(indices);
+  auto sample_weights =
+      per_sample_weights.has_value() && per_sample_weights.value().defined()
+          ? bridge::GetXlaTensor(per_sample_weights.value())
+          : tensor_methods::full_like(indices_tensor, 1.0,
+                                      *torch_xla::bridge::GetXlaDevice(weight),
+                                      at::ScalarType::Float);
+  auto result = tensor_methods::embedding_bag(
+      bridge::GetXlaTensor(weight), indices_tensor,
+      bridge::GetXlaTensor(offsets), mode, sample_weights, include_last_offset,
+      padding_idx);
+  return std::make_tuple(bridge::AtenFromXlaTensor(std::get<0>(result)),
+                         bridge::AtenFromXlaTensor(std::get<1>(result)),
+                         bridge::AtenFromXlaTensor(std::get<2>(result)),
+                         bridge::AtenFromXlaTensor(std::get<3>(result)));
+}
+
+// The blockwise attention lowering covers dropout free attention over XLA
+// tensors which share their batch dimensions, with a mask that broadcasts to
+// the scores and does not need a gradient.
+bool CanUseBlockwiseAttention(const at::Tensor& query, const at::Tensor& key,
+                              const at::Tensor& value,
+                              const std::optional<at::Tensor>& attn_mask,
+                              double dropout_p, bool is_causal,
+                              bool enable_gqa) {
+  if (dropout_p > 0.0 || enable_gqa) {
+    return false;
+  }
+  if (!bridge::TryGetXlaTensor(query) || !bridge::TryGetXlaTensor(key) ||
+      !bridge::TryGetXlaTensor(value)) {
+    return false;
+  }
+  if (!at::isFloatingType(query.scalar_type()) ||
+      key.scalar_type() != query.scalar_type() ||
+      value.scalar_type() != query.scalar_type()) {
+    return false;
+  }
+  int64_t rank = query.dim();
+  if (rank < 2 || key.dim() != rank || value.dim() != rank) {
+    return false;
+  }
+  for (int64_t i = 0; i < rank - 2; ++i) {
+    if (key.size(i) != query.size(i) || value.size(i) != query.size(i)) {
+      return false;
+    }
+  }
+  if (key.size(-1) != query.size(-1) || value.size(-2) != key.size(-2)) {
+    return false;
+  }
+  if (attn_mask.has_value() && attn_mask->defined()) {
+    const at::Tensor& mask = *attn_mask;
+    if (is_causal || mask.requires_grad() || !bridge::TryGetXlaTensor(mask) ||
+        mask.dim() > rank) {
+      return false;
+    }
+    if (mask.scalar_type() != at::ScalarType::Bool &&
+        !at::isFloatingType(mask.scalar_type())) {
+      return false;
+    }
+    std::vector<int64_t> scores_sizes(query.sizes().begin(),
+                                      query.sizes().end() - 1);
+    scores_sizes.push_back(key.size(-2));
+    for (int64_t i = 1; i <= mask.dim(); ++i) {
+      int64_t size = mask.size(-i);
+      if (size != 1 && size != scores_sizes[rank - i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 at::Tensor& XLANativeFunctions::__ilshift__(at::Tensor& self,
@@ -1594,6 +1680,23 @@ at::Tensor XLANativeFunctions::embedding_dense_backward(
       num_weights, padding_idx, scale_grad_by_freq));
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+XLANativeFunctions::_embedding_bag(
+    const at::Tensor& weight, const at::Tensor& indices,
+    const at::Tensor& offsets, bool scale_grad_by_freq, int64_t mode,
+    bool sparse, const std::optional<at::Tensor>& per_sample_weights,
+    bool include_last_offset, int64_t padding_idx) {
+  TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
+  if (!IsEmbeddingBagSupported(mode, per_sample_weights)) {
+    return at::native::call_fallback_fn<&xla_fallback,
+                                        ATEN_OP(_embedding_bag)>::
+        call(weight, indices, offsets, scale_grad_by_freq, mode, sparse,
+             per_sample_weights, include_last_offset, padding_idx);
+  }
+  return DoEmbeddingBag(weight, indices, offsets, mode, per_sample_weights,
+                        include_last_offset, padding_idx);
+}
+
 std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
 XLANativeFunctions::_embedding_bag_forward_only(
     const at::Tensor& weight, const at::Tensor& indices,
@@ -1601,7 +1704,7 @@ XLANativeFunctions::_embedding_bag_forward_only(
     bool sparse, const std::optional<at::Tensor>& per_sample_weights,
     bool include_last_offset, int64_t padding_idx) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
-  if (mode == 1 || scale_grad_by_freq || sparse || padding_idx != -1) {
+  if (!IsEmbeddingBagSupported(mode, per_sample_weights)) {
     return at::native::call_fallback_fn<
         &xla_fallback,
         ATEN_OP(_embedding_bag_forward_only)>::call(weight, indices, offsets,
@@ -1610,20 +1713,8 @@ XLANativeFunctions::_embedding_bag_forward_only(
                                                     include_last_offset,
                                                     padding_idx);
   }
-  auto indices_tensor = bridge::GetXlaTensor(indices);
-  auto sample_weights =
-      per_sample_weights.has_value() && per_sample_weights.value().defined()
-          ? bridge::GetXlaTensor(per_sample_weights.value())
-          : tensor_methods::full_like(indices_tensor, 1.0,
-                                      *torch_xla::bridge::GetXlaDevice(weight),
-                                      at::ScalarType::Float);
-  auto result = tensor_methods::embedding_bag(
-      bridge::GetXlaTensor(weight), indices_tensor,
-      bridge::GetXlaTensor(offsets), mode, sample_weights, include_last_offset);
-  return std::make_tuple(bridge::AtenFromXlaTensor(std::get<0>(result)),
-                         bridge::AtenFromXlaTensor(std::get<1>(result)),
-                         bridge::AtenFromXlaTensor(std::get<2>(result)),
-                         bridge::AtenFromXlaTensor(std::get<3>(result)));
+  return DoEmbeddingBag(weight, indices, offsets, mode, per_sample_weights,
+                        include_last_offset, padding_idx);
 }
 
 at::Tensor XLANativeFunctions::_embedding_bag_backward(
@@ -1639,6 +1730,17 @@ at::Tensor XLANativeFunctions::_embedding_bag_backward(
         "XLA does not support EmbeddingBag sparse backward function. "
         "Falling back to the dense function.");
   }
+  if (!scale_grad_by_freq) {
+    XLATensorPtr per_sample_weights;
+    if (per_sample_weights_opt.has_value() &&
+        per_sample_weights_opt->defined()) {
+      per_sample_weights = bridge::GetXlaTensor(*per_sample_weights_opt);
+    }
+    return bridge::AtenFromXlaTensor(tensor_methods::embedding_bag_backward(
+        bridge::GetXlaTensor(grad), bridge::GetXlaTensor(indices_),
+        bridge::GetXlaTensor(offsets_), bridge::GetXlaTensor(max_indices_),
+        per_sample_weights, num_weights, mode, padding_idx));
+  }
   if (runtime::sys_util::GetEnvBool("XLA_DISABLE_FUNCTIONALIZATION", false)) {
     return at::native::_embedding_bag_backward_symint(
         grad, indices_, offsets_, offset2bag, bag_size_, max_indices_,
@@ -3938,6 +4040,7 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> XLANativeFunctions::_linalg_svd(
 }
 
 at::Scalar XLANativeFunctions::_local_scalar_dense(const at::Tensor& self) {
+  runtime::EventLog::ScopedReason scoped_reason("item");
   if (DebugUtil::ExperimentEnabled("early_sync")) {
     // sync tensors in order to save computation when step is marked later.
     XLATensorPtr self_tensor = bridge::GetXlaTensor(self);
@@ -3974,6 +4077,28 @@ XLANativeFunctions::native_group_norm(const at::Tensor& input,
                                      eps);
 }
 
+// Lowers attention as a blockwise loop over the keys instead of
+// materializing the (L, S) scores, with a matching blockwise backward.
+at::Tensor XLANativeFunctions::scaled_dot_product_attention(
+    const at::Tensor& query, const at::Tensor& key, const at::Tensor& value,
+    const std::optional<at::Tensor>& attn_mask, double dropout_p,
+    bool is_causal, std::optional<double> scale, bool enable_gqa) {
+  TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
+  if (!CanUseBlockwiseAttention(query, key, value, attn_mask, dropout_p,
+                                is_causal, enable_gqa)) {
+    TORCH_LAZY_COUNTER("ScaledDotProductAttentionFallback", 1);
+    return at::native::scaled_dot_product_attention(
+        query, key, value, attn_mask, dropout_p, is_causal, scale, enable_gqa);
+  }
+  double softmax_scale =
+      scale.has_value()
+          ? *scale
+          : 1.0 / std::sqrt(static_cast<double>(query.size(-1)));
+  at::Tensor mask = attn_mask.has_value() ? *attn_mask : at::Tensor();
+  return aten_autograd_ops::ScaledDotProductAttentionAutogradFunction::apply(
+      query, key, value, mask, is_causal, softmax_scale);
+}
+
 at::Tensor XLANativeFunctions::_cdist_forward(
     const at::Tensor& x1, const at::Tensor& x2, double p,
     std::optional<int64_t> compute_mode) {
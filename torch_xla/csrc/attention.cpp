@@ -0,0 +1,350 @@
+#include "torch_xla/csrc/attention.h"
+
+#include <algorithm>
+
+#include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/status.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/hlo/builder/lib/constants.h"
+#include "xla/hlo/builder/lib/loops.h"
+#include "xla/hlo/builder/lib/math.h"
+#include "xla/shape_util.h"
+#include "xla/util.h"
+
+namespace torch_xla {
+namespace {
+
+// Static sizes shared by the forward and backward loops. The keys are padded
+// to num_blocks * block_size, and the padded keys are masked out of the
+// scores.
+struct AttentionBlocks {
+  int64_t rank = 0;
+  int64_t query_length = 0;
+  int64_t key_length = 0;
+  int64_t block_size = 0;
+  int64_t num_blocks = 0;
+  xla::PrimitiveType type = xla::PrimitiveType::PRIMITIVE_TYPE_INVALID;
+  // The type of the scores, probabilities and running statistics.
+  xla::PrimitiveType accumulation_type =
+      xla::PrimitiveType::PRIMITIVE_TYPE_INVALID;
+};
+
+AttentionBlocks GetAttentionBlocks(xla::XlaOp query, xla::XlaOp key,
+                                   int64_t block_size) {
+  const xla::Shape& query_shape = ShapeHelper::ShapeOfXlaOp(query);
+  const xla::Shape& key_shape = ShapeHelper::ShapeOfXlaOp(key);
+  AttentionBlocks blocks;
+  blocks.rank = query_shape.dimensions_size();
+  XLA_CHECK_GE(blocks.rank, 2) << "Attention query must have rank >= 2";
+  XLA_CHECK_EQ(key_shape.dimensions_size(), blocks.rank);
+  blocks.query_length = query_shape.dimensions(blocks.rank - 2);
+  blocks.key_length = key_shape.dimensions(blocks.rank - 2);
+  LoopBlocks key_blocks = GetLoopBlocks(blocks.key_length, block_size);
+  blocks.block_size = key_blocks.block_size;
+  blocks.num_blocks = key_blocks.num_blocks;
+  blocks.type = query_shape.element_type();
+  blocks.accumulation_type = GetAccumulationType(blocks.type);
+  return blocks;
+}
+
+xla::XlaOp PadKeys(xla::XlaOp input, int64_t dim,
+                   const AttentionBlocks& blocks) {
+  int64_t padding = blocks.num_blocks * blocks.block_size - blocks.key_length;
+  if (padding == 0) {
+    return input;
+  }
+  return xla::PadInDim(
+      input, xla::Zero(input.builder(), XlaHelpers::TypeOfXlaOp(input)), dim,
+      /*pad_lo=*/0, /*pad_hi=*/padding);
+}
+
+// Turns the mask into an additive bias with the rank of the scores. Its
+// broadcast dimensions stay at size 1 and are only expanded per key block.
+xla::XlaOp PrepareMask(xla::XlaOp mask, const AttentionBlocks& blocks) {
+  const xla::Shape& mask_shape = ShapeHelper::ShapeOfXlaOp(mask);
+  XLA_CHECK_LE(mask_shape.dimensions_size(), blocks.rank)
+      << "Attention mask rank exceeds the query rank";
+  std::vector<int64_t> dims(blocks.rank - mask_shape.dimensions_size(), 1);
+  dims.insert(dims.end(), mask_shape.dimensions().begin(),
+              mask_shape.dimensions().end());
+  xla::XlaOp bias = xla::Reshape(mask, dims);
+  xla::XlaBuilder* builder = mask.builder();
+  if (mask_shape.element_type() == xla::PrimitiveType::PRED) {
+    xla::PrimitiveType type = blocks.accumulation_type;
+    bias = xla::Select(bias, xla::Broadcast(xla::Zero(builder, type), dims),
+                       xla::Broadcast(xla::MinValue(builder, type), dims));
+  } else {
+    bias = xla::ConvertElementType(bias, blocks.accumulation_type);
+  }
+  if (dims.back() != 1) {
+    bias = PadKeys(bias, blocks.rank - 1, blocks);
+  }
+  return bias;
+}
+
+std::vector<xla::XlaOp> BlockStartIndices(xla::XlaOp start, int64_t rank,
+                                          int64_t dim) {
+  std::vector<xla::XlaOp> indices(
+      rank, xla::Zero(start.builder(), xla::PrimitiveType::S32));
+  indices[dim] = start;
+  return indices;
+}
+
+xla::XlaOp SliceKeyBlock(xla::XlaOp input, xla::XlaOp start, int64_t dim,
+                         int64_t block_size) {
+  std::vector<int64_t> sizes = XlaHelpers::SizesOfXlaOp(input);
+  sizes[dim] = block_size;
+  return xla::DynamicSlice(input, BlockStartIndices(start, sizes.size(), dim),
+                           sizes);
+}
+
+// Returns the scaled and masked scores of the query against the key block at
+// start, with -inf for the keys which are not attended to.
+xla::XlaOp BuildBlockScores(xla::XlaOp query, xla::XlaOp key_block,
+                            xla::XlaOp mask, xla::XlaOp start, bool is_causal,
+                            double scale, const AttentionBlocks& blocks) {
+  xla::XlaBuilder* builder = query.builder();
+  const int64_t rank = blocks.rank;
+  xla::PrimitiveType type = blocks.accumulation_type;
+  xla::XlaOp scores =
+      BuildBatchDot(query, rank - 1, key_block, rank - 1, type) *
+      XlaHelpers::ScalarValue<double>(scale, type, builder);
+  std::vector<int64_t> scores_dims = XlaHelpers::SizesOfXlaOp(scores);
+  if (mask.valid()) {
+    xla::XlaOp mask_block = mask;
+    if (XlaHelpers::SizesOfXlaOp(mask).back() != 1) {
+      mask_block = SliceKeyBlock(mask, start, rank - 1, blocks.block_size);
+    }
+    scores = scores + xla::BroadcastInDim(mask_block, scores_dims,
+                                          XlaHelpers::GetAllDimensions(rank));
+  }
+  xla::Shape index_shape = xla::ShapeUtil::MakeShape(
+      xla::PrimitiveType::S32, {blocks.query_length, blocks.block_size});
+  xla::XlaOp key_index = xla::Iota(builder, index_shape, 1) + start;
+  xla::XlaOp attend =
+      xla::Lt(key_index, xla::ConstantR0<int32_t>(
+                             builder, static_cast<int32_t>(blocks.key_length)));
+  if (is_causal) {
+    xla::XlaOp query_index = xla::Iota(builder, index_shape, 0);
+    attend = xla::And(attend, xla::Le(key_index, query_index));
+  }
+  attend = xla::BroadcastInDim(attend, scores_dims, {rank - 2, rank - 1});
+  return xla::Select(attend, scores,
+                     xla::Broadcast(xla::MinValue(builder, type), scores_dims));
+}
+
+// Rows which attend to no key so far have a -inf max; shifting them by zero
+// keeps their exponentials at zero instead of NaN.
+xla::XlaOp SafeRowMax(xla::XlaOp row_max) {
+  return xla::Select(xla::IsNegInf(row_max), xla::ZerosLike(row_max),
+                     row_max);
+}
+
+xla::XlaOp ReduceKeys(xla::XlaOp scores, xla::XlaOp init_value,
+                      const xla::XlaComputation& computation, int64_t rank) {
+  return xla::Reduce(scores, init_value, computation, {rank - 1});
+}
+
+}  // namespace
+
+std::vector<xla::XlaOp> BuildScaledDotProductAttention(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp mask,
+    bool is_causal, double scale, int64_t block_size) {
+  AttentionBlocks blocks = GetAttentionBlocks(query, key, block_size);
+  xla::XlaBuilder* builder = query.builder();
+  const int64_t rank = blocks.rank;
+  xla::PrimitiveType type = blocks.accumulation_type;
+  std::vector<int64_t> row_dims = XlaHelpers::SizesOfXlaOp(query);
+  row_dims.pop_back();
+  std::vector<int64_t> output_dims = row_dims;
+  output_dims.push_back(XlaHelpers::SizesOfXlaOp(value).back());
+
+  // Loop values: block index, query, key, value, optional mask, then the
+  // running row max, running row sum and unnormalized output.
+  bool has_mask = mask.valid();
+  std::vector<xla::XlaOp> init_values = {
+      xla::Zero(builder, xla::PrimitiveType::S32), query,
+      PadKeys(key, rank - 2, blocks), PadKeys(value, rank - 2, blocks)};
+  if (has_mask) {
+    init_values.push_back(PrepareMask(mask, blocks));
+  }
+  size_t stats_index = init_values.size();
+  init_values.push_back(xla::Broadcast(xla::MinValue(builder, type), row_dims));
+  init_values.push_back(xla::Broadcast(xla::Zero(builder, type), row_dims));
+  init_values.push_back(xla::Broadcast(xla::Zero(builder, type), output_dims));
+
+  std::vector<xla::XlaOp> results = GetValueOrThrow(xla::WhileLoopHelper(
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        return xla::Lt(values[0],
+                       xla::ConstantR0<int32_t>(
+                           builder, static_cast<int32_t>(blocks.num_blocks)));
+      },
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        std::vector<int64_t> row_broadcast =
+            XlaHelpers::GetAllDimensions(rank - 1);
+        xla::XlaOp start =
+            values[0] * xla::ConstantR0<int32_t>(
+                            builder, static_cast<int32_t>(blocks.block_size));
+        xla::XlaOp key_block =
+            SliceKeyBlock(values[2], start, rank - 2, blocks.block_size);
+        xla::XlaOp value_block =
+            SliceKeyBlock(values[3], start, rank - 2, blocks.block_size);
+        xla::XlaOp scores =
+            BuildBlockScores(values[1], key_block,
+                             has_mask ? values[4] : xla::XlaOp(), start,
+                             is_causal, scale, blocks);
+        xla::XlaOp running_max = values[stats_index];
+        xla::XlaOp running_sum = values[stats_index + 1];
+        xla::XlaOp output = values[stats_index + 2];
+
+        xla::XlaOp new_max = xla::Max(
+            running_max,
+            ReduceKeys(scores, xla::MinValue(builder, type),
+                       XlaHelpers::CreateMaxComputation(type), rank));
+        xla::XlaOp shift = SafeRowMax(new_max);
+        xla::XlaOp probs = xla::Exp(xla::Sub(scores, shift, row_broadcast));
+        xla::XlaOp correction = xla::Exp(running_max - shift);
+        xla::XlaOp new_sum =
+            running_sum * correction +
+            ReduceKeys(probs, xla::Zero(builder, type),
+                       XlaHelpers::CreateAddComputation(type), rank);
+        xla::XlaOp new_output =
+            xla::Mul(output, correction, row_broadcast) +
+            BuildBatchDot(xla::ConvertElementType(probs, blocks.type),
+                          rank - 1, value_block, rank - 2, type);
+
+        std::vector<xla::XlaOp> results(values.begin(), values.end());
+        results[0] = values[0] + xla::One(builder, xla::PrimitiveType::S32);
+        results[stats_index] = new_max;
+        results[stats_index + 1] = new_sum;
+        results[stats_index + 2] = new_output;
+        return results;
+      },
+      init_values, "ScaledDotProductAttention", builder));
+
+  xla::XlaOp row_max = results[stats_index];
+  xla::XlaOp row_sum = results[stats_index + 1];
+  xla::XlaOp empty_rows = xla::Eq(row_sum, xla::ZerosLike(row_sum));
+  // Rows which attend to no key get a zero output instead of 0/0, and a +inf
+  // log-sum-exp, so the backward rebuilds zero probabilities for them.
+  xla::XlaOp output = xla::ConvertElementType(
+      xla::Select(
+          xla::BroadcastInDim(empty_rows, output_dims,
+                              XlaHelpers::GetAllDimensions(rank - 1)),
+          xla::Broadcast(xla::Zero(builder, type), output_dims),
+          xla::Div(results[stats_index + 2], row_sum,
+                   XlaHelpers::GetAllDimensions(rank - 1))),
+      blocks.type);
+  xla::XlaOp logsumexp =
+      xla::Select(empty_rows,
+                  xla::Broadcast(xla::MaxValue(builder, type), row_dims),
+                  SafeRowMax(row_max) + xla::Log(row_sum));
+  return {output, logsumexp};
+}
+
+std::vector<xla::XlaOp> BuildScaledDotProductAttentionBackward(
+    xla::XlaOp grad_output, xla::XlaOp query, xla::XlaOp key, xla::XlaOp value,
+    xla::XlaOp mask, xla::XlaOp output, xla::XlaOp logsumexp, bool is_causal,
+    double scale, int64_t block_size) {
+  AttentionBlocks blocks = GetAttentionBlocks(query, key, block_size);
+  xla::XlaBuilder* builder = query.builder();
+  const int64_t rank = blocks.rank;
+  xla::PrimitiveType type = blocks.accumulation_type;
+  xla::XlaOp padded_key = PadKeys(key, rank - 2, blocks);
+  xla::XlaOp padded_value = PadKeys(value, rank - 2, blocks);
+  // The softmax backward term sum_j(P_ij * dP_ij), computed once from the
+  // forward output as sum(dO_i * O_i).
+  xla::XlaOp delta =
+      ReduceKeys(xla::ConvertElementType(grad_output, type) *
+                     xla::ConvertElementType(output, type),
+                 xla::Zero(builder, type),
+                 XlaHelpers::CreateAddComputation(type), rank);
+
+  // Loop values: block index, query, key, value, optional mask, then the
+  // output gradient, log-sum-exp, delta and the three input gradients.
+  bool has_mask = mask.valid();
+  std::vector<xla::XlaOp> init_values = {
+      xla::Zero(builder, xla::PrimitiveType::S32), query, padded_key,
+      padded_value};
+  if (has_mask) {
+    init_values.push_back(PrepareMask(mask, blocks));
+  }
+  size_t grads_index = init_values.size();
+  init_values.push_back(grad_output);
+  init_values.push_back(xla::ConvertElementType(logsumexp, type));
+  init_values.push_back(delta);
+  init_values.push_back(xla::Broadcast(xla::Zero(builder, type),
+                                       XlaHelpers::SizesOfXlaOp(query)));
+  init_values.push_back(xla::Broadcast(xla::Zero(builder, type),
+                                       XlaHelpers::SizesOfXlaOp(padded_key)));
+  init_values.push_back(xla::Broadcast(
+      xla::Zero(builder, type), XlaHelpers::SizesOfXlaOp(padded_value)));
+
+  std::vector<xla::XlaOp> results = GetValueOrThrow(xla::WhileLoopHelper(
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        return xla::Lt(values[0],
+                       xla::ConstantR0<int32_t>(
+                           builder, static_cast<int32_t>(blocks.num_blocks)));
+      },
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        std::vector<int64_t> row_broadcast =
+            XlaHelpers::GetAllDimensions(rank - 1);
+        xla::XlaOp start =
+            values[0] * xla::ConstantR0<int32_t>(
+                            builder, static_cast<int32_t>(blocks.block_size));
+        xla::XlaOp query = values[1];
+        xla::XlaOp key_block =
+            SliceKeyBlock(values[2], start, rank - 2, blocks.block_size);
+        xla::XlaOp value_block =
+            SliceKeyBlock(values[3], start, rank - 2, blocks.block_size);
+        xla::XlaOp scores = BuildBlockScores(
+            query, key_block, has_mask ? values[4] : xla::XlaOp(), start,
+            is_causal, scale, blocks);
+        xla::XlaOp grad_output = values[grads_index];
+        xla::XlaOp logsumexp = values[grads_index + 1];
+        xla::XlaOp delta = values[grads_index + 2];
+
+        xla::XlaOp probs = xla::Exp(xla::Sub(scores, logsumexp, row_broadcast));
+        xla::XlaOp grad_value_block =
+            BuildBatchDot(xla::ConvertElementType(probs, blocks.type),
+                          rank - 2, grad_output, rank - 2, type);
+        xla::XlaOp grad_probs =
+            BuildBatchDot(grad_output, rank - 1, value_block, rank - 1, type);
+        xla::XlaOp grad_scores = xla::ConvertElementType(
+            probs * xla::Sub(grad_probs, delta, row_broadcast) *
+                XlaHelpers::ScalarValue<double>(scale, type, builder),
+            blocks.type);
+        xla::XlaOp grad_key_block =
+            BuildBatchDot(grad_scores, rank - 2, query, rank - 2, type);
+        std::vector<xla::XlaOp> block_start =
+            BlockStartIndices(start, rank, rank - 2);
+
+        std::vector<xla::XlaOp> results(values.begin(), values.end());
+        results[0] = values[0] + xla::One(builder, xla::PrimitiveType::S32);
+        results[grads_index + 3] =
+            values[grads_index + 3] +
+            BuildBatchDot(grad_scores, rank - 1, key_block, rank - 2, type);
+        results[grads_index + 4] = xla::DynamicUpdateSlice(
+            values[grads_index + 4], grad_key_block, block_start);
+        results[grads_index + 5] = xla::DynamicUpdateSlice(
+            values[grads_index + 5], grad_value_block, block_start);
+        return results;
+      },
+      init_values, "ScaledDotProductAttentionBackward", builder));
+
+  xla::XlaOp grad_query =
+      xla::ConvertElementType(results[grads_index + 3], blocks.type);
+  xla::XlaOp grad_key = xla::ConvertElementType(
+      xla::SliceInDim(results[grads_index + 4], 0, blocks.key_length, 1,
+                      rank - 2),
+      blocks.type);
+  xla::XlaOp grad_value = xla::ConvertElementType(
+      xla::SliceInDim(results[grads_index + 5], 0, blocks.key_length, 1,
+                      rank - 2),
+      blocks.type);
+  return {grad_query, grad_key, grad_value};
+}
+
+}  // namespace torch_xla
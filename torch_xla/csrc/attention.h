@@ -0,0 +1,31 @@
+#ifndef XLA_TORCH_XLA_CSRC_ATTENTION_H_
+#define XLA_TORCH_XLA_CSRC_ATTENTION_H_
+
+#include <vector>
+
+#include "xla/hlo/builder/xla_builder.h"
+
+namespace torch_xla {
+
+// Computes softmax(query @ key^T * scale + mask) @ value one block of
+// block_size keys at a time, carrying a running row max and row sum, so the
+// full (L, S) score matrix is never materialized. The query, key and value
+// share their batch dimensions. The optional mask broadcasts to the score
+// shape without being expanded: boolean masks select the keys to attend to,
+// floating point masks are added to the scores. Returns the attention output
+// and the per row log-sum-exp of the scores.
+std::vector<xla::XlaOp> BuildScaledDotProductAttention(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp mask,
+    bool is_causal, double scale, int64_t block_size);
+
+// Computes the query, key and value gradients of
+// BuildScaledDotProductAttention, rebuilding each block of probabilities from
+// the forward log-sum-exp instead of saving them.
+std::vector<xla::XlaOp> BuildScaledDotProductAttentionBackward(
+    xla::XlaOp grad_output, xla::XlaOp query, xla::XlaOp key, xla::XlaOp value,
+    xla::XlaOp mask, xla::XlaOp output, xla::XlaOp logsumexp, bool is_causal,
+    double scale, int64_t block_size);
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_ATTENTION_H_
@@ -81,12 +81,20 @@ xla::XlaOp ConvertToNumeric(xla::XlaOp op) {
 
 xla::XlaOp CastToScalarType(xla::XlaOp input,
                             std::optional<at::ScalarType> dtype) {
+  xla::PrimitiveType from = XlaHelpers::TypeOfXlaOp(input);
+  return ConvertTo(input, from, GetCastToScalarType(from, dtype));
+}
+
+xla::PrimitiveType GetCastToScalarType(xla::PrimitiveType from,
+                                       std::optional<at::ScalarType> dtype) {
+  torch::lazy::BackendDevice xla_device = bridge::GetCurrentDevice();
   if (dtype) {
-    torch::lazy::BackendDevice xla_device = bridge::GetCurrentDevice();
-    return ConvertTo(input, XlaHelpers::TypeOfXlaOp(input),
-                     MakeXlaPrimitiveType(*dtype, &xla_device));
+    return MakeXlaPrimitiveType(*dtype, &xla_device);
+  }
+  if (from == xla::PrimitiveType::PRED) {
+    return MaybeDowncastToXlaDeviceType(xla::PrimitiveType::U8, xla_device);
   }
-  return ConvertToNumeric(input, XlaHelpers::TypeOfXlaOp(input));
+  return from;
 }
 
 xla::XlaOp MaybeConvertTo(xla::XlaOp input, xla::PrimitiveType type) {
@@ -27,6 +27,10 @@ xla::XlaOp ConvertToNumeric(xla::XlaOp op);
 xla::XlaOp CastToScalarType(xla::XlaOp input,
                             std::optional<at::ScalarType> dtype);
 
+// Returns the element type of CastToScalarType() for an input of type from.
+xla::PrimitiveType GetCastToScalarType(xla::PrimitiveType from,
+                                       std::optional<at::ScalarType> dtype);
+
 xla::XlaOp MaybeConvertTo(xla::XlaOp input, xla::PrimitiveType type);
 
 }  // namespace torch_xla
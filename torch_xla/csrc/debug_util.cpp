@@ -7,7 +7,6 @@
 #include <fstream>
 #include <iostream>
 #include <mutex>
-#include <regex>
 #include <sstream>
 #include <unordered_set>
 
@@ -259,7 +258,8 @@ int GetDebugLevel() {
 
 void DebugUtil::analyze_graph_execution_python_frame(
     GraphAnalysisSource source, torch::lazy::hash_t graph_hash,
-    const xla::ProgramShape* program_shape) {
+    const xla::ProgramShape* program_shape,
+    const std::string& recompilation_diff) {
   static const int pt_xla_debug_level = GetDebugLevel();
   static const bool is_master_process =
       (runtime::sys_util::GetEnvInt("PJRT_LOCAL_PROCESS_RANK", 0) == 0);
@@ -376,6 +376,14 @@ void DebugUtil::analyze_graph_execution_python_frame(
           "torch_xla.sync\n";
   }
 
+  if (!recompilation_diff.empty()) {
+    ss << debug_output_prefix << "Nearest Previously Compiled Graph: \n";
+    for (absl::string_view line :
+         absl::StrSplit(recompilation_diff, '\n', absl::SkipEmpty())) {
+      ss << debug_output_prefix << "  " << line << "\n";
+    }
+  }
+
   ss << debug_output_prefix << "Graph Info: \n";
   if (graph_executor->CurrentGraphName() != "") {
     ss << debug_output_prefix
@@ -465,35 +473,32 @@ void DebugUtil::post_compilation_analysis(
      << "======================================================================"
         "=========="
      << "\n";
-  std::string memory_info = computation->get_memory_info();
-
-  std::vector<std::string> keysToExtract = {
-      "generated_code_size_in_bytes", "argument_size_in_bytes",
-      "output_size_in_bytes", "alias_size_in_bytes", "temp_size_in_bytes"};
-  std::vector<std::string> sizes_in_gb;
-
-  for (const std::string& key : keysToExtract) {
-    std::regex pattern(key + "=([0-9]+)");
-    std::smatch match;
-
-    if (std::regex_search(memory_info, match, pattern)) {
-      sizes_in_gb.push_back(
-          std::to_string(std::stoll(match[1]) * 1.0 / 1024 / 1024 / 1024));
-    } else {
-      sizes_in_gb.push_back("Unknown ");
+  runtime::ComputationClient::ComputationStats stats =
+      computation->get_computation_stats();
+  auto format_size = [](int64_t size_in_bytes) -> std::string {
+    if (size_in_bytes < 0) {
+      return "Unknown ";
     }
-  }
+    return std::to_string(size_in_bytes * 1.0 / 1024 / 1024 / 1024);
+  };
 
-  ss << debug_output_prefix << "Graph input size: " << sizes_in_gb[1]
-     << " GB\n";
-  ss << debug_output_prefix << "Graph output size: " << sizes_in_gb[2]
+  ss << debug_output_prefix
+     << "Graph input size: " << format_size(stats.argument_size_in_bytes)
      << " GB\n";
-  ss << debug_output_prefix << "Aliased Input size: " << sizes_in_gb[3]
+  ss << debug_output_prefix
+     << "Graph output size: " << format_size(stats.output_size_in_bytes)
      << " GB\n";
-  ss << debug_output_prefix << "Intermediate tensor size: " << sizes_in_gb[4]
+  ss << debug_output_prefix
+     << "Aliased Input size: " << format_size(stats.alias_size_in_bytes)
      << " GB\n";
-  ss << debug_output_prefix << "Compiled program size: " << sizes_in_gb[0]
+  ss << debug_output_prefix
+     << "Intermediate tensor size: " << format_size(stats.temp_size_in_bytes)
      << " GB\n";
+  ss << debug_output_prefix << "Compiled program size: "
+     << format_size(stats.generated_code_size_in_bytes) << " GB\n";
+  if (stats.flops >= 0) {
+    ss << debug_output_prefix << "Estimated FLOPs: " << stats.flops << "\n";
+  }
   ss << debug_output_prefix
      << "----------------------------------------------------------------------"
         "----------"
@@ -57,10 +57,12 @@ class DebugUtil {
   static bool ExperimentEnabled(const std::string& name);
 
   // warning, this function should only be called when a graph execution is
-  // about to happen.
+  // about to happen. For compilations, recompilation_diff describes the
+  // difference with the nearest graph compiled before, if any.
   static void analyze_graph_execution_python_frame(
       GraphAnalysisSource source, torch::lazy::hash_t graph_hash = 0,
-      const xla::ProgramShape* program_shape = nullptr);
+      const xla::ProgramShape* program_shape = nullptr,
+      const std::string& recompilation_diff = "");
 
   static void post_compilation_analysis(
       runtime::ComputationClient::ComputationPtr computation);
@@ -11,6 +11,7 @@
 #include <torch/csrc/lazy/core/config.h>
 #include <torch/csrc/lazy/core/ir_util.h>
 #include <torch/csrc/lazy/core/lazy_graph_executor.h>
+#include <torch/csrc/lazy/python/python_util.h>
 
 #include <cstdint>
 #include <cstring>
@@ -48,10 +49,15 @@
 #include "torch_xla/csrc/ir.h"
 #include "torch_xla/csrc/ir_dump_util.h"
 #include "torch_xla/csrc/layout_manager.h"
+#include "torch_xla/csrc/lowering_context.h"
 #include "torch_xla/csrc/ops/device_data.h"
 #include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/recompilation_tracker.h"
+#include "torch_xla/csrc/rematerialization.h"
+#include "torch_xla/csrc/runtime/buffer_tracker.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/event_log.h"
 #include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/metrics_analysis.h"
 #include "torch_xla/csrc/runtime/metrics_reader.h"
@@ -59,10 +65,12 @@
 #include "torch_xla/csrc/runtime/pjrt_registry.h"
 #include "torch_xla/csrc/runtime/profiler.h"
 #include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/runtime/step_breakdown.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
+#include "torch_xla/csrc/scalar_pool.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/status.h"
 #include "torch_xla/csrc/tensor_impl.h"
@@ -229,6 +237,7 @@ void PrepareToExit() {
     SetAllReduceToken(xla_device, nullptr);
     WaitDeviceOps();
   }
+  runtime::EventLog::Get()->Flush();
 }
 
 std::string GetTensorsDump(
@@ -648,6 +657,8 @@ std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> Recv(
 void SyncTensors(const std::vector<at::Tensor>& tensors,
                  const std::vector<std::string>& devices, bool wait,
                  bool sync_xla_data, bool warm_up_cache_only = false) {
+  runtime::EventLog::ScopedReason scoped_reason(warm_up_cache_only ? "warm_up"
+                                                                   : "sync");
   std::vector<XLATensorPtr> xtensors =
       GetXlaTensors(tensors, /*want_all=*/false);
   XLAGraphExecutor::Get()->SyncTensorsGraph(&xtensors, devices, wait,
@@ -656,6 +667,7 @@ void SyncTensors(const std::vector<at::Tensor>& tensors,
 
 void SyncLiveTensors(const std::string& device_str,
                      const std::vector<std::string>& devices, bool wait) {
+  runtime::EventLog::ScopedReason scoped_reason("sync");
   auto opt_device = GetOptionalDevice(device_str);
   XLAGraphExecutor::Get()->SyncLiveTensorsGraph(
       opt_device ? &opt_device.value() : nullptr, devices, wait);
@@ -666,6 +678,7 @@ void StepMarker(const std::string& device_str,
                 bool reset_scope) {
   tsl::profiler::TraceMe activity("StepMarker",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  runtime::EventLog::ScopedReason scoped_reason("mark_step");
   torch::lazy::BackendDevice device = GetDeviceOrCurrent(device_str);
   XLAGraphExecutor::Get()->SyncLiveTensorsGraph(&device, devices, wait);
   XLAGraphExecutor::Get()->MarkStep(device, reset_scope);
@@ -941,6 +954,159 @@ py::dict GetMemoryInfo(const std::string& device_str) {
   return py_dict;
 }
 
+std::vector<std::string> GetMemoryKinds(const std::string& device_str) {
+  torch::lazy::BackendDevice device = GetDeviceOrCurrent(device_str);
+  return runtime::GetComputationClientOrDie()->GetMemoryKinds(
+      device.toString());
+}
+
+// Materializes the tensors, and moves their data to the memory space of kind
+// memory_kind, where it stays until the tensors are updated.
+void MoveToMemoryKind(const std::vector<at::Tensor>& tensors,
+                      const std::string& memory_kind) {
+  std::vector<XLATensorPtr> xtensors =
+      GetXlaTensors(tensors, /*want_all=*/true);
+  NoGilSection nogil;
+  XLAGraphExecutor::Get()->SyncTensorsGraph(&xtensors, /*devices=*/{},
+                                            /*wait=*/true,
+                                            /*sync_ltc_data=*/false);
+  for (XLATensorPtr& xtensor : xtensors) {
+    runtime::ComputationClient::DataPtr data =
+        runtime::GetComputationClientOrDie()->CopyToMemoryKind(
+            UnwrapXlaData(xtensor->GetXlaData()), memory_kind);
+    xtensor->SetXlaData(data);
+  }
+}
+
+std::string GetMemoryKind(const at::Tensor& tensor) {
+  XLATensorPtr xtensor = bridge::GetXlaTensor(tensor);
+  torch::lazy::BackendDataPtr data = xtensor->CurrentDataHandle();
+  return data != nullptr ? UnwrapXlaData(data)->memory_kind() : "";
+}
+
+void SetBufferTracking(bool enabled, bool capture_frames) {
+  runtime::BufferTracker* buffer_tracker = runtime::BufferTracker::Get();
+  if (capture_frames) {
+    buffer_tracker->SetFrameProvider([]() -> std::string {
+      std::vector<torch::lazy::SourceLocation> frames =
+          torch::lazy::GetPythonFrames();
+      if (frames.empty()) {
+        return "";
+      }
+      return absl::StrCat(frames.front().function, " (", frames.front().file,
+                          ":", frames.front().line, ")");
+    });
+  }
+  buffer_tracker->SetEnabled(enabled, capture_frames);
+}
+
+py::list ReadEventLog(const std::string& path) {
+  std::vector<runtime::EventLog::Event> events =
+      runtime::metrics_reader::ReadEventLog(path);
+  py::list py_events;
+  for (const runtime::EventLog::Event& event : events) {
+    py::dict py_event;
+    py_event["type"] = event.type;
+    py_event["timestamp_us"] = event.timestamp_us;
+    py_event["graph_hash"] = event.graph_hash;
+    py_event["reason"] = event.reason;
+    py_event["frame"] = event.frame;
+    py_event["device"] = event.device;
+    py_event["cache"] = event.cache;
+    py_event["compile_time_us"] = event.compile_time_us;
+    py_event["execute_time_us"] = event.execute_time_us;
+    py_event["input_bytes"] = event.input_bytes;
+    py_event["output_bytes"] = event.output_bytes;
+    py_event["num_parameters"] = event.num_parameters;
+    py_event["num_scalar_parameters"] = event.num_scalar_parameters;
+    py_event["padding_bytes"] = event.padding_bytes;
+    py_event["recompiled_node"] = event.recompiled_node;
+    py_event["phase_time_us"] = event.phase_time_us;
+    py_events.append(std::move(py_event));
+  }
+  return py_events;
+}
+
+// Analyzes the events of the log at path, or the recent events of this process
+// if path is empty.
+std::vector<runtime::metrics::Finding> AnalyzeEventLog(
+    const std::string& path) {
+  return runtime::metrics::AnalyzeEvents(
+      path.empty() ? runtime::EventLog::Get()->GetRecentEvents()
+                   : runtime::metrics_reader::ReadEventLog(path));
+}
+
+py::list GetPerformanceFindings(const std::string& path) {
+  std::vector<runtime::metrics::Finding> findings = AnalyzeEventLog(path);
+  py::list py_findings;
+  for (const runtime::metrics::Finding& finding : findings) {
+    py::dict py_finding;
+    py_finding["analyzer"] = finding.analyzer;
+    py_finding["description"] = finding.description;
+    py_finding["suggestion"] = finding.suggestion;
+    py_finding["estimated_cost_us"] = finding.estimated_cost_us;
+    py_findings.append(std::move(py_finding));
+  }
+  return py_findings;
+}
+
+py::list GetRecompilationDiffs() {
+  std::vector<RecompilationTracker::Diff> diffs =
+      RecompilationTracker::Get()->GetDiffs();
+  py::list py_diffs;
+  for (const RecompilationTracker::Diff& diff : diffs) {
+    py::dict py_diff;
+    py_diff["graph_hash"] = diff.graph_hash;
+    py_diff["nearest_graph_hash"] = diff.nearest_graph_hash;
+    py_diff["num_nodes"] = diff.num_nodes;
+    py_diff["nearest_num_nodes"] = diff.nearest_num_nodes;
+    py_diff["position"] = diff.position;
+    py_diff["node"] = diff.node;
+    py_diff["nearest_node"] = diff.nearest_node;
+    py_diff["frame"] = diff.frame;
+    py_diff["report"] = diff.ToString();
+    py_diffs.append(std::move(py_diff));
+  }
+  return py_diffs;
+}
+
+py::list GetStepBreakdown() {
+  // In the order of runtime::StepBreakdown::Phase.
+  static const char* const phase_keys[] = {
+      "hashing",      "lowering",           "compile", "transfer_to_device",
+      "execute_wait", "transfer_from_device"};
+  static_assert(std::size(phase_keys) == runtime::StepBreakdown::kNumPhases);
+  std::vector<runtime::StepBreakdown::Step> steps =
+      runtime::StepBreakdown::Get()->GetSteps();
+  py::list py_steps;
+  for (const runtime::StepBreakdown::Step& step : steps) {
+    py::dict py_step;
+    py_step["step_time"] = step.step_time_ns;
+    py_step["tracing"] = step.tracing_ns;
+    for (size_t i = 0; i < runtime::StepBreakdown::kNumPhases; ++i) {
+      py_step[phase_keys[i]] = step.phase_ns[i];
+    }
+    py_steps.append(std::move(py_step));
+  }
+  return py_steps;
+}
+
+py::list GetLiveBuffers() {
+  std::vector<runtime::BufferTracker::BufferInfo> buffers =
+      runtime::BufferTracker::Get()->GetLiveBuffers();
+  py::list py_buffers;
+  for (const runtime::BufferTracker::BufferInfo& buffer : buffers) {
+    py::dict py_buffer;
+    py_buffer["id"] = buffer.id;
+    py_buffer["device"] = buffer.device;
+    py_buffer["shape"] = buffer.shape;
+    py_buffer["size_in_bytes"] = buffer.size_in_bytes;
+    py_buffer["site"] = buffer.site;
+    py_buffers.append(std::move(py_buffer));
+  }
+  return py_buffers;
+}
+
 // Must be called holding GIL as it reads Python objects. Also, Python objects
 // are reference counted; reading py::dict will increase its reference count.
 absl::flat_hash_map<std::string, std::variant<int, std::string>>
@@ -965,9 +1131,11 @@ ConvertDictToMap(const py::dict& dictionary) {
 // Maps PT/XLA env vars to upstream torch::lazy env vars.
 // Upstream lazy env vars defined in torch/csrc/lazy/core/config.h.
 void MapXlaEnvVarsToLazy() {
+  // Python frames are captured for IR debugging, or to be attached to the HLO
+  // metadata, which by default happens with XLA_HLO_DEBUG.
   static bool wants_frames =
       runtime::sys_util::GetEnvBool("XLA_IR_DEBUG", false) |
-      runtime::sys_util::GetEnvBool("XLA_HLO_DEBUG", false);
+      (GetHloMetadataLevel() == HloMetadataLevel::kFull);
   FLAGS_torch_lazy_ir_debug = wants_frames;
   static bool no_scalars =
       runtime::sys_util::GetEnvBool("XLA_NO_SPECIAL_SCALARS", false);
@@ -1911,6 +2079,171 @@ void InitXlaModuleBindings(py::module m) {
             }
             return result;
            })
+      .def(
+          "_xla_weight_only_quantized_matmul",
+          [](const at::Tensor& input, const at::Tensor& weight,
+             const at::Tensor& scale,
+             const std::optional<at::Tensor>& zero_point, int64_t bits,
+             int64_t block_size) -> at::Tensor {
+            XLATensorPtr result;
+            {
+              NoGilSection nogil;
+              XLATensorPtr xla_zero_point;
+              if (zero_point) {
+                xla_zero_point = bridge::GetXlaTensor(*zero_point);
+              }
+              result = tensor_methods::weight_only_quantized_matmul(
+                  bridge::GetXlaTensor(input), bridge::GetXlaTensor(weight),
+                  bridge::GetXlaTensor(scale), xla_zero_point, bits,
+                  block_size);
+            }
+            return bridge::AtenFromXlaTensor(std::move(result));
+          },
+          py::arg("input"), py::arg("weight"), py::arg("scale"),
+          py::arg("zero_point") = py::none(), py::arg("bits") = 8,
+          py::arg("block_size") = -1)
+      .def(
+          "_xla_nonzero_padded",
+          [](const at::Tensor& input,
+             int64_t bound) -> std::tuple<at::Tensor, at::Tensor> {
+            std::pair<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::nonzero_padded(
+                  bridge::GetXlaTensor(input), bound);
+            }
+            return std::make_tuple(bridge::AtenFromXlaTensor(results.first),
+                                   bridge::AtenFromXlaTensor(results.second));
+          },
+          py::arg("input"), py::arg("bound") = -1)
+      .def(
+          "_xla_masked_select_padded",
+          [](const at::Tensor& input, const at::Tensor& mask,
+             int64_t bound) -> std::tuple<at::Tensor, at::Tensor> {
+            std::pair<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::masked_select_padded(
+                  bridge::GetXlaTensor(input), bridge::GetXlaTensor(mask),
+                  bound);
+            }
+            return std::make_tuple(bridge::AtenFromXlaTensor(results.first),
+                                   bridge::AtenFromXlaTensor(results.second));
+          },
+          py::arg("input"), py::arg("mask"), py::arg("bound") = -1)
+      .def(
+          "_xla_unique_padded",
+          [](const at::Tensor& input,
+             int64_t bound) -> std::tuple<at::Tensor, at::Tensor> {
+            std::pair<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::unique_padded(
+                  bridge::GetXlaTensor(input), bound);
+            }
+            return std::make_tuple(bridge::AtenFromXlaTensor(results.first),
+                                   bridge::AtenFromXlaTensor(results.second));
+          },
+          py::arg("input"), py::arg("bound") = -1)
+      .def(
+          "_xla_batched_nms",
+          [](const at::Tensor& boxes, const at::Tensor& scores,
+             const at::Tensor& classes, const at::Tensor& valid_counts,
+             double iou_threshold, int64_t max_output_size,
+             int64_t tile_size) -> std::tuple<at::Tensor, at::Tensor> {
+            std::pair<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::batched_nms(
+                  bridge::GetXlaTensor(boxes), bridge::GetXlaTensor(scores),
+                  bridge::GetXlaTensor(classes),
+                  bridge::GetXlaTensor(valid_counts), iou_threshold,
+                  max_output_size, tile_size);
+            }
+            return std::make_tuple(bridge::AtenFromXlaTensor(results.first),
+                                   bridge::AtenFromXlaTensor(results.second));
+          },
+          py::arg("boxes"), py::arg("scores"), py::arg("classes"),
+          py::arg("valid_counts"), py::arg("iou_threshold"),
+          py::arg("max_output_size"), py::arg("tile_size") = 512)
+      .def(
+          "_xla_row_sparse_coalesce",
+          [](const at::Tensor& rows, const at::Tensor& values, int64_t num_rows,
+             int64_t padding_idx)
+              -> std::tuple<at::Tensor, at::Tensor, at::Tensor> {
+            std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::row_sparse_coalesce(
+                  bridge::GetXlaTensor(rows), bridge::GetXlaTensor(values),
+                  num_rows, padding_idx);
+            }
+            return std::make_tuple(
+                bridge::AtenFromXlaTensor(std::get<0>(results)),
+                bridge::AtenFromXlaTensor(std::get<1>(results)),
+                bridge::AtenFromXlaTensor(std::get<2>(results)));
+          },
+          py::arg("rows"), py::arg("values"), py::arg("num_rows"),
+          py::arg("padding_idx") = -1)
+      .def(
+          "_xla_linear_cross_entropy",
+          [](const at::Tensor& hidden, const at::Tensor& weight,
+             const at::Tensor& target, int64_t reduction, int ignore_index,
+             int64_t vocab_block) -> std::tuple<at::Tensor, at::Tensor> {
+            std::tuple<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::linear_cross_entropy(
+                  bridge::GetXlaTensor(hidden), bridge::GetXlaTensor(weight),
+                  bridge::GetXlaTensor(target), reduction, ignore_index,
+                  vocab_block);
+            }
+            return std::make_tuple(
+                bridge::AtenFromXlaTensor(std::get<0>(results)),
+                bridge::AtenFromXlaTensor(std::get<1>(results)));
+          },
+          py::arg("hidden"), py::arg("weight"), py::arg("target"),
+          py::arg("reduction"), py::arg("ignore_index"),
+          py::arg("vocab_block"))
+      .def(
+          "_xla_linear_cross_entropy_backward",
+          [](const at::Tensor& grad_output, const at::Tensor& hidden,
+             const at::Tensor& weight, const at::Tensor& target,
+             const at::Tensor& logsumexp, int64_t reduction, int ignore_index,
+             int64_t vocab_block) -> std::tuple<at::Tensor, at::Tensor> {
+            std::tuple<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::linear_cross_entropy_backward(
+                  bridge::GetXlaTensor(grad_output),
+                  bridge::GetXlaTensor(hidden), bridge::GetXlaTensor(weight),
+                  bridge::GetXlaTensor(target),
+                  bridge::GetXlaTensor(logsumexp), reduction, ignore_index,
+                  vocab_block);
+            }
+            return std::make_tuple(
+                bridge::AtenFromXlaTensor(std::get<0>(results)),
+                bridge::AtenFromXlaTensor(std::get<1>(results)));
+          },
+          py::arg("grad_output"), py::arg("hidden"), py::arg("weight"),
+          py::arg("target"), py::arg("logsumexp"), py::arg("reduction"),
+          py::arg("ignore_index"), py::arg("vocab_block"))
+      .def("_xla_approx_topk",
+           [](const at::Tensor& input, int64_t k, int64_t dim, bool largest,
+              float recall_target) -> std::tuple<at::Tensor, at::Tensor> {
+            XLA_CHECK(recall_target > 0 && recall_target <= 1)
+                << "recall_target must be in (0, 1], got " << recall_target;
+            std::tuple<XLATensorPtr, XLATensorPtr> results;
+            {
+              NoGilSection nogil;
+              results = tensor_methods::topk(
+                  bridge::GetXlaTensor(input), k, dim, largest,
+                  /*sorted=*/true, /*stable=*/false, recall_target);
+            }
+            return std::make_tuple(
+                bridge::AtenFromXlaTensor(std::get<0>(results)),
+                bridge::AtenFromXlaTensor(std::get<1>(results)));
+           })
       .def("_xla_all_to_all",
            [](const at::Tensor& input,
               const std::shared_ptr<torch::lazy::Value>& token,
@@ -2250,6 +2583,14 @@ void InitXlaModuleBindings(py::module m) {
             return XLAGraphExecutor::Get()->GetAliasWithBufferDonorConfig();
           },
           py::arg("device") = "")
+      .def("_xla_set_auto_buffer_donation",
+           [](bool enable) {
+             XLAGraphExecutor::Get()->SetAutoBufferDonationConfig(enable);
+           })
+      .def("_xla_get_auto_buffer_donation",
+           []() {
+             return XLAGraphExecutor::Get()->GetAutoBufferDonationConfig();
+           })
       .def(
           "_xla_sync_multi",
           [](const std::vector<at::Tensor>& tensors,
@@ -2339,6 +2680,8 @@ void InitXlaModuleBindings(py::module m) {
           py::arg("devices"))
       .def("_get_executed_fallback_ops",
            []() { return GetFallbackOperations(); })
+      .def("_get_executed_fallback_ops_time",
+           []() { return GetFallbackOperationTimes(); })
       .def("_xla_counter_names",
            []() {
             auto counter_names = torch::lazy::GetCounterNames();
@@ -2425,6 +2768,56 @@ void InitXlaModuleBindings(py::module m) {
           py::arg("device") = "")
       .def("_xla_memory_info",
            [](const std::string& device) { return GetMemoryInfo(device); })
+      .def("_xla_set_buffer_tracking", &SetBufferTracking, py::arg("enabled"),
+           py::arg("capture_frames") = false)
+      .def("_xla_buffer_tracking_enabled",
+           []() { return runtime::BufferTracker::Get()->IsEnabled(); })
+      .def("_xla_live_buffers", []() { return GetLiveBuffers(); })
+      .def("_xla_step_breakdown", []() { return GetStepBreakdown(); })
+      .def("_xla_recompilation_diffs", []() { return GetRecompilationDiffs(); })
+      .def("_xla_clear_recompilation_diffs",
+           []() { RecompilationTracker::Get()->Clear(); })
+      .def("_xla_set_event_log",
+           [](const std::string& path) {
+             NoGilSection nogil;
+             runtime::EventLog::Get()->Open(path);
+           })
+      .def("_xla_event_log_path",
+           []() { return runtime::EventLog::Get()->path(); })
+      .def("_xla_flush_event_log",
+           []() {
+             NoGilSection nogil;
+             runtime::EventLog::Get()->Flush();
+           })
+      .def("_xla_set_event_log_in_memory",
+           [](bool in_memory) {
+             runtime::EventLog::Get()->SetInMemory(in_memory);
+           })
+      .def("_xla_event_log_in_memory",
+           []() { return runtime::EventLog::Get()->IsInMemory(); })
+      .def("_xla_read_event_log", &ReadEventLog)
+      .def("_xla_performance_findings", &GetPerformanceFindings,
+           py::arg("path") = "")
+      .def("_xla_performance_findings_report",
+           [](const std::string& path) {
+             return runtime::metrics::CreateFindingsReport(
+                 AnalyzeEventLog(path));
+           },
+           py::arg("path") = "")
+      .def("_xla_event_log_report",
+           [](const std::string& path) {
+             return runtime::metrics_reader::CreateEventLogReport(
+                 runtime::metrics_reader::ReadEventLog(path));
+           })
+      .def("_xla_memory_kinds", &GetMemoryKinds, py::arg("device") = "")
+      .def("_xla_move_to_memory_kind", &MoveToMemoryKind)
+      .def("_xla_get_memory_kind", &GetMemoryKind)
+      .def("_xla_memory_placement",
+           [](const at::Tensor& input,
+              const std::string& memory_kind) -> at::Tensor {
+            return bridge::AtenFromXlaTensor(tensor_methods::memory_placement(
+                bridge::GetXlaTensor(input), memory_kind));
+           })
       .def("_xla_set_mat_mul_precision",
            [](const std::string& mat_mul_precision) {
             xla::PrecisionConfig::Precision precision =
@@ -2533,6 +2926,63 @@ void InitXlaModuleBindings(py::module m) {
                   weight_decay, eps, amsgrad, maximize, use_adamw);
             }
            })
+      .def(
+          "_xla_foreach_sgd_optimizer_step_",
+          [](const at::Tensor& found_inf, const std::vector<at::Tensor>& steps,
+             const std::vector<at::Tensor>& params,
+             const std::vector<at::Tensor>& bufs,
+             const std::vector<at::Tensor>& d_ps, double weight_decay,
+             double momentum, double lr, double dampening, bool nesterov,
+             bool maximize, bool pack) {
+            {
+              NoGilSection nogil;
+              tensor_methods::foreach_sgd_optimizer_step_(
+                  bridge::GetXlaTensor(found_inf),
+                  GetXlaTensors(steps, /*want_all=*/true),
+                  GetXlaTensors(params, /*want_all=*/true),
+                  GetXlaTensors(bufs, /*want_all=*/true),
+                  GetXlaTensors(d_ps, /*want_all=*/true), weight_decay,
+                  momentum, lr, dampening, nesterov, maximize, pack);
+            }
+          },
+          py::arg("found_inf"), py::arg("steps"), py::arg("params"),
+          py::arg("bufs"), py::arg("d_ps"), py::arg("weight_decay"),
+          py::arg("momentum"), py::arg("lr"), py::arg("dampening"),
+          py::arg("nesterov"), py::arg("maximize"), py::arg("pack") = false)
+      .def(
+          "_xla_foreach_adam_optimizer_step_",
+          [](const at::Tensor& found_inf, const std::vector<at::Tensor>& steps,
+             const std::vector<at::Tensor>& params,
+             const std::vector<at::Tensor>& grads,
+             const std::vector<at::Tensor>& exp_avgs,
+             const std::vector<at::Tensor>& exp_avg_sqs,
+             const std::vector<at::Tensor>& max_exp_avg_sqs, double beta1,
+             double beta2, double lr, double weight_decay, double eps,
+             bool amsgrad, bool maximize, bool use_adamw, bool pack) {
+            {
+              NoGilSection nogil;
+              std::vector<XLATensorPtr> max_exp_avg_sqs_xla;
+              if (amsgrad) {
+                max_exp_avg_sqs_xla =
+                    GetXlaTensors(max_exp_avg_sqs, /*want_all=*/true);
+              }
+              tensor_methods::foreach_adam_optimizer_step_(
+                  bridge::GetXlaTensor(found_inf),
+                  GetXlaTensors(steps, /*want_all=*/true),
+                  GetXlaTensors(params, /*want_all=*/true),
+                  GetXlaTensors(grads, /*want_all=*/true),
+                  GetXlaTensors(exp_avgs, /*want_all=*/true),
+                  GetXlaTensors(exp_avg_sqs, /*want_all=*/true),
+                  max_exp_avg_sqs_xla, beta1, beta2, lr, weight_decay, eps,
+                  amsgrad, maximize, use_adamw, pack);
+            }
+          },
+          py::arg("found_inf"), py::arg("steps"), py::arg("params"),
+          py::arg("grads"), py::arg("exp_avgs"), py::arg("exp_avg_sqs"),
+          py::arg("max_exp_avg_sqs"), py::arg("beta1"), py::arg("beta2"),
+          py::arg("lr"), py::arg("weight_decay"), py::arg("eps"),
+          py::arg("amsgrad"), py::arg("maximize"), py::arg("use_adamw"),
+          py::arg("pack") = false)
       .def("_xla_mark_sharding",
            [](const at::Tensor& input, xla::OpSharding sharding) {
             ShardingUtil::XlaMarkSharding(input, sharding);
@@ -2936,6 +3386,32 @@ void InitXlaModuleBindings(py::module m) {
            [](bool ir_debug) { FLAGS_torch_lazy_ir_debug = ir_debug; })
       .def("_get_ir_debug",  //
            []() { return FLAGS_torch_lazy_ir_debug; })
+      .def("_set_hlo_metadata_level",
+           [](const std::string& level) {
+            HloMetadataLevel metadata_level = ParseHloMetadataLevel(level);
+            SetHloMetadataLevel(metadata_level);
+            // Frames are only worth capturing if they make it to the HLO.
+            static const bool ir_debug =
+                runtime::sys_util::GetEnvBool("XLA_IR_DEBUG", false);
+            FLAGS_torch_lazy_ir_debug =
+                ir_debug || metadata_level == HloMetadataLevel::kFull;
+           })
+      .def("_get_hlo_metadata_level",
+           []() -> std::string {
+            switch (GetHloMetadataLevel()) {
+              case HloMetadataLevel::kNone:
+                return "none";
+              case HloMetadataLevel::kOpType:
+                return "op_type";
+              case HloMetadataLevel::kFull:
+                return "full";
+            }
+            XLA_ERROR() << "Invalid HLO metadata level";
+           })
+      .def("_xla_set_rematerialization_budget",
+           [](int64_t budget) { SetRematerializationBudget(budget); })
+      .def("_xla_get_rematerialization_budget",
+           []() { return GetRematerializationBudget(); })
       .def("_set_xla_all_numbers_special_scalars",
            [](bool all_numbers_special_scalars) {
             FLAGS_torch_lazy_all_numbers_special_scalars =
@@ -2943,6 +3419,10 @@ void InitXlaModuleBindings(py::module m) {
            })
       .def("_get_xla_all_numbers_special_scalars",
            []() { return FLAGS_torch_lazy_all_numbers_special_scalars; })
+      .def("_xla_set_scalar_pool",
+           [](bool enabled) { ScalarPool::Get()->SetEnabled(enabled); })
+      .def("_xla_get_scalar_pool",
+           []() { return ScalarPool::Get()->IsEnabled(); })
       .def("_set_xla_handle_special_scalars",
            [](bool handle_special_scalars) {
             FLAGS_torch_lazy_handle_special_scalars = handle_special_scalars;
@@ -3374,6 +3854,28 @@ void InitXlaModuleBindings(py::module m) {
              std::string bin((const char*)&hash, sizeof(hash));
              return py::bytes(bin);
            })
+      .def("_get_computation_stats",
+           [](const std::string& hash_str) -> py::object {
+             XLA_CHECK(hash_str.size() == sizeof(torch::lazy::hash_t));
+             torch::lazy::hash_t hash =
+                 *(torch::lazy::hash_t*)(hash_str.c_str());
+             std::optional<runtime::ComputationClient::ComputationStats> stats =
+                 XLAGraphExecutor::Get()->GetComputationStats(hash);
+             if (!stats) {
+               return py::none();
+             }
+             py::dict dict;
+             dict["argument_size_in_bytes"] = stats->argument_size_in_bytes;
+             dict["output_size_in_bytes"] = stats->output_size_in_bytes;
+             dict["alias_size_in_bytes"] = stats->alias_size_in_bytes;
+             dict["temp_size_in_bytes"] = stats->temp_size_in_bytes;
+             dict["generated_code_size_in_bytes"] =
+                 stats->generated_code_size_in_bytes;
+             dict["flops"] = stats->flops;
+             dict["transcendentals"] = stats->transcendentals;
+             dict["bytes_accessed"] = stats->bytes_accessed;
+             return dict;
+           })
       .def("_clear_pending_irs",
            [](const std::string& device) {
              // Use with caution. Those tensor whole ir was cleared
@@ -1,7 +1,14 @@
 #include "torch_xla/csrc/lowering_context.h"
 
 #include <torch/csrc/lazy/core/ir_metadata.h>
-
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
@@ -13,24 +20,74 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/rematerialization.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/stack_frame_index_builder.h"
 #include "torch_xla/csrc/status.h"
+#include "torch_xla/csrc/thread_pool.h"
+#include "xla/layout_util.h"
 
 namespace torch_xla {
 
 namespace {
 
+// The level set with SetHloMetadataLevel(), or -1 if none was set.
+std::atomic<int> hlo_metadata_level_override(-1);
+
+// Runs fn(i) for every i in [0, num_tasks), using the calling thread and up to
+// num_threads - 1 threads of the shared pool. Tasks are pulled from a common
+// index, so pool threads that start late (or never start, if the pool is busy)
+// don't delay the calling thread, which waits only for tasks already running.
+void ParallelFor(size_t num_tasks, size_t num_threads,
+                 const std::function<void(size_t)>& fn) {
+  struct State {
+    std::atomic<size_t> next_task{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t active = 0;
+    bool closed = false;
+  };
+  auto state = std::make_shared<State>();
+  auto run_tasks = [state, num_tasks, &fn]() {
+    for (size_t i = state->next_task++; i < num_tasks;
+         i = state->next_task++) {
+      fn(i);
+    }
+  };
+  size_t num_helpers = std::min(num_threads, num_tasks) - 1;
+  for (size_t i = 0; i < num_helpers; ++i) {
+    thread::Schedule([state, run_tasks]() {
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->closed) {
+          return;
+        }
+        ++state->active;
+      }
+      run_tasks();
+      std::lock_guard<std::mutex> lock(state->mutex);
+      --state->active;
+      state->cv.notify_all();
+    });
+  }
+  run_tasks();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->closed = true;
+  state->cv.wait(lock, [&state]() { return state->active == 0; });
+}
+
 class HloMetadataSetter {
  public:
   HloMetadataSetter(LoweringContext& lowering_context,
-                    const torch::lazy::Node& node)
+                    const torch::lazy::Node& node, int64_t* time_ns)
       : lowering_context_(lowering_context) {
-    if (ShouldPopulateXlaOpMetadata()) {
+    if (lowering_context.hlo_metadata_level() != HloMetadataLevel::kNone) {
+      const int64_t start = runtime::sys_util::NowNs();
       PopulateXlaOpMetadata(lowering_context, node);
+      *time_ns += runtime::sys_util::NowNs() - start;
     }
   }
 
@@ -41,20 +98,12 @@ class HloMetadataSetter {
   HloMetadataSetter& operator=(HloMetadataSetter&&) = delete;
 
   ~HloMetadataSetter() {
-    if (ShouldPopulateXlaOpMetadata()) {
+    if (lowering_context_.hlo_metadata_level() != HloMetadataLevel::kNone) {
       lowering_context_.builder()->ClearOpMetadata();
     }
   }
 
  private:
-  // Returns true iff this class should populate XLA op metadata in its
-  // constructor.
-  static bool ShouldPopulateXlaOpMetadata() {
-    static const bool op_metadata =
-        runtime::sys_util::GetEnvBool("XLA_HLO_DEBUG", false);
-    return FLAGS_torch_lazy_ir_debug || op_metadata;
-  }
-
   static void PopulateXlaOpMetadata(LoweringContext& lowering_context,
                                     const torch::lazy::Node& node) {
     xla::OpMetadata metadata;
@@ -86,10 +135,13 @@ class HloMetadataSetter {
 
     // NOTE: if max_stack_depth is 0, we are just renaming the op, so we don't
     // need to add stack frame locations
-    if (max_stack_depth > 0) {
+    if (max_stack_depth > 0 &&
+        lowering_context.hlo_metadata_level() == HloMetadataLevel::kFull) {
       // Sets file, line and stack_frame_id in metadata
       lowering_context.stack_frame_index_builder()->AddStackFrameLocations(
           nmeta.frame_info, static_cast<int>(max_stack_depth), metadata);
+      TORCH_LAZY_COUNTER("HloMetadataFrames",
+                         std::min(max_stack_depth, nmeta.frame_info.size()));
     }
 
     lowering_context.builder()->SetOpMetadata(std::move(metadata));
@@ -100,6 +152,60 @@ class HloMetadataSetter {
 
 }  // namespace
 
+HloMetadataLevel GetHloMetadataLevel() {
+  const int level = hlo_metadata_level_override.load();
+  if (level >= 0) {
+    return static_cast<HloMetadataLevel>(level);
+  }
+  static const std::optional<HloMetadataLevel> env_level =
+      []() -> std::optional<HloMetadataLevel> {
+    std::string name =
+        runtime::sys_util::GetEnvString("XLA_HLO_METADATA_LEVEL", "");
+    if (name.empty()) {
+      return std::nullopt;
+    }
+    return ParseHloMetadataLevel(name);
+  }();
+  if (env_level) {
+    return *env_level;
+  }
+  static const bool hlo_debug =
+      runtime::sys_util::GetEnvBool("XLA_HLO_DEBUG", false);
+  return FLAGS_torch_lazy_ir_debug || hlo_debug ? HloMetadataLevel::kFull
+                                                : HloMetadataLevel::kNone;
+}
+
+void SetHloMetadataLevel(HloMetadataLevel level) {
+  hlo_metadata_level_override = static_cast<int>(level);
+}
+
+HloMetadataLevel ParseHloMetadataLevel(const std::string& name) {
+  if (name == "none") {
+    return HloMetadataLevel::kNone;
+  } else if (name == "op_type") {
+    return HloMetadataLevel::kOpType;
+  } else if (name == "full") {
+    return HloMetadataLevel::kFull;
+  }
+  XLA_ERROR() << "Invalid HLO metadata level: " << name
+              << " (expected none, op_type or full)";
+}
+
+bool IsHostMemoryKind(const std::string& memory_kind) {
+  return memory_kind == "pinned_host" || memory_kind == "unpinned_host";
+}
+
+xla::XlaOp BuildMemoryPlacement(xla::XlaOp input,
+                                const std::string& memory_kind) {
+  xla::FrontendAttributes attributes;
+  (*attributes.mutable_map())["_xla_buffer_placement"] = memory_kind;
+  xla::XlaScopedFrontendAttributesAssignment attributes_assignment(
+      input.builder(), std::move(attributes));
+  return xla::CustomCall(input.builder(), "annotate_device_placement", {input},
+                         ShapeHelper::ShapeOfXlaOp(input), /*opaque=*/"",
+                         /*has_side_effect=*/true);
+}
+
 LoweringContext::LoweringContext(const std::string& name,
                                  torch::lazy::BackendDevice device)
     : torch::lazy::LoweringContext(name, std::move(device)),
@@ -119,6 +225,207 @@ LoweringContext::LoweringContext(
   }
 }
 
+LoweringContext::LoweringContext(
+    const std::string& name, torch::lazy::BackendDevice device,
+    const c10::ArrayRef<const torch::lazy::Node*> post_order,
+    torch::lazy::Util::EmissionMap emit_status,
+    const absl::Span<const torch::lazy::Output> roots, const size_t num_threads,
+    const RematerializationPlan* const remat_plan)
+    : torch::lazy::LoweringContext(name, std::move(device), {},
+                                   std::move(emit_status)),
+      builder_(name),
+      stack_frame_index_builder_(std::make_shared<StackFrameIndexBuilder>()) {
+  if (remat_plan != nullptr && !remat_plan->empty()) {
+    for (const auto* node : post_order) {
+      auto it = remat_plan->recomputes.find(node);
+      if (it != remat_plan->recomputes.end()) {
+        for (const RematerializationPlan::Recompute& recompute : it->second) {
+          Rematerialize(*recompute.node, recompute.trigger);
+        }
+      }
+      LowerNode(*node);
+    }
+    return;
+  }
+  if (num_threads > 1 &&
+      LowerRegionsInParallel(post_order, roots, num_threads)) {
+    return;
+  }
+  for (const auto* node : post_order) {
+    LowerNode(*node);
+  }
+}
+
+bool LoweringContext::LowerRegionsInParallel(
+    const c10::ArrayRef<const torch::lazy::Node*> post_order,
+    const absl::Span<const torch::lazy::Output> roots,
+    const size_t num_threads) {
+  // Source locations refer to the stack frame index of the main builder, and
+  // both sharding annotations and unbounded dynamic dimensions are applied to
+  // the instructions of the main builder after lowering.
+  if (hlo_metadata_level_ == HloMetadataLevel::kFull) {
+    return false;
+  }
+  std::unordered_map<const torch::lazy::Node*, size_t> node_index;
+  node_index.reserve(post_order.size());
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    const XlaNode* const casted = dynamic_cast<const XlaNode*>(post_order[i]);
+    if (casted == nullptr || !casted->dynamic_dims().empty() ||
+        casted->shardingHash() != 0) {
+      return false;
+    }
+    node_index.emplace(post_order[i], i);
+  }
+
+  // Union-find over the non-leaf nodes. Leaves (device data, constants) are
+  // lowered by the main builder and shared by all regions, so that parameters
+  // are created in the same order as with a sequential lowering.
+  std::vector<size_t> parent(post_order.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&parent](size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    for (const torch::lazy::Output& operand : post_order[i]->operands()) {
+      auto it = node_index.find(operand.node);
+      if (it == node_index.end()) {
+        return false;
+      }
+      if (operand.node->operands().empty()) {
+        continue;
+      }
+      size_t a = find(i);
+      size_t b = find(it->second);
+      if (a != b) {
+        parent[std::max(a, b)] = std::min(a, b);
+      }
+    }
+  }
+
+  // Groups components into at most num_threads * 4 regions of similar size,
+  // assigning the largest components first.
+  std::unordered_map<size_t, size_t> component_size;
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    if (!post_order[i]->operands().empty()) {
+      ++component_size[find(i)];
+    }
+  }
+  if (component_size.size() < 2) {
+    return false;
+  }
+  std::vector<std::pair<size_t, size_t>> components(component_size.begin(),
+                                                    component_size.end());
+  std::sort(components.begin(), components.end(),
+            [](const std::pair<size_t, size_t>& a,
+               const std::pair<size_t, size_t>& b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+  std::vector<LoweringRegion> regions(
+      std::min(components.size(), num_threads * 4));
+  std::vector<size_t> region_size(regions.size(), 0);
+  std::unordered_map<size_t, size_t> component_region;
+  for (const auto& component : components) {
+    size_t region = std::distance(
+        region_size.begin(),
+        std::min_element(region_size.begin(), region_size.end()));
+    region_size[region] += component.second;
+    component_region.emplace(component.first, region);
+  }
+
+  std::vector<std::optional<size_t>> node_region(post_order.size());
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    const torch::lazy::Node* node = post_order[i];
+    if (!node->operands().empty()) {
+      node_region[i] = component_region.at(find(i));
+      regions[*node_region[i]].nodes.push_back(node);
+    }
+  }
+  OutputMap<size_t> outputs;
+  for (const torch::lazy::Output& root : roots) {
+    auto it = node_index.find(root.node);
+    if (it == node_index.end()) {
+      return false;
+    }
+    const std::optional<size_t>& region = node_region[it->second];
+    if (region && outputs.emplace(root, *region).second) {
+      regions[*region].outputs.push_back(root);
+    }
+  }
+
+  for (const torch::lazy::Node* node : post_order) {
+    if (node->operands().empty()) {
+      LowerNode(*node);
+    }
+  }
+  for (LoweringRegion& region : regions) {
+    OutputMap<size_t> inputs;
+    for (const torch::lazy::Node* node : region.nodes) {
+      for (const torch::lazy::Output& operand : node->operands()) {
+        if (operand.node->operands().empty() &&
+            inputs.emplace(operand, region.inputs.size()).second) {
+          region.inputs.push_back(operand);
+          region.input_shapes.push_back(
+              ShapeHelper::ShapeOfXlaOp(GetOutputOp(operand)));
+        }
+      }
+    }
+  }
+
+  ParallelFor(regions.size(), num_threads, [&](size_t i) {
+    LowerRegion(i, &regions[i]);
+  });
+
+  for (LoweringRegion& region : regions) {
+    if (region.error) {
+      std::rethrow_exception(region.error);
+    }
+    std::vector<xla::XlaOp> operands;
+    operands.reserve(region.inputs.size());
+    for (const torch::lazy::Output& input : region.inputs) {
+      operands.push_back(GetOutputOp(input));
+    }
+    const xla::XlaOp call =
+        xla::Call(builder(), *region.computation, operands);
+    for (size_t i = 0; i < region.outputs.size(); ++i) {
+      AssignOutputOp(region.outputs[i], xla::GetTupleElement(call, i));
+    }
+  }
+  XLA_CHECK_OK(builder()->first_error());
+  return true;
+}
+
+void LoweringContext::LowerRegion(const size_t region_index,
+                                  LoweringRegion* const region) const {
+  try {
+    LoweringContext region_ctx(
+        absl::StrCat(builder_.name(), ".region", region_index), device_);
+    region_ctx.hlo_metadata_level_ = hlo_metadata_level_;
+    for (size_t i = 0; i < region->inputs.size(); ++i) {
+      region_ctx.AssignOutputOp(
+          region->inputs[i],
+          xla::Parameter(region_ctx.builder(), i, region->input_shapes[i],
+                         absl::StrCat("p", i)));
+    }
+    for (const torch::lazy::Node* node : region->nodes) {
+      region_ctx.LowerNode(*node);
+    }
+    std::vector<xla::XlaOp> results;
+    results.reserve(region->outputs.size());
+    for (const torch::lazy::Output& output : region->outputs) {
+      results.push_back(region_ctx.GetOutputOp(output));
+    }
+    region->computation = GetValueOrThrow(
+        region_ctx.BuildXla(xla::Tuple(region_ctx.builder(), results)));
+  } catch (...) {
+    region->error = std::current_exception();
+  }
+}
+
 xla::XlaOp LoweringContext::GetParameter(
     const std::shared_ptr<torch::lazy::BackendData>& backend_data,
     const std::unordered_set<uint32_t>& unbounded_dynamic_dims) {
@@ -133,6 +440,15 @@ xla::XlaOp LoweringContext::GetParameter(
       shape.set_dynamic_dimension(dim, true);
       shape.set_dimensions(dim, xla::Shape::kUnboundedSize);
     }
+    // Buffers kept in host memory are passed in the host memory space, and
+    // moved to the device memory where the graph reads them.
+    const bool host_memory = IsHostMemoryKind(data->memory_kind());
+    if (host_memory) {
+      if (!shape.has_layout()) {
+        xla::LayoutUtil::SetToDefaultLayout(&shape);
+      }
+      shape.mutable_layout()->set_memory_space(xla::Layout::kHostMemorySpace);
+    }
     const size_t param_index = parameters_.size();
     const std::string param_name = absl::StrCat("p", param_index);
     xla::XlaOp param;
@@ -144,6 +460,9 @@ xla::XlaOp LoweringContext::GetParameter(
     } else {
       param = xla::Parameter(builder(), param_index, shape, param_name);
     }
+    if (host_memory) {
+      param = BuildMemoryPlacement(param, "device");
+    }
     it = parameters_map_.emplace(handle, Parameter{param, param_index}).first;
     parameters_.push_back(backend_data);
   } else {
@@ -201,6 +520,7 @@ absl::StatusOr<xla::XlaComputation> LoweringContext::BuildXla() {
     (*xla->mutable_proto()->mutable_stack_frame_index()) =
         stack_frame_index_builder()->stack_frame_index();
   }
+  ReportHloMetadataTime();
 
   return xla;
 }
@@ -214,10 +534,20 @@ absl::StatusOr<xla::XlaComputation> LoweringContext::BuildXla(
     (*xla->mutable_proto()->mutable_stack_frame_index()) =
         stack_frame_index_builder()->stack_frame_index();
   }
+  ReportHloMetadataTime();
 
   return xla;
 }
 
+void LoweringContext::ReportHloMetadataTime() {
+  if (hlo_metadata_time_ns_ > 0) {
+    static torch::lazy::Metric* metric =
+        new torch::lazy::Metric("HloMetadataTime", torch::lazy::MetricFnTime);
+    metric->AddSample(hlo_metadata_time_ns_);
+    hlo_metadata_time_ns_ = 0;
+  }
+}
+
 void LoweringContext::AssignOutputOp(const torch::lazy::Output& output,
                                      const xla::XlaOp op) {
   emitted_outputs_[output] = op;
@@ -241,10 +571,35 @@ xla::XlaOp LoweringContext::GetOutputOp(const torch::lazy::Output& output) {
   return it->second;
 }
 
+void LoweringContext::Rematerialize(const torch::lazy::Node& node,
+                                    const torch::lazy::Output& trigger) {
+  std::vector<torch::lazy::Output> inputs;
+  for (const torch::lazy::Output& operand : node.operands()) {
+    if (std::find(inputs.begin(), inputs.end(), operand) == inputs.end()) {
+      inputs.push_back(operand);
+    }
+  }
+  std::vector<xla::XlaOp> ops;
+  ops.reserve(inputs.size() + 1);
+  for (const torch::lazy::Output& input : inputs) {
+    ops.push_back(GetOutputOp(input));
+  }
+  ops.push_back(GetOutputOp(trigger));
+  const xla::XlaOp barrier =
+      xla::OptimizationBarrier(xla::Tuple(builder(), ops));
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    AssignOutputOp(inputs[i], xla::GetTupleElement(barrier, i));
+  }
+  LowerNode(node);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    AssignOutputOp(inputs[i], ops[i]);
+  }
+}
+
 XlaOpVector LoweringContext::LowerNode(const torch::lazy::Node& node) {
   XlaOpVector result_ops;
   try {
-    const HloMetadataSetter meta_setter(*this, node);
+    const HloMetadataSetter meta_setter(*this, node, &hlo_metadata_time_ns_);
     const XlaNode* const casted = dynamic_cast<const XlaNode*>(&node);
 
     result_ops = casted->Lower(this);
@@ -5,6 +5,7 @@
 #include <torch/csrc/lazy/backend/lowering_context.h>
 #include <torch/csrc/lazy/core/ir_util.h>
 
+#include <exception>
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,6 +26,37 @@
 namespace torch_xla {
 
 class StackFrameIndexBuilder;
+struct RematerializationPlan;
+
+// Amount of debug metadata attached to the lowered HLO instructions.
+enum class HloMetadataLevel {
+  // No metadata.
+  kNone = 0,
+  // Op type and op name (scope), without source locations.
+  kOpType = 1,
+  // Op type, op name and the Python stack frames captured with the IR nodes.
+  kFull = 2,
+};
+
+// Returns the metadata level for the graphs being lowered. Unless overridden
+// by XLA_HLO_METADATA_LEVEL or SetHloMetadataLevel(), it is kFull when
+// XLA_HLO_DEBUG or IR debugging is enabled, and kNone otherwise.
+HloMetadataLevel GetHloMetadataLevel();
+
+// Overrides the metadata level of the graphs lowered from now on.
+void SetHloMetadataLevel(HloMetadataLevel level);
+
+// Parses a level name ("none", "op_type" or "full").
+HloMetadataLevel ParseHloMetadataLevel(const std::string& name);
+
+// Returns whether memory_kind names a host memory space, whose buffers XLA
+// keeps in the host memory space of the compiled programs.
+bool IsHostMemoryKind(const std::string& memory_kind);
+
+// Annotates input to be moved to the memory space of kind memory_kind (e.g.
+// "pinned_host" or "device") by the XLA host offloading passes.
+xla::XlaOp BuildMemoryPlacement(xla::XlaOp input,
+                                const std::string& memory_kind);
 
 class LoweringContext : public torch::lazy::LoweringContext {
  public:
@@ -33,6 +65,19 @@ class LoweringContext : public torch::lazy::LoweringContext {
   LoweringContext(const std::string& name, torch::lazy::BackendDevice device,
                   c10::ArrayRef<const torch::lazy::Node*> post_order,
                   torch::lazy::Util::EmissionMap emit_status);
+  // Same as above, but the independent regions of post_order are lowered into
+  // separate computations using up to num_threads threads, and called from the
+  // main computation. Falls back to a sequential lowering if the graph has a
+  // single region, or uses features the parallel mode doesn't support. Only
+  // the outputs in roots are guaranteed to be available to GetOutputOp().
+  // If remat_plan is not empty, the graph is lowered sequentially, and the
+  // nodes of the plan are lowered again before their reusing nodes.
+  LoweringContext(const std::string& name, torch::lazy::BackendDevice device,
+                  c10::ArrayRef<const torch::lazy::Node*> post_order,
+                  torch::lazy::Util::EmissionMap emit_status,
+                  absl::Span<const torch::lazy::Output> roots,
+                  size_t num_threads,
+                  const RematerializationPlan* remat_plan = nullptr);
 
   xla::XlaBuilder* builder() { return &builder_; }
 
@@ -46,6 +91,10 @@ class LoweringContext : public torch::lazy::LoweringContext {
 
   const torch::lazy::BackendDevice& device() const { return device_; };
 
+  // The metadata level this context lowers nodes with, which is read from
+  // GetHloMetadataLevel() when the context is created.
+  HloMetadataLevel hlo_metadata_level() const { return hlo_metadata_level_; }
+
   // If a parameter associated with data has already been declared, it will be
   // returned. Otherwise a new one will be created, associated with the tensor
   // held in data.
@@ -123,6 +172,39 @@ class LoweringContext : public torch::lazy::LoweringContext {
     size_t index = 0;
   };
 
+  // A group of independent regions of the graph, lowered into its own
+  // computation.
+  struct LoweringRegion {
+    std::vector<const torch::lazy::Node*> nodes;
+    // Outputs of the nodes lowered by the main builder (graph leaves), which
+    // are passed as parameters to the region computation.
+    std::vector<torch::lazy::Output> inputs;
+    std::vector<xla::Shape> input_shapes;
+    // Outputs returned by the region computation, as a tuple.
+    std::vector<torch::lazy::Output> outputs;
+    std::optional<xla::XlaComputation> computation;
+    std::exception_ptr error;
+  };
+
+  // Records the time spent populating HLO metadata since the last call.
+  void ReportHloMetadataTime();
+
+  // Partitions post_order into regions which don't share any node other than
+  // the graph leaves, lowers them in parallel, and stitches them together in
+  // the main builder. Returns false, without lowering anything, if the graph
+  // is not eligible for parallel lowering.
+  bool LowerRegionsInParallel(
+      c10::ArrayRef<const torch::lazy::Node*> post_order,
+      absl::Span<const torch::lazy::Output> roots, size_t num_threads);
+
+  // Lowers the nodes of the region into a new computation.
+  void LowerRegion(size_t region_index, LoweringRegion* region) const;
+
+  // Lowers node again, from its operands tied to trigger by an optimization
+  // barrier. The new lowering replaces the emitted outputs of node.
+  void Rematerialize(const torch::lazy::Node& node,
+                     const torch::lazy::Output& trigger);
+
   // Reports an XLA builder error for the given node.
   TF_ATTRIBUTE_NORETURN void ReportBuilderError(const torch::lazy::Node& node,
                                                 absl::string_view error_msg);
@@ -133,6 +215,10 @@ class LoweringContext : public torch::lazy::LoweringContext {
   std::vector<xla::XlaOp> root_tuple_;
   OutputMap<xla::XlaOp> emitted_outputs_;
   std::string name_;
+  HloMetadataLevel hlo_metadata_level_ = GetHloMetadataLevel();
+  // Time spent populating HLO metadata, reported when the computation is
+  // built.
+  int64_t hlo_metadata_time_ns_ = 0;
 
   std::shared_ptr<StackFrameIndexBuilder> stack_frame_index_builder_;
 };  // namespace torch_xla
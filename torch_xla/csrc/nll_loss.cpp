@@ -1,12 +1,18 @@
 #include "torch_xla/csrc/nll_loss.h"
 
+#include <algorithm>
+
 #include "absl/types/span.h"
 #include "torch_xla/csrc/data_ops.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/status.h"
 #include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/xla_lower_util.h"
 #include "xla/hlo/builder/lib/constants.h"
+#include "xla/hlo/builder/lib/loops.h"
 #include "xla/hlo/builder/lib/math.h"
+#include "xla/util.h"
 
 namespace torch_xla {
 namespace {
@@ -107,6 +113,96 @@ WeightScale GetMaskedWeight(xla::XlaOp weight, const xla::Shape& logits_shape,
   return {result_weight, scale};
 }
 
+// Static sizes of the vocabulary loops. The weight rows are padded to
+// num_blocks * block_size, and the padded classes are masked out.
+struct VocabBlocks {
+  int64_t num_tokens = 0;
+  int64_t hidden_size = 0;
+  int64_t vocab_size = 0;
+  int64_t block_size = 0;
+  int64_t num_blocks = 0;
+  xla::PrimitiveType type = xla::PrimitiveType::PRIMITIVE_TYPE_INVALID;
+  // The type of the logits and their statistics.
+  xla::PrimitiveType accumulation_type =
+      xla::PrimitiveType::PRIMITIVE_TYPE_INVALID;
+};
+
+VocabBlocks GetVocabBlocks(xla::XlaOp hidden, xla::XlaOp weight,
+                           int64_t vocab_block) {
+  const xla::Shape& hidden_shape = ShapeHelper::ShapeOfXlaOp(hidden);
+  const xla::Shape& weight_shape = ShapeHelper::ShapeOfXlaOp(weight);
+  XLA_CHECK_EQ(hidden_shape.dimensions_size(), 2)
+      << "Linear cross entropy expects (tokens, hidden) inputs";
+  XLA_CHECK_EQ(weight_shape.dimensions_size(), 2)
+      << "Linear cross entropy expects a (vocab, hidden) weight";
+  XLA_CHECK_EQ(hidden_shape.dimensions(1), weight_shape.dimensions(1));
+  VocabBlocks blocks;
+  blocks.num_tokens = hidden_shape.dimensions(0);
+  blocks.hidden_size = hidden_shape.dimensions(1);
+  blocks.vocab_size = weight_shape.dimensions(0);
+  LoopBlocks vocab_blocks = GetLoopBlocks(blocks.vocab_size, vocab_block);
+  blocks.block_size = vocab_blocks.block_size;
+  blocks.num_blocks = vocab_blocks.num_blocks;
+  blocks.type = hidden_shape.element_type();
+  blocks.accumulation_type = GetAccumulationType(blocks.type);
+  return blocks;
+}
+
+xla::XlaOp PadVocab(xla::XlaOp weight, const VocabBlocks& blocks) {
+  int64_t padding = blocks.num_blocks * blocks.block_size - blocks.vocab_size;
+  if (padding == 0) {
+    return weight;
+  }
+  return xla::PadInDim(
+      weight, xla::Zero(weight.builder(), XlaHelpers::TypeOfXlaOp(weight)),
+      /*dimno=*/0, /*pad_lo=*/0, /*pad_hi=*/padding);
+}
+
+xla::XlaOp SliceVocabBlock(xla::XlaOp weight, xla::XlaOp start,
+                           int64_t block_size) {
+  std::vector<int64_t> sizes = XlaHelpers::SizesOfXlaOp(weight);
+  sizes[0] = block_size;
+  return xla::DynamicSlice(
+      weight, {start, xla::Zero(weight.builder(), xla::PrimitiveType::S32)},
+      sizes);
+}
+
+struct BlockLogits {
+  xla::XlaOp logits;
+  // Class index of each logit, for matching against the labels.
+  xla::XlaOp classes;
+};
+
+// Returns the logits of the classes in weight_block, which starts at class
+// start, with -inf for the padded classes.
+BlockLogits BuildBlockLogits(xla::XlaOp hidden, xla::XlaOp weight_block,
+                             xla::XlaOp start, const VocabBlocks& blocks) {
+  xla::XlaBuilder* builder = hidden.builder();
+  xla::XlaOp logits =
+      BuildBatchDot(hidden, 1, weight_block, 1, blocks.accumulation_type);
+  std::vector<int64_t> dims = {blocks.num_tokens, blocks.block_size};
+  xla::XlaOp classes =
+      xla::Iota(builder,
+                xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, dims), 1) +
+      start;
+  logits = xla::Select(
+      xla::Lt(classes, xla::ConstantR0<int32_t>(
+                           builder, static_cast<int32_t>(blocks.vocab_size))),
+      logits,
+      xla::Broadcast(xla::MinValue(builder, blocks.accumulation_type), dims));
+  return {logits, classes};
+}
+
+xla::XlaOp NumBlocksOp(xla::XlaBuilder* builder, const VocabBlocks& blocks) {
+  return xla::ConstantR0<int32_t>(builder,
+                                  static_cast<int32_t>(blocks.num_blocks));
+}
+
+xla::XlaOp BlockStart(xla::XlaOp index, const VocabBlocks& blocks) {
+  return index * xla::ConstantR0<int32_t>(
+                     index.builder(), static_cast<int32_t>(blocks.block_size));
+}
+
 }  // namespace
 
 // Builds the NLLLoss for log-probabilities "logits" and class indices "labels".
@@ -190,4 +286,156 @@ xla::XlaOp BuildNllLossBackward(xla::XlaOp grad_output, xla::XlaOp logits,
   return result / weight_scale.scale;
 }
 
+std::vector<xla::XlaOp> BuildLinearCrossEntropy(xla::XlaOp hidden,
+                                                xla::XlaOp weight,
+                                                xla::XlaOp target,
+                                                int ignore_index,
+                                                ReductionMode reduction_mode,
+                                                int64_t vocab_block) {
+  VocabBlocks blocks = GetVocabBlocks(hidden, weight, vocab_block);
+  xla::XlaBuilder* builder = hidden.builder();
+  xla::PrimitiveType type = blocks.accumulation_type;
+  std::vector<int64_t> token_dims = {blocks.num_tokens};
+
+  // Loop values: block index, hidden, weight, labels, then the running max,
+  // running sum of exponentials and the target logit of each token.
+  std::vector<xla::XlaOp> init_values = {
+      xla::Zero(builder, xla::PrimitiveType::S32),
+      hidden,
+      PadVocab(weight, blocks),
+      xla::ConvertElementType(target, xla::PrimitiveType::S32),
+      xla::Broadcast(xla::MinValue(builder, type), token_dims),
+      xla::Broadcast(xla::Zero(builder, type), token_dims),
+      xla::Broadcast(xla::Zero(builder, type), token_dims)};
+  std::vector<xla::XlaOp> results = GetValueOrThrow(xla::WhileLoopHelper(
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        return xla::Lt(values[0], NumBlocksOp(builder, blocks));
+      },
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        xla::XlaOp start = BlockStart(values[0], blocks);
+        BlockLogits block = BuildBlockLogits(
+            values[1], SliceVocabBlock(values[2], start, blocks.block_size),
+            start, blocks);
+        xla::XlaOp zero = xla::Zero(builder, type);
+        xla::XlaComputation add_func = XlaHelpers::CreateAddComputation(type);
+        xla::XlaOp running_max = values[4];
+        xla::XlaOp new_max = xla::Max(
+            running_max,
+            xla::Reduce(block.logits, xla::MinValue(builder, type),
+                        XlaHelpers::CreateMaxComputation(type), {1}));
+        xla::XlaOp new_sum =
+            values[5] * xla::Exp(running_max - new_max) +
+            xla::Reduce(xla::Exp(xla::Sub(block.logits, new_max, {0})), zero,
+                        add_func, {1});
+        xla::XlaOp target_logits = xla::Select(
+            xla::Eq(block.classes, values[3], {0}), block.logits,
+            xla::ZerosLike(block.logits));
+        xla::XlaOp new_target_logit =
+            values[6] + xla::Reduce(target_logits, zero, add_func, {1});
+
+        std::vector<xla::XlaOp> results(values.begin(), values.end());
+        results[0] = values[0] + xla::One(builder, xla::PrimitiveType::S32);
+        results[4] = new_max;
+        results[5] = new_sum;
+        results[6] = new_target_logit;
+        return results;
+      },
+      init_values, "LinearCrossEntropy", builder));
+
+  xla::XlaOp logsumexp = results[4] + xla::Log(results[5]);
+  const xla::Shape& target_shape = ShapeHelper::ShapeOfXlaOp(target);
+  xla::XlaOp valid = xla::Ne(
+      target, XlaHelpers::ScalarValue<int64_t>(
+                  ignore_index, target_shape.element_type(), builder));
+  xla::XlaOp zeros = xla::Broadcast(xla::Zero(builder, type), token_dims);
+  xla::XlaOp losses = xla::Select(valid, logsumexp - results[6], zeros);
+  xla::XlaOp loss = losses;
+  if (reduction_mode != ReductionMode::kNone) {
+    xla::XlaComputation add_func = XlaHelpers::CreateAddComputation(type);
+    loss = xla::ReduceAll(losses, xla::Zero(builder, type), add_func);
+    if (reduction_mode == ReductionMode::kMean) {
+      // As in nll_loss, a target made only of ignore_index gives NaN.
+      loss = loss / xla::ReduceAll(xla::ConvertElementType(valid, type),
+                                   xla::Zero(builder, type), add_func);
+    }
+  }
+  return {xla::ConvertElementType(loss, blocks.type), logsumexp};
+}
+
+std::vector<xla::XlaOp> BuildLinearCrossEntropyBackward(
+    xla::XlaOp grad_output, xla::XlaOp hidden, xla::XlaOp weight,
+    xla::XlaOp target, xla::XlaOp logsumexp, int ignore_index,
+    ReductionMode reduction_mode, int64_t vocab_block) {
+  VocabBlocks blocks = GetVocabBlocks(hidden, weight, vocab_block);
+  xla::XlaBuilder* builder = hidden.builder();
+  xla::PrimitiveType type = blocks.accumulation_type;
+  std::vector<int64_t> token_dims = {blocks.num_tokens};
+
+  // Per token scale of the logits gradient, zero for ignored tokens.
+  const xla::Shape& target_shape = ShapeHelper::ShapeOfXlaOp(target);
+  xla::XlaOp valid = xla::Ne(
+      target, XlaHelpers::ScalarValue<int64_t>(
+                  ignore_index, target_shape.element_type(), builder));
+  xla::XlaOp grad = xla::ConvertElementType(grad_output, type);
+  if (reduction_mode != ReductionMode::kNone) {
+    grad = xla::Broadcast(grad, token_dims);
+  }
+  if (reduction_mode == ReductionMode::kMean) {
+    xla::XlaOp zero = xla::Zero(builder, type);
+    xla::XlaOp count =
+        xla::ReduceAll(xla::ConvertElementType(valid, type), zero,
+                       XlaHelpers::CreateAddComputation(type));
+    grad = grad / xla::Select(xla::Ne(count, zero), count,
+                              xla::One(builder, type));
+  }
+  grad = xla::Select(valid, grad,
+                     xla::Broadcast(xla::Zero(builder, type), token_dims));
+
+  xla::XlaOp padded_weight = PadVocab(weight, blocks);
+  // Loop values: block index, hidden, weight, labels, logsumexp, the per token
+  // gradient scale, then the hidden and weight gradients.
+  std::vector<xla::XlaOp> init_values = {
+      xla::Zero(builder, xla::PrimitiveType::S32),
+      hidden,
+      padded_weight,
+      xla::ConvertElementType(target, xla::PrimitiveType::S32),
+      xla::ConvertElementType(logsumexp, type),
+      grad,
+      xla::Broadcast(xla::Zero(builder, type),
+                     XlaHelpers::SizesOfXlaOp(hidden)),
+      xla::Broadcast(xla::Zero(builder, type),
+                     XlaHelpers::SizesOfXlaOp(padded_weight))};
+  std::vector<xla::XlaOp> results = GetValueOrThrow(xla::WhileLoopHelper(
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        return xla::Lt(values[0], NumBlocksOp(builder, blocks));
+      },
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        xla::XlaOp start = BlockStart(values[0], blocks);
+        xla::XlaOp weight_block =
+            SliceVocabBlock(values[2], start, blocks.block_size);
+        BlockLogits block =
+            BuildBlockLogits(values[1], weight_block, start, blocks);
+        xla::XlaOp probs = xla::Exp(xla::Sub(block.logits, values[4], {0}));
+        xla::XlaOp one_hot = xla::ConvertElementType(
+            xla::Eq(block.classes, values[3], {0}), type);
+        xla::XlaOp grad_logits = xla::ConvertElementType(
+            xla::Mul(probs - one_hot, values[5], {0}), blocks.type);
+
+        std::vector<xla::XlaOp> results(values.begin(), values.end());
+        results[0] = values[0] + xla::One(builder, xla::PrimitiveType::S32);
+        results[6] =
+            values[6] + BuildBatchDot(grad_logits, 1, weight_block, 0, type);
+        results[7] = xla::DynamicUpdateSlice(
+            values[7], BuildBatchDot(grad_logits, 0, values[1], 0, type),
+            {start, xla::Zero(builder, xla::PrimitiveType::S32)});
+        return results;
+      },
+      init_values, "LinearCrossEntropyBackward", builder));
+
+  xla::XlaOp grad_hidden = xla::ConvertElementType(results[6], blocks.type);
+  xla::XlaOp grad_weight = xla::ConvertElementType(
+      xla::SliceInDim(results[7], 0, blocks.vocab_size, 1, 0), blocks.type);
+  return {grad_hidden, grad_weight};
+}
+
 }  // namespace torch_xla
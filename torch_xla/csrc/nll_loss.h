@@ -1,6 +1,8 @@
 #ifndef XLA_TORCH_XLA_CSRC_NLL_LOSS_H_
 #define XLA_TORCH_XLA_CSRC_NLL_LOSS_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "torch_xla/csrc/reduction.h"
 #include "xla/hlo/builder/xla_builder.h"
@@ -18,6 +20,24 @@ xla::XlaOp BuildNllLossBackward(xla::XlaOp grad_output, xla::XlaOp logits,
                                 xla::XlaOp total_weight, int ignore_index,
                                 ReductionMode reduction_mode);
 
+// Builds the cross entropy of the logits "hidden @ weight^T" against the class
+// indices "target" one block of vocab_block classes at a time, carrying a
+// running logsumexp and the target logit, so the (tokens, vocab) logits are
+// never materialized. Returns the loss and the per token logsumexp.
+std::vector<xla::XlaOp> BuildLinearCrossEntropy(xla::XlaOp hidden,
+                                                xla::XlaOp weight,
+                                                xla::XlaOp target,
+                                                int ignore_index,
+                                                ReductionMode reduction_mode,
+                                                int64_t vocab_block);
+
+// Builds the "hidden" and "weight" gradients of BuildLinearCrossEntropy,
+// recomputing each block of logits from the forward logsumexp.
+std::vector<xla::XlaOp> BuildLinearCrossEntropyBackward(
+    xla::XlaOp grad_output, xla::XlaOp hidden, xla::XlaOp weight,
+    xla::XlaOp target, xla::XlaOp logsumexp, int ignore_index,
+    ReductionMode reduction_mode, int64_t vocab_block);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_NLL_LOSS_H_
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "torch_xla/csrc/ops/batched_nms.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& boxes,
+                           int64_t max_output_size) {
+  int64_t batch = GetXlaShape(boxes).dimensions(0);
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32,
+                                 {batch, max_output_size}),
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, {batch})});
+}
+
+}  // namespace
+
+BatchedNms::BatchedNms(const torch::lazy::Value& boxes,
+                       const torch::lazy::Value& scores,
+                       const torch::lazy::Value& classes,
+                       const torch::lazy::Value& valid_counts,
+                       const torch::lazy::Value& iou_threshold,
+                       int64_t max_output_size, int64_t tile_size)
+    : XlaNode(xla_batched_nms,
+              {boxes, scores, classes, valid_counts, iou_threshold},
+              NodeOutputShape(boxes, max_output_size), /*num_outputs=*/2,
+              torch::lazy::MHash(max_output_size, tile_size)),
+      max_output_size_(max_output_size),
+      tile_size_(tile_size) {}
+
+std::string BatchedNms::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", max_output_size=" << max_output_size_
+     << ", tile_size=" << tile_size_;
+  return ss.str();
+}
+
+torch::lazy::NodePtr BatchedNms::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<BatchedNms>(operands.at(0), operands.at(1),
+                                         operands.at(2), operands.at(3),
+                                         operands.at(4), max_output_size_,
+                                         tile_size_);
+}
+
+XlaOpVector BatchedNms::Lower(LoweringContext* loctx) const {
+  xla::XlaOp boxes = loctx->GetOutputOp(operand(0));
+  xla::XlaOp scores = loctx->GetOutputOp(operand(1));
+  xla::XlaOp classes = loctx->GetOutputOp(operand(2));
+  xla::XlaOp valid_counts = loctx->GetOutputOp(operand(3));
+  xla::XlaOp iou_threshold = loctx->GetOutputOp(operand(4));
+  return ReturnOps(BuildBatchedNms(boxes, scores, classes, valid_counts,
+                                   iou_threshold, max_output_size_, tile_size_),
+                   loctx);
+}
+
+}  // namespace torch_xla
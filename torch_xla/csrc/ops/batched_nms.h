@@ -0,0 +1,35 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_BATCHED_NMS_H_
+#define XLA_TORCH_XLA_CSRC_OPS_BATCHED_NMS_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The padded indices of the boxes kept by class-aware NMS of each image of a
+// batch, and the number of kept boxes of each image.
+class BatchedNms : public XlaNode {
+ public:
+  BatchedNms(const torch::lazy::Value& boxes, const torch::lazy::Value& scores,
+             const torch::lazy::Value& classes,
+             const torch::lazy::Value& valid_counts,
+             const torch::lazy::Value& iou_threshold, int64_t max_output_size,
+             int64_t tile_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t max_output_size() const { return max_output_size_; }
+
+  int64_t tile_size() const { return tile_size_; }
+
+ private:
+  int64_t max_output_size_;
+  int64_t tile_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_BATCHED_NMS_H_
@@ -15,7 +15,7 @@ CustomCall::CustomCall(
     const std::unordered_map<std::string, std::string>& frontend_attributes)
     : XlaNode(xla_custom_call, inputs, output_shape,
               /*num_outputs=*/output_shape.tuple_shapes_size(),
-              torch::lazy::MHash(call_target)),
+              torch::lazy::MHash(call_target, backend_config, api_version)),
       call_target_(call_target),
       has_side_effect_(has_side_effect),
       backend_config_(backend_config),
@@ -31,9 +31,9 @@ CustomCall::CustomCall(torch::lazy::OpList inputs,
                  std::unordered_map<std::string, std::string>()) {}
 
 torch::lazy::NodePtr CustomCall::Clone(torch::lazy::OpList operands) const {
-  return torch_xla::MakeNode<CustomCall>(operands, call_target_,
-                                         this->xla_shape(), has_side_effect_,
-                                         backend_config_, api_version_);
+  return torch_xla::MakeNode<CustomCall>(
+      operands, call_target_, this->xla_shape(), has_side_effect_,
+      backend_config_, api_version_, frontend_attributes_);
 }
 
 XlaOpVector CustomCall::Lower(LoweringContext* loctx) const {
@@ -6,9 +6,7 @@
 #include "torch_xla/csrc/ops/xla_ops.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/xla_lower_util.h"
-#include "tsl/platform/stacktrace.h"
 #include "xla/hlo/builder/lib/constants.h"
-#include "xla/hlo/builder/lib/loops.h"
 #include "xla/hlo/builder/lib/slicing.h"
 #include "xla/shape_util.h"
 
@@ -17,16 +15,21 @@ namespace {
 const int MODE_SUM = 0;
 const int MODE_MEAN = 1;
 const int MODE_MAX = 2;
+
+// Lowers embedding_bag as a gather of the looked up rows followed by segment
+// reductions, so that the size of the computation does not depend on the
+// number of bags. Returns the output, offset2bag, bag_size and max_indices.
 std::vector<xla::XlaOp> BuildEmbeddingBag(xla::XlaOp weight, xla::XlaOp indices,
                                           xla::XlaOp offsets,
                                           xla::XlaOp per_sample_weights,
-                                          bool include_last_offset, int mode) {
+                                          bool include_last_offset, int mode,
+                                          int64_t padding_idx) {
+  xla::XlaBuilder* builder = weight.builder();
   xla::Shape offset_shape = ShapeHelper::ShapeOfXlaOp(offsets);
   int64_t n = offset_shape.dimensions(0);
   xla::Shape weight_shape = ShapeHelper::ShapeOfXlaOp(weight);
   int64_t weight_dim = weight_shape.dimensions(1);
   xla::Shape indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
-  int64_t num_embeddings = indices_shape.dimensions(0);
   XLA_CHECK(indices_shape.dimensions_size() == 1 ||
             indices_shape.dimensions_size() == 2)
       << "input has to be a 1D or 2D Tensor, but got Tensor of dimension "
@@ -39,106 +42,115 @@ std::vector<xla::XlaOp> BuildEmbeddingBag(xla::XlaOp weight, xla::XlaOp indices,
   XLA_CHECK(weight_shape.dimensions_size() == 2)
       << "weight has to be a 2D Tensor, but got Tensor of dimension "
       << weight_shape.dimensions_size();
-
-  xla::XlaOp output2 = xla::ZerosLike(indices);
-  xla::XlaOp output3 = xla::ZerosLike(offsets);
-  std::vector<int64_t> sizes = {n, weight_dim};
-  xla::XlaOp output4 =
-      xla::Zeros(offsets.builder(),
-                 xla::ShapeUtil::MakeShape(offset_shape.element_type(), sizes));
-
-  xla::XlaOp embeddings = xla::TorchIndexSelect(weight, indices, 0);
-  xla::XlaOp embeddings_weighted = xla::Mul(
-      embeddings, xla::ConvertElementType(
-                      xla::BroadcastInDim(per_sample_weights,
-                                          {num_embeddings, weight_dim}, {0}),
-                      weight_shape.element_type()));
-
-  std::vector<xla::Shape> shape_elements = {
-      xla::ShapeUtil::MakeShape(offset_shape.element_type(), {}),
-      xla::ShapeUtil::MakeShape(offset_shape.element_type(), {}),
-      xla::ShapeUtil::MakeShape(weight_shape.element_type(),
-                                {num_embeddings, weight_dim}),
-      xla::ShapeUtil::MakeShape(weight_shape.element_type(), {1, weight_dim})};
-  xla::Shape result_shape = xla::ShapeUtil::MakeTupleShape(shape_elements);
-
-  xla::XlaComputation condition;
-  {
-    xla::XlaBuilder builder("condition");
-    auto prev = xla::Parameter(&builder, 0, result_shape, "prev");
-    auto index = xla::GetTupleElement(prev, 0);
-    auto final_value = xla::GetTupleElement(prev, 1);
-    xla::Lt(index, final_value);
-    condition = builder.Build().value();
+  XLA_CHECK(!include_last_offset || n > 0)
+      << "include_last_offset requires at least one offset";
+
+  int64_t num_indices = xla::ShapeUtil::ElementsIn(indices_shape);
+  int64_t num_bags = include_last_offset ? n - 1 : n;
+  indices = xla::Reshape(indices, {num_indices});
+  xla::PrimitiveType offset_type = offset_shape.element_type();
+  xla::PrimitiveType weight_type = weight_shape.element_type();
+
+  xla::XlaOp offset2bag =
+      BuildEmbeddingBagSegmentIds(offsets, num_bags, num_indices);
+  // Padding entries don't contribute to any bag.
+  xla::XlaOp segment_ids = offset2bag;
+  if (padding_idx >= 0) {
+    segment_ids = xla::Select(
+        xla::Eq(indices,
+                XlaHelpers::ScalarValue<int64_t>(
+                    padding_idx, indices_shape.element_type(), builder)),
+        XlaHelpers::ScalarBroadcast<int64_t>(num_bags, offset_type,
+                                             {num_indices}, builder),
+        segment_ids);
   }
+  xla::XlaOp bag_size = BuildSegmentReduction(
+      XlaHelpers::ScalarBroadcast<int64_t>(1, offset_type, {num_indices},
+                                           builder),
+      segment_ids, num_bags, XlaHelpers::CreateAddComputation(offset_type),
+      xla::Zero(builder, offset_type));
+  xla::XlaOp non_empty =
+      xla::BroadcastInDim(xla::Gt(bag_size, xla::Zero(builder, offset_type)),
+                          {num_bags, weight_dim}, {0});
 
-  xla::XlaComputation body;
-  {
-    xla::XlaBuilder builder("body");
-    auto prev = xla::Parameter(&builder, 0, result_shape, "prev");
-    auto index = xla::GetTupleElement(prev, 0);
-    auto emb = xla::GetTupleElement(prev, 2);
-    auto w = xla::GetTupleElement(prev, 3);
-
-    xla::XlaOp slice = xla::DynamicSlice(
-        emb,
-        {index, xla::ConvertElementType(xla::ConstantR0<int64_t>(&builder, 0),
-                                        offset_shape.element_type())},
-        {1, weight_dim});
-    xla::XlaOp result =
-        mode == MODE_SUM ? xla::Add(w, slice) : xla::Max(w, slice);
-
-    xla::Tuple(&builder,
-               {
-                   xla::Add(index, xla::ConvertElementType(
-                                       xla::ConstantR0<int64_t>(&builder, 1),
-                                       offset_shape.element_type())),
-                   xla::GetTupleElement(prev, 1),
-                   xla::GetTupleElement(prev, 2),
-                   result,
-               });
-    body = builder.Build().value();
+  xla::XlaOp embeddings = xla::TorchIndexSelect(weight, indices, 0);
+  xla::XlaOp output;
+  xla::XlaOp max_indices;
+  if (mode == MODE_MAX) {
+    XlaHelpers::MinMax min_max = XlaHelpers::MinMaxValues(weight_type);
+    xla::XlaOp maxes = BuildSegmentReduction(
+        embeddings, segment_ids, num_bags,
+        XlaHelpers::CreateMaxComputation(weight_type),
+        XlaHelpers::ScalarValue(min_max.min, weight_type, builder));
+    output = xla::Select(non_empty, maxes, xla::ZerosLike(maxes));
+    max_indices = xla::Zeros(builder, xla::ShapeUtil::MakeShape(
+                                          offset_type, {num_bags, weight_dim}));
+    if (num_bags > 0) {
+      // The index of the maximum of each bag and feature is the smallest
+      // embedding index among the entries holding it.
+      xla::XlaOp in_bag = xla::Lt(
+          segment_ids,
+          XlaHelpers::ScalarValue<int64_t>(num_bags, offset_type, builder));
+      xla::XlaOp bag_maxes = xla::TorchIndexSelect(
+          maxes,
+          xla::Min(segment_ids, XlaHelpers::ScalarValue<int64_t>(
+                                    num_bags - 1, offset_type, builder)),
+          0);
+      xla::XlaOp is_max = xla::And(
+          xla::BroadcastInDim(in_bag, {num_indices, weight_dim}, {0}),
+          xla::Eq(embeddings, bag_maxes));
+      XlaHelpers::MinMax index_min_max = XlaHelpers::MinMaxValues(offset_type);
+      xla::XlaOp no_index =
+          XlaHelpers::ScalarValue(index_min_max.max, offset_type, builder);
+      xla::XlaOp candidates = xla::Select(
+          is_max,
+          xla::BroadcastInDim(xla::ConvertElementType(indices, offset_type),
+                              {num_indices, weight_dim}, {0}),
+          xla::Broadcast(no_index, {num_indices, weight_dim}));
+      max_indices = xla::Select(
+          non_empty,
+          BuildSegmentReduction(candidates, segment_ids, num_bags,
+                                XlaHelpers::CreateMinComputation(offset_type),
+                                no_index),
+          max_indices);
+    }
+  } else {
+    if (mode == MODE_SUM) {
+      embeddings = xla::Mul(
+          embeddings,
+          xla::ConvertElementType(
+              xla::BroadcastInDim(per_sample_weights,
+                                  {num_indices, weight_dim}, {0}),
+              weight_type));
+    }
+    output = BuildSegmentReduction(
+        embeddings, segment_ids, num_bags,
+        XlaHelpers::CreateAddComputation(weight_type),
+        xla::Zero(builder, weight_type));
+    if (mode == MODE_MEAN) {
+      xla::XlaOp divisor = xla::ConvertElementType(
+          xla::Max(bag_size, xla::One(builder, offset_type)), weight_type);
+      output = xla::Div(output, divisor, {0});
+    }
+    max_indices = xla::ZerosLike(bag_size);
   }
-
-  xla::Array<float> initial_vector({1, weight_dim}, 0.f);
-  std::vector<xla::XlaOp> results;
-  for (int64_t i = 0; i < n; i++) {
-    xla::XlaOp start = xla::DynamicSlice(
-        offsets, {xla::ConstantR0<int64_t>(offsets.builder(), i)}, {1});
-    if (i == n - 1 && include_last_offset) continue;
-    xla::XlaOp end =
-        i == n - 1 && !include_last_offset
-            ? xla::ConvertElementType(xla::ConstantR1<int64_t>(
-                                          offsets.builder(), 1, num_embeddings),
-                                      offset_shape.element_type())
-            : xla::DynamicSlice(
-                  offsets, {xla::ConstantR0<int64_t>(offsets.builder(), i + 1)},
-                  {1});
-    // Create a While node with computations for the condition and the body.
-    auto init_tuple = xla::Tuple(
-        offsets.builder(),
-        {xla::Reshape(start, {}), xla::Reshape(end, {}), embeddings_weighted,
-         xla::ConvertElementType(
-             xla::ConstantFromArray<float>(offsets.builder(), initial_vector),
-             weight_shape.element_type())});
-    auto result = xla::While(condition, body, init_tuple);
-    results.push_back(xla::GetTupleElement(result, 3));
-  };
-  xla::XlaOp output1 = xla::ConcatInDim(offsets.builder(), results, 0);
-  return {output1, output2, output3, output4};
+  return {output,
+          xla::ConvertElementType(offset2bag, indices_shape.element_type()),
+          bag_size, max_indices};
 }
 
 xla::Shape NodeOutputShapes(const torch::lazy::Value& weight,
                             const torch::lazy::Value& indices,
                             const torch::lazy::Value& offsets,
                             const torch::lazy::Value& per_sample_weights,
-                            bool include_last_offset, bool mode) {
+                            bool include_last_offset, int64_t mode,
+                            int64_t padding_idx) {
   auto lower_for_shapes_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return xla::Tuple(
         operands[0].builder(),
         BuildEmbeddingBag(operands[0], operands[1], operands[2], operands[3],
-                          include_last_offset, mode));
+                          include_last_offset, mode, padding_idx));
   };
 
   std::vector<xla::Shape> input_shapes = {
@@ -151,7 +163,9 @@ xla::Shape NodeOutputShapes(const torch::lazy::Value& weight,
 
 std::string EmbeddingBag::ToString() const {
   std::stringstream ss;
-  ss << XlaNode::ToString();
+  ss << XlaNode::ToString() << ", mode=" << mode_
+     << ", include_last_offset=" << include_last_offset_
+     << ", padding_idx=" << padding_idx_;
   return ss.str();
 }
 
@@ -159,23 +173,25 @@ EmbeddingBag::EmbeddingBag(const torch::lazy::Value& weight,
                            const torch::lazy::Value& indices,
                            const torch::lazy::Value& offsets, int64_t mode,
                            const torch::lazy::Value& per_sample_weights,
-                           bool include_last_offset)
+                           bool include_last_offset, int64_t padding_idx)
     : XlaNode(
           torch::lazy::OpKind(at::aten::embedding_bag),
           {weight, indices, offsets, per_sample_weights},
           [&]() {
             return NodeOutputShapes(weight, indices, offsets,
                                     per_sample_weights, include_last_offset,
-                                    mode);
+                                    mode, padding_idx);
           },
-          /*num_outputs=*/4, torch::lazy::MHash(mode, include_last_offset)),
+          /*num_outputs=*/4,
+          torch::lazy::MHash(mode, include_last_offset, padding_idx)),
       mode_(mode),
-      include_last_offset_(include_last_offset) {}
+      include_last_offset_(include_last_offset),
+      padding_idx_(padding_idx) {}
 
 torch::lazy::NodePtr EmbeddingBag::Clone(torch::lazy::OpList operands) const {
-  return torch_xla::MakeNode<EmbeddingBag>(operands.at(0), operands.at(1),
-                                           operands.at(2), mode_,
-                                           operands.at(3), false);
+  return torch_xla::MakeNode<EmbeddingBag>(
+      operands.at(0), operands.at(1), operands.at(2), mode_, operands.at(3),
+      include_last_offset_, padding_idx_);
 }
 
 XlaOpVector EmbeddingBag::Lower(LoweringContext* loctx) const {
@@ -185,7 +201,7 @@ XlaOpVector EmbeddingBag::Lower(LoweringContext* loctx) const {
   xla::XlaOp per_sample_weights = loctx->GetOutputOp(operand(3));
   std::vector<xla::XlaOp> ops =
       BuildEmbeddingBag(weight, indices, offsets, per_sample_weights,
-                        include_last_offset_, mode_);
+                        include_last_offset_, mode_, padding_idx_);
   return ReturnOps(absl::MakeSpan(ops), loctx);
 }
 
@@ -13,7 +13,7 @@ class EmbeddingBag : public XlaNode {
                const torch::lazy::Value& indices,
                const torch::lazy::Value& offsets, int64_t mode,
                const torch::lazy::Value& per_sample_weights,
-               bool include_last_offset);
+               bool include_last_offset, int64_t padding_idx);
 
   std::string ToString() const override;
 
@@ -24,6 +24,7 @@ class EmbeddingBag : public XlaNode {
  private:
   int64_t mode_;
   bool include_last_offset_;
+  int64_t padding_idx_;
 };
 
 }  // namespace torch_xla
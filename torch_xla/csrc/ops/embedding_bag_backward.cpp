@@ -0,0 +1,195 @@
+#include "torch_xla/csrc/ops/embedding_bag_backward.h"
+
+#include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/infer_output_shape.h"
+#include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/hlo/builder/lib/constants.h"
+#include "xla/hlo/builder/lib/slicing.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+const int MODE_MEAN = 1;
+const int MODE_MAX = 2;
+
+xla::XlaOp BuildEmbeddingBagBackward(xla::XlaOp grad, xla::XlaOp indices,
+                                     xla::XlaOp offsets, xla::XlaOp max_indices,
+                                     xla::XlaOp per_sample_weights,
+                                     int64_t num_weights, int mode,
+                                     int64_t padding_idx) {
+  xla::XlaBuilder* builder = grad.builder();
+  const xla::Shape& grad_shape = ShapeHelper::ShapeOfXlaOp(grad);
+  XLA_CHECK_EQ(grad_shape.dimensions_size(), 2) << grad_shape;
+  int64_t num_bags = grad_shape.dimensions(0);
+  int64_t weight_dim = grad_shape.dimensions(1);
+  const xla::Shape& indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
+  int64_t num_indices = xla::ShapeUtil::ElementsIn(indices_shape);
+  indices = xla::Reshape(indices, {num_indices});
+  xla::PrimitiveType offset_type = XlaHelpers::TypeOfXlaOp(offsets);
+  xla::PrimitiveType grad_type = grad_shape.element_type();
+  xla::XlaOp zero_grad = xla::Zeros(
+      builder, xla::ShapeUtil::MakeShape(grad_type, {num_weights, weight_dim}));
+  if (num_bags == 0) {
+    return zero_grad;
+  }
+
+  xla::XlaOp segment_ids =
+      BuildEmbeddingBagSegmentIds(offsets, num_bags, num_indices);
+  if (padding_idx >= 0) {
+    segment_ids = xla::Select(
+        xla::Eq(indices,
+                XlaHelpers::ScalarValue<int64_t>(
+                    padding_idx, indices_shape.element_type(), builder)),
+        XlaHelpers::ScalarBroadcast<int64_t>(num_bags, offset_type,
+                                             {num_indices}, builder),
+        segment_ids);
+  }
+  xla::XlaOp bag_size = BuildSegmentReduction(
+      XlaHelpers::ScalarBroadcast<int64_t>(1, offset_type, {num_indices},
+                                           builder),
+      segment_ids, num_bags, XlaHelpers::CreateAddComputation(offset_type),
+      xla::Zero(builder, offset_type));
+
+  if (mode == MODE_MAX) {
+    // Each bag and feature routes its gradient to the row holding the maximum.
+    // Empty bags have no maximum, and are sent out of range to be dropped.
+    xla::XlaOp non_empty =
+        xla::BroadcastInDim(xla::Gt(bag_size, xla::Zero(builder, offset_type)),
+                            {num_bags, weight_dim}, {0});
+    xla::XlaOp rows = xla::Select(
+        non_empty, xla::ConvertElementType(max_indices, offset_type),
+        XlaHelpers::ScalarBroadcast<int64_t>(
+            num_weights, offset_type, {num_bags, weight_dim}, builder));
+    xla::XlaOp columns = xla::Iota(
+        builder, xla::ShapeUtil::MakeShape(offset_type, {num_bags, weight_dim}),
+        1);
+    xla::XlaOp scatter_indices =
+        xla::ConcatInDim(builder,
+                         {xla::Reshape(rows, {num_bags, weight_dim, 1}),
+                          xla::Reshape(columns, {num_bags, weight_dim, 1})},
+                         2);
+    xla::ScatterDimensionNumbers dim_numbers;
+    dim_numbers.set_index_vector_dim(2);
+    for (int64_t dim = 0; dim < 2; ++dim) {
+      dim_numbers.add_inserted_window_dims(dim);
+      dim_numbers.add_scatter_dims_to_operand_dims(dim);
+    }
+    return xla::Scatter(zero_grad, scatter_indices, grad,
+                        XlaHelpers::CreateAddComputation(grad_type),
+                        dim_numbers);
+  }
+
+  if (mode == MODE_MEAN) {
+    xla::XlaOp divisor = xla::ConvertElementType(
+        xla::Max(bag_size, xla::One(builder, offset_type)), grad_type);
+    grad = xla::Div(grad, divisor, {0});
+  }
+  // Gradient of every looked up row, which is then accumulated into the rows
+  // of the weight. Entries out of any bag are dropped.
+  xla::XlaOp entry_grads = xla::TorchIndexSelect(
+      grad,
+      xla::Min(segment_ids, XlaHelpers::ScalarValue<int64_t>(
+                                num_bags - 1, offset_type, builder)),
+      0);
+  if (per_sample_weights.valid()) {
+    entry_grads = xla::Mul(
+        entry_grads,
+        xla::ConvertElementType(
+            xla::BroadcastInDim(per_sample_weights, {num_indices, weight_dim},
+                                {0}),
+            grad_type));
+  }
+  xla::XlaOp rows = xla::Select(
+      xla::Lt(segment_ids,
+              XlaHelpers::ScalarValue<int64_t>(num_bags, offset_type, builder)),
+      xla::ConvertElementType(indices, offset_type),
+      XlaHelpers::ScalarBroadcast<int64_t>(num_weights, offset_type,
+                                           {num_indices}, builder));
+  return BuildSegmentReduction(entry_grads, rows, num_weights,
+                               XlaHelpers::CreateAddComputation(grad_type),
+                               xla::Zero(builder, grad_type));
+}
+
+xla::Shape NodeOutputShape(
+    const torch::lazy::Value& grad, const torch::lazy::Value& indices,
+    const torch::lazy::Value& offsets, const torch::lazy::Value& max_indices,
+    const absl::optional<torch::lazy::Value>& per_sample_weights,
+    int64_t num_weights, int64_t mode, int64_t padding_idx) {
+  auto lower_for_shape_fn =
+      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    xla::XlaOp per_sample_weights_op;
+    if (operands.size() > 4) {
+      per_sample_weights_op = operands[4];
+    }
+    return BuildEmbeddingBagBackward(operands[0], operands[1], operands[2],
+                                     operands[3], per_sample_weights_op,
+                                     num_weights, mode, padding_idx);
+  };
+  std::vector<xla::Shape> shapes;
+  for (auto& input :
+       torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+           {grad, indices, offsets, max_indices}, {&per_sample_weights})) {
+    shapes.push_back(GetXlaShape(input));
+  }
+  return InferOutputShape(shapes, lower_for_shape_fn);
+}
+
+}  // namespace
+
+EmbeddingBagBackward::EmbeddingBagBackward(
+    const torch::lazy::Value& grad, const torch::lazy::Value& indices,
+    const torch::lazy::Value& offsets, const torch::lazy::Value& max_indices,
+    const absl::optional<torch::lazy::Value>& per_sample_weights,
+    int64_t num_weights, int64_t mode, int64_t padding_idx)
+    : XlaNode(
+          torch::lazy::OpKind(at::aten::_embedding_bag_backward),
+          torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+              {grad, indices, offsets, max_indices}, {&per_sample_weights}),
+          [&]() {
+            return NodeOutputShape(grad, indices, offsets, max_indices,
+                                   per_sample_weights, num_weights, mode,
+                                   padding_idx);
+          },
+          /*num_outputs=*/1,
+          torch::lazy::MHash(num_weights, mode, padding_idx)),
+      num_weights_(num_weights),
+      mode_(mode),
+      padding_idx_(padding_idx) {}
+
+torch::lazy::NodePtr EmbeddingBagBackward::Clone(
+    torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> per_sample_weights;
+  if (operands.size() > 4) {
+    per_sample_weights = operands.at(4);
+  }
+  return torch_xla::MakeNode<EmbeddingBagBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      per_sample_weights, num_weights_, mode_, padding_idx_);
+}
+
+XlaOpVector EmbeddingBagBackward::Lower(LoweringContext* loctx) const {
+  xla::XlaOp grad = loctx->GetOutputOp(operand(0));
+  xla::XlaOp indices = loctx->GetOutputOp(operand(1));
+  xla::XlaOp offsets = loctx->GetOutputOp(operand(2));
+  xla::XlaOp max_indices = loctx->GetOutputOp(operand(3));
+  xla::XlaOp per_sample_weights;
+  if (operands().size() > 4) {
+    per_sample_weights = loctx->GetOutputOp(operand(4));
+  }
+  return ReturnOp(BuildEmbeddingBagBackward(grad, indices, offsets, max_indices,
+                                            per_sample_weights, num_weights_,
+                                            mode_, padding_idx_),
+                  loctx);
+}
+
+std::string EmbeddingBagBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", num_weights=" << num_weights_
+     << ", mode=" << mode_ << ", padding_idx=" << padding_idx_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
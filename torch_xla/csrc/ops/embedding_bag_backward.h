@@ -0,0 +1,32 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_EMBEDDING_BAG_BACKWARD_H_
+#define XLA_TORCH_XLA_CSRC_OPS_EMBEDDING_BAG_BACKWARD_H_
+
+#include "absl/types/optional.h"
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Dense gradient of embedding_bag with respect to the weight.
+class EmbeddingBagBackward : public XlaNode {
+ public:
+  EmbeddingBagBackward(
+      const torch::lazy::Value& grad, const torch::lazy::Value& indices,
+      const torch::lazy::Value& offsets, const torch::lazy::Value& max_indices,
+      const absl::optional<torch::lazy::Value>& per_sample_weights,
+      int64_t num_weights, int64_t mode, int64_t padding_idx);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+ private:
+  int64_t num_weights_;
+  int64_t mode_;
+  int64_t padding_idx_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_EMBEDDING_BAG_BACKWARD_H_
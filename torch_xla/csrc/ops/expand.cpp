@@ -10,11 +10,15 @@ namespace {
 
 xla::Shape NodeOutputShape(const torch::lazy::Value& input,
                            const std::vector<int64_t>& size) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return InferExpandShape(input_shape, size);
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildExpand(operands[0], size);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
 }
 
 }  // namespace
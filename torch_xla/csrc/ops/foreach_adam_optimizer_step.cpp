@@ -0,0 +1,117 @@
+#include "torch_xla/csrc/ops/foreach_adam_optimizer_step.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// Number of scalar operands ahead of the per param lists.
+constexpr size_t kNumScalarOperands = 6;
+
+xla::Shape NodeOutputShape(torch::lazy::OpList steps,
+                           torch::lazy::OpList params, bool use_amsgrad) {
+  std::vector<xla::Shape> output_shapes;
+  for (size_t i = 0; i < params.size(); ++i) {
+    const xla::Shape& param_shape = GetXlaShape(params[i]);
+    output_shapes.push_back(GetXlaShape(steps[i]));
+    output_shapes.push_back(param_shape);
+    output_shapes.push_back(param_shape);
+    output_shapes.push_back(param_shape);
+    if (use_amsgrad) {
+      output_shapes.push_back(param_shape);
+    }
+  }
+  return xla::ShapeUtil::MakeTupleShape(output_shapes);
+}
+
+std::vector<torch::lazy::Value> GetOperandList(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& beta1,
+    const torch::lazy::Value& beta2, const torch::lazy::Value& lr,
+    const torch::lazy::Value& weight_decay, const torch::lazy::Value& eps,
+    absl::Span<const torch::lazy::OpList> lists) {
+  std::vector<torch::lazy::Value> operand_list = {
+      found_inf, beta1, beta2, lr, weight_decay, eps};
+  for (torch::lazy::OpList list : lists) {
+    operand_list.insert(operand_list.end(), list.begin(), list.end());
+  }
+  return operand_list;
+}
+
+}  // namespace
+
+ForeachAdamOptimizerStep::ForeachAdamOptimizerStep(
+    const torch::lazy::Value& found_inf, torch::lazy::OpList steps,
+    torch::lazy::OpList params, torch::lazy::OpList grads,
+    torch::lazy::OpList exp_avgs, torch::lazy::OpList exp_avg_sqs,
+    torch::lazy::OpList max_exp_avg_sqs, const torch::lazy::Value& beta1,
+    const torch::lazy::Value& beta2, const torch::lazy::Value& lr,
+    const torch::lazy::Value& weight_decay, const torch::lazy::Value& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw, bool maximize,
+    bool pack)
+    : XlaNode(xla_foreach_adam_optimizer_step,
+              GetOperandList(found_inf, beta1, beta2, lr, weight_decay, eps,
+                             {steps, params, grads, exp_avgs, exp_avg_sqs,
+                              max_exp_avg_sqs}),
+              NodeOutputShape(steps, params, use_amsgrad),
+              /*num_outputs=*/params.size() * (use_amsgrad ? 5 : 4),
+              torch::lazy::MHash(params.size(), use_weight_decay, use_amsgrad,
+                                 use_adamw, maximize, pack)),
+      num_params_(params.size()),
+      use_weight_decay_(use_weight_decay),
+      use_amsgrad_(use_amsgrad),
+      use_adamw_(use_adamw),
+      maximize_(maximize),
+      pack_(pack) {
+  XLA_CHECK_EQ(max_exp_avg_sqs.size(), use_amsgrad ? num_params_ : 0);
+}
+
+torch::lazy::NodePtr ForeachAdamOptimizerStep::Clone(
+    torch::lazy::OpList operands) const {
+  auto list = [&](size_t index) {
+    return operands.slice(kNumScalarOperands + index * num_params_,
+                          num_params_);
+  };
+  return torch_xla::MakeNode<ForeachAdamOptimizerStep>(
+      operands.at(0), list(0), list(1), list(2), list(3), list(4),
+      use_amsgrad_ ? list(5) : torch::lazy::OpList(), operands.at(1),
+      operands.at(2), operands.at(3), operands.at(4), operands.at(5),
+      use_weight_decay_, use_amsgrad_, use_adamw_, maximize_, pack_);
+}
+
+XlaOpVector ForeachAdamOptimizerStep::Lower(LoweringContext* loctx) const {
+  auto list = [&](size_t index) {
+    std::vector<xla::XlaOp> ops;
+    ops.reserve(num_params_);
+    for (size_t i = 0; i < num_params_; ++i) {
+      ops.push_back(loctx->GetOutputOp(
+          operand(kNumScalarOperands + index * num_params_ + i)));
+    }
+    return ops;
+  };
+  std::vector<xla::XlaOp> max_exp_avg_sqs;
+  if (use_amsgrad_) {
+    max_exp_avg_sqs = list(5);
+  }
+  return ReturnOps(
+      BuildForeachAdamOptimizerStep(
+          loctx->GetOutputOp(operand(0)), list(0), list(1), list(2), list(3),
+          list(4), max_exp_avg_sqs, loctx->GetOutputOp(operand(1)),
+          loctx->GetOutputOp(operand(2)), loctx->GetOutputOp(operand(3)),
+          loctx->GetOutputOp(operand(4)), loctx->GetOutputOp(operand(5)),
+          use_weight_decay_, use_amsgrad_, use_adamw_, maximize_, pack_),
+      loctx);
+}
+
+std::string ForeachAdamOptimizerStep::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", num_params=" << num_params_
+     << ", use_weight_decay=" << use_weight_decay_
+     << ", use_amsgrad=" << use_amsgrad_ << ", use_adamw=" << use_adamw_
+     << ", maximize=" << maximize_ << ", pack=" << pack_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
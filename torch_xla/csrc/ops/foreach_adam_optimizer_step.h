@@ -0,0 +1,41 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FOREACH_ADAM_OPTIMIZER_STEP_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FOREACH_ADAM_OPTIMIZER_STEP_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Adam/AdamW step over a list of params, sharing the scalar inputs. The
+// outputs are the step, param, exp_avg, exp_avg_sq and, with amsgrad,
+// max_exp_avg_sq of each param in turn. max_exp_avg_sqs must be empty unless
+// use_amsgrad is set.
+class ForeachAdamOptimizerStep : public XlaNode {
+ public:
+  ForeachAdamOptimizerStep(
+      const torch::lazy::Value& found_inf, torch::lazy::OpList steps,
+      torch::lazy::OpList params, torch::lazy::OpList grads,
+      torch::lazy::OpList exp_avgs, torch::lazy::OpList exp_avg_sqs,
+      torch::lazy::OpList max_exp_avg_sqs, const torch::lazy::Value& beta1,
+      const torch::lazy::Value& beta2, const torch::lazy::Value& lr,
+      const torch::lazy::Value& weight_decay, const torch::lazy::Value& eps,
+      bool use_weight_decay, bool use_amsgrad, bool use_adamw, bool maximize,
+      bool pack);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  std::string ToString() const override;
+
+ private:
+  size_t num_params_;
+  bool use_weight_decay_;
+  bool use_amsgrad_;
+  bool use_adamw_;
+  bool maximize_;
+  bool pack_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FOREACH_ADAM_OPTIMIZER_STEP_H_
@@ -0,0 +1,102 @@
+#include "torch_xla/csrc/ops/foreach_sgd_optimizer_step.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// Number of scalar operands ahead of the per param lists.
+constexpr size_t kNumScalarOperands = 5;
+
+xla::Shape NodeOutputShape(torch::lazy::OpList steps,
+                           torch::lazy::OpList params) {
+  std::vector<xla::Shape> output_shapes;
+  output_shapes.reserve(params.size() * 3);
+  for (size_t i = 0; i < params.size(); ++i) {
+    const xla::Shape& param_shape = GetXlaShape(params[i]);
+    output_shapes.push_back(GetXlaShape(steps[i]));
+    output_shapes.push_back(param_shape);
+    output_shapes.push_back(param_shape);
+  }
+  return xla::ShapeUtil::MakeTupleShape(output_shapes);
+}
+
+std::vector<torch::lazy::Value> GetOperandList(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& weight_decay,
+    const torch::lazy::Value& momentum, const torch::lazy::Value& lr,
+    const torch::lazy::Value& dampening,
+    absl::Span<const torch::lazy::OpList> lists) {
+  std::vector<torch::lazy::Value> operand_list = {found_inf, weight_decay,
+                                                  momentum, lr, dampening};
+  for (torch::lazy::OpList list : lists) {
+    operand_list.insert(operand_list.end(), list.begin(), list.end());
+  }
+  return operand_list;
+}
+
+}  // namespace
+
+ForeachSgdOptimizerStep::ForeachSgdOptimizerStep(
+    const torch::lazy::Value& found_inf, torch::lazy::OpList steps,
+    torch::lazy::OpList params, torch::lazy::OpList bufs,
+    torch::lazy::OpList d_ps, const torch::lazy::Value& weight_decay,
+    const torch::lazy::Value& momentum, const torch::lazy::Value& lr,
+    const torch::lazy::Value& dampening, bool use_weight_decay,
+    bool use_momentum, bool use_nesterov, bool pack)
+    : XlaNode(xla_foreach_sgd_optimizer_step,
+              GetOperandList(found_inf, weight_decay, momentum, lr, dampening,
+                             {steps, params, bufs, d_ps}),
+              NodeOutputShape(steps, params),
+              /*num_outputs=*/params.size() * 3,
+              torch::lazy::MHash(params.size(), use_weight_decay, use_momentum,
+                                 use_nesterov, pack)),
+      num_params_(params.size()),
+      use_weight_decay_(use_weight_decay),
+      use_momentum_(use_momentum),
+      use_nesterov_(use_nesterov),
+      pack_(pack) {}
+
+torch::lazy::NodePtr ForeachSgdOptimizerStep::Clone(
+    torch::lazy::OpList operands) const {
+  auto list = [&](size_t index) {
+    return operands.slice(kNumScalarOperands + index * num_params_,
+                          num_params_);
+  };
+  return torch_xla::MakeNode<ForeachSgdOptimizerStep>(
+      operands.at(0), list(0), list(1), list(2), list(3), operands.at(1),
+      operands.at(2), operands.at(3), operands.at(4), use_weight_decay_,
+      use_momentum_, use_nesterov_, pack_);
+}
+
+XlaOpVector ForeachSgdOptimizerStep::Lower(LoweringContext* loctx) const {
+  auto list = [&](size_t index) {
+    std::vector<xla::XlaOp> ops;
+    ops.reserve(num_params_);
+    for (size_t i = 0; i < num_params_; ++i) {
+      ops.push_back(loctx->GetOutputOp(
+          operand(kNumScalarOperands + index * num_params_ + i)));
+    }
+    return ops;
+  };
+  return ReturnOps(
+      BuildForeachSgdOptimizerStep(
+          loctx->GetOutputOp(operand(0)), list(0), list(1), list(2), list(3),
+          loctx->GetOutputOp(operand(1)), loctx->GetOutputOp(operand(2)),
+          loctx->GetOutputOp(operand(3)), loctx->GetOutputOp(operand(4)),
+          use_weight_decay_, use_momentum_, use_nesterov_, pack_),
+      loctx);
+}
+
+std::string ForeachSgdOptimizerStep::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", num_params=" << num_params_
+     << ", use_weight_decay=" << use_weight_decay_
+     << ", use_momentum=" << use_momentum_
+     << ", use_nesterov=" << use_nesterov_ << ", pack=" << pack_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
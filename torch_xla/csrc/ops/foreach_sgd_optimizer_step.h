@@ -0,0 +1,36 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FOREACH_SGD_OPTIMIZER_STEP_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FOREACH_SGD_OPTIMIZER_STEP_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// SGD step over a list of params, sharing the scalar inputs. The outputs are
+// the step, param and momentum buffer of each param in turn.
+class ForeachSgdOptimizerStep : public XlaNode {
+ public:
+  ForeachSgdOptimizerStep(
+      const torch::lazy::Value& found_inf, torch::lazy::OpList steps,
+      torch::lazy::OpList params, torch::lazy::OpList bufs,
+      torch::lazy::OpList d_ps, const torch::lazy::Value& weight_decay,
+      const torch::lazy::Value& momentum, const torch::lazy::Value& lr,
+      const torch::lazy::Value& dampening, bool use_weight_decay,
+      bool use_momentum, bool use_nesterov, bool pack);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  std::string ToString() const override;
+
+ private:
+  size_t num_params_;
+  bool use_weight_decay_;
+  bool use_momentum_;
+  bool use_nesterov_;
+  bool pack_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FOREACH_SGD_OPTIMIZER_STEP_H_
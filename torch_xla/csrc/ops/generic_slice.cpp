@@ -13,11 +13,15 @@ namespace {
 xla::Shape NodeOutputShape(const torch::lazy::Value& input,
                            absl::Span<const int64_t> base_indices,
                            absl::Span<const int64_t> sizes) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return InferSliceShape(input_shape, base_indices, sizes);
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildSlice(operands[0], base_indices, sizes);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
 }
 
 }  // namespace
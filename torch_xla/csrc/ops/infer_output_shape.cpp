@@ -1,44 +1,200 @@
 #include "torch_xla/csrc/ops/infer_output_shape.h"
 
+#include <memory>
+
+#include "absl/strings/str_join.h"
+#include "torch_xla/csrc/data_ops.h"
+#include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/status.h"
+#include "xla/shape_util.h"
 
 namespace torch_xla {
+namespace {
+
+// Number of shape inferences after which the thread local builder is
+// recreated, to bound the memory held by the instructions it accumulates.
+constexpr int64_t kMaxBuilderUses = 1024;
+
+// Builder reused by the shape inferences of a thread, to avoid paying for the
+// construction of a new builder for every inferred shape. Parameter numbers
+// must be unique within a builder, so they keep increasing until the builder
+// is recreated.
+class ShapeInferenceBuilder {
+ public:
+  // Returns the builder for a new shape inference, or nullptr if the thread
+  // builder is already in use by an enclosing inference.
+  static ShapeInferenceBuilder* Acquire() {
+    thread_local ShapeInferenceBuilder builder;
+    if (builder.in_use_) {
+      return nullptr;
+    }
+    if (builder.builder_ == nullptr || builder.uses_ >= kMaxBuilderUses ||
+        !builder.builder_->first_error().ok()) {
+      builder.builder_ = std::make_unique<xla::XlaBuilder>("InferOutputShape");
+      builder.uses_ = 0;
+      builder.next_parameter_ = 0;
+    }
+    ++builder.uses_;
+    builder.in_use_ = true;
+    return &builder;
+  }
+
+  void Release() { in_use_ = false; }
+
+  std::vector<xla::XlaOp> MakeParameters(
+      absl::Span<const xla::Shape> input_shapes) {
+    std::vector<xla::XlaOp> parameters;
+    parameters.reserve(input_shapes.size());
+    for (const xla::Shape& shape : input_shapes) {
+      parameters.push_back(
+          xla::Parameter(builder_.get(), next_parameter_++, shape, "p"));
+    }
+    return parameters;
+  }
+
+ private:
+  std::unique_ptr<xla::XlaBuilder> builder_;
+  int64_t uses_ = 0;
+  int64_t next_parameter_ = 0;
+  bool in_use_ = false;
+};
+
+// Runs fn with the parameters for input_shapes, created either in the thread
+// builder, or in a new builder for nested inferences.
+template <typename T>
+T WithParameters(absl::Span<const xla::Shape> input_shapes,
+                 const std::function<T(absl::Span<const xla::XlaOp>)>& fn) {
+  ShapeInferenceBuilder* builder = ShapeInferenceBuilder::Acquire();
+  if (builder == nullptr) {
+    xla::XlaBuilder b("InferOutputShape");
+    std::vector<xla::XlaOp> parameters;
+    for (size_t i = 0; i < input_shapes.size(); ++i) {
+      parameters.push_back(xla::Parameter(&b, i, input_shapes[i], "p"));
+    }
+    return fn(parameters);
+  }
+  struct Releaser {
+    ~Releaser() { builder->Release(); }
+    ShapeInferenceBuilder* builder;
+  } releaser{builder};
+  return fn(builder->MakeParameters(input_shapes));
+}
+
+void CheckStatic(const xla::Shape& shape) {
+  XLA_CHECK(shape.is_static()) << "Dynamic shape not supported: " << shape;
+}
+
+}  // namespace
 
 xla::Shape InferOutputShape(absl::Span<const xla::Shape> input_shapes,
                             const LowerForShapeFn& core_lowering_fn) {
-  xla::XlaBuilder b("InferOutputShape");
-  std::vector<xla::XlaOp> parameters;
-  for (size_t parameter_number = 0; parameter_number < input_shapes.size();
-       ++parameter_number) {
-    parameters.push_back(xla::Parameter(&b, parameter_number,
-                                        input_shapes[parameter_number],
-                                        absl::StrCat("p", parameter_number)));
-  }
-  xla::XlaOp result = core_lowering_fn(parameters);
-  return ShapeHelper::ShapeOfXlaOp(result);
+  return WithParameters<xla::Shape>(
+      input_shapes, [&](absl::Span<const xla::XlaOp> parameters) {
+        xla::XlaOp result = core_lowering_fn(parameters);
+        return ShapeHelper::ShapeOfXlaOp(result);
+      });
 }
 
 xla::Shape InferOutputShapes(absl::Span<const xla::Shape> input_shapes,
                              const LowerForShapesFn& core_lowering_fn) {
-  xla::XlaBuilder b("InferOutputShape");
-  std::vector<xla::XlaOp> parameters;
-  for (size_t parameter_number = 0; parameter_number < input_shapes.size();
-       ++parameter_number) {
-    parameters.push_back(xla::Parameter(&b, parameter_number,
-                                        input_shapes[parameter_number],
-                                        absl::StrCat("p", parameter_number)));
-  }
-  std::vector<xla::XlaOp> results = core_lowering_fn(parameters);
-
-  xla::Shape output_shape;
-  if (results.size() == 2) {
-    output_shape =
-        xla::ShapeUtil::MakeTupleShape({ShapeHelper::ShapeOfXlaOp(results[0]),
-                                        ShapeHelper::ShapeOfXlaOp(results[1])});
-  } else {
-    output_shape = ShapeHelper::ShapeOfXlaOp(results[0]);
-  }
-  return output_shape;
+  return WithParameters<xla::Shape>(
+      input_shapes, [&](absl::Span<const xla::XlaOp> parameters) {
+        std::vector<xla::XlaOp> results = core_lowering_fn(parameters);
+        xla::Shape output_shape;
+        if (results.size() == 2) {
+          output_shape = xla::ShapeUtil::MakeTupleShape(
+              {ShapeHelper::ShapeOfXlaOp(results[0]),
+               ShapeHelper::ShapeOfXlaOp(results[1])});
+        } else {
+          output_shape = ShapeHelper::ShapeOfXlaOp(results[0]);
+        }
+        return output_shape;
+      });
+}
+
+xla::Shape InferBroadcastShape(const xla::Shape& lhs, const xla::Shape& rhs,
+                               xla::PrimitiveType type) {
+  CheckStatic(lhs);
+  CheckStatic(rhs);
+  xla::Shape shape = GetValueOrThrow(XlaHelpers::GetPromotedShape(lhs, rhs));
+  shape.set_element_type(type);
+  return shape;
+}
+
+xla::Shape InferReduceShape(const xla::Shape& input,
+                            absl::Span<const int64_t> dimensions,
+                            bool keep_reduced_dimensions,
+                            xla::PrimitiveType type) {
+  CheckStatic(input);
+  std::vector<bool> reduced(input.dimensions_size(), false);
+  for (int64_t dim : dimensions) {
+    XLA_CHECK(dim >= 0 && dim < input.dimensions_size())
+        << "Invalid reduction dimension " << dim << " for shape " << input;
+    reduced[dim] = true;
+  }
+  std::vector<int64_t> output_dimensions;
+  for (int64_t i = 0; i < input.dimensions_size(); ++i) {
+    if (!reduced[i]) {
+      output_dimensions.push_back(input.dimensions(i));
+    } else if (keep_reduced_dimensions) {
+      output_dimensions.push_back(1);
+    }
+  }
+  return xla::ShapeUtil::MakeShape(type, output_dimensions);
+}
+
+xla::Shape InferTransposeShape(const xla::Shape& input,
+                               absl::Span<const int64_t> permutation) {
+  CheckStatic(input);
+  XLA_CHECK_EQ(permutation.size(), input.dimensions_size())
+      << "Invalid permutation for shape " << input;
+  std::vector<bool> used(permutation.size(), false);
+  std::vector<int64_t> output_dimensions;
+  output_dimensions.reserve(permutation.size());
+  for (int64_t dim : permutation) {
+    XLA_CHECK(dim >= 0 && dim < input.dimensions_size() && !used[dim])
+        << "Invalid permutation for shape " << input;
+    used[dim] = true;
+    output_dimensions.push_back(input.dimensions(dim));
+  }
+  return xla::ShapeUtil::MakeShape(input.element_type(), output_dimensions);
+}
+
+xla::Shape InferSliceShape(const xla::Shape& input,
+                           absl::Span<const int64_t> base_indices,
+                           absl::Span<const int64_t> sizes) {
+  CheckStatic(input);
+  XLA_CHECK_EQ(base_indices.size(), sizes.size());
+  XLA_CHECK_EQ(sizes.size(), input.dimensions_size());
+  for (int64_t i = 0; i < input.dimensions_size(); ++i) {
+    XLA_CHECK(base_indices[i] >= 0 && sizes[i] >= 0 &&
+              base_indices[i] + sizes[i] <= input.dimensions(i))
+        << "Invalid slice of dimension " << i << " for shape " << input;
+  }
+  return xla::ShapeUtil::MakeShape(input.element_type(), sizes);
+}
+
+xla::Shape InferSqueezeShape(const xla::Shape& input, int64_t dim) {
+  CheckStatic(input);
+  XLA_CHECK_LT(dim, input.dimensions_size());
+  return xla::ShapeUtil::MakeShape(
+      input.element_type(), BuildSqueezedDimensions(input.dimensions(), dim));
+}
+
+xla::Shape InferExpandShape(const xla::Shape& input,
+                            absl::Span<const int64_t> sizes) {
+  CheckStatic(input);
+  XLA_CHECK_LE(input.dimensions_size(), sizes.size());
+  int64_t offset = sizes.size() - input.dimensions_size();
+  for (int64_t i = 0; i < input.dimensions_size(); ++i) {
+    XLA_CHECK(input.dimensions(i) == 1 ||
+              input.dimensions(i) == sizes[offset + i])
+        << "Invalid expansion of shape " << input << " to ["
+        << absl::StrJoin(sizes, ", ") << "]";
+  }
+  return xla::ShapeUtil::MakeShape(input.element_type(), sizes);
 }
 
 }  // namespace torch_xla
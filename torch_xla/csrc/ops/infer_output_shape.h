@@ -18,6 +18,35 @@ xla::Shape InferOutputShape(absl::Span<const xla::Shape> input_shapes,
 xla::Shape InferOutputShapes(absl::Span<const xla::Shape> input_shapes,
                              const LowerForShapesFn& core_lowering_fn);
 
+// Closed-form shape functions for common operations, which compute the output
+// shape without running the lowering. They only handle static input shapes,
+// callers are expected to fall back to InferOutputShape() otherwise.
+
+// Shape of an elementwise operation between lhs and rhs, after implicit
+// broadcasting, with the given element type.
+xla::Shape InferBroadcastShape(const xla::Shape& lhs, const xla::Shape& rhs,
+                               xla::PrimitiveType type);
+
+// Shape of a reduction over the given (canonical) dimensions.
+xla::Shape InferReduceShape(const xla::Shape& input,
+                            absl::Span<const int64_t> dimensions,
+                            bool keep_reduced_dimensions,
+                            xla::PrimitiveType type);
+
+xla::Shape InferTransposeShape(const xla::Shape& input,
+                               absl::Span<const int64_t> permutation);
+
+xla::Shape InferSliceShape(const xla::Shape& input,
+                           absl::Span<const int64_t> base_indices,
+                           absl::Span<const int64_t> sizes);
+
+// Drops dimension dim if it has size 1, or all the size 1 dimensions if dim is
+// -1.
+xla::Shape InferSqueezeShape(const xla::Shape& input, int64_t dim);
+
+xla::Shape InferExpandShape(const xla::Shape& input,
+                            absl::Span<const int64_t> sizes);
+
 }  // namespace torch_xla
 
-#endif  // XLA_TORCH_XLA_CSRC_OPS_INFER_OUTPUT_SHAPE_H_
\ No newline at end of file
+#endif  // XLA_TORCH_XLA_CSRC_OPS_INFER_OUTPUT_SHAPE_H_
@@ -0,0 +1,80 @@
+#include "torch_xla/csrc/ops/linear_cross_entropy.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/nll_loss.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The loss is a scalar, or one value per token without reduction, in the type
+// of hidden, and the log-sum-exp has one accumulated value per token.
+xla::Shape NodeOutputShape(const torch::lazy::Value& hidden,
+                           const torch::lazy::Value& weight,
+                           ReductionMode reduction) {
+  const xla::Shape& hidden_shape = GetXlaShape(hidden);
+  const xla::Shape& weight_shape = GetXlaShape(weight);
+  XLA_CHECK_EQ(hidden_shape.dimensions_size(), 2)
+      << "Linear cross entropy expects (tokens, hidden) inputs";
+  XLA_CHECK_EQ(weight_shape.dimensions_size(), 2)
+      << "Linear cross entropy expects a (vocab, hidden) weight";
+  XLA_CHECK_EQ(hidden_shape.dimensions(1), weight_shape.dimensions(1));
+  std::vector<int64_t> token_dims = {hidden_shape.dimensions(0)};
+  std::vector<int64_t> loss_dims;
+  if (reduction == ReductionMode::kNone) {
+    loss_dims = token_dims;
+  }
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(hidden_shape.element_type(), loss_dims),
+       xla::ShapeUtil::MakeShape(
+           GetAccumulationType(hidden_shape.element_type()), token_dims)});
+}
+
+}  // namespace
+
+LinearCrossEntropy::LinearCrossEntropy(const torch::lazy::Value& hidden,
+                                       const torch::lazy::Value& weight,
+                                       const torch::lazy::Value& target,
+                                       ReductionMode reduction,
+                                       int ignore_index, int64_t vocab_block)
+    : XlaNode(
+          xla_linear_cross_entropy, {hidden, weight, target},
+          [&]() { return NodeOutputShape(hidden, weight, reduction); },
+          /*num_outputs=*/2,
+          torch::lazy::MHash(torch::lazy::GetEnumValue(reduction),
+                             ignore_index, vocab_block)),
+      reduction_(reduction),
+      ignore_index_(ignore_index),
+      vocab_block_(vocab_block) {}
+
+torch::lazy::NodePtr LinearCrossEntropy::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<LinearCrossEntropy>(
+      operands.at(0), operands.at(1), operands.at(2), reduction_,
+      ignore_index_, vocab_block_);
+}
+
+XlaOpVector LinearCrossEntropy::Lower(LoweringContext* loctx) const {
+  xla::XlaOp hidden = loctx->GetOutputOp(operand(0));
+  xla::XlaOp weight = loctx->GetOutputOp(operand(1));
+  xla::XlaOp target = loctx->GetOutputOp(operand(2));
+  return ReturnOps(BuildLinearCrossEntropy(hidden, weight, target,
+                                           ignore_index_, reduction_,
+                                           vocab_block_),
+                   loctx);
+}
+
+std::string LinearCrossEntropy::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString()
+     << ", reduction=" << torch::lazy::GetEnumValue(reduction_)
+     << ", ignore_index=" << ignore_index_ << ", vocab_block=" << vocab_block_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,69 @@
+#include "torch_xla/csrc/ops/linear_cross_entropy_backward.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/nll_loss.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The gradients have the shapes of hidden and weight, in the type of hidden.
+xla::Shape NodeOutputShape(const torch::lazy::Value& hidden,
+                           const torch::lazy::Value& weight) {
+  const xla::Shape& hidden_shape = GetXlaShape(hidden);
+  const xla::Shape& weight_shape = GetXlaShape(weight);
+  return xla::ShapeUtil::MakeTupleShape(
+      {hidden_shape, xla::ShapeUtil::MakeShape(hidden_shape.element_type(),
+                                               weight_shape.dimensions())});
+}
+
+}  // namespace
+
+LinearCrossEntropyBackward::LinearCrossEntropyBackward(
+    const torch::lazy::Value& grad_output, const torch::lazy::Value& hidden,
+    const torch::lazy::Value& weight, const torch::lazy::Value& target,
+    const torch::lazy::Value& logsumexp, ReductionMode reduction,
+    int ignore_index, int64_t vocab_block)
+    : XlaNode(
+          xla_linear_cross_entropy_backward,
+          {grad_output, hidden, weight, target, logsumexp},
+          [&]() { return NodeOutputShape(hidden, weight); },
+          /*num_outputs=*/2,
+          torch::lazy::MHash(torch::lazy::GetEnumValue(reduction),
+                             ignore_index, vocab_block)),
+      reduction_(reduction),
+      ignore_index_(ignore_index),
+      vocab_block_(vocab_block) {}
+
+torch::lazy::NodePtr LinearCrossEntropyBackward::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<LinearCrossEntropyBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), reduction_, ignore_index_, vocab_block_);
+}
+
+XlaOpVector LinearCrossEntropyBackward::Lower(LoweringContext* loctx) const {
+  xla::XlaOp grad_output = loctx->GetOutputOp(operand(0));
+  xla::XlaOp hidden = loctx->GetOutputOp(operand(1));
+  xla::XlaOp weight = loctx->GetOutputOp(operand(2));
+  xla::XlaOp target = loctx->GetOutputOp(operand(3));
+  xla::XlaOp logsumexp = loctx->GetOutputOp(operand(4));
+  return ReturnOps(
+      BuildLinearCrossEntropyBackward(grad_output, hidden, weight, target,
+                                      logsumexp, ignore_index_, reduction_,
+                                      vocab_block_),
+      loctx);
+}
+
+std::string LinearCrossEntropyBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString()
+     << ", reduction=" << torch::lazy::GetEnumValue(reduction_)
+     << ", ignore_index=" << ignore_index_ << ", vocab_block=" << vocab_block_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,41 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_LINEAR_CROSS_ENTROPY_BACKWARD_H_
+#define XLA_TORCH_XLA_CSRC_OPS_LINEAR_CROSS_ENTROPY_BACKWARD_H_
+
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/reduction.h"
+
+namespace torch_xla {
+
+// Gradients of LinearCrossEntropy. The outputs are the hidden and weight
+// gradients.
+class LinearCrossEntropyBackward : public XlaNode {
+ public:
+  LinearCrossEntropyBackward(const torch::lazy::Value& grad_output,
+                             const torch::lazy::Value& hidden,
+                             const torch::lazy::Value& weight,
+                             const torch::lazy::Value& target,
+                             const torch::lazy::Value& logsumexp,
+                             ReductionMode reduction, int ignore_index,
+                             int64_t vocab_block);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  ReductionMode reduction() const { return reduction_; }
+
+  int ignore_index() const { return ignore_index_; }
+
+  int64_t vocab_block() const { return vocab_block_; }
+
+ private:
+  ReductionMode reduction_;
+  int ignore_index_;
+  int64_t vocab_block_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_LINEAR_CROSS_ENTROPY_BACKWARD_H_
@@ -8,13 +8,17 @@
 namespace torch_xla {
 namespace {
 
-xla::Shape NodeOutputShape(const torch::lazy::Value& input) {
+xla::Shape NodeOutputShape(const torch::lazy::Value& input,
+                           int64_t padded_size) {
   const xla::Shape& input_shape = GetXlaShape(input);
   int64_t input_elements = xla::ShapeUtil::ElementsIn(input_shape);
   xla::PrimitiveType size_type = GetShapeDimensionType(/*device=*/nullptr);
-  xla::Shape result_shape =
-      xla::ShapeUtil::MakeShape(input_shape.element_type(), {input_elements});
-  result_shape.set_dynamic_dimension(0, true);
+  xla::Shape result_shape = xla::ShapeUtil::MakeShape(
+      input_shape.element_type(),
+      {padded_size >= 0 ? padded_size : input_elements});
+  if (padded_size < 0) {
+    result_shape.set_dynamic_dimension(0, true);
+  }
   return xla::ShapeUtil::MakeTupleShape(
       {result_shape, xla::ShapeUtil::MakeShape(size_type, {})});
 }
@@ -22,19 +26,30 @@ xla::Shape NodeOutputShape(const torch::lazy::Value& input) {
 }  // namespace
 
 MaskedSelect::MaskedSelect(const torch::lazy::Value& input,
-                           const torch::lazy::Value& mask)
+                           const torch::lazy::Value& mask, int64_t padded_size)
     : XlaNode(torch::lazy::OpKind(at::aten::masked_select), {input, mask},
-              NodeOutputShape(input),
-              /*num_outputs=*/2) {}
+              NodeOutputShape(input, padded_size),
+              /*num_outputs=*/2, torch::lazy::MHash(padded_size)),
+      padded_size_(padded_size) {}
+
+std::string MaskedSelect::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString();
+  if (padded_size_ >= 0) {
+    ss << ", padded_size=" << padded_size_;
+  }
+  return ss.str();
+}
 
 torch::lazy::NodePtr MaskedSelect::Clone(torch::lazy::OpList operands) const {
-  return torch_xla::MakeNode<MaskedSelect>(operands.at(0), operands.at(1));
+  return torch_xla::MakeNode<MaskedSelect>(operands.at(0), operands.at(1),
+                                           padded_size_);
 }
 
 XlaOpVector MaskedSelect::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
   xla::XlaOp mask = loctx->GetOutputOp(operand(1));
-  return ReturnOps(BuildMaskedSelect(input, mask), loctx);
+  return ReturnOps(BuildMaskedSelect(input, mask, padded_size_), loctx);
 }
 
 }  // namespace torch_xla
@@ -5,18 +5,27 @@
 
 namespace torch_xla {
 
-// This node has no metadata, so it could have been implemented as generic-op in
-// ops.cpp, but since this might require special handling from upper IR layers,
-// it gets its own IR node class.
+// This node has little metadata, so it could have been implemented as
+// generic-op in ops.cpp, but since this might require special handling from
+// upper IR layers, it gets its own IR node class. With padded_size >= 0 the
+// result has a static size instead of a dynamic one.
 class MaskedSelect : public XlaNode {
  public:
-  MaskedSelect(const torch::lazy::Value& input, const torch::lazy::Value& mask);
+  MaskedSelect(const torch::lazy::Value& input, const torch::lazy::Value& mask,
+               int64_t padded_size = -1);
+
+  std::string ToString() const override;
 
   torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
 
   XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t padded_size() const { return padded_size_; }
+
+ private:
+  int64_t padded_size_;
 };
 
 }  // namespace torch_xla
 
-#endif  // XLA_TORCH_XLA_CSRC_OPS_MASKED_SELECT_H_
\ No newline at end of file
+#endif  // XLA_TORCH_XLA_CSRC_OPS_MASKED_SELECT_H_
@@ -26,11 +26,18 @@ xla::Shape NodeOutputShape(const torch::lazy::Value& input,
                            const std::vector<int64_t>& dimensions,
                            bool keep_reduced_dimensions,
                            const std::optional<at::ScalarType>& dtype) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return InferReduceShape(
+        input_shape, dimensions, keep_reduced_dimensions,
+        dtype ? MakeXlaPrimitiveType(*dtype, /*device=*/nullptr)
+              : input_shape.element_type());
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return LowerMean(operands[0], dimensions, keep_reduced_dimensions, dtype);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
 }
 
 }  // namespace
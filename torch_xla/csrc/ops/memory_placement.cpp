@@ -0,0 +1,30 @@
+#include "torch_xla/csrc/ops/memory_placement.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+
+namespace torch_xla {
+
+MemoryPlacement::MemoryPlacement(const torch::lazy::Value& input,
+                                 std::string memory_kind)
+    : XlaNode(xla_memory_placement, {input}, GetXlaShape(input),
+              /*num_outputs=*/1, torch::lazy::MHash(memory_kind)),
+      memory_kind_(std::move(memory_kind)) {}
+
+torch::lazy::NodePtr MemoryPlacement::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<MemoryPlacement>(operands.at(0), memory_kind_);
+}
+
+XlaOpVector MemoryPlacement::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  return ReturnOp(BuildMemoryPlacement(input, memory_kind_), loctx);
+}
+
+std::string MemoryPlacement::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", memory_kind=" << memory_kind_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,31 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_MEMORY_PLACEMENT_H_
+#define XLA_TORCH_XLA_CSRC_OPS_MEMORY_PLACEMENT_H_
+
+#include <string>
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Moves its input to the memory space of kind memory_kind (e.g. "pinned_host"
+// to offload an activation after its forward uses, or "device" to prefetch it
+// before its backward uses).
+class MemoryPlacement : public XlaNode {
+ public:
+  MemoryPlacement(const torch::lazy::Value& input, std::string memory_kind);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  std::string ToString() const override;
+
+  const std::string& memory_kind() const { return memory_kind_; }
+
+ private:
+  std::string memory_kind_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_MEMORY_PLACEMENT_H_
@@ -8,31 +8,45 @@
 namespace torch_xla {
 namespace {
 
-xla::Shape NodeOutputShape(const torch::lazy::Value& input) {
+xla::Shape NodeOutputShape(const torch::lazy::Value& input,
+                           int64_t padded_size) {
   const xla::Shape& input_shape = GetXlaShape(input);
   int64_t index_elements = xla::ShapeUtil::ElementsIn(input_shape);
   xla::PrimitiveType size_type = GetShapeDimensionType(/*device=*/nullptr);
   xla::Shape result_shape = xla::ShapeUtil::MakeShape(
-      size_type, {index_elements, input_shape.dimensions_size()});
-  result_shape.set_dynamic_dimension(0, true);
+      size_type, {padded_size >= 0 ? padded_size : index_elements,
+                  input_shape.dimensions_size()});
+  if (padded_size < 0) {
+    result_shape.set_dynamic_dimension(0, true);
+  }
   return xla::ShapeUtil::MakeTupleShape(
       {result_shape, xla::ShapeUtil::MakeShape(size_type, {})});
 }
 
 }  // namespace
 
-NonZero::NonZero(const torch::lazy::Value& input)
+NonZero::NonZero(const torch::lazy::Value& input, int64_t padded_size)
     : XlaNode(torch::lazy::OpKind(at::aten::nonzero), {input},
-              NodeOutputShape(input),
-              /*num_outputs=*/2) {}
+              NodeOutputShape(input, padded_size),
+              /*num_outputs=*/2, torch::lazy::MHash(padded_size)),
+      padded_size_(padded_size) {}
+
+std::string NonZero::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString();
+  if (padded_size_ >= 0) {
+    ss << ", padded_size=" << padded_size_;
+  }
+  return ss.str();
+}
 
 torch::lazy::NodePtr NonZero::Clone(torch::lazy::OpList operands) const {
-  return torch_xla::MakeNode<NonZero>(operands.at(0));
+  return torch_xla::MakeNode<NonZero>(operands.at(0), padded_size_);
 }
 
 XlaOpVector NonZero::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
-  return ReturnOps(BuildNonZero(input), loctx);
+  return ReturnOps(BuildNonZero(input, padded_size_), loctx);
 }
 
 }  // namespace torch_xla
@@ -5,16 +5,24 @@
 
 namespace torch_xla {
 
-// This node has no metadata, so it could have been implemented as generic-op in
-// ops.cpp, but since this might require special handling from upper IR layers,
-// it gets its own IR node class.
+// This node has little metadata, so it could have been implemented as
+// generic-op in ops.cpp, but since this might require special handling from
+// upper IR layers, it gets its own IR node class. With padded_size >= 0 the
+// result has a static number of rows instead of a dynamic one.
 class NonZero : public XlaNode {
  public:
-  NonZero(const torch::lazy::Value& input);
+  NonZero(const torch::lazy::Value& input, int64_t padded_size = -1);
+
+  std::string ToString() const override;
 
   torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
 
   XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t padded_size() const { return padded_size_; }
+
+ private:
+  int64_t padded_size_;
 };
 
 }  // namespace torch_xla
@@ -7,6 +7,7 @@
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/pooling.h"
 #include "torch_xla/csrc/reduction.h"
+#include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/xla_lower_util.h"
 #include "xla/hlo/builder/lib/logdet.h"
 #include "xla/shape_util.h"
@@ -41,6 +42,42 @@ xla::Shape InferBinaryOpShape(const torch::lazy::Value& first,
 
   return InferOutputShape(shapes, lower_for_shape_fn);
 }
+
+// Shape of a comparison or logical operation between first and second, which
+// is computed in closed form when both inputs are static.
+xla::Shape InferPredicateOpShape(const torch::lazy::Value& first,
+                                 const torch::lazy::Value& second,
+                                 const LowerForShapeFn& lower_for_shape_fn) {
+  const xla::Shape& first_shape = GetXlaShape(first);
+  const xla::Shape& second_shape = GetXlaShape(second);
+  if (first_shape.is_static() && second_shape.is_static()) {
+    return InferBroadcastShape(first_shape, second_shape,
+                               xla::PrimitiveType::PRED);
+  }
+  return InferOutputShape({first_shape, second_shape}, lower_for_shape_fn);
+}
+
+// Shape of a min/max reduction over dim, which is computed in closed form when
+// the input is static.
+xla::Shape InferMinMaxInDimsShape(const torch::lazy::Value& input,
+                                  absl::Span<const int64_t> dim, bool keepdim,
+                                  const LowerForShapeFn& lower_for_shape_fn) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    std::vector<int64_t> dimensions =
+        torch::lazy::GetCanonicalDimensionIndices(
+            runtime::util::ToVector<int64_t>(dim),
+            input_shape.dimensions_size());
+    int64_t reduced_size = 1;
+    for (int64_t dimension : dimensions) {
+      reduced_size *= input_shape.dimensions(dimension);
+    }
+    XLA_CHECK_GT(reduced_size, 0);
+    return InferReduceShape(input_shape, dimensions, keepdim,
+                            input_shape.element_type());
+  }
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
+}
 }  // namespace
 
 xla::Shape AbsOutputShape(const torch::lazy::Value& input) {
@@ -160,7 +197,7 @@ xla::Shape AmaxOutputShape(const torch::lazy::Value& input,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildMaxInDims(operands[0], dim, keepdim);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferMinMaxInDimsShape(input, dim, keepdim, lower_for_shape_fn);
 }
 
 xla::Shape AminOutputShape(const torch::lazy::Value& input,
@@ -169,7 +206,7 @@ xla::Shape AminOutputShape(const torch::lazy::Value& input,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildMinInDims(operands[0], dim, keepdim);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferMinMaxInDimsShape(input, dim, keepdim, lower_for_shape_fn);
 }
 
 xla::Shape AnyOutputShape(const torch::lazy::Value& input) {
@@ -473,8 +510,7 @@ xla::Shape EqScalarOutputShape(const torch::lazy::Value& self,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildComparisonOp(at::aten::eq, operands[0], operands[1]);
   };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return InferPredicateOpShape(self, other, lower_for_shape_fn);
 }
 
 xla::Shape EqTensorOutputShape(const torch::lazy::Value& self,
@@ -528,8 +564,7 @@ xla::Shape GeScalarOutputShape(const torch::lazy::Value& self,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildComparisonOp(at::aten::ge, operands[0], operands[1]);
   };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return InferPredicateOpShape(self, other, lower_for_shape_fn);
 }
 
 xla::Shape GeTensorOutputShape(const torch::lazy::Value& self,
@@ -558,8 +593,7 @@ xla::Shape GtScalarOutputShape(const torch::lazy::Value& self,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildComparisonOp(at::aten::gt, operands[0], operands[1]);
   };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return InferPredicateOpShape(self, other, lower_for_shape_fn);
 }
 
 xla::Shape GtTensorOutputShape(const torch::lazy::Value& self,
@@ -642,8 +676,7 @@ xla::Shape LeScalarOutputShape(const torch::lazy::Value& self,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildComparisonOp(at::aten::le, operands[0], operands[1]);
   };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return InferPredicateOpShape(self, other, lower_for_shape_fn);
 }
 
 xla::Shape LeTensorOutputShape(const torch::lazy::Value& self,
@@ -657,8 +690,7 @@ xla::Shape LtScalarOutputShape(const torch::lazy::Value& self,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildComparisonOp(at::aten::lt, operands[0], operands[1]);
   };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return InferPredicateOpShape(self, other, lower_for_shape_fn);
 }
 
 xla::Shape LtTensorOutputShape(const torch::lazy::Value& self,
@@ -685,7 +717,7 @@ xla::Shape LogicalAndOutputShape(const torch::lazy::Value& input,
                           XlaHelpers::getBroadcastDimensions(lhs, rhs));
         });
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)}, shape_fn);
+  return InferPredicateOpShape(input, other, shape_fn);
 }
 
 xla::Shape LogicalNotOutputShape(const torch::lazy::Value& input) {
@@ -693,7 +725,12 @@ xla::Shape LogicalNotOutputShape(const torch::lazy::Value& input) {
     return XlaHelpers::PromotedLogicalUnaryOp(
         operands[0], [](xla::XlaOp lhs) { return xla::Not(lhs); });
   };
-  return InferOutputShape({GetXlaShape(input)}, shape_fn);
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return xla::ShapeUtil::ChangeElementType(input_shape,
+                                             xla::PrimitiveType::PRED);
+  }
+  return InferOutputShape({input_shape}, shape_fn);
 }
 
 xla::Shape LogicalOrOutputShape(const torch::lazy::Value& input,
@@ -705,7 +742,7 @@ xla::Shape LogicalOrOutputShape(const torch::lazy::Value& input,
                          XlaHelpers::getBroadcastDimensions(lhs, rhs));
         });
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)}, shape_fn);
+  return InferPredicateOpShape(input, other, shape_fn);
 }
 
 xla::Shape LogicalXorOutputShape(const torch::lazy::Value& input,
@@ -717,7 +754,7 @@ xla::Shape LogicalXorOutputShape(const torch::lazy::Value& input,
                           XlaHelpers::getBroadcastDimensions(lhs, rhs));
         });
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)}, shape_fn);
+  return InferPredicateOpShape(input, other, shape_fn);
 }
 
 xla::Shape LogSigmoidForwardOutputShape(const torch::lazy::Value& input) {
@@ -758,8 +795,12 @@ xla::Shape MaximumOutputShape(const torch::lazy::Value& input,
         promoted.first, promoted.second,
         XlaHelpers::getBroadcastDimensions(promoted.first, promoted.second));
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return XlaHelpers::GetPromotedBinaryOpShape(input_shape, other_shape);
+  }
+  return InferOutputShape({input_shape, other_shape}, lower_for_shape_fn);
 }
 
 xla::Shape MinimumOutputShape(const torch::lazy::Value& input,
@@ -771,8 +812,12 @@ xla::Shape MinimumOutputShape(const torch::lazy::Value& input,
         promoted.first, promoted.second,
         XlaHelpers::getBroadcastDimensions(promoted.first, promoted.second));
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return XlaHelpers::GetPromotedBinaryOpShape(input_shape, other_shape);
+  }
+  return InferOutputShape({input_shape, other_shape}, lower_for_shape_fn);
 }
 
 xla::Shape NativeDropoutBackwardOutputShape(
@@ -786,8 +831,7 @@ xla::Shape NeScalarOutputShape(const torch::lazy::Value& self,
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildComparisonOp(at::aten::ne, operands[0], operands[1]);
   };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return InferPredicateOpShape(self, other, lower_for_shape_fn);
 }
 
 xla::Shape NeTensorOutputShape(const torch::lazy::Value& self,
@@ -809,7 +853,11 @@ xla::Shape ReluOutputShape(const torch::lazy::Value& input) {
     XLA_CHECK_EQ(operands.size(), 1) << "Unexpected number of operands";
     return BuildRelu(operands[0]);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return input_shape;
+  }
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
 }
 
 xla::Shape RepeatOutputShape(const torch::lazy::Value& input,
@@ -0,0 +1,44 @@
+#include "torch_xla/csrc/ops/padded_unique.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& input,
+                           int64_t padded_size) {
+  xla::PrimitiveType size_type = GetShapeDimensionType(/*device=*/nullptr);
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(GetXlaShape(input).element_type(),
+                                 {padded_size}),
+       xla::ShapeUtil::MakeShape(size_type, {})});
+}
+
+}  // namespace
+
+PaddedUnique::PaddedUnique(const torch::lazy::Value& input,
+                           int64_t padded_size)
+    : XlaNode(xla_padded_unique, {input}, NodeOutputShape(input, padded_size),
+              /*num_outputs=*/2, torch::lazy::MHash(padded_size)),
+      padded_size_(padded_size) {}
+
+std::string PaddedUnique::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", padded_size=" << padded_size_;
+  return ss.str();
+}
+
+torch::lazy::NodePtr PaddedUnique::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<PaddedUnique>(operands.at(0), padded_size_);
+}
+
+XlaOpVector PaddedUnique::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  return ReturnOps(BuildPaddedUnique(input, padded_size_), loctx);
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,28 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_PADDED_UNIQUE_H_
+#define XLA_TORCH_XLA_CSRC_OPS_PADDED_UNIQUE_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The sorted unique values of the input, zero padded to padded_size, and the
+// number of unique values.
+class PaddedUnique : public XlaNode {
+ public:
+  PaddedUnique(const torch::lazy::Value& input, int64_t padded_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t padded_size() const { return padded_size_; }
+
+ private:
+  int64_t padded_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_PADDED_UNIQUE_H_
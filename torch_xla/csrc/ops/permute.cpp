@@ -10,12 +10,16 @@ namespace {
 
 xla::Shape NodeOutputShape(const torch::lazy::Value& input,
                            absl::Span<const int64_t> dims) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return InferTransposeShape(input_shape, dims);
+  }
   auto lower_for_shape_fn =
       [dims](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     XLA_CHECK_EQ(operands.size(), 1);
     return xla::Transpose(operands[0], dims);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
 }
 
 }  // namespace
@@ -0,0 +1,29 @@
+#include "torch_xla/csrc/ops/rng_seed.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/random.h"
+
+namespace torch_xla {
+
+RngSeed::RngSeed(const torch::lazy::Value& base_seed, uint64_t offset)
+    : XlaNode(xla_rng_seed, {base_seed}, GetXlaShape(base_seed),
+              /*num_outputs=*/1, torch::lazy::MHash(offset)),
+      offset_(offset) {}
+
+std::string RngSeed::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", offset=" << offset_;
+  return ss.str();
+}
+
+torch::lazy::NodePtr RngSeed::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<RngSeed>(operands.at(0), offset_);
+}
+
+XlaOpVector RngSeed::Lower(LoweringContext* loctx) const {
+  xla::XlaOp base_seed = loctx->GetOutputOp(operand(0));
+  return ReturnOp(BuildCounterRngSeed(base_seed, offset_), loctx);
+}
+
+}  // namespace torch_xla
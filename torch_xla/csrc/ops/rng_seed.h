@@ -0,0 +1,28 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_RNG_SEED_H_
+#define XLA_TORCH_XLA_CSRC_OPS_RNG_SEED_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The seed of the random op at the given counter offset from base_seed. The
+// offset is part of the node, so each random op only depends on the base seed.
+class RngSeed : public XlaNode {
+ public:
+  RngSeed(const torch::lazy::Value& base_seed, uint64_t offset);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  uint64_t offset() const { return offset_; }
+
+ private:
+  uint64_t offset_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_RNG_SEED_H_
@@ -0,0 +1,51 @@
+#include "torch_xla/csrc/ops/row_sparse_coalesce.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& rows,
+                           const torch::lazy::Value& values) {
+  xla::PrimitiveType size_type = GetShapeDimensionType(/*device=*/nullptr);
+  return xla::ShapeUtil::MakeTupleShape(
+      {GetXlaShape(rows), GetXlaShape(values),
+       xla::ShapeUtil::MakeShape(size_type, {})});
+}
+
+}  // namespace
+
+RowSparseCoalesce::RowSparseCoalesce(const torch::lazy::Value& rows,
+                                     const torch::lazy::Value& values,
+                                     int64_t num_rows, int64_t padding_idx)
+    : XlaNode(xla_row_sparse_coalesce, {rows, values},
+              NodeOutputShape(rows, values),
+              /*num_outputs=*/3, torch::lazy::MHash(num_rows, padding_idx)),
+      num_rows_(num_rows),
+      padding_idx_(padding_idx) {}
+
+std::string RowSparseCoalesce::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", num_rows=" << num_rows_
+     << ", padding_idx=" << padding_idx_;
+  return ss.str();
+}
+
+torch::lazy::NodePtr RowSparseCoalesce::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<RowSparseCoalesce>(operands.at(0), operands.at(1),
+                                                num_rows_, padding_idx_);
+}
+
+XlaOpVector RowSparseCoalesce::Lower(LoweringContext* loctx) const {
+  xla::XlaOp rows = loctx->GetOutputOp(operand(0));
+  xla::XlaOp values = loctx->GetOutputOp(operand(1));
+  return ReturnOps(
+      BuildRowSparseCoalesce(rows, values, num_rows_, padding_idx_), loctx);
+}
+
+}  // namespace torch_xla
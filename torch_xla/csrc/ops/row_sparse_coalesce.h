@@ -0,0 +1,33 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_ROW_SPARSE_COALESCE_H_
+#define XLA_TORCH_XLA_CSRC_OPS_ROW_SPARSE_COALESCE_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The distinct rows of a row-sparse tensor, their summed values and the
+// number of distinct rows.
+class RowSparseCoalesce : public XlaNode {
+ public:
+  RowSparseCoalesce(const torch::lazy::Value& rows,
+                    const torch::lazy::Value& values, int64_t num_rows,
+                    int64_t padding_idx);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t num_rows() const { return num_rows_; }
+
+  int64_t padding_idx() const { return padding_idx_; }
+
+ private:
+  int64_t num_rows_;
+  int64_t padding_idx_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_ROW_SPARSE_COALESCE_H_
@@ -0,0 +1,79 @@
+#include "torch_xla/csrc/ops/scaled_dot_product_attention.h"
+
+#include "torch_xla/csrc/attention.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The output has the shape of the query with the head size of the value, and
+// the log-sum-exp has one accumulated value per query row.
+xla::Shape NodeOutputShape(const torch::lazy::Value& query,
+                           const torch::lazy::Value& value) {
+  const xla::Shape& query_shape = GetXlaShape(query);
+  const xla::Shape& value_shape = GetXlaShape(value);
+  std::vector<int64_t> row_dims(query_shape.dimensions().begin(),
+                                query_shape.dimensions().end() - 1);
+  std::vector<int64_t> output_dims = row_dims;
+  output_dims.push_back(value_shape.dimensions().back());
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(query_shape.element_type(), output_dims),
+       xla::ShapeUtil::MakeShape(
+           GetAccumulationType(query_shape.element_type()), row_dims)});
+}
+
+}  // namespace
+
+ScaledDotProductAttention::ScaledDotProductAttention(
+    const torch::lazy::Value& query, const torch::lazy::Value& key,
+    const torch::lazy::Value& value,
+    const absl::optional<torch::lazy::Value>& mask, bool is_causal,
+    double scale, int64_t block_size)
+    : XlaNode(
+          xla_scaled_dot_product_attention,
+          torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+              {query, key, value}, {&mask}),
+          [&]() { return NodeOutputShape(query, value); },
+          /*num_outputs=*/2,
+          torch::lazy::MHash(is_causal, scale, block_size)),
+      is_causal_(is_causal),
+      scale_(scale),
+      block_size_(block_size) {}
+
+torch::lazy::NodePtr ScaledDotProductAttention::Clone(
+    torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> mask;
+  if (operands.size() > 3) {
+    mask = operands.at(3);
+  }
+  return torch_xla::MakeNode<ScaledDotProductAttention>(
+      operands.at(0), operands.at(1), operands.at(2), mask, is_causal_, scale_,
+      block_size_);
+}
+
+XlaOpVector ScaledDotProductAttention::Lower(LoweringContext* loctx) const {
+  xla::XlaOp query = loctx->GetOutputOp(operand(0));
+  xla::XlaOp key = loctx->GetOutputOp(operand(1));
+  xla::XlaOp value = loctx->GetOutputOp(operand(2));
+  xla::XlaOp mask;
+  if (operands().size() > 3) {
+    mask = loctx->GetOutputOp(operand(3));
+  }
+  return ReturnOps(
+      BuildScaledDotProductAttention(query, key, value, mask, is_causal_,
+                                     scale_, block_size_),
+      loctx);
+}
+
+std::string ScaledDotProductAttention::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", is_causal=" << is_causal_
+     << ", scale=" << scale_ << ", block_size=" << block_size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
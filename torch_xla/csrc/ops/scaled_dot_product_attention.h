@@ -0,0 +1,39 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_SCALED_DOT_PRODUCT_ATTENTION_H_
+#define XLA_TORCH_XLA_CSRC_OPS_SCALED_DOT_PRODUCT_ATTENTION_H_
+
+#include "absl/types/optional.h"
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Blockwise attention forward. The outputs are the attention output and the
+// per row log-sum-exp of the scores.
+class ScaledDotProductAttention : public XlaNode {
+ public:
+  ScaledDotProductAttention(const torch::lazy::Value& query,
+                            const torch::lazy::Value& key,
+                            const torch::lazy::Value& value,
+                            const absl::optional<torch::lazy::Value>& mask,
+                            bool is_causal, double scale, int64_t block_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  bool is_causal() const { return is_causal_; }
+
+  double scale() const { return scale_; }
+
+  int64_t block_size() const { return block_size_; }
+
+ private:
+  bool is_causal_;
+  double scale_;
+  int64_t block_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_SCALED_DOT_PRODUCT_ATTENTION_H_
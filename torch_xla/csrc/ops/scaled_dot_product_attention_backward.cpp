@@ -0,0 +1,84 @@
+#include "torch_xla/csrc/ops/scaled_dot_product_attention_backward.h"
+
+#include "torch_xla/csrc/attention.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+std::vector<xla::XlaOp> LowerBackward(absl::Span<const xla::XlaOp> operands,
+                                      bool is_causal, double scale,
+                                      int64_t block_size) {
+  xla::XlaOp mask;
+  if (operands.size() > 6) {
+    mask = operands[6];
+  }
+  return BuildScaledDotProductAttentionBackward(
+      operands[0], operands[1], operands[2], operands[3], mask, operands[4],
+      operands[5], is_causal, scale, block_size);
+}
+
+// The gradients have the shapes of the query, key and value, in the type of
+// the query.
+xla::Shape NodeOutputShape(const torch::lazy::Value& query,
+                           const torch::lazy::Value& key,
+                           const torch::lazy::Value& value) {
+  const xla::Shape& query_shape = GetXlaShape(query);
+  xla::PrimitiveType type = query_shape.element_type();
+  return xla::ShapeUtil::MakeTupleShape(
+      {query_shape,
+       xla::ShapeUtil::ChangeElementType(GetXlaShape(key), type),
+       xla::ShapeUtil::ChangeElementType(GetXlaShape(value), type)});
+}
+
+}  // namespace
+
+ScaledDotProductAttentionBackward::ScaledDotProductAttentionBackward(
+    const torch::lazy::Value& grad_output, const torch::lazy::Value& query,
+    const torch::lazy::Value& key, const torch::lazy::Value& value,
+    const torch::lazy::Value& output, const torch::lazy::Value& logsumexp,
+    const absl::optional<torch::lazy::Value>& mask, bool is_causal,
+    double scale, int64_t block_size)
+    : XlaNode(
+          xla_scaled_dot_product_attention_backward,
+          torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+              {grad_output, query, key, value, output, logsumexp}, {&mask}),
+          [&]() { return NodeOutputShape(query, key, value); },
+          /*num_outputs=*/3,
+          torch::lazy::MHash(is_causal, scale, block_size)),
+      is_causal_(is_causal),
+      scale_(scale),
+      block_size_(block_size) {}
+
+torch::lazy::NodePtr ScaledDotProductAttentionBackward::Clone(
+    torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> mask;
+  if (operands.size() > 6) {
+    mask = operands.at(6);
+  }
+  return torch_xla::MakeNode<ScaledDotProductAttentionBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), operands.at(5), mask, is_causal_, scale_, block_size_);
+}
+
+XlaOpVector ScaledDotProductAttentionBackward::Lower(
+    LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> inputs;
+  for (const torch::lazy::Output& input : operands()) {
+    inputs.push_back(loctx->GetOutputOp(input));
+  }
+  return ReturnOps(LowerBackward(inputs, is_causal_, scale_, block_size_),
+                   loctx);
+}
+
+std::string ScaledDotProductAttentionBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", is_causal=" << is_causal_
+     << ", scale=" << scale_ << ", block_size=" << block_size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
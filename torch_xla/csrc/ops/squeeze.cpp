@@ -17,12 +17,16 @@ xla::XlaOp LowerSqueeze(xla::XlaOp input, int dim) {
 }
 
 xla::Shape NodeOutputShape(const torch::lazy::Value& input, int dim) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return InferSqueezeShape(input_shape, dim);
+  }
   auto lower_for_shape_fn =
       [dim](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     XLA_CHECK_EQ(operands.size(), 1);
     return LowerSqueeze(operands[0], dim);
   };
-  return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
+  return InferOutputShape({input_shape}, lower_for_shape_fn);
 }
 
 }  // namespace
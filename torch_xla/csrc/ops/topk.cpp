@@ -9,11 +9,12 @@ namespace {
 
 xla::Shape NodeOutputShape(const torch::lazy::Value& input, int64_t k,
                            int64_t dim, bool largest, bool sorted,
-                           bool stable) {
+                           bool stable, float recall_target) {
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return xla::Tuple(operands[0].builder(),
-                      CreateTopK(operands[0], k, dim, largest, stable));
+    return xla::Tuple(
+        operands[0].builder(),
+        CreateTopK(operands[0], k, dim, largest, stable, recall_target));
   };
   return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
 }
@@ -21,28 +22,31 @@ xla::Shape NodeOutputShape(const torch::lazy::Value& input, int64_t k,
 }  // namespace
 
 TopK::TopK(const torch::lazy::Value& input, int64_t k, int64_t dim,
-           bool largest, bool sorted, bool stable)
+           bool largest, bool sorted, bool stable, float recall_target)
     : XlaNode(
           torch::lazy::OpKind(at::aten::topk), {input},
           [&]() {
-            return NodeOutputShape(input, k, dim, largest, sorted, stable);
+            return NodeOutputShape(input, k, dim, largest, sorted, stable,
+                                   recall_target);
           },
           /*num_outputs=*/2,
-          torch::lazy::MHash(k, dim, largest, sorted, stable)),
+          torch::lazy::MHash(k, dim, largest, sorted, stable, recall_target)),
       k_(k),
       dim_(dim),
       largest_(largest),
       sorted_(sorted),
-      stable_(stable) {}
+      stable_(stable),
+      recall_target_(recall_target) {}
 
 torch::lazy::NodePtr TopK::Clone(torch::lazy::OpList operands) const {
   return torch_xla::MakeNode<TopK>(operands.at(0), k_, dim_, largest_, sorted_,
-                                   stable_);
+                                   stable_, recall_target_);
 }
 
 XlaOpVector TopK::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
-  return ReturnOps(CreateTopK(input, k_, dim_, largest_, stable_), loctx);
+  return ReturnOps(
+      CreateTopK(input, k_, dim_, largest_, stable_, recall_target_), loctx);
 }
 
 std::string TopK::ToString() const {
@@ -50,6 +54,9 @@ std::string TopK::ToString() const {
   ss << XlaNode::ToString() << ", k=" << k_ << ", dim=" << dim_
      << ", largest=" << largest_ << ", sorted=" << sorted_
      << ", stable=" << stable_;
+  if (recall_target_ < 1.0) {
+    ss << ", recall_target=" << recall_target_;
+  }
   return ss.str();
 }
 
@@ -7,8 +7,9 @@ namespace torch_xla {
 
 class TopK : public XlaNode {
  public:
+  // A recall_target below 1 lowers to an approximate top-k.
   TopK(const torch::lazy::Value& input, int64_t k, int64_t dim, bool largest,
-       bool sorted, bool stable);
+       bool sorted, bool stable, float recall_target = 1.0);
 
   std::string ToString() const override;
 
@@ -26,12 +27,15 @@ class TopK : public XlaNode {
 
   bool stable() const { return stable_; }
 
+  float recall_target() const { return recall_target_; }
+
  private:
   int64_t k_;
   int64_t dim_;
   bool largest_;
   bool sorted_;
   bool stable_;
+  float recall_target_;
 };
 
 }  // namespace torch_xla
@@ -0,0 +1,87 @@
+#include "torch_xla/csrc/ops/weight_only_quantized_matmul.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/infer_output_shape.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/quant_util.h"
+#include "torch_xla/csrc/runtime/util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(
+    const torch::lazy::Value& input, const torch::lazy::Value& weight,
+    const torch::lazy::Value& scale,
+    const absl::optional<torch::lazy::Value>& zero_point, int64_t bits,
+    int64_t block_size) {
+  auto lower_for_shape_fn =
+      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    xla::XlaOp zero_point_op;
+    if (operands.size() > 3) {
+      zero_point_op = operands[3];
+    }
+    return BuildWeightOnlyQuantizedMatMul(operands[0], operands[1],
+                                          operands[2], zero_point_op, bits,
+                                          block_size);
+  };
+  std::vector<xla::Shape> shapes;
+  for (auto& operand :
+       torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+           {input, weight, scale}, {&zero_point})) {
+    shapes.push_back(GetXlaShape(operand));
+  }
+  return InferOutputShape(shapes, lower_for_shape_fn);
+}
+
+}  // namespace
+
+WeightOnlyQuantizedMatMul::WeightOnlyQuantizedMatMul(
+    const torch::lazy::Value& input, const torch::lazy::Value& weight,
+    const torch::lazy::Value& scale,
+    const absl::optional<torch::lazy::Value>& zero_point, int64_t bits,
+    int64_t block_size)
+    : XlaNode(
+          xla_weight_only_quantized_matmul,
+          torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+              {input, weight, scale}, {&zero_point}),
+          [&]() {
+            return NodeOutputShape(input, weight, scale, zero_point, bits,
+                                   block_size);
+          },
+          /*num_outputs=*/1, torch::lazy::MHash(bits, block_size)),
+      bits_(bits),
+      block_size_(block_size) {}
+
+torch::lazy::NodePtr WeightOnlyQuantizedMatMul::Clone(
+    torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> zero_point;
+  if (operands.size() > 3) {
+    zero_point = operands.at(3);
+  }
+  return torch_xla::MakeNode<WeightOnlyQuantizedMatMul>(
+      operands.at(0), operands.at(1), operands.at(2), zero_point, bits_,
+      block_size_);
+}
+
+XlaOpVector WeightOnlyQuantizedMatMul::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  xla::XlaOp weight = loctx->GetOutputOp(operand(1));
+  xla::XlaOp scale = loctx->GetOutputOp(operand(2));
+  xla::XlaOp zero_point;
+  if (operands().size() > 3) {
+    zero_point = loctx->GetOutputOp(operand(3));
+  }
+  return ReturnOp(BuildWeightOnlyQuantizedMatMul(input, weight, scale,
+                                                 zero_point, bits_,
+                                                 block_size_),
+                  loctx);
+}
+
+std::string WeightOnlyQuantizedMatMul::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", bits=" << bits_
+     << ", block_size=" << block_size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
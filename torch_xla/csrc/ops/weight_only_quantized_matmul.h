@@ -0,0 +1,35 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_WEIGHT_ONLY_QUANTIZED_MATMUL_H_
+#define XLA_TORCH_XLA_CSRC_OPS_WEIGHT_ONLY_QUANTIZED_MATMUL_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Matmul of an activation with an int8 or packed int4 weight dequantized by
+// per-channel or per-block scales and optional zero points.
+class WeightOnlyQuantizedMatMul : public XlaNode {
+ public:
+  WeightOnlyQuantizedMatMul(
+      const torch::lazy::Value& input, const torch::lazy::Value& weight,
+      const torch::lazy::Value& scale,
+      const absl::optional<torch::lazy::Value>& zero_point, int64_t bits,
+      int64_t block_size);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  std::string ToString() const override;
+
+  int64_t bits() const { return bits_; }
+
+  int64_t block_size() const { return block_size_; }
+
+ private:
+  int64_t bits_;
+  int64_t block_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_WEIGHT_ONLY_QUANTIZED_MATMUL_H_
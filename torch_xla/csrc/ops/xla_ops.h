@@ -32,6 +32,7 @@ extern const OpKindWrapper xla_adam_optimizer_step;
 extern const OpKindWrapper xla_all_gather;
 extern const OpKindWrapper xla_all_to_all;
 extern const OpKindWrapper xla_as_strided_view_update;
+extern const OpKindWrapper xla_batched_nms;
 extern const OpKindWrapper xla_cast;
 extern const OpKindWrapper xla_collective_permute;
 extern const OpKindWrapper xla_cross_replica_sum;
@@ -43,25 +44,36 @@ extern const OpKindWrapper xla_dot_general;
 extern const OpKindWrapper xla_dynamic_expand;
 extern const OpKindWrapper xla_dynamic_view;
 extern const OpKindWrapper xla_einsum_backward;
+extern const OpKindWrapper xla_foreach_adam_optimizer_step;
+extern const OpKindWrapper xla_foreach_sgd_optimizer_step;
 extern const OpKindWrapper xla_generic_slice;
 extern const OpKindWrapper xla_get_dimensions_size;
+extern const OpKindWrapper xla_linear_cross_entropy;
+extern const OpKindWrapper xla_linear_cross_entropy_backward;
 extern const OpKindWrapper xla_mark_tensor;
+extern const OpKindWrapper xla_memory_placement;
 extern const OpKindWrapper xla_moving_average;
 extern const OpKindWrapper xla_nms;
 extern const OpKindWrapper xla_not_supported;
 extern const OpKindWrapper xla_optimization_barrier;
+extern const OpKindWrapper xla_padded_unique;
 extern const OpKindWrapper xla_quantize_tensor;
 extern const OpKindWrapper xla_recv;
 extern const OpKindWrapper xla_reduce_scatter;
 extern const OpKindWrapper xla_cast_int4;
 extern const OpKindWrapper xla_replication_pad;
 extern const OpKindWrapper xla_replication_pad_backward;
+extern const OpKindWrapper xla_rng_seed;
+extern const OpKindWrapper xla_row_sparse_coalesce;
+extern const OpKindWrapper xla_scaled_dot_product_attention;
+extern const OpKindWrapper xla_scaled_dot_product_attention_backward;
 extern const OpKindWrapper xla_select;
 extern const OpKindWrapper xla_send;
 extern const OpKindWrapper xla_sgd_optimizer_step;
 extern const OpKindWrapper xla_tensor_data;
 extern const OpKindWrapper xla_unselect;
 extern const OpKindWrapper xla_update_slice;
+extern const OpKindWrapper xla_weight_only_quantized_matmul;
 extern const OpKindWrapper xla_custom_sharding;
 extern const OpKindWrapper xla_tpu_custom_call;
 extern const OpKindWrapper xla_gpu_custom_call;
@@ -4,10 +4,46 @@
 #include <iostream>
 #include <unordered_map>
 
+#include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/stablehlo_helper.h"
+#include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/hlo/builder/lib/constants.h"
+#include "xla/shape_util.h"
 
 namespace torch_xla {
+namespace {
+
+// Sign extends the two int4 values packed in each int8 along dimension dim,
+// doubling its size.
+xla::XlaOp UnpackInt4(xla::XlaOp packed, int64_t dim) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(packed);
+  XLA_CHECK_EQ(shape.element_type(), xla::PrimitiveType::S8) << shape;
+  xla::XlaBuilder* builder = packed.builder();
+  xla::XlaOp four = xla::ConstantR0<int8_t>(builder, 4);
+  xla::XlaOp low =
+      xla::ShiftRightArithmetic(xla::ShiftLeft(packed, four), four);
+  xla::XlaOp high = xla::ShiftRightArithmetic(packed, four);
+  std::vector<int64_t> pair_sizes(shape.dimensions().begin(),
+                                  shape.dimensions().end());
+  pair_sizes.insert(pair_sizes.begin() + dim + 1, 1);
+  xla::XlaOp pairs = xla::ConcatInDim(
+      builder, {xla::Reshape(low, pair_sizes), xla::Reshape(high, pair_sizes)},
+      dim + 1);
+  std::vector<int64_t> sizes(shape.dimensions().begin(),
+                             shape.dimensions().end());
+  sizes[dim] *= 2;
+  return xla::Reshape(pairs, sizes);
+}
+
+xla::XlaOp ReduceSum(xla::XlaOp input, absl::Span<const int64_t> dims) {
+  xla::PrimitiveType type = XlaHelpers::TypeOfXlaOp(input);
+  return xla::Reduce(input, xla::Zero(input.builder(), type),
+                     XlaHelpers::CreateAddComputation(type), dims);
+}
+
+}  // namespace
 
 static inline std::string MaybeAppendDecimalForInteger(float v) {
   std::stringstream ss;
@@ -57,4 +93,81 @@ std::string QuantParams::SerializeToAttrDictStr() const {
   return ss.str();
 }
 
+xla::XlaOp BuildWeightOnlyQuantizedMatMul(xla::XlaOp input, xla::XlaOp weight,
+                                          xla::XlaOp scale,
+                                          xla::XlaOp zero_point, int64_t bits,
+                                          int64_t block_size) {
+  XLA_CHECK(bits == 4 || bits == 8) << "Unsupported weight bits: " << bits;
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  xla::PrimitiveType type = input_shape.element_type();
+  // The type the per block partial products are summed in.
+  xla::PrimitiveType accumulation_type = GetAccumulationType(type);
+  int64_t rank = input_shape.dimensions_size();
+  int64_t in_features = input_shape.dimensions(rank - 1);
+  int64_t rows = xla::ShapeUtil::ElementsIn(input_shape) / in_features;
+  xla::XlaOp x = xla::Reshape(input, {rows, in_features});
+  if (bits == 4) {
+    weight = UnpackInt4(weight, 1);
+  }
+  const xla::Shape& weight_shape = ShapeHelper::ShapeOfXlaOp(weight);
+  // The weight only goes through a convert, which XLA fuses into the dot
+  // operand, and the scales apply to the much smaller dot result.
+  xla::XlaOp w = xla::ConvertElementType(weight, type);
+  scale = xla::ConvertElementType(scale, type);
+  if (zero_point.valid()) {
+    zero_point = xla::ConvertElementType(zero_point, type);
+  }
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  xla::XlaOp output;
+  int64_t out_features;
+  if (block_size < 0) {
+    XLA_CHECK_EQ(weight_shape.dimensions_size(), 2) << weight_shape;
+    XLA_CHECK_EQ(weight_shape.dimensions(1), in_features) << weight_shape;
+    out_features = weight_shape.dimensions(0);
+    std::vector<int64_t> output_sizes = {rows, out_features};
+    xla::DotDimensionNumbers dims;
+    dims.add_lhs_contracting_dimensions(1);
+    dims.add_rhs_contracting_dimensions(1);
+    output = xla::DotGeneral(x, w, dims, &precision_config) *
+             xla::BroadcastInDim(scale, output_sizes, {1});
+    if (zero_point.valid()) {
+      output = output -
+               xla::BroadcastInDim(ReduceSum(x, {1}), output_sizes, {0}) *
+                   xla::BroadcastInDim(zero_point, output_sizes, {1});
+    }
+  } else {
+    XLA_CHECK_EQ(weight_shape.dimensions_size(), 3) << weight_shape;
+    XLA_CHECK_EQ(weight_shape.dimensions(1), block_size) << weight_shape;
+    int64_t num_blocks = weight_shape.dimensions(0);
+    XLA_CHECK_EQ(num_blocks * block_size, in_features) << weight_shape;
+    out_features = weight_shape.dimensions(2);
+    xla::XlaOp blocked_x = xla::Reshape(x, {rows, num_blocks, block_size});
+    // [num_blocks, rows, out_features] products of each block of the input
+    // with the matching block of the weight.
+    xla::DotDimensionNumbers dims;
+    dims.add_lhs_batch_dimensions(1);
+    dims.add_rhs_batch_dimensions(0);
+    dims.add_lhs_contracting_dimensions(2);
+    dims.add_rhs_contracting_dimensions(1);
+    xla::XlaOp products =
+        xla::DotGeneral(blocked_x, w, dims, &precision_config) *
+        xla::BroadcastInDim(scale, {num_blocks, rows, out_features}, {0, 2});
+    output = ReduceSum(xla::ConvertElementType(products, accumulation_type),
+                       {0});
+    if (zero_point.valid()) {
+      // [rows, num_blocks] @ [num_blocks, out_features].
+      output = output - xla::ConvertElementType(
+                            xla::Dot(ReduceSum(blocked_x, {2}), zero_point,
+                                     &precision_config),
+                            accumulation_type);
+    }
+    output = xla::ConvertElementType(output, type);
+  }
+  std::vector<int64_t> output_sizes(input_shape.dimensions().begin(),
+                                    input_shape.dimensions().end());
+  output_sizes.back() = out_features;
+  return xla::Reshape(output, output_sizes);
+}
+
 }  // namespace torch_xla
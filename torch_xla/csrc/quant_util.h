@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "xla/hlo/builder/xla_builder.h"
 #include "xla/primitive_util.h"
 
 namespace torch_xla {
@@ -34,6 +35,20 @@ struct QuantParams {
   std::string SerializeToAttrDictStr() const;
 };
 
+// Computes input @ dequantize(weight)^T for a weight-only quantized linear
+// layer without materializing the dequantized weight. The int8 weight is
+// [out_features, in_features] with per-channel scale and zero_point of shape
+// [out_features] when block_size is -1, and [in_features / block_size,
+// block_size, out_features] with [in_features / block_size, out_features]
+// scale and zero_point otherwise. With bits == 4 the weight holds two int4
+// values per int8 along dimension 1, the even one in the low nibble. The
+// dequantized weight is weight * scale - zero_point, and zero_point is
+// optional.
+xla::XlaOp BuildWeightOnlyQuantizedMatMul(xla::XlaOp input, xla::XlaOp weight,
+                                          xla::XlaOp scale,
+                                          xla::XlaOp zero_point, int64_t bits,
+                                          int64_t block_size);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_QUANT_UTIL_H_
@@ -16,6 +16,10 @@
 namespace torch_xla {
 namespace {
 
+// The SplitMix64 increment, and its inverse modulo 2^64.
+constexpr uint64_t kSeedIncrement = 0x9E3779B97F4A7C15ull;
+constexpr uint64_t kSeedIncrementInverse = 0xF1DE83E19937733Dull;
+
 std::string GetDefaultGitGeneratorName() {
   XlaDeviceType hw_type =
       static_cast<XlaDeviceType>(bridge::GetCurrentDevice().type());
@@ -89,6 +93,37 @@ xla::Shape MakeRngShape(const xla::Shape& shape, bool downcast = false) {
 
 }  // namespace
 
+xla::XlaOp BuildCounterRngSeed(xla::XlaOp base_seed, uint64_t offset) {
+  xla::XlaBuilder* builder = base_seed.builder();
+  xla::PrimitiveType type = XlaHelpers::TypeOfXlaOp(base_seed);
+  auto u64 = [&](uint64_t value) {
+    return xla::ConstantR0<uint64_t>(builder, value);
+  };
+  xla::XlaOp z =
+      xla::primitive_util::BitWidth(type) == 64
+          ? xla::BitcastConvertType(base_seed, xla::PrimitiveType::U64)
+          : xla::ConvertElementType(base_seed, xla::PrimitiveType::U64);
+  // SplitMix64: the state moves by the increment for each position of the
+  // counter, and the output is the mix of the state.
+  z = z + u64(AdvanceRngSeed(0, offset));
+  z = xla::Xor(z, xla::ShiftRightLogical(z, u64(30))) *
+      u64(0xBF58476D1CE4E5B9ull);
+  z = xla::Xor(z, xla::ShiftRightLogical(z, u64(27))) *
+      u64(0x94D049BB133111EBull);
+  z = xla::Xor(z, xla::ShiftRightLogical(z, u64(31)));
+  return xla::primitive_util::BitWidth(type) == 64
+             ? xla::BitcastConvertType(z, type)
+             : xla::ConvertElementType(z, type);
+}
+
+uint64_t AdvanceRngSeed(uint64_t seed, uint64_t count) {
+  return seed + count * kSeedIncrement;
+}
+
+uint64_t RngSeedDistance(uint64_t base_seed, uint64_t seed) {
+  return (seed - base_seed) * kSeedIncrementInverse;
+}
+
 xla::XlaOp RngDiscreteUniform(xla::XlaOp seed, const xla::Shape& shape,
                               xla::XlaOp minval, xla::XlaOp maxval) {
   xla::PrimitiveType minval_type = XlaHelpers::TypeOfXlaOp(minval);
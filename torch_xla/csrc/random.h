@@ -18,6 +18,20 @@ xla::XlaOp RngDiscreteUniform(xla::XlaOp seed, const xla::Shape& shape,
 xla::XlaOp RngNormal(xla::XlaOp seed, const xla::Shape& shape, xla::XlaOp mean,
                      xla::XlaOp std);
 
+// Derives the seed of a random op from a base seed and the position of the op
+// in the counter, with SplitMix64. Consecutive offsets yield unrelated seeds,
+// with the same type as base_seed.
+xla::XlaOp BuildCounterRngSeed(xla::XlaOp base_seed, uint64_t offset);
+
+// The seed state reached from seed after count random ops. Each op moves the
+// state by the SplitMix64 increment rather than by one, so that the sequences
+// of close seeds, like s and s + 1 or a seed plus the rank, do not overlap.
+uint64_t AdvanceRngSeed(uint64_t seed, uint64_t count);
+
+// The number of random ops between the seed states base_seed and seed, the
+// inverse of AdvanceRngSeed().
+uint64_t RngSeedDistance(uint64_t base_seed, uint64_t seed);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_RANDOM_H_
@@ -0,0 +1,188 @@
+#include "torch_xla/csrc/recompilation_tracker.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "xla/hlo/ir/hlo_sharding.h"
+
+namespace torch_xla {
+namespace {
+
+// Number of diffs returned by GetDiffs().
+constexpr size_t kMaxDiffs = 32;
+
+// Number of graphs kept by default with PT_XLA_DEBUG=1. Fingerprinting a graph
+// describes each of its nodes, so the tracker is off by default otherwise.
+constexpr int64_t kDebugHistory = 8;
+
+std::string NodeDescription(const torch::lazy::Node* node) {
+  std::string description = node->ToString();
+  const XlaNode* xla_node = dynamic_cast<const XlaNode*>(node);
+  if (xla_node == nullptr || xla_node->shardingHash() == 0) {
+    return description;
+  }
+  for (size_t i = 0; i < xla_node->num_outputs(); ++i) {
+    std::shared_ptr<xla::OpSharding> sharding = xla_node->GetSharding(i);
+    if (sharding != nullptr) {
+      auto hlo_sharding = xla::HloSharding::FromProto(*sharding);
+      absl::StrAppend(&description, ", sharding[", i, "]=",
+                      hlo_sharding.ok() ? hlo_sharding->ToString() : "?");
+    }
+  }
+  return description;
+}
+
+}  // namespace
+
+std::string RecompilationTracker::Diff::ToString() const {
+  std::stringstream ss;
+  ss << "Graph " << graph_hash << " (" << num_nodes << " nodes) ";
+  if (node.empty() && nearest_node.empty()) {
+    ss << "has the same nodes as graph " << nearest_graph_hash
+       << ", and differs by its compilation config, like the buffer donors, "
+          "the memory kinds of its inputs or the sharding settings.\n";
+    return ss.str();
+  }
+  ss << "first differs from graph " << nearest_graph_hash << " ("
+     << nearest_num_nodes << " nodes) at node " << position << "\n";
+  ss << "  New node: " << (node.empty() ? "<none>" : node) << "\n";
+  ss << "  Previous node: " << (nearest_node.empty() ? "<none>" : nearest_node)
+     << "\n";
+  if (!frame.empty()) {
+    ss << "  Created at: " << frame << "\n";
+  } else if (!node.empty()) {
+    ss << "  Set XLA_IR_DEBUG=1 to record the Python frames of the nodes.\n";
+  }
+  return ss.str();
+}
+
+RecompilationTracker* RecompilationTracker::Get() {
+  static RecompilationTracker* tracker = new RecompilationTracker();
+  return tracker;
+}
+
+RecompilationTracker::RecompilationTracker()
+    : capacity_(std::max<int64_t>(
+          runtime::sys_util::GetEnvInt(
+              "XLA_RECOMPILATION_HISTORY",
+              runtime::sys_util::GetEnvBool("PT_XLA_DEBUG", false)
+                  ? kDebugHistory
+                  : 0),
+          0)) {}
+
+RecompilationTracker::GraphFingerprint RecompilationTracker::Fingerprint(
+    c10::ArrayRef<const torch::lazy::Node*> post_order) {
+  std::unordered_map<const torch::lazy::Node*, size_t> positions;
+  positions.reserve(post_order.size());
+  GraphFingerprint fingerprint;
+  fingerprint.reserve(post_order.size());
+  for (const torch::lazy::Node* node : post_order) {
+    NodeFingerprint node_fingerprint;
+    node_fingerprint.structure_hash = node->op().hash();
+    for (const torch::lazy::Output& operand : node->operands()) {
+      auto it = positions.find(operand.node);
+      node_fingerprint.structure_hash = torch::lazy::HashCombine(
+          node_fingerprint.structure_hash,
+          torch::lazy::MHash(
+              it != positions.end() ? static_cast<int64_t>(it->second) : -1,
+              static_cast<int64_t>(operand.index)));
+    }
+    node_fingerprint.description = NodeDescription(node);
+    node_fingerprint.hash = torch::lazy::HashCombine(
+        node_fingerprint.structure_hash,
+        torch::lazy::Hash(node_fingerprint.description));
+    const std::vector<torch::lazy::SourceLocation>& frames =
+        node->metadata().frame_info;
+    if (!frames.empty()) {
+      node_fingerprint.frame =
+          absl::StrCat(frames.front().function, " (", frames.front().file, ":",
+                       frames.front().line, ")");
+    }
+    positions.emplace(node, fingerprint.size());
+    fingerprint.push_back(std::move(node_fingerprint));
+  }
+  return fingerprint;
+}
+
+std::optional<RecompilationTracker::Diff> RecompilationTracker::Record(
+    const torch::lazy::hash_t& hash,
+    c10::ArrayRef<const torch::lazy::Node*> post_order) {
+  if (!IsEnabled()) {
+    return std::nullopt;
+  }
+  GraphFingerprint fingerprint = Fingerprint(post_order);
+  std::lock_guard<std::mutex> lock(lock_);
+  // A graph compiled again, after its eviction from the cache, replaces its
+  // previous fingerprint.
+  graphs_.remove_if([&](const auto& graph) { return graph.first == hash; });
+
+  // The nearest graph has the most nodes with the same structure at the same
+  // positions, then the closest number of nodes.
+  const std::pair<torch::lazy::hash_t, GraphFingerprint>* nearest = nullptr;
+  size_t nearest_score = 0;
+  size_t nearest_size_diff = 0;
+  for (const auto& graph : graphs_) {
+    const GraphFingerprint& other = graph.second;
+    size_t common = std::min(fingerprint.size(), other.size());
+    size_t score = 0;
+    for (size_t i = 0; i < common; ++i) {
+      score += fingerprint[i].structure_hash == other[i].structure_hash;
+    }
+    size_t size_diff = std::max(fingerprint.size(), other.size()) - common;
+    if (nearest == nullptr || score > nearest_score ||
+        (score == nearest_score && size_diff < nearest_size_diff)) {
+      nearest = &graph;
+      nearest_score = score;
+      nearest_size_diff = size_diff;
+    }
+  }
+
+  std::optional<Diff> diff;
+  if (nearest != nullptr) {
+    const GraphFingerprint& other = nearest->second;
+    diff = Diff();
+    diff->graph_hash = torch::lazy::HashToString(hash);
+    diff->nearest_graph_hash = torch::lazy::HashToString(nearest->first);
+    diff->num_nodes = fingerprint.size();
+    diff->nearest_num_nodes = other.size();
+    size_t common = std::min(fingerprint.size(), other.size());
+    while (diff->position < common &&
+           fingerprint[diff->position].hash == other[diff->position].hash) {
+      ++diff->position;
+    }
+    if (diff->position < fingerprint.size()) {
+      diff->node = fingerprint[diff->position].description;
+      diff->frame = fingerprint[diff->position].frame;
+    }
+    if (diff->position < other.size()) {
+      diff->nearest_node = other[diff->position].description;
+    }
+    diffs_.push_back(*diff);
+    if (diffs_.size() > kMaxDiffs) {
+      diffs_.pop_front();
+    }
+  }
+
+  graphs_.emplace_front(hash, std::move(fingerprint));
+  if (graphs_.size() > capacity_) {
+    graphs_.pop_back();
+  }
+  return diff;
+}
+
+std::vector<RecompilationTracker::Diff> RecompilationTracker::GetDiffs() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return std::vector<Diff>(diffs_.begin(), diffs_.end());
+}
+
+void RecompilationTracker::Clear() {
+  std::lock_guard<std::mutex> lock(lock_);
+  graphs_.clear();
+  diffs_.clear();
+}
+
+}  // namespace torch_xla
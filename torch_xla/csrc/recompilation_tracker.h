@@ -0,0 +1,86 @@
+#ifndef XLA_TORCH_XLA_CSRC_RECOMPILATION_TRACKER_H_
+#define XLA_TORCH_XLA_CSRC_RECOMPILATION_TRACKER_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <deque>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch_xla {
+
+// Keeps a structural fingerprint of the graphs compiled recently, to explain
+// the compilation of a new graph by its first difference with the most similar
+// of them. The number of graphs kept is read from XLA_RECOMPILATION_HISTORY,
+// and zero disables the tracker. It defaults to 8 with PT_XLA_DEBUG=1, and to
+// zero otherwise.
+class RecompilationTracker {
+ public:
+  // The difference between a newly compiled graph and its nearest graph.
+  struct Diff {
+    std::string ToString() const;
+
+    std::string graph_hash;
+    std::string nearest_graph_hash;
+    size_t num_nodes = 0;
+    size_t nearest_num_nodes = 0;
+    // Position in the post orders of the first node which differs.
+    size_t position = 0;
+    // The differing nodes, with their shapes, shardings and attributes. A node
+    // is empty when the position is past the end of its graph.
+    std::string node;
+    std::string nearest_node;
+    // The Python frame which created the differing node of the new graph, if
+    // the IR was recorded with XLA_IR_DEBUG=1.
+    std::string frame;
+  };
+
+  static RecompilationTracker* Get();
+
+  bool IsEnabled() const { return capacity_ > 0; }
+
+  // Records the post order of the graph compiled for hash, and returns its
+  // difference with the nearest graph recorded before, if any.
+  std::optional<Diff> Record(
+      const torch::lazy::hash_t& hash,
+      c10::ArrayRef<const torch::lazy::Node*> post_order);
+
+  // Returns the most recent diffs, oldest first.
+  std::vector<Diff> GetDiffs() const;
+
+  // Forgets the recorded graphs and diffs.
+  void Clear();
+
+ private:
+  struct NodeFingerprint {
+    // Covers the op kind and the positions of the operands in the post order.
+    torch::lazy::hash_t structure_hash;
+    // Also covers the shapes, dtypes, shardings and attributes of the node,
+    // like the value of scalar constants.
+    torch::lazy::hash_t hash;
+    std::string description;
+    std::string frame;
+  };
+
+  using GraphFingerprint = std::vector<NodeFingerprint>;
+
+  RecompilationTracker();
+
+  static GraphFingerprint Fingerprint(
+      c10::ArrayRef<const torch::lazy::Node*> post_order);
+
+  const size_t capacity_;
+  mutable std::mutex lock_;
+  // Most recently compiled first.
+  std::list<std::pair<torch::lazy::hash_t, GraphFingerprint>> graphs_;
+  std::deque<Diff> diffs_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_RECOMPILATION_TRACKER_H_
@@ -0,0 +1,329 @@
+#include "torch_xla/csrc/rematerialization.h"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The budget set with SetRematerializationBudget(), or -1 if none was set.
+std::atomic<int64_t> budget_override(-1);
+
+// Relative cost, per output element, of recomputing the nodes which may be
+// rematerialized.
+std::optional<int64_t> RecomputeCost(const torch::lazy::Node* node) {
+  static const auto* const costs =
+      new std::unordered_map<std::string, int64_t>({
+          {"aten::abs", 1},
+          {"aten::add", 1},
+          {"aten::clamp", 1},
+          {"aten::div", 1},
+          {"aten::elu", 4},
+          {"aten::exp", 4},
+          {"aten::gelu", 8},
+          {"aten::hardsigmoid", 2},
+          {"aten::hardswish", 2},
+          {"aten::hardtanh", 1},
+          {"aten::leaky_relu", 1},
+          {"aten::log_softmax", 8},
+          {"aten::maximum", 1},
+          {"aten::minimum", 1},
+          {"aten::mul", 1},
+          {"aten::native_batch_norm", 8},
+          {"aten::neg", 1},
+          {"aten::relu", 1},
+          {"aten::sigmoid", 4},
+          {"aten::silu", 4},
+          {"aten::softmax", 8},
+          {"aten::sub", 1},
+          {"aten::tanh", 4},
+          {"aten::where", 1},
+          {"xla::cast", 1},
+      });
+  auto it = costs->find(node->op().ToString());
+  if (it == costs->end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+// Live bytes at each position of the post order, supporting range updates and
+// maximum queries in logarithmic time.
+class LiveBytesTree {
+ public:
+  explicit LiveBytesTree(size_t size)
+      : size_(size), max_(4 * size, 0), add_(4 * size, 0) {}
+
+  // Adds delta to the positions in [lo, hi].
+  void Add(size_t lo, size_t hi, int64_t delta) {
+    if (lo <= hi) {
+      Add(1, 0, size_ - 1, lo, hi, delta);
+    }
+  }
+
+  int64_t Max() const { return max_[1]; }
+
+  // Returns the first position holding Max().
+  size_t ArgMax() const {
+    size_t node = 1;
+    size_t lo = 0;
+    size_t hi = size_ - 1;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (max_[2 * node] >= max_[2 * node + 1]) {
+        node = 2 * node;
+        hi = mid;
+      } else {
+        node = 2 * node + 1;
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+ private:
+  void Add(size_t node, size_t lo, size_t hi, size_t from, size_t to,
+           int64_t delta) {
+    if (to < lo || hi < from) {
+      return;
+    }
+    if (from <= lo && hi <= to) {
+      max_[node] += delta;
+      add_[node] += delta;
+      return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    Add(2 * node, lo, mid, from, to, delta);
+    Add(2 * node + 1, mid + 1, hi, from, to, delta);
+    max_[node] = add_[node] + std::max(max_[2 * node], max_[2 * node + 1]);
+  }
+
+  size_t size_;
+  std::vector<int64_t> max_;
+  std::vector<int64_t> add_;
+};
+
+struct Candidate {
+  size_t position = 0;
+  // The node is dropped after its use at position drop, and recomputed for
+  // its use at position reuse.
+  size_t drop = 0;
+  size_t reuse = 0;
+  torch::lazy::Output trigger;
+  int64_t bytes = 0;
+  int64_t flops = 0;
+};
+
+}  // namespace
+
+int64_t GetRematerializationBudget() {
+  const int64_t budget = budget_override.load();
+  if (budget >= 0) {
+    return budget;
+  }
+  static const int64_t env_budget =
+      runtime::sys_util::GetEnvInt("XLA_REMAT_MEMORY_BUDGET", 0);
+  return env_budget;
+}
+
+void SetRematerializationBudget(int64_t budget) {
+  budget_override = std::max<int64_t>(budget, 0);
+}
+
+std::string RematerializationPlan::ToString() const {
+  std::stringstream ss;
+  ss << "Rematerialized " << num_recomputes << " nodes, peak " << peak_bytes
+     << " -> " << rematerialized_peak_bytes << " bytes, " << extra_flops
+     << " extra flops\n";
+  for (const auto& [user, node_recomputes] : recomputes) {
+    for (const Recompute& recompute : node_recomputes) {
+      ss << "  " << recompute.node->ToString() << " before "
+         << user->ToString() << "\n";
+    }
+  }
+  return ss.str();
+}
+
+RematerializationPlan PlanRematerialization(
+    c10::ArrayRef<const torch::lazy::Node*> post_order,
+    absl::Span<const torch::lazy::Output> roots, int64_t budget) {
+  RematerializationPlan plan;
+  if (budget <= 0 || post_order.empty()) {
+    return plan;
+  }
+  const size_t end = post_order.size();
+  std::unordered_map<const torch::lazy::Node*, size_t> position;
+  position.reserve(post_order.size());
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    position.emplace(post_order[i], i);
+  }
+  std::vector<std::vector<size_t>> uses(post_order.size());
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    for (const torch::lazy::Output& operand : post_order[i]->operands()) {
+      auto it = position.find(operand.node);
+      if (it == position.end()) {
+        return plan;
+      }
+      std::vector<size_t>& node_uses = uses[it->second];
+      if (node_uses.empty() || node_uses.back() != i) {
+        node_uses.push_back(i);
+      }
+    }
+  }
+  // The roots are alive until the end of the graph.
+  std::vector<bool> is_root(post_order.size(), false);
+  for (const torch::lazy::Output& root : roots) {
+    auto it = position.find(root.node);
+    if (it != position.end()) {
+      is_root[it->second] = true;
+    }
+  }
+  auto last_use = [&](size_t i) {
+    if (is_root[i]) {
+      return end;
+    }
+    return uses[i].empty() ? i : uses[i].back();
+  };
+
+  // Device data and constants are not activations, and are ignored.
+  LiveBytesTree live_bytes(end + 1);
+  std::vector<int64_t> bytes(post_order.size(), 0);
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    const XlaNode* node = dynamic_cast<const XlaNode*>(post_order[i]);
+    if (node == nullptr || node->operands().empty()) {
+      continue;
+    }
+    for (size_t j = 0; j < node->num_outputs(); ++j) {
+      bytes[i] += xla::ShapeUtil::ByteSizeOf(node->xla_shape(j),
+                                             /*pointer_size=*/sizeof(void*));
+    }
+    live_bytes.Add(i, last_use(i), bytes[i]);
+  }
+  plan.peak_bytes = live_bytes.Max();
+  plan.rematerialized_peak_bytes = plan.peak_bytes;
+  if (plan.peak_bytes <= budget) {
+    return plan;
+  }
+
+  std::vector<Candidate> candidates;
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    const XlaNode* node = dynamic_cast<const XlaNode*>(post_order[i]);
+    std::optional<int64_t> cost =
+        node != nullptr ? RecomputeCost(node) : std::nullopt;
+    if (!cost || is_root[i] || uses[i].size() < 2 ||
+        !node->dynamic_dims().empty() || node->shardingHash() != 0) {
+      continue;
+    }
+    // Drops the node over the largest gap between two of its uses.
+    Candidate candidate;
+    candidate.position = i;
+    for (size_t j = 1; j < uses[i].size(); ++j) {
+      if (uses[i][j] - uses[i][j - 1] > candidate.reuse - candidate.drop) {
+        candidate.drop = uses[i][j - 1];
+        candidate.reuse = uses[i][j];
+      }
+    }
+    if (candidate.reuse - candidate.drop < 2) {
+      continue;
+    }
+    // The operands of the recomputation must still be alive.
+    bool operands_alive = true;
+    for (const torch::lazy::Output& operand : node->operands()) {
+      size_t operand_position = position.at(operand.node);
+      if (!operand.node->operands().empty() &&
+          last_use(operand_position) < candidate.reuse) {
+        operands_alive = false;
+        break;
+      }
+    }
+    if (!operands_alive) {
+      continue;
+    }
+    // The trigger is the latest operand of the reusing node. If it was computed
+    // before the drop, the recomputation could be scheduled next to the
+    // original computation, and save nothing.
+    std::optional<size_t> trigger_position;
+    for (const torch::lazy::Output& operand :
+         post_order[candidate.reuse]->operands()) {
+      size_t operand_position = position.at(operand.node);
+      if (operand.node != node &&
+          (!trigger_position || operand_position > *trigger_position)) {
+        trigger_position = operand_position;
+        candidate.trigger = operand;
+      }
+    }
+    if (!trigger_position || *trigger_position <= candidate.drop) {
+      continue;
+    }
+    candidate.bytes = bytes[i];
+    for (size_t j = 0; j < node->num_outputs(); ++j) {
+      candidate.flops +=
+          *cost * xla::ShapeUtil::ElementsInRecursive(node->xla_shape(j));
+    }
+    candidates.push_back(std::move(candidate));
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              if (a.bytes != b.bytes) {
+                return a.bytes > b.bytes;
+              }
+              return a.flops != b.flops ? a.flops < b.flops
+                                        : a.position < b.position;
+            });
+
+  // Greedily drops the largest candidate alive at the peak, until the peak
+  // fits in the budget. The operands and trigger of a recomputation must not
+  // be rematerialized themselves, as the recomputation would then keep their
+  // original value alive.
+  std::vector<bool> used(candidates.size(), false);
+  std::unordered_set<const torch::lazy::Node*> rematerialized;
+  std::unordered_set<const torch::lazy::Node*> pinned;
+  while (live_bytes.Max() > budget) {
+    const size_t peak = live_bytes.ArgMax();
+    std::optional<size_t> chosen;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      const Candidate& candidate = candidates[i];
+      if (used[i] || peak <= candidate.drop || peak >= candidate.reuse) {
+        continue;
+      }
+      const torch::lazy::Node* node = post_order[candidate.position];
+      bool blocked = pinned.count(node) > 0 ||
+                     rematerialized.count(candidate.trigger.node) > 0;
+      for (const torch::lazy::Output& operand : node->operands()) {
+        blocked = blocked || rematerialized.count(operand.node) > 0;
+      }
+      used[i] = true;
+      if (!blocked) {
+        chosen = i;
+        break;
+      }
+    }
+    if (!chosen) {
+      break;
+    }
+    const Candidate& candidate = candidates[*chosen];
+    const torch::lazy::Node* node = post_order[candidate.position];
+    live_bytes.Add(candidate.drop + 1, candidate.reuse - 1, -candidate.bytes);
+    rematerialized.insert(node);
+    pinned.insert(candidate.trigger.node);
+    for (const torch::lazy::Output& operand : node->operands()) {
+      pinned.insert(operand.node);
+    }
+    plan.recomputes[post_order[candidate.reuse]].push_back(
+        {node, candidate.trigger});
+    ++plan.num_recomputes;
+    plan.extra_flops += candidate.flops;
+  }
+  plan.rematerialized_peak_bytes = live_bytes.Max();
+  return plan;
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,62 @@
+#ifndef XLA_TORCH_XLA_CSRC_REMATERIALIZATION_H_
+#define XLA_TORCH_XLA_CSRC_REMATERIALIZATION_H_
+
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace torch_xla {
+
+// Returns the peak activation memory, in bytes, above which graphs are
+// rematerialized. Unless overridden by SetRematerializationBudget(), it is
+// read from XLA_REMAT_MEMORY_BUDGET. Zero disables rematerialization.
+int64_t GetRematerializationBudget();
+
+// Overrides the budget of the graphs compiled from now on.
+void SetRematerializationBudget(int64_t budget);
+
+// The activations to drop after their forward uses, and to recompute right
+// before their first backward use.
+struct RematerializationPlan {
+  struct Recompute {
+    // The node whose outputs are recomputed.
+    const torch::lazy::Node* node = nullptr;
+    // An output computed after the forward uses of the node. The operands of
+    // the recomputation are tied to it by an optimization barrier, so that
+    // XLA neither hoists the recomputation into the forward nor CSEs it with
+    // the original computation.
+    torch::lazy::Output trigger;
+  };
+
+  bool empty() const { return recomputes.empty(); }
+
+  std::string ToString() const;
+
+  // Keyed by the first node using the recomputed outputs.
+  std::unordered_map<const torch::lazy::Node*, std::vector<Recompute>>
+      recomputes;
+  size_t num_recomputes = 0;
+  // Estimated peak activation memory before and after rematerialization.
+  int64_t peak_bytes = 0;
+  int64_t rematerialized_peak_bytes = 0;
+  // Estimated element-wise operations added by the recomputations.
+  int64_t extra_flops = 0;
+};
+
+// Chooses the cheap to recompute nodes of post_order (element-wise ops,
+// normalizations and softmaxes) whose outputs stay alive the longest between
+// their uses, until the estimated peak activation memory of the graph fits in
+// budget or no candidate is left. The estimate follows the post order, and
+// ignores the device data and the memory reuse done by XLA.
+RematerializationPlan PlanRematerialization(
+    c10::ArrayRef<const torch::lazy::Node*> post_order,
+    absl::Span<const torch::lazy::Output> roots, int64_t budget);
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_REMATERIALIZATION_H_
@@ -0,0 +1,113 @@
+#include "torch_xla/csrc/runtime/buffer_tracker.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+thread_local std::string current_site;
+
+}  // namespace
+
+BufferTracker::ScopedSite::ScopedSite(std::string site) {
+  previous_site_ = std::exchange(current_site, std::move(site));
+}
+
+BufferTracker::ScopedSite::~ScopedSite() {
+  current_site = std::move(previous_site_);
+}
+
+BufferTracker* BufferTracker::Get() {
+  static BufferTracker* tracker = new BufferTracker();
+  return tracker;
+}
+
+BufferTracker::BufferTracker()
+    : enabled_(sys_util::GetEnvBool(env::kEnvTrackBuffers, false)) {}
+
+void BufferTracker::SetEnabled(bool enabled, bool capture_frames) {
+  std::lock_guard<std::mutex> lock(lock_);
+  enabled_.store(enabled);
+  capture_frames_.store(enabled && capture_frames);
+  if (!enabled) {
+    buffers_.clear();
+  }
+}
+
+void BufferTracker::SetFrameProvider(
+    std::function<std::string()> frame_provider) {
+  std::lock_guard<std::mutex> lock(lock_);
+  frame_provider_ = std::move(frame_provider);
+}
+
+std::string BufferTracker::MakeSite(const std::string& site) const {
+  if (!capture_frames_.load(std::memory_order_relaxed)) {
+    return site;
+  }
+  std::function<std::string()> frame_provider;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    frame_provider = frame_provider_;
+  }
+  // The provider may need to take the Python GIL, so it must not run under
+  // the tracker lock.
+  std::string frame = frame_provider ? frame_provider() : "";
+  return frame.empty() ? site : site + " @ " + frame;
+}
+
+std::string BufferTracker::CurrentSite(const std::string& default_site) const {
+  return current_site.empty() ? MakeSite(default_site) : current_site;
+}
+
+std::shared_ptr<xla::PjRtBuffer> BufferTracker::Track(
+    std::unique_ptr<xla::PjRtBuffer> buffer, const std::string& device,
+    const std::string& site) {
+  if (!IsEnabled()) {
+    return std::move(buffer);
+  }
+  BufferInfo info;
+  info.id = next_id_.fetch_add(1);
+  info.device = device;
+  info.shape = buffer->on_device_shape().ToString();
+  absl::StatusOr<size_t> size = buffer->GetOnDeviceSizeInBytes();
+  info.size_in_bytes =
+      size.ok() ? *size : xla::ShapeUtil::ByteSizeOf(buffer->on_device_shape());
+  info.site = site;
+  int64_t id = info.id;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    buffers_.emplace(id, std::move(info));
+  }
+  return std::shared_ptr<xla::PjRtBuffer>(
+      buffer.release(), [this, id](xla::PjRtBuffer* buffer) {
+        Untrack(id);
+        delete buffer;
+      });
+}
+
+std::vector<BufferTracker::BufferInfo> BufferTracker::GetLiveBuffers() const {
+  std::vector<BufferInfo> buffers;
+  std::lock_guard<std::mutex> lock(lock_);
+  buffers.reserve(buffers_.size());
+  for (const auto& [id, info] : buffers_) {
+    buffers.push_back(info);
+  }
+  std::sort(
+      buffers.begin(), buffers.end(),
+      [](const BufferInfo& a, const BufferInfo& b) { return a.id < b.id; });
+  return buffers;
+}
+
+void BufferTracker::Untrack(int64_t id) {
+  std::lock_guard<std::mutex> lock(lock_);
+  buffers_.erase(id);
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -0,0 +1,88 @@
+#ifndef XLA_CLIENT_BUFFER_TRACKER_H_
+#define XLA_CLIENT_BUFFER_TRACKER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xla/pjrt/pjrt_client.h"
+
+namespace torch_xla {
+namespace runtime {
+
+// Opt-in registry of the live device buffers, recording for each buffer its
+// size, device and the site which created it. While disabled, tracking a
+// buffer costs a single atomic load.
+class BufferTracker {
+ public:
+  struct BufferInfo {
+    // Increases with the creation order of the buffers.
+    int64_t id;
+    std::string device;
+    std::string shape;
+    int64_t size_in_bytes;
+    std::string site;
+  };
+
+  // Sets the site of the buffers the current thread creates while it is alive.
+  class ScopedSite {
+   public:
+    explicit ScopedSite(std::string site);
+    ~ScopedSite();
+
+    ScopedSite(const ScopedSite&) = delete;
+    ScopedSite& operator=(const ScopedSite&) = delete;
+
+   private:
+    std::string previous_site_;
+  };
+
+  static BufferTracker* Get();
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Disabling the tracker forgets the buffers tracked so far.
+  void SetEnabled(bool enabled, bool capture_frames = false);
+
+  // Sets the function returning the Python frame of the calling thread,
+  // appended to the sites when frame capture is enabled.
+  void SetFrameProvider(std::function<std::string()> frame_provider);
+
+  // Returns `site`, followed by the Python frame of the calling thread when
+  // frame capture is enabled.
+  std::string MakeSite(const std::string& site) const;
+
+  // Returns the site set by the innermost ScopedSite of the current thread,
+  // or MakeSite(default_site) if there is none.
+  std::string CurrentSite(const std::string& default_site) const;
+
+  // Takes the ownership of `buffer`. When tracking is enabled, the buffer is
+  // registered under `site` until it is destroyed.
+  std::shared_ptr<xla::PjRtBuffer> Track(
+      std::unique_ptr<xla::PjRtBuffer> buffer, const std::string& device,
+      const std::string& site);
+
+  std::vector<BufferInfo> GetLiveBuffers() const;
+
+ private:
+  BufferTracker();
+
+  void Untrack(int64_t id);
+
+  std::atomic<bool> enabled_;
+  std::atomic<bool> capture_frames_{false};
+  std::atomic<int64_t> next_id_{0};
+  mutable std::mutex lock_;
+  std::unordered_map<int64_t, BufferInfo> buffers_;
+  std::function<std::string()> frame_provider_;
+};
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_BUFFER_TRACKER_H_
@@ -81,6 +81,10 @@ class ComputationClient {
 
     virtual xla::OpSharding GetSharding() const = 0;
 
+    // Returns the kind of the memory space holding the data, or an empty
+    // string if it is the default memory space of its device.
+    virtual std::string memory_kind() const { return ""; }
+
    private:
     std::string xla_device_;
     xla::Shape xla_shape_;
@@ -89,6 +93,20 @@ class ComputationClient {
 
   using DataPtr = std::shared_ptr<Data>;
 
+  // Memory footprint and estimated cost of a compiled computation. Values the
+  // runtime cannot report are -1.
+  struct ComputationStats {
+    int64_t argument_size_in_bytes = -1;
+    int64_t output_size_in_bytes = -1;
+    int64_t alias_size_in_bytes = -1;
+    int64_t temp_size_in_bytes = -1;
+    int64_t generated_code_size_in_bytes = -1;
+    // From the HLO cost analysis of the compiled module.
+    double flops = -1;
+    double transcendentals = -1;
+    double bytes_accessed = -1;
+  };
+
   // There are 4 different Computation class being used here
   // 1. torch::lazy::Computation represent a general computation from LTC
   // perspective.
@@ -199,6 +217,8 @@ class ComputationClient {
       XLA_ERROR() << "Unimplemented";
     }
 
+    virtual ComputationStats get_computation_stats() const { return {}; }
+
    private:
     xla::XlaComputation computation_;
     xla::ProgramShape program_shape_;
@@ -313,6 +333,19 @@ class ComputationClient {
   // Copies `data->buffer` to `dst` device buffer.
   virtual DataPtr CopyToDevice(DataPtr data, std::string dst) = 0;
 
+  // Returns the kinds of the memory spaces of `device` (e.g. "device" and
+  // "pinned_host"), starting with its default memory space.
+  virtual std::vector<std::string> GetMemoryKinds(const std::string& device) {
+    return {};
+  }
+
+  // Copies `data` to the memory space of kind `memory_kind` of its device.
+  // Returns `data` if it is already there.
+  virtual DataPtr CopyToMemoryKind(DataPtr data,
+                                   const std::string& memory_kind) {
+    XLA_ERROR() << "Memory kinds are not supported by this runtime";
+  }
+
   // Reads the tensor literal values stored at TPU server sites, behind the
   // supplied handles.
   // Note: `TransferFromDevice` call will block until the `DataPtrs` are ready
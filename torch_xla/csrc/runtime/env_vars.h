@@ -37,6 +37,8 @@ inline constexpr char kEnvDistSvcMaxMissingHeartbeats[] =
     "DIST_SERVICE_MAX_MISSING_HEARTBEATS";
 inline constexpr char kEnvDistSvcShutdownTimeoutInMin[] =
     "DIST_SERVICE_SHUTDOWN_TIMEOUT_IN_MIN";
+inline constexpr char kEnvTrackBuffers[] = "XLA_TRACK_BUFFERS";
+inline constexpr char kEnvEventLog[] = "XLA_EVENT_LOG";
 
 }  // namespace env
 }  // namespace runtime
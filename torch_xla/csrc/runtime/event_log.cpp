@@ -0,0 +1,220 @@
+#include "torch_xla/csrc/runtime/event_log.h"
+
+#include <chrono>
+#include <utility>
+
+#include "single_include/nlohmann/json.hpp"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+// Events appended while the writer is this far behind are dropped.
+constexpr size_t kMaxPendingEvents = 1 << 16;
+// Number of events kept in memory for the live analysis.
+constexpr size_t kMaxRecentEvents = 4096;
+
+thread_local const char* current_reason = nullptr;
+
+}  // namespace
+
+EventLog::ScopedReason::ScopedReason(const char* reason)
+    : previous_reason_(current_reason) {
+  if (current_reason == nullptr) {
+    current_reason = reason;
+  }
+}
+
+EventLog::ScopedReason::~ScopedReason() { current_reason = previous_reason_; }
+
+std::string EventLog::CurrentReason() {
+  return current_reason != nullptr ? current_reason : "other";
+}
+
+EventLog* EventLog::Get() {
+  static EventLog* event_log = new EventLog();
+  return event_log;
+}
+
+EventLog::EventLog() {
+  SetInMemory(sys_util::GetEnvBool("PT_XLA_DEBUG", false));
+  Open(sys_util::GetEnvString(env::kEnvEventLog, ""));
+}
+
+bool EventLog::IsInMemory() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return in_memory_;
+}
+
+std::string EventLog::path() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return path_;
+}
+
+void EventLog::Open(const std::string& path) {
+  Close();
+  if (path.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(lock_);
+  file_.open(path, std::ios::out | std::ios::app);
+  XLA_CHECK(file_.is_open()) << "Failed to open the event log " << path;
+  path_ = path;
+  stop_ = false;
+  writer_ = std::thread([this]() { Run(); });
+  UpdateEnabled();
+}
+
+void EventLog::SetInMemory(bool in_memory) {
+  std::lock_guard<std::mutex> lock(lock_);
+  in_memory_ = in_memory;
+  UpdateEnabled();
+}
+
+void EventLog::UpdateEnabled() {
+  bool enabled = in_memory_ || (!path_.empty() && !stop_);
+  if (!enabled) {
+    recent_.clear();
+  }
+  enabled_.store(enabled);
+}
+
+void EventLog::Close() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!writer_.joinable()) {
+      return;
+    }
+    stop_ = true;
+    UpdateEnabled();
+  }
+  cv_.notify_all();
+  // The writer drains the pending events before exiting.
+  writer_.join();
+  std::lock_guard<std::mutex> lock(lock_);
+  file_.close();
+  path_.clear();
+}
+
+void EventLog::Append(Event event) {
+  if (!IsEnabled()) {
+    return;
+  }
+  if (event.timestamp_us == 0) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    event.timestamp_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  }
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    recent_.push_back(event);
+    if (recent_.size() > kMaxRecentEvents) {
+      recent_.pop_front();
+    }
+    if (path_.empty() || stop_) {
+      return;
+    }
+    if (pending_.size() >= kMaxPendingEvents) {
+      XLA_COUNTER("EventLogDroppedEvents", 1);
+      return;
+    }
+    pending_.push_back(std::move(event));
+  }
+  cv_.notify_all();
+}
+
+void EventLog::Flush() {
+  std::unique_lock<std::mutex> lock(lock_);
+  cv_.wait(lock, [this]() {
+    return path_.empty() || (pending_.empty() && writing_ == 0);
+  });
+}
+
+std::vector<EventLog::Event> EventLog::GetRecentEvents() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return std::vector<Event>(recent_.begin(), recent_.end());
+}
+
+void EventLog::Run() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      break;
+    }
+    std::deque<Event> events;
+    events.swap(pending_);
+    writing_ = events.size();
+    lock.unlock();
+    // Only the writer touches the file while it runs.
+    for (const Event& event : events) {
+      file_ << ToJson(event) << "\n";
+    }
+    file_.flush();
+    lock.lock();
+    writing_ = 0;
+    cv_.notify_all();
+  }
+}
+
+std::string EventLog::ToJson(const Event& event) {
+  nlohmann::json json = {
+      {"type", event.type},
+      {"timestamp_us", event.timestamp_us},
+      {"graph_hash", event.graph_hash},
+      {"reason", event.reason},
+      {"frame", event.frame},
+      {"device", event.device},
+      {"cache", event.cache},
+      {"compile_time_us", event.compile_time_us},
+      {"execute_time_us", event.execute_time_us},
+      {"input_bytes", event.input_bytes},
+      {"output_bytes", event.output_bytes},
+      {"num_parameters", event.num_parameters},
+      {"num_scalar_parameters", event.num_scalar_parameters},
+      {"padding_bytes", event.padding_bytes},
+      {"recompiled_node", event.recompiled_node},
+      {"phase_time_us", event.phase_time_us},
+  };
+  return json.dump();
+}
+
+std::optional<EventLog::Event> EventLog::FromJson(const std::string& line) {
+  nlohmann::json json =
+      nlohmann::json::parse(line, /*cb=*/nullptr, /*allow_exceptions=*/false);
+  if (!json.is_object()) {
+    return std::nullopt;
+  }
+  Event event;
+  event.type = json.value("type", "");
+  event.timestamp_us = json.value("timestamp_us", int64_t{0});
+  event.graph_hash = json.value("graph_hash", "");
+  event.reason = json.value("reason", "");
+  event.frame = json.value("frame", "");
+  event.device = json.value("device", "");
+  event.cache = json.value("cache", "");
+  event.compile_time_us = json.value("compile_time_us", int64_t{0});
+  event.execute_time_us = json.value("execute_time_us", int64_t{0});
+  event.input_bytes = json.value("input_bytes", int64_t{0});
+  event.output_bytes = json.value("output_bytes", int64_t{0});
+  event.num_parameters = json.value("num_parameters", int64_t{0});
+  event.num_scalar_parameters = json.value("num_scalar_parameters", int64_t{0});
+  event.padding_bytes = json.value("padding_bytes", int64_t{0});
+  event.recompiled_node = json.value("recompiled_node", "");
+  auto phase_time_us = json.find("phase_time_us");
+  if (phase_time_us != json.end() && phase_time_us->is_object()) {
+    for (auto it = phase_time_us->begin(); it != phase_time_us->end(); ++it) {
+      if (it.value().is_number_integer()) {
+        event.phase_time_us[it.key()] = it.value().get<int64_t>();
+      }
+    }
+  }
+  return event;
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
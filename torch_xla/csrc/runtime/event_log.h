@@ -0,0 +1,132 @@
+#ifndef XLA_CLIENT_EVENT_LOG_H_
+#define XLA_CLIENT_EVENT_LOG_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace torch_xla {
+namespace runtime {
+
+// Append-only log of the graph compilations and executions, written by a
+// background thread as one JSON object per line. It is enabled by setting
+// XLA_EVENT_LOG to the path of the log, or with Open(). The most recent events
+// are also kept in memory for the live performance analysis, which is enabled
+// without a file by SetInMemory() or PT_XLA_DEBUG=1. While disabled, logging an
+// event costs a single atomic load.
+class EventLog {
+ public:
+  struct Event {
+    // "compile", "execute" or "step", for the end of a step.
+    std::string type;
+    // Microseconds since the Unix epoch, set by Append() when zero.
+    int64_t timestamp_us = 0;
+    std::string graph_hash;
+    // What triggered the sync of the graph, see ScopedReason. A "to_cpu" sync
+    // called from torch/_tensor_str.py, which prints tensors, is a "print".
+    std::string reason;
+    // The Python frame which triggered the sync.
+    std::string frame;
+    std::string device;
+    // "miss" when the sync compiled the graph, otherwise the cache tier which
+    // provided it: "memory" or "persistent".
+    std::string cache;
+    int64_t compile_time_us = 0;
+    int64_t execute_time_us = 0;
+    int64_t input_bytes = 0;
+    int64_t output_bytes = 0;
+    // The graph of a compile event. The padding is the difference between the
+    // sizes of the inputs and outputs on the device and their logical sizes,
+    // and is not computed for SPMD graphs.
+    int64_t num_parameters = 0;
+    int64_t num_scalar_parameters = 0;
+    int64_t padding_bytes = 0;
+    // The first node which differs from the nearest graph compiled before, see
+    // RecompilationTracker.
+    std::string recompiled_node;
+    // The breakdown of a step event by phase, see StepBreakdown. "Step" is the
+    // wall time of the step, and "Tracing" the host time outside the phases.
+    std::map<std::string, int64_t> phase_time_us;
+  };
+
+  // Sets the reason of the syncs done by the current thread while it is alive.
+  // The outermost reason wins, as it is the closest to the user code.
+  class ScopedReason {
+   public:
+    explicit ScopedReason(const char* reason);
+    ~ScopedReason();
+
+    ScopedReason(const ScopedReason&) = delete;
+    ScopedReason& operator=(const ScopedReason&) = delete;
+
+   private:
+    const char* previous_reason_;
+  };
+
+  // Returns the reason set for the current thread, or "other".
+  static std::string CurrentReason();
+
+  static EventLog* Get();
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  bool IsInMemory() const;
+
+  std::string path() const;
+
+  // Appends the events logged from now on to the file at path. An empty path
+  // disables the log.
+  void Open(const std::string& path);
+
+  // Keeps the recent events in memory even when no file is open.
+  void SetInMemory(bool in_memory);
+
+  void Append(Event event);
+
+  // Blocks until the appended events are written to the file.
+  void Flush();
+
+  // Returns the events appended most recently, oldest first.
+  std::vector<Event> GetRecentEvents() const;
+
+  static std::string ToJson(const Event& event);
+  // Returns nullopt for malformed lines, like the last line of the log of a
+  // process which crashed while writing it.
+  static std::optional<Event> FromJson(const std::string& line);
+
+ private:
+  EventLog();
+
+  void Close();
+
+  void Run();
+
+  // Requires lock_.
+  void UpdateEnabled();
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex lock_;
+  std::condition_variable cv_;
+  std::string path_;
+  std::ofstream file_;
+  std::deque<Event> pending_;
+  bool in_memory_ = false;
+  std::deque<Event> recent_;
+  // Number of events popped from pending_ which are not written yet.
+  size_t writing_ = 0;
+  bool stop_ = false;
+  std::thread writer_;
+};
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_EVENT_LOG_H_
@@ -13,6 +13,7 @@
 #include "torch_xla/csrc/runtime/env_vars.h"
 #include "torch_xla/csrc/runtime/pjrt_registry.h"
 #include "torch_xla/csrc/runtime/stablehlo_helper.h"
+#include "torch_xla/csrc/runtime/step_breakdown.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "torch_xla/csrc/status.h"
@@ -286,6 +287,7 @@ std::vector<ComputationClient::DataPtr> IfrtComputationClient::TransferToDevice(
     absl::Span<const std::shared_ptr<const TensorSource>> tensors) {
   auto timed =
       std::make_shared<metrics::TimedSection>(TransferToDeviceMetric());
+  StepBreakdown::ScopedPhase phase(StepBreakdown::Phase::kTransferToDevice);
   tsl::profiler::TraceMe activity("IfrtComputationClient::TransferToDevice",
                                   tsl::profiler::TraceMeLevel::kInfo);
   std::vector<ComputationClient::DataPtr> datas;
@@ -439,6 +441,7 @@ std::shared_ptr<xla::PjRtBuffer> IfrtComputationClient::GetPjRtBuffer(
 std::vector<xla::Literal> IfrtComputationClient::TransferFromDevice(
     absl::Span<const DataPtr> handles) {
   metrics::TimedSection timed(TransferFromDeviceMetric());
+  StepBreakdown::ScopedPhase phase(StepBreakdown::Phase::kTransferFromDevice);
   tsl::profiler::TraceMe activity("IfrtComputationClient::TransferFromDevice",
                                   tsl::profiler::TraceMeLevel::kInfo);
   std::vector<xla::Literal> literals;
@@ -473,6 +476,7 @@ std::vector<xla::Literal> IfrtComputationClient::TransferFromDevice(
 std::vector<ComputationClient::ComputationPtr> IfrtComputationClient::Compile(
     std::vector<ComputationClient::CompileInstance> instances) {
   metrics::TimedSection timed(CompileMetric());
+  StepBreakdown::ScopedPhase phase(StepBreakdown::Phase::kCompile);
   tsl::profiler::TraceMe activity("IfrtComputationClient::Compile",
                                   tsl::profiler::TraceMeLevel::kInfo);
   std::vector<ComputationClient::ComputationPtr> computations;
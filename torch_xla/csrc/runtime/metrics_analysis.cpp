@@ -1,6 +1,12 @@
 #include "torch_xla/csrc/runtime/metrics_analysis.h"
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/variant.h"
 #include "torch_xla/csrc/runtime/metrics.h"
@@ -183,6 +189,340 @@ class UnloweredOp : public Analyzer {
   }
 };
 
+// Number of steps marked in the events, at least one.
+int64_t CountSteps(const std::vector<EventLog::Event>& events) {
+  int64_t steps = 0;
+  for (const EventLog::Event& event : events) {
+    steps += event.type == "step";
+  }
+  return std::max<int64_t>(steps, 1);
+}
+
+std::string FrameName(const std::string& frame) {
+  return frame.empty() ? "<unknown frame>" : frame;
+}
+
+std::string TimeUs(int64_t time_us) { return MetricFnTime(1000.0 * time_us); }
+
+// Whether the node of a recompilation is a scalar constant, which differs
+// from the previous graph by its value.
+bool IsScalarConstant(const std::string& node) {
+  return absl::StrContains(node, "prim::Constant") &&
+         absl::StrContains(node, "value=");
+}
+
+// Python frames which compile again and again, rather than once at warm-up.
+class RecompilingFrame : public EventAnalyzer {
+ public:
+  explicit RecompilingFrame(int64_t min_compilations)
+      : min_compilations_(min_compilations) {}
+
+  std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) override {
+    struct FrameStats {
+      int64_t compilations = 0;
+      int64_t compile_time_us = 0;
+      int64_t first_compile_time_us = 0;
+      std::string recompiled_node;
+    };
+    std::map<std::string, FrameStats> frames;
+    for (const EventLog::Event& event : events) {
+      // Scalar constants have their own analyzer.
+      if (event.type != "compile" || IsScalarConstant(event.recompiled_node)) {
+        continue;
+      }
+      FrameStats& stats = frames[event.frame];
+      if (stats.compilations++ == 0) {
+        stats.first_compile_time_us = event.compile_time_us;
+      }
+      stats.compile_time_us += event.compile_time_us;
+      if (!event.recompiled_node.empty()) {
+        stats.recompiled_node = event.recompiled_node;
+      }
+    }
+    std::vector<Finding> findings;
+    for (const auto& [frame, stats] : frames) {
+      if (stats.compilations < min_compilations_) {
+        continue;
+      }
+      Finding finding;
+      finding.analyzer = "RecompilingFrame";
+      finding.description = absl::StrFormat(
+          "%s compiled %d graphs, in %s.", FrameName(frame),
+          stats.compilations, TimeUs(stats.compile_time_us));
+      if (!stats.recompiled_node.empty()) {
+        absl::StrAppend(&finding.description,
+                        " The last one first differed from the graphs "
+                        "compiled before at node: ",
+                        stats.recompiled_node);
+      }
+      finding.suggestion =
+          "Keep the shapes of the graph the same across steps, like by "
+          "padding the dynamic dimensions to a few buckets, and move the "
+          "code which changes between steps out of the graph.";
+      finding.estimated_cost_us =
+          stats.compile_time_us - stats.first_compile_time_us;
+      findings.push_back(std::move(finding));
+    }
+    return findings;
+  }
+
+ private:
+  int64_t min_compilations_;
+};
+
+// Python scalars which are baked into the graph as constants, and compile a
+// new graph when their value changes.
+class ScalarConstantRecompile : public EventAnalyzer {
+ public:
+  explicit ScalarConstantRecompile(int64_t min_compilations)
+      : min_compilations_(min_compilations) {}
+
+  std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) override {
+    std::map<std::string, std::pair<int64_t, int64_t>> frames;
+    std::map<std::string, std::string> nodes;
+    for (const EventLog::Event& event : events) {
+      if (event.type == "compile" &&
+          IsScalarConstant(event.recompiled_node)) {
+        std::pair<int64_t, int64_t>& stats = frames[event.frame];
+        stats.first += 1;
+        stats.second += event.compile_time_us;
+        nodes[event.frame] = event.recompiled_node;
+      }
+    }
+    std::vector<Finding> findings;
+    for (const auto& [frame, stats] : frames) {
+      if (stats.first < min_compilations_) {
+        continue;
+      }
+      Finding finding;
+      finding.analyzer = "ScalarConstantRecompile";
+      finding.description = absl::StrFormat(
+          "%s compiled %d graphs which differ by the value of a scalar "
+          "constant, in %s. The last one was: %s",
+          FrameName(frame), stats.first, TimeUs(stats.second), nodes[frame]);
+      finding.suggestion =
+          "Pass the Python scalars which change between steps, like the "
+          "learning rate or a step count, as device tensors, so that they "
+          "become inputs of a single graph.";
+      finding.estimated_cost_us = stats.second;
+      findings.push_back(std::move(finding));
+    }
+    return findings;
+  }
+
+ private:
+  int64_t min_compilations_;
+};
+
+// Graphs with so many parameters that handling their buffers on every
+// execution costs significant host time.
+class TooManyParameters : public EventAnalyzer {
+ public:
+  TooManyParameters(int64_t max_parameters, int64_t parameter_cost_ns)
+      : max_parameters_(max_parameters),
+        parameter_cost_ns_(parameter_cost_ns) {}
+
+  std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) override {
+    std::unordered_map<std::string, int64_t> executions;
+    for (const EventLog::Event& event : events) {
+      if (event.type == "execute") {
+        ++executions[event.graph_hash];
+      }
+    }
+    std::map<std::string, const EventLog::Event*> graphs;
+    for (const EventLog::Event& event : events) {
+      if (event.type == "compile" && event.num_parameters > max_parameters_) {
+        graphs[event.graph_hash] = &event;
+      }
+    }
+    std::vector<Finding> findings;
+    for (const auto& [graph_hash, event] : graphs) {
+      int64_t graph_executions = std::max<int64_t>(executions[graph_hash], 1);
+      Finding finding;
+      finding.analyzer = "TooManyParameters";
+      finding.description = absl::StrFormat(
+          "Graph %s, compiled at %s, has %d parameters, %d of them scalars, "
+          "and ran %d times.",
+          graph_hash, FrameName(event->frame), event->num_parameters,
+          event->num_scalar_parameters, graph_executions);
+      finding.suggestion =
+          "Use fewer and larger tensors, like the foreach or fused versions "
+          "of the optimizers, and create the constant tensors and scalars on "
+          "the device once, outside of the training loop.";
+      finding.estimated_cost_us = graph_executions * event->num_parameters *
+                                  parameter_cost_ns_ / 1000;
+      findings.push_back(std::move(finding));
+    }
+    return findings;
+  }
+
+ private:
+  int64_t max_parameters_;
+  // Rough host time to handle one parameter of an execution.
+  int64_t parameter_cost_ns_;
+};
+
+// Transfers to the device which take a large share of the steps.
+class TransferInStep : public EventAnalyzer {
+ public:
+  explicit TransferInStep(double max_step_fraction)
+      : max_step_fraction_(max_step_fraction) {}
+
+  std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) override {
+    int64_t steps = 0;
+    int64_t step_time_us = 0;
+    int64_t transfer_time_us = 0;
+    for (const EventLog::Event& event : events) {
+      if (event.type != "step") {
+        continue;
+      }
+      auto step_it = event.phase_time_us.find("Step");
+      auto transfer_it = event.phase_time_us.find("TransferToDevice");
+      if (step_it != event.phase_time_us.end() &&
+          transfer_it != event.phase_time_us.end()) {
+        ++steps;
+        step_time_us += step_it->second;
+        transfer_time_us += transfer_it->second;
+      }
+    }
+    if (steps == 0 || transfer_time_us <= max_step_fraction_ * step_time_us) {
+      return {};
+    }
+    Finding finding;
+    finding.analyzer = "TransferInStep";
+    finding.description = absl::StrFormat(
+        "Transfers to the device took %s of the %s of %d steps (%.0f%%).",
+        TimeUs(transfer_time_us), TimeUs(step_time_us), steps,
+        100.0 * transfer_time_us / step_time_us);
+    finding.suggestion =
+        "Create the tensors directly on the device, keep the tensors reused "
+        "across steps on the device, and load the inputs with "
+        "MpDeviceLoader, which overlaps their transfers with the previous "
+        "step. The transfers of a background loader only cost time when the "
+        "host is the bottleneck.";
+    finding.estimated_cost_us = transfer_time_us;
+    return {std::move(finding)};
+  }
+
+ private:
+  double max_step_fraction_;
+};
+
+// Python frames which sync the graph to read tensor values more than once per
+// step, like .item() inside a loop. Printing a tensor copies it to the CPU,
+// which the graph events report as a "print" sync.
+class SyncInLoop : public EventAnalyzer {
+ public:
+  explicit SyncInLoop(int64_t min_syncs) : min_syncs_(min_syncs) {}
+
+  std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) override {
+    struct FrameStats {
+      int64_t syncs = 0;
+      int64_t execute_time_us = 0;
+      std::string reason;
+    };
+    std::map<std::string, FrameStats> frames;
+    for (const EventLog::Event& event : events) {
+      if (event.type == "execute" &&
+          (event.reason == "item" || event.reason == "to_cpu" ||
+           event.reason == "print")) {
+        FrameStats& stats = frames[event.frame];
+        ++stats.syncs;
+        stats.execute_time_us += event.execute_time_us;
+        stats.reason = event.reason;
+      }
+    }
+    int64_t steps = CountSteps(events);
+    std::vector<Finding> findings;
+    for (const auto& [frame, stats] : frames) {
+      if (stats.syncs < min_syncs_ || stats.syncs <= steps) {
+        continue;
+      }
+      Finding finding;
+      finding.analyzer = "SyncInLoop";
+      finding.description = absl::StrFormat(
+          "%s synced the graph for %s %d times during %d steps, waiting %s "
+          "for the device.",
+          FrameName(frame), stats.reason, stats.syncs, steps,
+          TimeUs(stats.execute_time_us));
+      finding.suggestion =
+          "Each sync cuts the graph and waits for the device. Accumulate the "
+          "values in device tensors and read them once after the loop, or "
+          "read them in a step closure.";
+      finding.estimated_cost_us = stats.execute_time_us;
+      findings.push_back(std::move(finding));
+    }
+    return findings;
+  }
+
+ private:
+  int64_t min_syncs_;
+};
+
+// Graphs whose inputs and outputs are padded far beyond their logical size on
+// the device, which wastes memory and bandwidth.
+class OversizedPadding : public EventAnalyzer {
+ public:
+  OversizedPadding(double max_padding_fraction, int64_t min_padding_bytes)
+      : max_padding_fraction_(max_padding_fraction),
+        min_padding_bytes_(min_padding_bytes) {}
+
+  std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) override {
+    std::unordered_map<std::string, int64_t> execute_time_us;
+    for (const EventLog::Event& event : events) {
+      if (event.type == "execute") {
+        execute_time_us[event.graph_hash] += event.execute_time_us;
+      }
+    }
+    std::map<std::string, const EventLog::Event*> graphs;
+    for (const EventLog::Event& event : events) {
+      int64_t device_bytes = event.input_bytes + event.output_bytes;
+      if (event.type == "compile" && device_bytes > 0 &&
+          event.padding_bytes >= min_padding_bytes_ &&
+          event.padding_bytes > max_padding_fraction_ * device_bytes) {
+        graphs[event.graph_hash] = &event;
+      }
+    }
+    std::vector<Finding> findings;
+    for (const auto& [graph_hash, event] : graphs) {
+      int64_t device_bytes = event->input_bytes + event->output_bytes;
+      Finding finding;
+      finding.analyzer = "OversizedPadding";
+      finding.description = absl::StrFormat(
+          "Graph %s, compiled at %s, has inputs and outputs of %s on the "
+          "device for %s of data.",
+          graph_hash, FrameName(event->frame), MetricFnBytes(device_bytes),
+          MetricFnBytes(device_bytes - event->padding_bytes));
+      finding.suggestion =
+          "The devices pad the two minor dimensions of the tensors to their "
+          "tiles, like multiples of 8 and 128 on TPU. Make the last two "
+          "dimensions of the large tensors, like the batch, hidden and "
+          "vocabulary sizes, multiples of them.";
+      // The executions are assumed to be bound by the memory bandwidth.
+      finding.estimated_cost_us = static_cast<int64_t>(
+          static_cast<double>(execute_time_us[graph_hash]) *
+          event->padding_bytes / device_bytes);
+      findings.push_back(std::move(finding));
+    }
+    return findings;
+  }
+
+ private:
+  double max_padding_fraction_;
+  int64_t min_padding_bytes_;
+};
+
+std::mutex* GetAnalyzersLock() {
+  static std::mutex* lock = new std::mutex();
+  return lock;
+}
+
 std::vector<Analyzer*>* GetAnalyzers() {
   static std::vector<Analyzer*>* analyzers = new std::vector<Analyzer*>{
       new MetricFrequency("CompileTime", 0.5f, 10),
@@ -198,18 +538,82 @@ std::vector<Analyzer*>* GetAnalyzers() {
   return analyzers;
 }
 
+std::vector<std::unique_ptr<EventAnalyzer>>* GetEventAnalyzers() {
+  static std::vector<std::unique_ptr<EventAnalyzer>>* analyzers = []() {
+    auto* analyzers = new std::vector<std::unique_ptr<EventAnalyzer>>();
+    analyzers->push_back(std::make_unique<RecompilingFrame>(4));
+    analyzers->push_back(std::make_unique<ScalarConstantRecompile>(2));
+    analyzers->push_back(std::make_unique<TooManyParameters>(1000, 500));
+    analyzers->push_back(std::make_unique<TransferInStep>(0.1));
+    analyzers->push_back(std::make_unique<SyncInLoop>(3));
+    analyzers->push_back(std::make_unique<OversizedPadding>(0.25, 1 << 20));
+    return analyzers;
+  }();
+  return analyzers;
+}
+
 }  // namespace
 
+void RegisterAnalyzer(std::unique_ptr<Analyzer> analyzer) {
+  std::lock_guard<std::mutex> lock(*GetAnalyzersLock());
+  GetAnalyzers()->push_back(analyzer.release());
+}
+
+void RegisterEventAnalyzer(std::unique_ptr<EventAnalyzer> analyzer) {
+  std::lock_guard<std::mutex> lock(*GetAnalyzersLock());
+  GetEventAnalyzers()->push_back(std::move(analyzer));
+}
+
+std::vector<Finding> AnalyzeEvents(const std::vector<EventLog::Event>& events) {
+  std::vector<Finding> findings;
+  {
+    std::lock_guard<std::mutex> lock(*GetAnalyzersLock());
+    for (auto const& analyzer : *GetEventAnalyzers()) {
+      std::vector<Finding> analyzer_findings = analyzer->Run(events);
+      findings.insert(findings.end(),
+                      std::make_move_iterator(analyzer_findings.begin()),
+                      std::make_move_iterator(analyzer_findings.end()));
+    }
+  }
+  std::stable_sort(findings.begin(), findings.end(),
+                   [](const Finding& a, const Finding& b) {
+                     return a.estimated_cost_us > b.estimated_cost_us;
+                   });
+  return findings;
+}
+
+std::string CreateFindingsReport(const std::vector<Finding>& findings) {
+  if (findings.empty()) {
+    return "";
+  }
+  std::stringstream ss;
+  ss << kAnalysisPrefix << ": Findings, most costly first:" << std::endl;
+  for (size_t i = 0; i < findings.size(); ++i) {
+    const Finding& finding = findings[i];
+    ss << "  " << i + 1 << ". [" << finding.analyzer << "] ~"
+       << TimeUs(finding.estimated_cost_us) << ": " << finding.description
+       << std::endl;
+    ss << "     " << finding.suggestion << std::endl;
+  }
+  return ss.str();
+}
+
 std::string CreatePerformanceReport(
     const std::map<std::string, torch_xla::runtime::Metric>& xrt_metrics) {
   std::stringstream ss;
-  std::vector<Analyzer*>* analyzers = GetAnalyzers();
-  for (auto const& analyzer : *analyzers) {
-    Analysis result = analyzer->Run(xrt_metrics);
-    if (result.symptom != Analysis::Symptom::kNormal) {
-      ss << result.repr << std::endl;
+  {
+    std::lock_guard<std::mutex> lock(*GetAnalyzersLock());
+    for (auto const& analyzer : *GetAnalyzers()) {
+      Analysis result = analyzer->Run(xrt_metrics);
+      if (result.symptom != Analysis::Symptom::kNormal) {
+        ss << result.repr << std::endl;
+      }
     }
   }
+  if (EventLog::Get()->IsEnabled()) {
+    ss << CreateFindingsReport(
+        AnalyzeEvents(EventLog::Get()->GetRecentEvents()));
+  }
   return ss.str();
 }
 
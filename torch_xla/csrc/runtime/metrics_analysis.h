@@ -1,12 +1,14 @@
 #ifndef XLA_CLIENT_METRICS_ANALYSIS_H_
 #define XLA_CLIENT_METRICS_ANALYSIS_H_
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "torch_xla/csrc/runtime/event_log.h"
 #include "torch_xla/csrc/runtime/types.h"
 
 namespace torch_xla {
@@ -20,6 +22,12 @@ namespace metrics {
 // - Frequent XLA->CPU transfers
 // - Device HBM to host RAM swapping and HBM defragmentation
 // - Unlowered aten:: ops
+// And from the events of the event log:
+// - Python frames recompiling, or changing scalar constants of the graph
+// - Graphs with too many parameters
+// - Large transfers to the device during the steps
+// - Syncs, like .item(), inside loops
+// - Tensors padded far beyond their logical size on the device
 
 struct Analysis {
   enum class Symptom {
@@ -48,6 +56,39 @@ class Analyzer {
   }
 };
 
+// An actionable performance problem found in the events of the event log.
+// The estimated cost is the time the problem adds to the run, which ranks
+// the findings.
+struct Finding {
+  std::string analyzer;
+  std::string description;
+  std::string suggestion;
+  int64_t estimated_cost_us = 0;
+};
+
+// Analyzes the events of the event log: the recent events of this process
+// when run live, or the events of a recorded log.
+class EventAnalyzer {
+ public:
+  virtual ~EventAnalyzer() = default;
+
+  virtual std::vector<Finding> Run(
+      const std::vector<EventLog::Event>& events) = 0;
+};
+
+// Adds an analyzer to the ones run by CreatePerformanceReport().
+void RegisterAnalyzer(std::unique_ptr<Analyzer> analyzer);
+
+// Adds an analyzer to the ones run by AnalyzeEvents().
+void RegisterEventAnalyzer(std::unique_ptr<EventAnalyzer> analyzer);
+
+// Runs the event analyzers, and returns their findings, most costly first.
+std::vector<Finding> AnalyzeEvents(const std::vector<EventLog::Event>& events);
+
+std::string CreateFindingsReport(const std::vector<Finding>& findings);
+
+// Runs the metric analyzers and, when the event log is enabled, the event
+// analyzers on its recent events.
 std::string CreatePerformanceReport(
     const std::map<std::string, torch_xla::runtime::Metric>& metrics);
 
@@ -1,6 +1,11 @@
 #include "torch_xla/csrc/runtime/metrics_reader.h"
 
+#include <algorithm>
+#include <fstream>
+#include <set>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
 
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/metrics.h"
@@ -68,6 +73,52 @@ std::string CreateXrtMetricReport(
   return ss.str();
 }
 
+struct EventStats {
+  int64_t compilations = 0;
+  int64_t compile_time_us = 0;
+  int64_t executions = 0;
+  int64_t execute_time_us = 0;
+  int64_t input_bytes = 0;
+  int64_t output_bytes = 0;
+  // Number of compilations per "<reason> at <frame>".
+  std::map<std::string, int64_t> compile_causes;
+  std::set<std::string> graph_hashes;
+};
+
+void AddEvent(const EventLog::Event& event, EventStats* stats) {
+  if (event.type == "compile") {
+    ++stats->compilations;
+    stats->compile_time_us += event.compile_time_us;
+    ++stats->compile_causes[event.frame.empty()
+                                ? event.reason
+                                : event.reason + " at " + event.frame];
+  } else if (event.type == "execute") {
+    ++stats->executions;
+    stats->execute_time_us += event.execute_time_us;
+    stats->input_bytes += event.input_bytes;
+    stats->output_bytes += event.output_bytes;
+  }
+  stats->graph_hashes.insert(event.graph_hash);
+}
+
+std::vector<std::pair<std::string, EventStats>> SortByCompilations(
+    std::unordered_map<std::string, EventStats> stats) {
+  std::vector<std::pair<std::string, EventStats>> sorted(
+      std::make_move_iterator(stats.begin()),
+      std::make_move_iterator(stats.end()));
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    if (a.second.compilations != b.second.compilations) {
+      return a.second.compilations > b.second.compilations;
+    }
+    return a.first < b.first;
+  });
+  return sorted;
+}
+
+std::string TimeUs(int64_t time_us) {
+  return metrics::MetricFnTime(1000.0 * time_us);
+}
+
 }  // namespace
 
 std::string CreateMetricReport(
@@ -80,6 +131,73 @@ std::string CreateMetricReport(const std::vector<std::string>& counter_names,
   return metrics::CreateMetricReport(counter_names, metric_names);
 }
 
+std::vector<EventLog::Event> ReadEventLog(const std::string& path) {
+  std::ifstream file(path);
+  XLA_CHECK(file.is_open()) << "Failed to open the event log " << path;
+  std::vector<EventLog::Event> events;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::optional<EventLog::Event> event = EventLog::FromJson(line);
+    if (event) {
+      events.push_back(std::move(*event));
+    }
+  }
+  return events;
+}
+
+std::string CreateEventLogReport(const std::vector<EventLog::Event>& events) {
+  EventStats total;
+  std::map<std::string, int64_t> cache_tiers;
+  std::unordered_map<std::string, EventStats> graph_stats;
+  std::unordered_map<std::string, EventStats> frame_stats;
+  for (const EventLog::Event& event : events) {
+    if (event.type == "step") {
+      continue;
+    }
+    AddEvent(event, &total);
+    AddEvent(event, &graph_stats[event.graph_hash]);
+    if (event.type == "compile") {
+      AddEvent(event, &frame_stats[event.frame]);
+    } else if (event.type == "execute") {
+      ++cache_tiers[event.cache];
+    }
+  }
+
+  std::stringstream ss;
+  ss << "Graphs: " << total.graph_hashes.size() << std::endl;
+  ss << "Compilations: " << total.compilations
+     << ", CompileTime: " << TimeUs(total.compile_time_us) << std::endl;
+  ss << "Executions: " << total.executions
+     << ", ExecuteTime: " << TimeUs(total.execute_time_us) << std::endl;
+  ss << "Cache:";
+  for (const auto& [tier, count] : cache_tiers) {
+    ss << " " << tier << "=" << count;
+  }
+  ss << std::endl;
+  for (const auto& [frame, stats] :
+       SortByCompilations(std::move(frame_stats))) {
+    ss << "Frame: " << (frame.empty() ? "<unknown>" : frame) << std::endl;
+    ss << "  Compilations: " << stats.compilations
+       << ", Graphs: " << stats.graph_hashes.size()
+       << ", CompileTime: " << TimeUs(stats.compile_time_us) << std::endl;
+  }
+  for (const auto& [graph_hash, stats] :
+       SortByCompilations(std::move(graph_stats))) {
+    ss << "Graph: " << graph_hash << std::endl;
+    ss << "  Compilations: " << stats.compilations
+       << ", CompileTime: " << TimeUs(stats.compile_time_us) << std::endl;
+    ss << "  Executions: " << stats.executions
+       << ", ExecuteTime: " << TimeUs(stats.execute_time_us)
+       << ", InputBytes: " << metrics::MetricFnBytes(stats.input_bytes)
+       << ", OutputBytes: " << metrics::MetricFnBytes(stats.output_bytes)
+       << std::endl;
+    for (const auto& [cause, count] : stats.compile_causes) {
+      ss << "  CompiledBy: " << cause << " (" << count << ")" << std::endl;
+    }
+  }
+  return ss.str();
+}
+
 }  // namespace metrics_reader
 }  // namespace runtime
 }  // namespace torch_xla
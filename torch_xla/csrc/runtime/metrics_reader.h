@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "torch_xla/csrc/runtime/event_log.h"
 #include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/types.h"
 
@@ -20,6 +21,14 @@ std::string CreateMetricReport(
 std::string CreateMetricReport(const std::vector<std::string>& counter_names,
                                const std::vector<std::string>& metric_names);
 
+// Reads the events of the event log at path, skipping the malformed lines.
+std::vector<EventLog::Event> ReadEventLog(const std::string& path);
+
+// Creates a report of the compilations and executions of an event log, per
+// graph hash and per Python frame. The graphs and frames compiling the most
+// come first, to find the sources of recompilations.
+std::string CreateEventLogReport(const std::vector<EventLog::Event>& events);
+
 }  // namespace metrics_reader
 }  // namespace runtime
 }  // namespace torch_xla
@@ -1,18 +1,22 @@
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
 #include "absl/strings/ascii.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
+#include "torch_xla/csrc/runtime/buffer_tracker.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/env_hash.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
 #include "torch_xla/csrc/runtime/pjrt_registry.h"
 #include "torch_xla/csrc/runtime/stablehlo_helper.h"
+#include "torch_xla/csrc/runtime/step_breakdown.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/tensor_source.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
@@ -265,27 +269,33 @@ std::optional<xla::OpSharding> PjRtComputationClient::GetDataSharding(
 std::vector<ComputationClient::DataPtr> PjRtComputationClient::TransferToDevice(
     absl::Span<const std::shared_ptr<const TensorSource>> tensors) {
   metrics::TimedSection timed(TransferToDeviceMetric());
+  StepBreakdown::ScopedPhase phase(StepBreakdown::Phase::kTransferToDevice);
   tsl::profiler::TraceMe activity("PjRtComputationClient::TransferToDevice",
                                   tsl::profiler::TraceMeLevel::kInfo);
   std::vector<ComputationClient::DataPtr> datas;
   datas.reserve(tensors.size());
+  BufferTracker* buffer_tracker = BufferTracker::Get();
+  std::string buffer_site =
+      buffer_tracker->IsEnabled()
+          ? buffer_tracker->CurrentSite("TransferToDevice")
+          : "";
   int64_t total_size = 0;
   for (auto& tensor : tensors) {
     xla::PjRtDevice* pjrt_device = StringToPjRtDevice(tensor->device());
 
     total_size += xla::ShapeUtil::ByteSizeOf(tensor->shape());
 
-    std::shared_ptr<xla::PjRtBuffer> buffer =
-        std::move(client_
-                      ->BufferFromHostBuffer(
-                          tensor->data(), tensor->primitive_type(),
-                          tensor->dimensions(), tensor->byte_strides(),
-                          xla::PjRtClient::HostBufferSemantics::
-                              kImmutableUntilTransferCompletes,
-                          [tensor]() { /* frees tensor */ },
-                          *pjrt_device->default_memory_space(),
-                          /*device_layout=*/nullptr)
-                      .value());
+    std::shared_ptr<xla::PjRtBuffer> buffer = buffer_tracker->Track(
+        client_
+            ->BufferFromHostBuffer(tensor->data(), tensor->primitive_type(),
+                                   tensor->dimensions(), tensor->byte_strides(),
+                                   xla::PjRtClient::HostBufferSemantics::
+                                       kImmutableUntilTransferCompletes,
+                                   [tensor]() { /* frees tensor */ },
+                                   *pjrt_device->default_memory_space(),
+                                   /*device_layout=*/nullptr)
+            .value(),
+        tensor->device(), buffer_site);
 
     ComputationClient::DataPtr data =
         std::make_shared<PjRtData>(tensor->device(), tensor->shape(), buffer);
@@ -335,8 +345,71 @@ ComputationClient::DataPtr PjRtComputationClient::CopyToDevice(
   if (!status_or.ok()) {
     return data;
   }
-  return std::make_shared<PjRtData>(dst, pjrt_data->shape(),
-                                    std::move(status_or.value()));
+  BufferTracker* buffer_tracker = BufferTracker::Get();
+  std::string buffer_site = buffer_tracker->IsEnabled()
+                                ? buffer_tracker->CurrentSite("CopyToDevice")
+                                : "";
+  return std::make_shared<PjRtData>(
+      dst, pjrt_data->shape(),
+      buffer_tracker->Track(std::move(status_or.value()), dst, buffer_site));
+}
+
+std::vector<std::string> PjRtComputationClient::GetMemoryKinds(
+    const std::string& device) {
+  xla::PjRtDevice* pjrt_device = StringToPjRtDevice(device);
+  std::vector<std::string> memory_kinds;
+  absl::StatusOr<xla::PjRtMemorySpace*> default_memory_space =
+      pjrt_device->default_memory_space();
+  if (default_memory_space.ok()) {
+    memory_kinds.emplace_back((*default_memory_space)->kind());
+  }
+  for (const xla::PjRtMemorySpace* memory_space :
+       pjrt_device->memory_spaces()) {
+    std::string memory_kind(memory_space->kind());
+    if (std::find(memory_kinds.begin(), memory_kinds.end(), memory_kind) ==
+        memory_kinds.end()) {
+      memory_kinds.push_back(std::move(memory_kind));
+    }
+  }
+  return memory_kinds;
+}
+
+ComputationClient::DataPtr PjRtComputationClient::CopyToMemoryKind(
+    ComputationClient::DataPtr data, const std::string& memory_kind) {
+  tsl::profiler::TraceMe activity("PjRtComputationClient::CopyToMemoryKind",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  if (auto sharded_data = std::dynamic_pointer_cast<PjRtShardedData>(data)) {
+    std::vector<std::shared_ptr<PjRtData>> shards;
+    shards.reserve(sharded_data->shards.size());
+    for (const std::shared_ptr<PjRtData>& shard : sharded_data->shards) {
+      shards.push_back(std::dynamic_pointer_cast<PjRtData>(
+          CopyToMemoryKind(shard, memory_kind)));
+    }
+    return std::make_shared<PjRtShardedData>(
+        sharded_data->device(), sharded_data->shape(), std::move(shards),
+        sharded_data->GetSharding());
+  }
+  const PjRtData* pjrt_data = dynamic_cast<PjRtData*>(data.get());
+  XLA_CHECK(pjrt_data != nullptr && pjrt_data->HasValue())
+      << "Can't copy invalid device data.";
+
+  xla::PjRtDevice* pjrt_device = StringToPjRtDevice(pjrt_data->device());
+  xla::PjRtMemorySpace* memory_space =
+      GetValueOrThrow(pjrt_device->memory_space_by_kind(memory_kind));
+  if (pjrt_data->buffer->memory_space() == memory_space) {
+    return data;
+  }
+  std::unique_ptr<xla::PjRtBuffer> buffer =
+      GetValueOrThrow(pjrt_data->buffer->CopyToMemorySpace(memory_space));
+  BufferTracker* buffer_tracker = BufferTracker::Get();
+  std::string buffer_site =
+      buffer_tracker->IsEnabled()
+          ? buffer_tracker->CurrentSite("CopyToMemoryKind")
+          : "";
+  return std::make_shared<PjRtData>(
+      pjrt_data->device(), pjrt_data->shape(),
+      buffer_tracker->Track(std::move(buffer), pjrt_data->device(),
+                            buffer_site));
 }
 
 std::shared_ptr<PjRtComputationClient::PjRtData>
@@ -512,13 +585,11 @@ std::shared_ptr<xla::PjRtBuffer> PjRtComputationClient::GetPjRtBuffer(
 std::vector<xla::Literal> PjRtComputationClient::TransferFromDevice(
     absl::Span<const DataPtr> handles) {
   metrics::TimedSection timed(TransferFromDeviceMetric());
+  StepBreakdown::ScopedPhase phase(StepBreakdown::Phase::kTransferFromDevice);
   tsl::profiler::TraceMe activity("PjRtComputationClient::TransferFromDevice",
                                   tsl::profiler::TraceMeLevel::kInfo);
-  std::vector<xla::PjRtFuture<>> futures;
-  futures.reserve(handles.size());
-  std::vector<xla::Literal> literals;
-  literals.reserve(handles.size());
-  int64_t total_size = 0;
+  std::vector<std::shared_ptr<PjRtData>> pjrt_datas;
+  pjrt_datas.reserve(handles.size());
   for (auto handle : handles) {
     // Use XLA replication to reassemble the sharded data. If input handle
     // is not sharded, then it is a no-op.
@@ -526,7 +597,26 @@ std::vector<xla::Literal> PjRtComputationClient::TransferFromDevice(
     XLA_CHECK(pjrt_data) << "PjRt_data is null in " << __FUNCTION__;
     XLA_CHECK(pjrt_data->buffer != nullptr)
         << "PjRt buffer is null in " << __FUNCTION__;
-
+    pjrt_datas.push_back(std::move(pjrt_data));
+  }
+  // Waiting for the computations producing the buffers is not part of the
+  // transfer. The copies start right away, and the time until the last buffer
+  // is ready is attributed to the execute wait.
+  int64_t start_ns = sys_util::NowNs();
+  auto ready_ns = std::make_shared<std::atomic<int64_t>>(start_ns);
+  std::vector<xla::PjRtFuture<>> futures;
+  futures.reserve(handles.size());
+  std::vector<xla::Literal> literals;
+  literals.reserve(handles.size());
+  int64_t total_size = 0;
+  for (const std::shared_ptr<PjRtData>& pjrt_data : pjrt_datas) {
+    pjrt_data->buffer->GetReadyFuture().OnReady([ready_ns](absl::Status) {
+      int64_t now_ns = sys_util::NowNs();
+      int64_t latest_ns = ready_ns->load();
+      while (latest_ns < now_ns &&
+             !ready_ns->compare_exchange_weak(latest_ns, now_ns)) {
+      }
+    });
     xla::Literal& literal =
         literals.emplace_back(host_output_shape(pjrt_data->buffer.get()));
     futures.push_back(pjrt_data->buffer->ToLiteral(&literal));
@@ -538,6 +628,8 @@ std::vector<xla::Literal> PjRtComputationClient::TransferFromDevice(
     XLA_CHECK_OK(status) << "Failed to await future from buffer to literal in"
                          << __FUNCTION__;
   }
+  phase.Reattribute(StepBreakdown::Phase::kExecuteWait,
+                    ready_ns->load() - start_ns);
   InboundDataMetric()->AddSample(total_size);
 
   return literals;
@@ -550,6 +642,7 @@ std::vector<ComputationClient::ComputationPtr> PjRtComputationClient::Compile(
     metrics_fn = EagerCompileMetric;
   }
   metrics::TimedSection timed(metrics_fn());
+  StepBreakdown::ScopedPhase phase(StepBreakdown::Phase::kCompile);
   tsl::profiler::TraceMe activity("PjRtComputationClient::Compile",
                                   tsl::profiler::TraceMeLevel::kInfo);
   std::vector<ComputationClient::ComputationPtr> computations;
@@ -795,8 +888,14 @@ PjRtComputationClient::ExecuteComputation(
 
   std::vector<DataPtr> datas;
   datas.reserve(results.size());
+  BufferTracker* buffer_tracker = BufferTracker::Get();
+  std::string buffer_site =
+      buffer_tracker->IsEnabled()
+          ? buffer_tracker->CurrentSite("ExecuteComputation")
+          : "";
   for (auto& result : results) {
-    std::unique_ptr<xla::PjRtBuffer> buffer = std::move(result);
+    std::shared_ptr<xla::PjRtBuffer> buffer =
+        buffer_tracker->Track(std::move(result), device, buffer_site);
 
     std::shared_ptr<PjRtData> data =
         std::make_shared<PjRtData>(device, std::move(buffer));
@@ -926,6 +1025,14 @@ PjRtComputationClient::ExecuteReplicated(
 
     absl::BlockingCounter counter(num_outputs);
 
+    // The result handles are created on the pool threads, so the site is
+    // taken here.
+    BufferTracker* buffer_tracker = BufferTracker::Get();
+    std::string buffer_site =
+        buffer_tracker->IsEnabled()
+            ? buffer_tracker->CurrentSite("ExecuteReplicated")
+            : "";
+
     // Time in nanoseconds that it takes to process a result buffer.
     // Measured on 2023/11/28.
     static constexpr int64_t result_handle_cost_ns = 10000;
@@ -934,8 +1041,8 @@ PjRtComputationClient::ExecuteReplicated(
           for (int32_t i = start; i < end; ++i) {
             std::vector<std::shared_ptr<PjRtData>> shards(devices.size());
             for (int32_t d = 0; d < devices.size(); d++) {
-              std::unique_ptr<xla::PjRtBuffer> buffer =
-                  std::move(results[d][i]);
+              std::shared_ptr<xla::PjRtBuffer> buffer = buffer_tracker->Track(
+                  std::move(results[d][i]), devices[d], buffer_site);
               shards[d] =
                   std::make_shared<PjRtData>(devices[d], std::move(buffer));
             }
@@ -1045,9 +1152,19 @@ ComputationClient::MemoryInfo PjRtComputationClient::GetMemoryInfo(
 void PjRtComputationClient::RegisterCustomCall(const std::string& fn_name,
                                                void* function_ptr,
                                                const std::string& platform) {
+  if (platform == "Host") {
+    // Host custom calls are run by the CPU runtime, which looks them up in the
+    // process-wide registry.
+    XLA_CHECK(dynamic_cast<xla::PjRtCApiClient*>(client_.get()) == nullptr)
+        << "Host custom call targets can only be registered for the "
+           "in-process PJRT CPU runtime.";
+    xla::CustomCallTargetRegistry::Global()->Register(fn_name, function_ptr,
+                                                      platform);
+    return;
+  }
   if (platform != "CUDA") {
     XLA_ERROR() << "Custom call targets can only be registered for "
-                   "PJRT CUDA runtime.";
+                   "PJRT CUDA and CPU (Host) runtimes.";
     return;
   }
 
@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <variant>
 
 #include "absl/types/span.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
@@ -78,6 +80,11 @@ class PjRtComputationClient : public ComputationClient {
 
   DataPtr CopyToDevice(DataPtr data, std::string dst) override;
 
+  std::vector<std::string> GetMemoryKinds(const std::string& device) override;
+
+  DataPtr CopyToMemoryKind(DataPtr data,
+                           const std::string& memory_kind) override;
+
   std::vector<ComputationPtr> Compile(
       std::vector<CompileInstance> instances) override;
 
@@ -250,6 +257,19 @@ class PjRtComputationClient : public ComputationClient {
       return xla::OpSharding();
     }
 
+    std::string memory_kind() const override {
+      if (!HasValue() || buffer->memory_space() == nullptr) {
+        return "";
+      }
+      absl::StatusOr<xla::PjRtMemorySpace*> default_memory_space =
+          buffer->device()->default_memory_space();
+      if (default_memory_space.ok() &&
+          *default_memory_space == buffer->memory_space()) {
+        return "";
+      }
+      return std::string(buffer->memory_space()->kind());
+    }
+
     std::string ToString() const override {
       std::stringstream ss;
       ss << "XLAData: \n";
@@ -322,6 +342,10 @@ class PjRtComputationClient : public ComputationClient {
 
     xla::OpSharding GetSharding() const override { return sharding; }
 
+    std::string memory_kind() const override {
+      return shards.empty() ? "" : shards[0]->memory_kind();
+    }
+
     std::vector<std::shared_ptr<PjRtData>> shards;
     xla::OpSharding sharding;
   };
@@ -344,8 +368,48 @@ class PjRtComputationClient : public ComputationClient {
       }
     }
 
+    ComputationStats get_computation_stats() const override {
+      ComputationStats stats;
+      absl::StatusOr<xla::CompiledMemoryStats> memory_stats =
+          executable->GetCompiledMemoryStats();
+      if (memory_stats.ok()) {
+        stats.argument_size_in_bytes = memory_stats->argument_size_in_bytes;
+        stats.output_size_in_bytes = memory_stats->output_size_in_bytes;
+        stats.alias_size_in_bytes = memory_stats->alias_size_in_bytes;
+        stats.temp_size_in_bytes = memory_stats->temp_size_in_bytes;
+        stats.generated_code_size_in_bytes =
+            memory_stats->generated_code_size_in_bytes;
+      }
+      auto cost_analysis = executable->GetCostAnalysis();
+      if (cost_analysis.ok()) {
+        stats.flops = GetCostProperty(*cost_analysis, "flops");
+        stats.transcendentals =
+            GetCostProperty(*cost_analysis, "transcendentals");
+        stats.bytes_accessed =
+            GetCostProperty(*cost_analysis, "bytes accessed");
+      }
+      return stats;
+    }
+
     std::unique_ptr<xla::PjRtLoadedExecutable> executable;
     std::optional<std::vector<xla::OpSharding>> output_shardings_;
+
+   private:
+    template <typename Properties>
+    static double GetCostProperty(const Properties& properties,
+                                  const std::string& name) {
+      auto it = properties.find(name);
+      if (it == properties.end()) {
+        return -1;
+      }
+      if (const float* value = std::get_if<float>(&it->second)) {
+        return *value;
+      }
+      if (const int64_t* value = std::get_if<int64_t>(&it->second)) {
+        return *value;
+      }
+      return -1;
+    }
   };
 
   // Use XLA replication to re-assemble the sharded data.
@@ -0,0 +1,138 @@
+#include "torch_xla/csrc/runtime/step_breakdown.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "torch_xla/csrc/runtime/event_log.h"
+#include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+// Number of steps returned by GetSteps().
+constexpr size_t kMaxSteps = 128;
+
+thread_local StepBreakdown::ScopedPhase* current_phase = nullptr;
+
+metrics::Metric* PhaseMetric(StepBreakdown::Phase phase) {
+  static const auto* const phase_metrics = []() {
+    auto* phase_metrics =
+        new std::array<metrics::Metric*, StepBreakdown::kNumPhases>();
+    for (size_t i = 0; i < StepBreakdown::kNumPhases; ++i) {
+      (*phase_metrics)[i] = new metrics::Metric(
+          std::string("Step") +
+              StepBreakdown::PhaseName(static_cast<StepBreakdown::Phase>(i)) +
+              "Time",
+          metrics::MetricFnTime);
+    }
+    return phase_metrics;
+  }();
+  return (*phase_metrics)[static_cast<size_t>(phase)];
+}
+
+}  // namespace
+
+StepBreakdown::ScopedPhase::ScopedPhase(Phase phase)
+    : phase_(phase), start_ns_(sys_util::NowNs()), parent_(current_phase) {
+  current_phase = this;
+}
+
+StepBreakdown::ScopedPhase::~ScopedPhase() {
+  int64_t elapsed_ns = sys_util::NowNs() - start_ns_;
+  StepBreakdown::Get()->AddTime(phase_, elapsed_ns - nested_ns_);
+  if (parent_ != nullptr) {
+    parent_->nested_ns_ += elapsed_ns;
+  }
+  current_phase = parent_;
+}
+
+void StepBreakdown::ScopedPhase::Reattribute(Phase phase, int64_t time_ns) {
+  StepBreakdown::Get()->AddTime(phase, time_ns);
+  nested_ns_ += time_ns;
+}
+
+StepBreakdown* StepBreakdown::Get() {
+  static StepBreakdown* step_breakdown = new StepBreakdown();
+  return step_breakdown;
+}
+
+const char* StepBreakdown::PhaseName(Phase phase) {
+  switch (phase) {
+    case Phase::kHashing:
+      return "Hashing";
+    case Phase::kLowering:
+      return "Lowering";
+    case Phase::kCompile:
+      return "Compile";
+    case Phase::kTransferToDevice:
+      return "TransferToDevice";
+    case Phase::kExecuteWait:
+      return "ExecuteWait";
+    case Phase::kTransferFromDevice:
+      return "TransferFromDevice";
+    default:
+      return "Unknown";
+  }
+}
+
+StepBreakdown::StepBreakdown() : step_start_ns_(sys_util::NowNs()) {
+  for (std::atomic<int64_t>& phase_ns : current_ns_) {
+    phase_ns.store(0);
+  }
+}
+
+void StepBreakdown::AddTime(Phase phase, int64_t time_ns) {
+  current_ns_[static_cast<size_t>(phase)].fetch_add(time_ns,
+                                                    std::memory_order_relaxed);
+}
+
+void StepBreakdown::EndStep() {
+  static metrics::Metric* step_time =
+      new metrics::Metric("StepTime", metrics::MetricFnTime);
+  static metrics::Metric* tracing_time =
+      new metrics::Metric("StepTracingTime", metrics::MetricFnTime);
+  int64_t now_ns = sys_util::NowNs();
+  Step step;
+  step.step_time_ns = now_ns - step_start_ns_.exchange(now_ns);
+  // Phases on other threads, like the transfers of a background data loader,
+  // overlap with the step, so the tracing time is clamped to zero.
+  int64_t phases_ns = 0;
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    step.phase_ns[i] = current_ns_[i].exchange(0);
+    phases_ns += step.phase_ns[i];
+  }
+  step.tracing_ns = std::max<int64_t>(step.step_time_ns - phases_ns, 0);
+
+  step_time->AddSample(now_ns, step.step_time_ns);
+  tracing_time->AddSample(now_ns, step.tracing_ns);
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    PhaseMetric(static_cast<Phase>(i))->AddSample(now_ns, step.phase_ns[i]);
+  }
+  if (EventLog::Get()->IsEnabled()) {
+    EventLog::Event event;
+    event.type = "step";
+    event.phase_time_us["Step"] = step.step_time_ns / 1000;
+    event.phase_time_us["Tracing"] = step.tracing_ns / 1000;
+    for (size_t i = 0; i < kNumPhases; ++i) {
+      event.phase_time_us[PhaseName(static_cast<Phase>(i))] =
+          step.phase_ns[i] / 1000;
+    }
+    EventLog::Get()->Append(std::move(event));
+  }
+  std::lock_guard<std::mutex> lock(lock_);
+  steps_.push_back(step);
+  if (steps_.size() > kMaxSteps) {
+    steps_.pop_front();
+  }
+}
+
+std::vector<StepBreakdown::Step> StepBreakdown::GetSteps() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return std::vector<Step>(steps_.begin(), steps_.end());
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -0,0 +1,87 @@
+#ifndef XLA_CLIENT_STEP_BREAKDOWN_H_
+#define XLA_CLIENT_STEP_BREAKDOWN_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace torch_xla {
+namespace runtime {
+
+// Always-on attribution of the wall time of each step, from one step marker
+// to the next, to the phases of the lazy tensor pipeline. The host time not
+// spent in any phase is the tracing time: running the Python code and
+// recording the IR. A phase costs two clock reads and one atomic add.
+class StepBreakdown {
+ public:
+  enum class Phase {
+    // Collecting the pending graph, hashing it and scheduling its execution.
+    kHashing,
+    // Lowering the graph to HLO.
+    kLowering,
+    kCompile,
+    kTransferToDevice,
+    // Waiting for the device to finish the executions.
+    kExecuteWait,
+    kTransferFromDevice,
+    kNumPhases,
+  };
+
+  static constexpr size_t kNumPhases = static_cast<size_t>(Phase::kNumPhases);
+
+  struct Step {
+    int64_t step_time_ns = 0;
+    int64_t tracing_ns = 0;
+    std::array<int64_t, kNumPhases> phase_ns = {};
+  };
+
+  // Attributes the time the current thread spends in its scope to phase. The
+  // time spent in nested scopes is attributed to their phases instead.
+  class ScopedPhase {
+   public:
+    explicit ScopedPhase(Phase phase);
+    ~ScopedPhase();
+
+    // Attributes time_ns of the scope, measured apart, to phase instead, like
+    // the time the scope waited on a future.
+    void Reattribute(Phase phase, int64_t time_ns);
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+   private:
+    Phase phase_;
+    int64_t start_ns_;
+    int64_t nested_ns_ = 0;
+    ScopedPhase* parent_;
+  };
+
+  static StepBreakdown* Get();
+
+  static const char* PhaseName(Phase phase);
+
+  // Ends the current step, and records its breakdown in the StepTime and
+  // Step<Phase>Time metrics, and in a step event of the event log.
+  void EndStep();
+
+  // Returns the breakdown of the most recent steps, oldest first.
+  std::vector<Step> GetSteps() const;
+
+ private:
+  StepBreakdown();
+
+  void AddTime(Phase phase, int64_t time_ns);
+
+  std::array<std::atomic<int64_t>, kNumPhases> current_ns_;
+  std::atomic<int64_t> step_start_ns_;
+  mutable std::mutex lock_;
+  std::deque<Step> steps_;
+};
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_STEP_BREAKDOWN_H_
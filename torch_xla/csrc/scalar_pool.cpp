@@ -0,0 +1,168 @@
+#include "torch_xla/csrc/scalar_pool.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/lazy/core/lazy_graph_executor.h>
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include "torch_xla/csrc/device.h"
+#include "torch_xla/csrc/dtype.h"
+#include "torch_xla/csrc/ops/device_data.h"
+#include "torch_xla/csrc/ops/generic_slice.h"
+#include "torch_xla/csrc/ops/ops.h"
+#include "torch_xla/csrc/ops/scalar.h"
+#include "torch_xla/csrc/ops/view.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/runtime/tensor_source.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// Number of scalars of a packed buffer. It is part of the shape of the
+// parameter, so it is fixed to keep the graph hashes stable.
+constexpr int64_t kPackedBufferSize = 64;
+
+// Number of positions observed per step and device. The scalars past it are
+// constants.
+constexpr size_t kMaxSites = 4096;
+
+xla::Shape PackedBufferShape(xla::PrimitiveType type) {
+  return xla::ShapeUtil::MakeShape(type, {kPackedBufferSize});
+}
+
+}  // namespace
+
+ScalarPool* ScalarPool::Get() {
+  static ScalarPool* pool = new ScalarPool();
+  return pool;
+}
+
+ScalarPool::ScalarPool()
+    : enabled_(runtime::sys_util::GetEnvBool("XLA_SCALAR_POOL", false)) {}
+
+void ScalarPool::SetEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(lock_);
+  enabled_.store(enabled);
+  sequences_.clear();
+}
+
+std::optional<torch::lazy::Value> ScalarPool::GetIrValue(
+    const at::Scalar& value, xla::PrimitiveType type,
+    const torch::lazy::BackendDevice& device) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!IsVarying(value, type, device)) {
+    TORCH_LAZY_COUNTER("ScalarPoolConstants", 1);
+    return ScalarOp(value, type);
+  }
+  if (static_cast<XlaDeviceType>(device.type()) == XlaDeviceType::SPMD) {
+    return std::nullopt;
+  }
+  TORCH_LAZY_COUNTER("ScalarPoolParameters", 1);
+  return AddParameter(value, type, device);
+}
+
+bool ScalarPool::IsVarying(const at::Scalar& value, xla::PrimitiveType type,
+                           const torch::lazy::BackendDevice& device) {
+  Sequence& sequence = sequences_[device.toString()];
+  size_t position = sequence.position++;
+  if (position >= kMaxSites) {
+    // Without step markers the positions do not line up across steps.
+    TORCH_LAZY_COUNTER("ScalarPoolUnobserved", 1);
+    return false;
+  }
+  torch::lazy::hash_t value_hash = ScalarHash(value);
+  if (position == sequence.sites.size()) {
+    sequence.sites.push_back({type, value_hash});
+    return false;
+  }
+  Site& site = sequence.sites[position];
+  if (site.type != type) {
+    // The step took another path, which restarts the observation.
+    site = {type, value_hash};
+    return false;
+  }
+  if (!site.varying && site.value_hash != value_hash) {
+    site.varying = true;
+    TORCH_LAZY_COUNTER("ScalarPoolPromotions", 1);
+  }
+  site.value_hash = value_hash;
+  return site.varying;
+}
+
+torch::lazy::Value ScalarPool::AddParameter(
+    const at::Scalar& value, xla::PrimitiveType type,
+    const torch::lazy::BackendDevice& device) {
+  PackedBuffer& buffer = open_buffers_[{device.toString(), type}];
+  if (buffer.values.size() == kPackedBufferSize) {
+    full_buffers_.push_back(std::move(buffer));
+    buffer = PackedBuffer();
+  }
+  if (buffer.data == nullptr) {
+    buffer.type = type;
+    buffer.device = device.toString();
+    buffer.data = runtime::GetComputationClientOrDie()->CreateDataPlaceholder(
+        buffer.device, PackedBufferShape(type));
+    buffer.data->SetInfo(
+        std::make_shared<torch::lazy::LazyGraphExecutor::DeviceDataInfo>(
+            /*tensor_id=*/-1, /*read_only=*/true));
+  }
+  int64_t slot = buffer.values.size();
+  buffer.values.push_back(value);
+  torch::lazy::Value packed = torch_xla::MakeNode<DeviceData>(buffer.data);
+  torch::lazy::Value element = torch_xla::MakeNode<GenericSlice>(
+      packed, std::vector<int64_t>{slot}, std::vector<int64_t>{1});
+  return torch_xla::MakeNode<ViewOp>(element, std::vector<int64_t>());
+}
+
+void ScalarPool::Flush() {
+  // Held until the buffers are assigned, so that a concurrent flush which finds
+  // nothing pending does not return while they are still placeholders.
+  std::lock_guard<std::mutex> flush_lock(flush_lock_);
+  std::vector<PackedBuffer> buffers;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    buffers.swap(full_buffers_);
+    for (auto& [key, buffer] : open_buffers_) {
+      buffers.push_back(std::move(buffer));
+    }
+    open_buffers_.clear();
+  }
+  if (buffers.empty()) {
+    return;
+  }
+  std::vector<std::shared_ptr<const runtime::TensorSource>> source_tensors;
+  size_t num_scalars = 0;
+  for (const PackedBuffer& buffer : buffers) {
+    // The unused slots are zeros.
+    at::Tensor tensor =
+        at::zeros({kPackedBufferSize},
+                  at::TensorOptions(MaybeUpcastToHostTorchType(buffer.type)));
+    for (size_t i = 0; i < buffer.values.size(); ++i) {
+      tensor.select(/*dim=*/0, i).fill_(buffer.values[i]);
+    }
+    num_scalars += buffer.values.size();
+    source_tensors.push_back(std::make_shared<runtime::AtenSource>(
+        tensor, PackedBufferShape(buffer.type), buffer.device));
+  }
+  std::vector<runtime::ComputationClient::DataPtr> handles =
+      runtime::GetComputationClientOrDie()->TransferToDevice(source_tensors);
+  XLA_CHECK_EQ(handles.size(), buffers.size());
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    buffers[i].data->Assign(*handles[i]);
+  }
+  TORCH_LAZY_COUNTER("ScalarPoolTransfers", 1);
+  TORCH_LAZY_VALUE_METRIC("ScalarPoolTransferScalars", num_scalars);
+}
+
+void ScalarPool::MarkStep(const torch::lazy::BackendDevice& device) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = sequences_.find(device.toString());
+  if (it != sequences_.end()) {
+    it->second.position = 0;
+  }
+}
+
+}  // namespace torch_xla
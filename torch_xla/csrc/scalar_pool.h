@@ -0,0 +1,105 @@
+#ifndef XLA_TORCH_XLA_CSRC_SCALAR_POOL_H_
+#define XLA_TORCH_XLA_CSRC_SCALAR_POOL_H_
+
+#include <ATen/core/Scalar.h>
+#include <torch/csrc/lazy/backend/backend_data.h>
+#include <torch/csrc/lazy/backend/backend_device.h>
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xla/xla_data.pb.h"
+
+namespace torch_xla {
+
+// Decides how the non-special Python scalars enter the graphs. A scalar which
+// kept its value since the previous step, at the same position in the sequence
+// of scalars of the step, is kept as a constant, which XLA can fold. A scalar
+// observed to vary is promoted to a parameter, so that a learning rate schedule
+// does not recompile the graph at every step. The parameters are slots of a
+// packed buffer per device and element type, transferred in a single batch
+// before the next execution, rather than one transfer and one parameter per
+// scalar. It is enabled by XLA_SCALAR_POOL=1 or SetEnabled().
+//
+// Each device has its own sequence of scalars, so that threads tracing for
+// different devices do not shift the positions of each other. The sequences
+// restart at mark_step. Runs which never mark a step, like eager mode or loops
+// of dynamo graphs only, leave the scalars past the observed positions as
+// constants, as without the pool.
+class ScalarPool {
+ public:
+  static ScalarPool* Get();
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Also forgets the observed scalars.
+  void SetEnabled(bool enabled);
+
+  // Returns the IR value of a non-special scalar, or nullopt if it has to be a
+  // parameter on a device the pool does not pack, like the SPMD virtual device.
+  std::optional<torch::lazy::Value> GetIrValue(
+      const at::Scalar& value, xla::PrimitiveType type,
+      const torch::lazy::BackendDevice& device);
+
+  // Transfers the values of the packed buffers filled since the last flush,
+  // and waits for the transfers of concurrent flushes. Must be called before
+  // executing graphs which may read them.
+  void Flush();
+
+  // Starts a new sequence of scalars on device.
+  void MarkStep(const torch::lazy::BackendDevice& device);
+
+ private:
+  struct Site {
+    xla::PrimitiveType type;
+    torch::lazy::hash_t value_hash;
+    bool varying = false;
+  };
+
+  // The scalars seen on a device, by position since the last step marker.
+  struct Sequence {
+    std::vector<Site> sites;
+    size_t position = 0;
+  };
+
+  struct PackedBuffer {
+    torch::lazy::BackendDataPtr data;
+    xla::PrimitiveType type = xla::PRIMITIVE_TYPE_INVALID;
+    std::string device;
+    std::vector<at::Scalar> values;
+  };
+
+  ScalarPool();
+
+  // Returns whether the scalar at the current position of the step of device
+  // varies.
+  bool IsVarying(const at::Scalar& value, xla::PrimitiveType type,
+                 const torch::lazy::BackendDevice& device);
+
+  torch::lazy::Value AddParameter(const at::Scalar& value,
+                                  xla::PrimitiveType type,
+                                  const torch::lazy::BackendDevice& device);
+
+  std::atomic<bool> enabled_;
+  // Serializes the flushes. Taken before lock_.
+  std::mutex flush_lock_;
+  std::mutex lock_;
+  // Keyed by device.
+  std::map<std::string, Sequence> sequences_;
+  // Keyed by device and element type.
+  std::map<std::pair<std::string, xla::PrimitiveType>, PackedBuffer>
+      open_buffers_;
+  // Buffers which are full, and wait for the next flush.
+  std::vector<PackedBuffer> full_buffers_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_SCALAR_POOL_H_
@@ -40,6 +40,7 @@
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
+#include "torch_xla/csrc/scalar_pool.h"
 #include "torch_xla/csrc/tensor_util.h"
 #include "torch_xla/csrc/torch_util.h"
 #include "torch_xla/csrc/xla_graph_executor.h"
@@ -428,6 +429,15 @@ torch::lazy::Value XLATensor::GetIrValueForTensor(
       return ScalarOp(std::move(value),
                       MakeXlaPrimitiveType(tensor.scalar_type(), &device));
     }
+    if (ScalarPool::Get()->IsEnabled()) {
+      std::optional<torch::lazy::Value> ir_value =
+          ScalarPool::Get()->GetIrValue(
+              value, MakeXlaPrimitiveType(tensor.scalar_type(), &device),
+              device);
+      if (ir_value) {
+        return *ir_value;
+      }
+    }
     data = XLAGraphExecutor::Get()->GetDeviceData(tensor.cpu(), device);
     read_only = true;
   } else {
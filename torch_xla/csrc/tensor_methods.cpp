@@ -8,6 +8,9 @@
 
 #include <algorithm>
 #include <functional>
+#include <mutex>
+#include <set>
+#include <tuple>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
@@ -29,6 +32,7 @@
 #include "torch_xla/csrc/ops/as_strided.h"
 #include "torch_xla/csrc/ops/avg_pool_nd.h"
 #include "torch_xla/csrc/ops/avg_pool_nd_backward.h"
+#include "torch_xla/csrc/ops/batched_nms.h"
 #include "torch_xla/csrc/ops/bernoulli.h"
 #include "torch_xla/csrc/ops/cast.h"
 #include "torch_xla/csrc/ops/cast_int4.h"
@@ -55,10 +59,13 @@
 #include "torch_xla/csrc/ops/einsum.h"
 #include "torch_xla/csrc/ops/einsum_backward.h"
 #include "torch_xla/csrc/ops/embedding_bag.h"
+#include "torch_xla/csrc/ops/embedding_bag_backward.h"
 #include "torch_xla/csrc/ops/expand.h"
 #include "torch_xla/csrc/ops/expand_symint.h"
 #include "torch_xla/csrc/ops/exponential.h"
 #include "torch_xla/csrc/ops/flip.h"
+#include "torch_xla/csrc/ops/foreach_adam_optimizer_step.h"
+#include "torch_xla/csrc/ops/foreach_sgd_optimizer_step.h"
 #include "torch_xla/csrc/ops/gather.h"
 #include "torch_xla/csrc/ops/generic.h"
 #include "torch_xla/csrc/ops/generic_slice.h"
@@ -70,6 +77,8 @@
 #include "torch_xla/csrc/ops/infer_output_shape.h"
 #include "torch_xla/csrc/ops/kth_value.h"
 #include "torch_xla/csrc/ops/linear_interpolation.h"
+#include "torch_xla/csrc/ops/linear_cross_entropy.h"
+#include "torch_xla/csrc/ops/linear_cross_entropy_backward.h"
 #include "torch_xla/csrc/ops/linspace.h"
 #include "torch_xla/csrc/ops/log_softmax.h"
 #include "torch_xla/csrc/ops/logsumexp.h"
@@ -81,6 +90,7 @@
 #include "torch_xla/csrc/ops/max_pool_nd_backward.h"
 #include "torch_xla/csrc/ops/max_unpool_nd.h"
 #include "torch_xla/csrc/ops/mean.h"
+#include "torch_xla/csrc/ops/memory_placement.h"
 #include "torch_xla/csrc/ops/min_in_dim.h"
 #include "torch_xla/csrc/ops/mse_loss.h"
 #include "torch_xla/csrc/ops/mse_loss_backward.h"
@@ -98,6 +108,7 @@
 #include "torch_xla/csrc/ops/not_supported.h"
 #include "torch_xla/csrc/ops/ops.h"
 #include "torch_xla/csrc/ops/optimization_barrier.h"
+#include "torch_xla/csrc/ops/padded_unique.h"
 #include "torch_xla/csrc/ops/permute.h"
 #include "torch_xla/csrc/ops/prod.h"
 #include "torch_xla/csrc/ops/put.h"
@@ -112,9 +123,12 @@
 #include "torch_xla/csrc/ops/replication_pad_backward.h"
 #include "torch_xla/csrc/ops/resize.h"
 #include "torch_xla/csrc/ops/roll.h"
+#include "torch_xla/csrc/ops/row_sparse_coalesce.h"
 #include "torch_xla/csrc/ops/rrelu_with_noise.h"
 #include "torch_xla/csrc/ops/rrelu_with_noise_backward.h"
 #include "torch_xla/csrc/ops/scalar.h"
+#include "torch_xla/csrc/ops/scaled_dot_product_attention.h"
+#include "torch_xla/csrc/ops/scaled_dot_product_attention_backward.h"
 #include "torch_xla/csrc/ops/scatter.h"
 #include "torch_xla/csrc/ops/scatter_add.h"
 #include "torch_xla/csrc/ops/scatter_reduce.h"
@@ -144,6 +158,7 @@
 #include "torch_xla/csrc/ops/var.h"
 #include "torch_xla/csrc/ops/var_mean.h"
 #include "torch_xla/csrc/ops/view.h"
+#include "torch_xla/csrc/ops/weight_only_quantized_matmul.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/metrics.h"
@@ -344,6 +359,70 @@ XLATensorPtr DispatchComparisonOp(c10::Symbol kind, const XLATensorPtr& input,
   return XLATensor::Create(node, input->GetDevice(), at::ScalarType::Bool);
 }
 
+std::vector<torch::lazy::Value> GetIrValues(
+    absl::Span<const XLATensorPtr> tensors) {
+  std::vector<torch::lazy::Value> values;
+  values.reserve(tensors.size());
+  for (const XLATensorPtr& tensor : tensors) {
+    values.push_back(tensor->GetIrValue());
+  }
+  return values;
+}
+
+// Number of keys processed per step of the blockwise attention loops.
+int64_t GetAttentionBlockSize() {
+  static const int64_t block_size =
+      runtime::sys_util::GetEnvInt("XLA_SDPA_BLOCK_SIZE", 512);
+  return block_size;
+}
+
+// Returns the number of rows to pad a data dependent result of op_name to,
+// given that it has at most max_size rows. A non-negative bound is used as is.
+// Otherwise the valid count, made by count_fn from the operands, is fetched
+// from the device, which syncs, and rounded up to a power of two, so that the
+// graphs consuming the result are only compiled for a few sizes. The operands
+// are materialized by the same sync, so the graph producing them runs once.
+int64_t GetDynamicPaddingSize(const std::string& op_name,
+                              std::vector<XLATensorPtr> operands,
+                              const std::function<XLATensorPtr()>& count_fn,
+                              int64_t max_size, int64_t bound) {
+  // Number of sizes remembered for the DynamicPaddingRecompilesAvoided
+  // counter.
+  static const size_t kMaxSeenSizes = 4096;
+  if (bound >= 0) {
+    return std::min(bound, max_size);
+  }
+  XLA_COUNTER("DynamicPaddingCountSync", 1);
+  operands.push_back(count_fn());
+  XLAGraphExecutor::Get()->SyncTensorsGraph(&operands, /*devices=*/{},
+                                            /*wait=*/true,
+                                            /*sync_ltc_data=*/false);
+  int64_t valid_count =
+      operands.back()->ToTensor(/*detached=*/true).item<int64_t>();
+  int64_t padded_size = 1;
+  while (padded_size < valid_count) {
+    padded_size *= 2;
+  }
+  padded_size = std::min(padded_size, max_size);
+
+  // Without padding, each distinct count would have compiled its own graphs.
+  static std::mutex* seen_lock = new std::mutex();
+  static auto* seen_sizes =
+      new std::set<std::tuple<std::string, int64_t, int64_t, bool>>();
+  std::lock_guard<std::mutex> lock(*seen_lock);
+  if (seen_sizes->size() >= kMaxSeenSizes) {
+    seen_sizes->clear();
+  }
+  bool new_count =
+      seen_sizes->emplace(op_name, max_size, valid_count, false).second;
+  bool new_padded_size =
+      seen_sizes->emplace(op_name, max_size, padded_size, true).second;
+  if (new_count && !new_padded_size) {
+    XLA_COUNTER("DynamicPaddingRecompilesAvoided", 1);
+  }
+  return padded_size;
+}
+
 }  // namespace
 
 //////////////////////////////////////////////////////////////////////////////
@@ -723,6 +802,12 @@ XLATensorPtr get_dimensions_size(const XLATensorPtr& input,
                            at::ScalarType::Int);
 }
 
+XLATensorPtr memory_placement(const XLATensorPtr& input,
+                              const std::string& memory_kind) {
+  return input->CreateFrom(torch_xla::MakeNode<MemoryPlacement>(
+      input->GetIrValue(), memory_kind));
+}
+
 std::pair<XLATensorPtr, torch::lazy::Value> recv(
     XLATensorPtr& output, const torch::lazy::Value& token, int64_t channel_id) {
   torch::lazy::NodePtr node = torch_xla::MakeNode<ir::ops::Recv>(
@@ -829,6 +914,129 @@ void adam_optimizer_step_(const XLATensorPtr& found_inf, XLATensorPtr& step,
   }
 }
 
+void foreach_sgd_optimizer_step_(const XLATensorPtr& found_inf,
+                                 absl::Span<const XLATensorPtr> steps,
+                                 absl::Span<const XLATensorPtr> params,
+                                 absl::Span<const XLATensorPtr> bufs,
+                                 absl::Span<const XLATensorPtr> d_ps,
+                                 double weight_decay, double momentum,
+                                 double lr, double dampening, bool nesterov,
+                                 bool maximize, bool pack) {
+  XLA_CHECK_EQ(steps.size(), params.size());
+  XLA_CHECK_EQ(bufs.size(), params.size());
+  XLA_CHECK_EQ(d_ps.size(), params.size());
+  if (params.empty()) {
+    return;
+  }
+  // The scalar inputs are shared by all the params, and converted to the
+  // element type of each param by the lowering.
+  XLAGraphExecutor* graph_executor = XLAGraphExecutor::Get();
+  const torch::lazy::BackendDevice& device = found_inf->GetDevice();
+  torch::lazy::Value weight_decay_value = graph_executor->GetIrValueForScalar(
+      weight_decay, found_inf->shape(), device);
+  torch::lazy::Value momentum_value =
+      graph_executor->GetIrValueForScalar(momentum, found_inf->shape(), device);
+  torch::lazy::Value lr_value = graph_executor->GetIrValueForScalar(
+      maximize ? -lr : lr, found_inf->shape(), device);
+  torch::lazy::Value dampening_value = graph_executor->GetIrValueForScalar(
+      dampening, found_inf->shape(), device);
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ForeachSgdOptimizerStep>(
+      found_inf->GetIrValue(), GetIrValues(steps), GetIrValues(params),
+      GetIrValues(bufs), GetIrValues(d_ps), weight_decay_value, momentum_value,
+      lr_value, dampening_value,
+      /*use_weight_decay=*/weight_decay != 0,
+      /*use_momentum=*/momentum != 0, /*use_nesterov=*/nesterov, pack);
+  std::vector<XLATensorPtr> tensors_to_sync;
+  tensors_to_sync.reserve(params.size() * 3);
+  for (size_t i = 0; i < params.size(); ++i) {
+    steps[i]->SetInPlaceIrValue(torch::lazy::Value(node, i * 3),
+                                /*delay_eager_execution=*/true);
+    params[i]->SetInPlaceIrValue(torch::lazy::Value(node, i * 3 + 1),
+                                 /*delay_eager_execution=*/true);
+    bufs[i]->SetInPlaceIrValue(torch::lazy::Value(node, i * 3 + 2),
+                               /*delay_eager_execution=*/true);
+    tensors_to_sync.insert(tensors_to_sync.end(),
+                           {steps[i], params[i], bufs[i]});
+  }
+  if (graph_executor->UseEagerMode()) {
+    // Execute the HLO that will run the `foreach_sgd_optimizer_step_` and in
+    // one hlo
+    graph_executor->ApplyEagerSync(tensors_to_sync);
+  }
+}
+
+void foreach_adam_optimizer_step_(
+    const XLATensorPtr& found_inf, absl::Span<const XLATensorPtr> steps,
+    absl::Span<const XLATensorPtr> params,
+    absl::Span<const XLATensorPtr> grads,
+    absl::Span<const XLATensorPtr> exp_avgs,
+    absl::Span<const XLATensorPtr> exp_avg_sqs,
+    absl::Span<const XLATensorPtr> max_exp_avg_sqs, double beta1, double beta2,
+    double lr, double weight_decay, double eps, bool amsgrad, bool maximize,
+    bool use_adamw, bool pack) {
+  XLA_CHECK_EQ(steps.size(), params.size());
+  XLA_CHECK_EQ(grads.size(), params.size());
+  XLA_CHECK_EQ(exp_avgs.size(), params.size());
+  XLA_CHECK_EQ(exp_avg_sqs.size(), params.size());
+  if (amsgrad) {
+    XLA_CHECK_EQ(max_exp_avg_sqs.size(), params.size());
+  }
+  if (params.empty()) {
+    return;
+  }
+  // The scalar inputs are shared by all the params, and converted to the
+  // element type of each param by the lowering.
+  XLAGraphExecutor* graph_executor = XLAGraphExecutor::Get();
+  const torch::lazy::BackendDevice& device = found_inf->GetDevice();
+  torch::lazy::Value beta1_value =
+      graph_executor->GetIrValueForScalar(beta1, found_inf->shape(), device);
+  torch::lazy::Value beta2_value =
+      graph_executor->GetIrValueForScalar(beta2, found_inf->shape(), device);
+  torch::lazy::Value lr_value =
+      graph_executor->GetIrValueForScalar(lr, found_inf->shape(), device);
+  torch::lazy::Value weight_decay_value = graph_executor->GetIrValueForScalar(
+      weight_decay, found_inf->shape(), device);
+  torch::lazy::Value eps_value =
+      graph_executor->GetIrValueForScalar(eps, found_inf->shape(), device);
+  std::vector<torch::lazy::Value> max_exp_avg_sq_values;
+  if (amsgrad) {
+    max_exp_avg_sq_values = GetIrValues(max_exp_avg_sqs);
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ForeachAdamOptimizerStep>(
+      found_inf->GetIrValue(), GetIrValues(steps), GetIrValues(params),
+      GetIrValues(grads), GetIrValues(exp_avgs), GetIrValues(exp_avg_sqs),
+      max_exp_avg_sq_values, beta1_value, beta2_value, lr_value,
+      weight_decay_value, eps_value,
+      /*use_weight_decay=*/weight_decay != 0,
+      /*use_amsgrad=*/amsgrad, /*use_adamw=*/use_adamw, maximize, pack);
+  size_t num_outputs = amsgrad ? 5 : 4;
+  std::vector<XLATensorPtr> tensors_to_sync;
+  tensors_to_sync.reserve(params.size() * num_outputs);
+  for (size_t i = 0; i < params.size(); ++i) {
+    size_t base = i * num_outputs;
+    steps[i]->SetInPlaceIrValue(torch::lazy::Value(node, base),
+                                /*delay_eager_execution=*/true);
+    params[i]->SetInPlaceIrValue(torch::lazy::Value(node, base + 1),
+                                 /*delay_eager_execution=*/true);
+    exp_avgs[i]->SetInPlaceIrValue(torch::lazy::Value(node, base + 2),
+                                   /*delay_eager_execution=*/true);
+    exp_avg_sqs[i]->SetInPlaceIrValue(torch::lazy::Value(node, base + 3),
+                                      /*delay_eager_execution=*/true);
+    tensors_to_sync.insert(tensors_to_sync.end(),
+                           {steps[i], params[i], exp_avgs[i], exp_avg_sqs[i]});
+    if (amsgrad) {
+      max_exp_avg_sqs[i]->SetInPlaceIrValue(torch::lazy::Value(node, base + 4),
+                                            /*delay_eager_execution=*/true);
+      tensors_to_sync.push_back(max_exp_avg_sqs[i]);
+    }
+  }
+  if (graph_executor->UseEagerMode()) {
+    // Execute the HLO that will run the `foreach_adam_optimizer_step_` and in
+    // one hlo
+    graph_executor->ApplyEagerSync(tensors_to_sync);
+  }
+}
+
 std::vector<XLATensorPtr> user_computation(
     const std::string& opname, absl::Span<const XLATensorPtr> inputs,
     runtime::ComputationClient::ComputationPtr computation) {
@@ -1112,6 +1320,30 @@ XLATensorPtr baddbmm(const XLATensorPtr& input, const XLATensorPtr& batch1,
       bias_multiplier, product_multiplier));
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> batched_nms(
+    const XLATensorPtr& boxes, const XLATensorPtr& scores,
+    const XLATensorPtr& classes, const XLATensorPtr& valid_counts,
+    double iou_threshold, int64_t max_output_size, int64_t tile_size) {
+  XLA_CHECK_EQ(boxes->shape().get().dimensions_size(), 3)
+      << "batched_nms(): boxes should be of shape [B, N, 4].";
+  XLA_CHECK_EQ(boxes->size(2), 4)
+      << "batched_nms(): boxes should be of shape [B, N, 4].";
+  XLA_CHECK_GE(max_output_size, 0);
+  XLA_CHECK_GT(tile_size, 0);
+  const torch::lazy::BackendDevice& device = boxes->GetDevice();
+  torch::lazy::NodePtr xla_iou_threshold =
+      ScalarOp(iou_threshold, MakeXlaPrimitiveType(at::kDouble, &device));
+  torch::lazy::NodePtr node = torch_xla::MakeNode<BatchedNms>(
+      boxes->GetIrValue(), scores->GetIrValue(), classes->GetIrValue(),
+      valid_counts->GetIrValue(), xla_iou_threshold, max_output_size,
+      tile_size);
+  return std::make_pair(
+      XLATensor::Create(torch::lazy::Value(node, 0), device,
+                        at::ScalarType::Int),
+      XLATensor::Create(torch::lazy::Value(node, 1), device,
+                        at::ScalarType::Int));
+}
+
 XLATensorPtr bernoulli(const XLATensorPtr& input, double probability) {
   auto input_shape = input->shape();
   return input->CreateFrom(torch_xla::MakeNode<Bernoulli>(
@@ -1592,11 +1824,11 @@ XLATensorPtr embedding(const XLATensorPtr& weight,
 std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr, XLATensorPtr>
 embedding_bag(const XLATensorPtr& weight, const XLATensorPtr& indices,
               const XLATensorPtr& offsets, int64_t mode,
-              const XLATensorPtr& per_sample_weights,
-              bool include_last_offset) {
+              const XLATensorPtr& per_sample_weights, bool include_last_offset,
+              int64_t padding_idx) {
   torch::lazy::NodePtr node = torch_xla::MakeNode<EmbeddingBag>(
       weight->GetIrValue(), indices->GetIrValue(), offsets->GetIrValue(), mode,
-      per_sample_weights->GetIrValue(), include_last_offset);
+      per_sample_weights->GetIrValue(), include_last_offset, padding_idx);
 
   XLATensorPtr t1 = weight->CreateFrom(torch::lazy::Value(node, 0),
                                        /*delay_eager_execution=*/true);
@@ -1615,6 +1847,19 @@ embedding_bag(const XLATensorPtr& weight, const XLATensorPtr& indices,
   return std::make_tuple(t1, t2, t3, t4);
 }
 
+XLATensorPtr embedding_bag_backward(const XLATensorPtr& grad,
+                                    const XLATensorPtr& indices,
+                                    const XLATensorPtr& offsets,
+                                    const XLATensorPtr& max_indices,
+                                    const XLATensorPtr& per_sample_weights,
+                                    int64_t num_weights, int64_t mode,
+                                    int64_t padding_idx) {
+  return grad->CreateFrom(torch_xla::MakeNode<EmbeddingBagBackward>(
+      grad->GetIrValue(), indices->GetIrValue(), offsets->GetIrValue(),
+      max_indices->GetIrValue(), GetOptionalIrValue(per_sample_weights),
+      num_weights, mode, padding_idx));
+}
+
 XLATensorPtr exp(const XLATensorPtr& input) {
   return input->CreateFrom(Exp(input->GetIrValue()));
 }
@@ -1964,6 +2209,34 @@ XLATensorPtr linalg_vector_norm(const XLATensorPtr& input,
   return input->CreateFrom(res, dtype);
 }
 
+std::tuple<XLATensorPtr, XLATensorPtr> linear_cross_entropy(
+    const XLATensorPtr& hidden, const XLATensorPtr& weight,
+    const XLATensorPtr& target, int64_t reduction, int ignore_index,
+    int64_t vocab_block) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<LinearCrossEntropy>(
+      hidden->GetIrValue(), weight->GetIrValue(), target->GetIrValue(),
+      GetXlaReductionMode(reduction), ignore_index, vocab_block);
+  at::ScalarType stats_type = at::isReducedFloatingType(hidden->dtype())
+                                  ? at::ScalarType::Float
+                                  : hidden->dtype();
+  return std::make_tuple(
+      hidden->CreateFrom(torch::lazy::Value(node, 0)),
+      hidden->CreateFrom(torch::lazy::Value(node, 1), stats_type));
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr> linear_cross_entropy_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& hidden,
+    const XLATensorPtr& weight, const XLATensorPtr& target,
+    const XLATensorPtr& logsumexp, int64_t reduction, int ignore_index,
+    int64_t vocab_block) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<LinearCrossEntropyBackward>(
+      grad_output->GetIrValue(), hidden->GetIrValue(), weight->GetIrValue(),
+      target->GetIrValue(), logsumexp->GetIrValue(),
+      GetXlaReductionMode(reduction), ignore_index, vocab_block);
+  return std::make_tuple(hidden->CreateFrom(torch::lazy::Value(node, 0)),
+                         weight->CreateFrom(torch::lazy::Value(node, 1)));
+}
+
 XLATensorPtr linspace(const at::Scalar& start, const at::Scalar& end,
                       const int64_t steps, at::ScalarType element_type,
                       const torch::lazy::BackendDevice& device) {
@@ -2099,6 +2372,26 @@ XLATensorPtr masked_select(const XLATensorPtr& input,
   return input->CreateFrom(torch::lazy::Value(node, 0));
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> masked_select_padded(
+    const XLATensorPtr& input, const XLATensorPtr& mask, int64_t bound) {
+  int64_t max_size = xla::ShapeUtil::ElementsIn(input->shape().get());
+  int64_t padded_size = GetDynamicPaddingSize(
+      "masked_select", {input, mask},
+      [&]() {
+        torch::lazy::NodePtr node = torch_xla::MakeNode<MaskedSelect>(
+            input->GetIrValue(), mask->GetIrValue(), max_size);
+        return XLATensor::Create(torch::lazy::Value(node, 1),
+                                 input->GetDevice(), at::ScalarType::Int);
+      },
+      max_size, bound);
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MaskedSelect>(
+      input->GetIrValue(), mask->GetIrValue(), padded_size);
+  return std::make_pair(
+      input->CreateFrom(torch::lazy::Value(node, 0)),
+      XLATensor::Create(torch::lazy::Value(node, 1), input->GetDevice(),
+                        at::ScalarType::Int));
+}
+
 XLATensorPtr matmul(const XLATensorPtr& input, const XLATensorPtr& other) {
   return input->CreateFrom(MatMul(input->GetIrValue(), other->GetIrValue()));
 }
@@ -2546,6 +2839,26 @@ XLATensorPtr nonzero(const XLATensorPtr& input) {
   return XLATensor::Create(torch::lazy::Value(node, 0), input->GetDevice());
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> nonzero_padded(const XLATensorPtr& input,
+                                                     int64_t bound) {
+  int64_t max_size = xla::ShapeUtil::ElementsIn(input->shape().get());
+  int64_t padded_size = GetDynamicPaddingSize(
+      "nonzero", {input},
+      [&]() {
+        torch::lazy::NodePtr node =
+            torch_xla::MakeNode<NonZero>(input->GetIrValue(), max_size);
+        return XLATensor::Create(torch::lazy::Value(node, 1),
+                                 input->GetDevice(), at::ScalarType::Int);
+      },
+      max_size, bound);
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<NonZero>(input->GetIrValue(), padded_size);
+  return std::make_pair(
+      XLATensor::Create(torch::lazy::Value(node, 0), input->GetDevice()),
+      XLATensor::Create(torch::lazy::Value(node, 1), input->GetDevice(),
+                        at::ScalarType::Int));
+}
+
 XLATensorPtr norm(const XLATensorPtr& input, const std::optional<at::Scalar>& p,
                   std::optional<at::ScalarType> dtype, at::IntArrayRef dim,
                   bool keepdim) {
@@ -2759,6 +3072,22 @@ XLATensorPtr cast_int4(const XLATensorPtr& weight,
   return weight->CreateFrom(torch::lazy::Value(node));
 }
 
+XLATensorPtr weight_only_quantized_matmul(const XLATensorPtr& input,
+                                          const XLATensorPtr& weight,
+                                          const XLATensorPtr& scale,
+                                          const XLATensorPtr& zero_point,
+                                          int64_t bits, int64_t block_size) {
+  XLA_CHECK(weight->dtype() == at::ScalarType::Char)
+      << "Quantized weights are expected to be int8, got " << weight->dtype();
+  absl::optional<torch::lazy::Value> zero_point_value;
+  if (zero_point) {
+    zero_point_value = zero_point->GetIrValue();
+  }
+  return input->CreateFrom(torch_xla::MakeNode<WeightOnlyQuantizedMatMul>(
+      input->GetIrValue(), weight->GetIrValue(), scale->GetIrValue(),
+      zero_point_value, bits, block_size));
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Dynamic Reshape ops here.
 //////////////////////////////////////////////////////////////////////////////
@@ -2940,6 +3269,23 @@ XLATensorPtr roll(const XLATensorPtr& input, absl::Span<const int64_t> shifts,
       canonical_dims));
 }
 
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> row_sparse_coalesce(
+    const XLATensorPtr& rows, const XLATensorPtr& values, int64_t num_rows,
+    int64_t padding_idx) {
+  XLA_CHECK(rows->dtype() == at::ScalarType::Long ||
+            rows->dtype() == at::ScalarType::Int);
+  XLA_CHECK_EQ(rows->shape().get().dimensions_size(), 1);
+  XLA_CHECK_GE(values->shape().get().dimensions_size(), 1);
+  XLA_CHECK_EQ(values->size(0), rows->size(0));
+  torch::lazy::NodePtr node = torch_xla::MakeNode<RowSparseCoalesce>(
+      rows->GetIrValue(), values->GetIrValue(), num_rows, padding_idx);
+  return std::make_tuple(
+      rows->CreateFrom(torch::lazy::Value(node, 0)),
+      values->CreateFrom(torch::lazy::Value(node, 1)),
+      XLATensor::Create(torch::lazy::Value(node, 2), rows->GetDevice(),
+                        at::ScalarType::Int));
+}
+
 XLATensorPtr rrelu_with_noise(const XLATensorPtr& input, XLATensorPtr& noise,
                               const at::Scalar& lower, const at::Scalar& upper,
                               bool training) {
@@ -3022,6 +3368,45 @@ void copy_(XLATensorPtr& input, XLATensorPtr& src) {
   }
 }
 
+std::tuple<XLATensorPtr, XLATensorPtr> scaled_dot_product_attention(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, const XLATensorPtr& attn_mask, bool is_causal,
+    double scale) {
+  absl::optional<torch::lazy::Value> mask;
+  if (attn_mask) {
+    mask = attn_mask->GetIrValue();
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ScaledDotProductAttention>(
+      query->GetIrValue(), key->GetIrValue(), value->GetIrValue(), mask,
+      is_causal, scale, GetAttentionBlockSize());
+  at::ScalarType stats_type = at::isReducedFloatingType(query->dtype())
+                                  ? at::ScalarType::Float
+                                  : query->dtype();
+  return std::make_tuple(
+      query->CreateFrom(torch::lazy::Value(node, 0)),
+      query->CreateFrom(torch::lazy::Value(node, 1), stats_type));
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr>
+scaled_dot_product_attention_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& query,
+    const XLATensorPtr& key, const XLATensorPtr& value,
+    const XLATensorPtr& attn_mask, const XLATensorPtr& output,
+    const XLATensorPtr& logsumexp, bool is_causal, double scale) {
+  absl::optional<torch::lazy::Value> mask;
+  if (attn_mask) {
+    mask = attn_mask->GetIrValue();
+  }
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<ScaledDotProductAttentionBackward>(
+          grad_output->GetIrValue(), query->GetIrValue(), key->GetIrValue(),
+          value->GetIrValue(), output->GetIrValue(), logsumexp->GetIrValue(),
+          mask, is_causal, scale, GetAttentionBlockSize());
+  return std::make_tuple(query->CreateFrom(torch::lazy::Value(node, 0)),
+                         key->CreateFrom(torch::lazy::Value(node, 1)),
+                         value->CreateFrom(torch::lazy::Value(node, 2)));
+}
+
 XLATensorPtr scatter(const XLATensorPtr& input, int64_t dim,
                      const XLATensorPtr& index, const XLATensorPtr& src) {
   return input->CreateFrom(torch_xla::MakeNode<Scatter>(
@@ -3426,12 +3811,12 @@ XLATensorPtr to(XLATensorPtr& input,
 std::tuple<XLATensorPtr, XLATensorPtr> topk(const XLATensorPtr& input,
                                             int64_t k, int64_t dim,
                                             bool largest, bool sorted,
-                                            bool stable) {
+                                            bool stable, float recall_target) {
   torch::lazy::NodePtr node = torch_xla::MakeNode<TopK>(
       input->GetIrValue(), k,
       torch::lazy::GetCanonicalDimensionIndex(
           dim, input->shape().get().dimensions_size()),
-      largest, sorted, stable);
+      largest, sorted, stable, recall_target);
   XLATensorPtr t1 = input->CreateFrom(torch::lazy::Value(node, 0),
                                       /*delay_eager_execution=*/true);
   XLATensorPtr t2 =
@@ -3552,6 +3937,26 @@ void unsqueeze_(XLATensorPtr& input, int64_t dim) {
       torch_xla::MakeNode<Unsqueeze>(input->GetIrValue(), squeeze_dim));
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> unique_padded(const XLATensorPtr& input,
+                                                    int64_t bound) {
+  int64_t max_size = xla::ShapeUtil::ElementsIn(input->shape().get());
+  int64_t padded_size = GetDynamicPaddingSize(
+      "unique", {input},
+      [&]() {
+        torch::lazy::NodePtr node =
+            torch_xla::MakeNode<PaddedUnique>(input->GetIrValue(), max_size);
+        return XLATensor::Create(torch::lazy::Value(node, 1),
+                                 input->GetDevice(), at::ScalarType::Int);
+      },
+      max_size, bound);
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<PaddedUnique>(input->GetIrValue(), padded_size);
+  return std::make_pair(
+      input->CreateFrom(torch::lazy::Value(node, 0)),
+      XLATensor::Create(torch::lazy::Value(node, 1), input->GetDevice(),
+                        at::ScalarType::Int));
+}
+
 XLATensorPtr upsample_bilinear2d(const XLATensorPtr& input,
                                  std::vector<int64_t> output_size,
                                  bool align_corners) {
@@ -115,6 +115,10 @@ std::vector<XLATensorPtr> tpu_custom_call(
 XLATensorPtr get_dimensions_size(const XLATensorPtr& input,
                                  std::vector<int64_t> dimensions);
 
+// Moves input to the memory space of kind memory_kind within the graph.
+XLATensorPtr memory_placement(const XLATensorPtr& input,
+                              const std::string& memory_kind);
+
 std::pair<XLATensorPtr, torch::lazy::Value> recv(
     XLATensorPtr& output, const torch::lazy::Value& token, int64_t channel_id);
 
@@ -136,6 +140,29 @@ void adam_optimizer_step_(const XLATensorPtr& found_inf, XLATensorPtr& step,
                           double eps, bool amsgrad, bool maximize,
                           bool use_adamw);
 
+// Multi-tensor variants of the optimizer steps above. They update all the
+// params with a single IR node, sharing the scalar inputs. With pack set, the
+// params of the same dtype are updated as one flat buffer.
+void foreach_sgd_optimizer_step_(const XLATensorPtr& found_inf,
+                                 absl::Span<const XLATensorPtr> steps,
+                                 absl::Span<const XLATensorPtr> params,
+                                 absl::Span<const XLATensorPtr> bufs,
+                                 absl::Span<const XLATensorPtr> d_ps,
+                                 double weight_decay, double momentum,
+                                 double lr, double dampening, bool nesterov,
+                                 bool maximize, bool pack);
+
+// max_exp_avg_sqs is ignored unless amsgrad is set.
+void foreach_adam_optimizer_step_(
+    const XLATensorPtr& found_inf, absl::Span<const XLATensorPtr> steps,
+    absl::Span<const XLATensorPtr> params,
+    absl::Span<const XLATensorPtr> grads,
+    absl::Span<const XLATensorPtr> exp_avgs,
+    absl::Span<const XLATensorPtr> exp_avg_sqs,
+    absl::Span<const XLATensorPtr> max_exp_avg_sqs, double beta1, double beta2,
+    double lr, double weight_decay, double eps, bool amsgrad, bool maximize,
+    bool use_adamw, bool pack);
+
 std::vector<XLATensorPtr> user_computation(
     const std::string& opname, absl::Span<const XLATensorPtr> inputs,
     runtime::ComputationClient::ComputationPtr computation);
@@ -158,6 +185,14 @@ XLATensorPtr dequantize_tensor(const XLATensorPtr& input,
 XLATensorPtr cast_int4(const XLATensorPtr& weight,
                        const std::vector<int>& int4_vals);
 
+// Matmul of input with an int8 or packed int4 weight which is dequantized
+// inside the dot. The zero_point tensor is optional.
+XLATensorPtr weight_only_quantized_matmul(const XLATensorPtr& input,
+                                          const XLATensorPtr& weight,
+                                          const XLATensorPtr& scale,
+                                          const XLATensorPtr& zero_point,
+                                          int64_t bits, int64_t block_size);
+
 //////////////////////////////////////////////////////////////////////////////
 // Dynamic Reshape ops here.
 //////////////////////////////////////////////////////////////////////////////
@@ -280,6 +315,13 @@ XLATensorPtr baddbmm(const XLATensorPtr& input, const XLATensorPtr& batch1,
                      const XLATensorPtr& batch2, const at::Scalar& beta,
                      const at::Scalar& alpha);
 
+// Class-aware NMS of each image of a batch. Returns the indices of the kept
+// boxes of each image, padded to max_output_size with -1, and their number.
+std::pair<XLATensorPtr, XLATensorPtr> batched_nms(
+    const XLATensorPtr& boxes, const XLATensorPtr& scores,
+    const XLATensorPtr& classes, const XLATensorPtr& valid_counts,
+    double iou_threshold, int64_t max_output_size, int64_t tile_size);
+
 XLATensorPtr bernoulli(const XLATensorPtr& input, double probability);
 XLATensorPtr bernoulli(const XLATensorPtr& input);
 void bernoulli_(XLATensorPtr& input, const XLATensorPtr& probability);
@@ -421,7 +463,18 @@ XLATensorPtr embedding_dense_backward(const XLATensorPtr& grad_output,
 std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr, XLATensorPtr>
 embedding_bag(const XLATensorPtr& weight, const XLATensorPtr& indices,
               const XLATensorPtr& offsets, int64_t mode,
-              const XLATensorPtr& per_sample_weights, bool include_last_offset);
+              const XLATensorPtr& per_sample_weights, bool include_last_offset,
+              int64_t padding_idx);
+
+// Dense weight gradient of embedding_bag. The per_sample_weights tensor is
+// optional.
+XLATensorPtr embedding_bag_backward(const XLATensorPtr& grad,
+                                    const XLATensorPtr& indices,
+                                    const XLATensorPtr& offsets,
+                                    const XLATensorPtr& max_indices,
+                                    const XLATensorPtr& per_sample_weights,
+                                    int64_t num_weights, int64_t mode,
+                                    int64_t padding_idx);
 
 XLATensorPtr embedding(const XLATensorPtr& weight, const XLATensorPtr& indices);
 
@@ -563,6 +616,20 @@ XLATensorPtr linalg_vector_norm(const XLATensorPtr& input,
                                 std::vector<int64_t> dimensions, bool keep_dim,
                                 std::optional<at::ScalarType> dtype);
 
+// Cross entropy of the logits hidden @ weight^T against target, computed over
+// blocks of vocab_block classes without materializing the logits. Returns the
+// loss and the per token logsumexp used by the backward.
+std::tuple<XLATensorPtr, XLATensorPtr> linear_cross_entropy(
+    const XLATensorPtr& hidden, const XLATensorPtr& weight,
+    const XLATensorPtr& target, int64_t reduction, int ignore_index,
+    int64_t vocab_block);
+
+std::tuple<XLATensorPtr, XLATensorPtr> linear_cross_entropy_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& hidden,
+    const XLATensorPtr& weight, const XLATensorPtr& target,
+    const XLATensorPtr& logsumexp, int64_t reduction, int ignore_index,
+    int64_t vocab_block);
+
 XLATensorPtr linspace(const at::Scalar& start, const at::Scalar& end,
                       const int64_t steps, at::ScalarType element_type,
                       const torch::lazy::BackendDevice& device);
@@ -601,6 +668,15 @@ XLATensorPtr masked_scatter(XLATensorPtr& input, const XLATensorPtr& mask,
 
 XLATensorPtr masked_select(const XLATensorPtr& input, const XLATensorPtr& mask);
 
+// The *_padded variants of the data dependent ops return a result with a
+// static number of rows, zero filled past the valid rows, and the valid count.
+// A non-negative bound sets the number of rows, truncating the result and its
+// count if needed. Otherwise the valid count is synced to the host and rounded
+// up to a power of two, so that the graphs consuming the result compile for a
+// few sizes only.
+std::pair<XLATensorPtr, XLATensorPtr> masked_select_padded(
+    const XLATensorPtr& input, const XLATensorPtr& mask, int64_t bound);
+
 XLATensorPtr matmul(const XLATensorPtr& input, const XLATensorPtr& other);
 
 XLATensorPtr max(const XLATensorPtr& input);
@@ -729,6 +805,9 @@ XLATensorPtr nms(const XLATensorPtr& boxes, const XLATensorPtr& scores,
 
 XLATensorPtr nonzero(const XLATensorPtr& input);
 
+std::pair<XLATensorPtr, XLATensorPtr> nonzero_padded(const XLATensorPtr& input,
+                                                     int64_t bound);
+
 XLATensorPtr norm(const XLATensorPtr& input, const std::optional<at::Scalar>& p,
                   std::optional<at::ScalarType> dtype, at::IntArrayRef dim,
                   bool keepdim);
@@ -826,6 +905,14 @@ void resize_(XLATensorPtr& input, std::vector<int64_t> size);
 XLATensorPtr roll(const XLATensorPtr& input, absl::Span<const int64_t> shifts,
                   absl::Span<const int64_t> dims);
 
+// Sums the values of equal rows of the row-sparse tensor (rows, values), for
+// a dense tensor with num_rows rows. Returns the distinct rows, their values
+// and the number of distinct rows. The trailing slots hold row num_rows,
+// which scatters into the dense tensor drop.
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> row_sparse_coalesce(
+    const XLATensorPtr& rows, const XLATensorPtr& values, int64_t num_rows,
+    int64_t padding_idx);
+
 XLATensorPtr rrelu_with_noise(const XLATensorPtr& input, XLATensorPtr& noise,
                               const at::Scalar& lower, const at::Scalar& upper,
                               bool training);
@@ -846,6 +933,22 @@ XLATensorPtr rsub(
 
 void copy_(XLATensorPtr& input, XLATensorPtr& src);
 
+// Blockwise attention over the last two dimensions of query, key and value,
+// which share their batch dimensions. attn_mask is optional and broadcasts to
+// the (..., L, S) scores. Returns the output and the per row log-sum-exp used
+// by the backward.
+std::tuple<XLATensorPtr, XLATensorPtr> scaled_dot_product_attention(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, const XLATensorPtr& attn_mask, bool is_causal,
+    double scale);
+
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr>
+scaled_dot_product_attention_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& query,
+    const XLATensorPtr& key, const XLATensorPtr& value,
+    const XLATensorPtr& attn_mask, const XLATensorPtr& output,
+    const XLATensorPtr& logsumexp, bool is_causal, double scale);
+
 XLATensorPtr scatter(const XLATensorPtr& input, int64_t dim,
                      const XLATensorPtr& index, const XLATensorPtr& src);
 XLATensorPtr scatter(const XLATensorPtr& input, int64_t dim,
@@ -966,10 +1069,13 @@ XLATensorPtr to(XLATensorPtr& input,
                 std::optional<torch::lazy::BackendDevice> device,
                 std::optional<at::ScalarType> scalar_type);
 
+// A recall_target below 1 computes an approximate top-k, which may miss some
+// of the top k values.
 std::tuple<XLATensorPtr, XLATensorPtr> topk(const XLATensorPtr& input,
                                             int64_t k, int64_t dim,
                                             bool largest, bool sorted,
-                                            bool stable);
+                                            bool stable,
+                                            float recall_target = 1.0);
 
 // Returns the sum of the elements of the diagonal of the input 2-D matrix.
 XLATensorPtr trace(const XLATensorPtr& input);
@@ -996,6 +1102,10 @@ XLATensorPtr unsqueeze(const XLATensorPtr& input, int64_t dim);
 // In-place version of the method above.
 void unsqueeze_(XLATensorPtr& input, int64_t dim);
 
+// Returns the sorted unique values of the flattened input.
+std::pair<XLATensorPtr, XLATensorPtr> unique_padded(const XLATensorPtr& input,
+                                                    int64_t bound);
+
 XLATensorPtr upsample_bilinear2d(const XLATensorPtr& input,
                                  std::vector<int64_t> output_size,
                                  bool align_corners);
@@ -10,6 +10,7 @@
 #include <torch/csrc/lazy/core/tensor_util.h>
 #include <torch/csrc/lazy/core/unique.h>
 #include <torch/csrc/lazy/core/util.h>
+#include <torch/csrc/lazy/python/python_util.h>
 
 #include <algorithm>
 #include <cmath>
@@ -25,6 +26,8 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "stablehlo/dialect/Serialization.h"  // from @stablehlo
 #include "torch_xla/csrc/aten_xla_bridge.h"
@@ -40,17 +43,25 @@
 #include "torch_xla/csrc/ops/expand.h"
 #include "torch_xla/csrc/ops/expand_symint.h"
 #include "torch_xla/csrc/ops/ops.h"
+#include "torch_xla/csrc/ops/rng_seed.h"
 #include "torch_xla/csrc/ops/view.h"
 #include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/random.h"
+#include "torch_xla/csrc/recompilation_tracker.h"
+#include "torch_xla/csrc/rematerialization.h"
+#include "torch_xla/csrc/runtime/buffer_tracker.h"
 #include "torch_xla/csrc/runtime/cache.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/event_log.h"
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 #include "torch_xla/csrc/runtime/runtime.h"
 #include "torch_xla/csrc/runtime/stablehlo_helper.h"
+#include "torch_xla/csrc/runtime/step_breakdown.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
+#include "torch_xla/csrc/scalar_pool.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/status.h"
 #include "torch_xla/csrc/tensor_util.h"
@@ -99,8 +110,11 @@ XLAGraphExecutor::ComputationCache* CreateComputationCache() {
           runtime::GetComputationClientOrDie()->DeserializeComputation(
               serialization);
       if (!computation) return nullptr;
-      return std::make_shared<XLAGraphExecutor::CachedComputation>(
-          computation, /*is_sharded=*/UseVirtualDevice());
+      auto cached_computation =
+          std::make_shared<XLAGraphExecutor::CachedComputation>(
+              computation, /*is_sharded=*/UseVirtualDevice());
+      cached_computation->from_persistent_cache = true;
+      return cached_computation;
     };
     if (runtime::sys_util::GetEnvBool("XLA_HLO_DEBUG", false) ||
         runtime::sys_util::GetEnvBool("XLA_IR_DEBUG", false)) {
@@ -116,6 +130,82 @@ XLAGraphExecutor::ComputationCache* CreateComputationCache() {
   return new XLAGraphExecutor::MemoryCache(kMaxCacheSize);
 }
 
+// Returns the site of the device buffers created by the execution of the graph
+// with the given hash, or an empty site if buffer tracking is disabled.
+std::string GraphBufferSite(const torch::lazy::hash_t& hash) {
+  runtime::BufferTracker* buffer_tracker = runtime::BufferTracker::Get();
+  if (!buffer_tracker->IsEnabled()) {
+    return "";
+  }
+  return buffer_tracker->MakeSite("graph " + torch::lazy::HashToString(hash));
+}
+
+// Returns an event of the event log for the graph with the given hash, with
+// the reason and the Python frame of the sync done by the current thread.
+runtime::EventLog::Event MakeGraphEvent(const char* type,
+                                        const torch::lazy::hash_t& hash,
+                                        const std::string& device) {
+  runtime::EventLog::Event event;
+  event.type = type;
+  event.graph_hash = torch::lazy::HashToString(hash);
+  event.reason = runtime::EventLog::CurrentReason();
+  event.device = device;
+  std::vector<torch::lazy::SourceLocation> frames =
+      torch::lazy::GetPythonFrames();
+  if (frames.empty()) {
+    return event;
+  }
+  // The frame is the innermost one outside of torch and torch_xla, so that
+  // syncs done by the library are attributed to the user code calling it.
+  const torch::lazy::SourceLocation* frame = &frames.front();
+  for (const torch::lazy::SourceLocation& location : frames) {
+    if (event.reason == "to_cpu" &&
+        absl::EndsWith(location.file, "torch/_tensor_str.py")) {
+      // Tensors are printed by copying them to the CPU.
+      event.reason = "print";
+    }
+    if (location.file.find("/torch/") == std::string::npos &&
+        location.file.find("/torch_xla/") == std::string::npos) {
+      frame = &location;
+      break;
+    }
+  }
+  event.frame = absl::StrCat(frame->function, " (", frame->file, ":",
+                             frame->line, ")");
+  return event;
+}
+
+// Appends an execute event made by MakeGraphEvent(), for an execution which
+// started at start_ns and just finished.
+void AppendExecuteEvent(
+    runtime::EventLog::Event event, int64_t start_ns,
+    const std::vector<torch::lazy::BackendDataPtr>& parameters_data,
+    const std::vector<torch::lazy::BackendDataPtr>& results) {
+  event.execute_time_us = (runtime::sys_util::NowNs() - start_ns) / 1000;
+  for (const torch::lazy::BackendDataPtr& data : parameters_data) {
+    event.input_bytes +=
+        xla::ShapeUtil::ByteSizeOf(UnwrapXlaData(data)->shape());
+  }
+  for (const torch::lazy::BackendDataPtr& data : results) {
+    event.output_bytes +=
+        xla::ShapeUtil::ByteSizeOf(UnwrapXlaData(data)->shape());
+  }
+  runtime::EventLog::Get()->Append(std::move(event));
+}
+
+// Graphs take the data kept in host memory in the host memory space, so they
+// are cached apart from the graphs reading the same data from device memory.
+void MergeParameterMemoryKinds(
+    const std::vector<torch::lazy::BackendDataPtr>& parameters_data,
+    torch::lazy::hash_t* hash) {
+  for (size_t i = 0; i < parameters_data.size(); ++i) {
+    std::string memory_kind = UnwrapXlaData(parameters_data[i])->memory_kind();
+    if (!memory_kind.empty()) {
+      MergeHash(torch::lazy::MHash(i, memory_kind), hash);
+    }
+  }
+}
+
 }  // namespace
 
 auto XLAGraphExecutor::DeviceContextArena::Get() -> DeviceContextArena* {
@@ -143,37 +233,37 @@ std::vector<XLATensorPtr> XLAGraphExecutor::DeviceContextArena::GetLiveTensors(
 torch::lazy::Value XLAGraphExecutor::DeviceContextArena::GetRngSeed(
     const torch::lazy::BackendDevice& device) {
   static const at::ScalarType kSeedType = at::ScalarType::Long;
-  static const uint64_t kSeedMul = 214013;
-  static const uint64_t kSeedAdd = 2531011;
   DeviceContext* devctx = GetDeviceContext(device);
   std::lock_guard<std::mutex> lock(devctx->lock);
   if (!devctx->seed_ir_value) {
     devctx->seed_ir_value =
         IrValueFromScalar(MakeIntScalar(devctx->seed), kSeedType, device);
   }
-  // Compose new seeds from the root seed, to avoid creating too many XLA
-  // computation parameters which might overflow the TPU capacity.
-  torch::lazy::Value k = ScalarOp(MakeIntScalar(kSeedMul),
-                                  MakeXlaPrimitiveType(kSeedType, &device));
-  torch::lazy::Value b = ScalarOp(MakeIntScalar(kSeedAdd),
-                                  MakeXlaPrimitiveType(kSeedType, &device));
+  // Seeds are counter based: running_seed advances with the random ops, and
+  // each op derives its seed from the base seed and its offset from it. The
+  // seeds do not depend on each other, and the offsets only depend on the
+  // order of the random ops within the graph.
+  uint64_t offset = RngSeedDistance(devctx->seed, devctx->running_seed);
+  torch::lazy::Value seed_value =
+      torch_xla::MakeNode<RngSeed>(devctx->seed_ir_value, offset);
+  devctx->running_seed = AdvanceRngSeed(devctx->running_seed, 1);
   if (XLAGraphExecutor::Get()->UseEagerMode()) {
     // In eager mode we want to make sure that `seed_ir_value` is always just
-    // a device data instead a long sequence of pending IR.
-    torch::lazy::Value seed_to_return = devctx->seed_ir_value;
-    devctx->seed = kSeedAdd + kSeedMul * devctx->seed;
-    devctx->running_seed = devctx->seed;
-    // reset the `seed_ir_value`. Next time `seed_ir_value` will be generated
-    // based on devctx->seed.
+    // a device data holding the current counter.
+    devctx->seed = devctx->running_seed;
     devctx->seed_ir_value = torch::lazy::Value();
-    return seed_to_return;
-  } else {
-    // Keep the running seed as scalar as well, so we can return it directly
-    // without executing graphs.
-    devctx->running_seed = kSeedAdd + kSeedMul * devctx->running_seed;
-    devctx->seed_ir_value = b + k * devctx->seed_ir_value;
-    return devctx->seed_ir_value;
   }
+  return seed_value;
+}
+
+void XLAGraphExecutor::DeviceContextArena::MarkStep(
+    const torch::lazy::BackendDevice& device) {
+  // The base class advances the seed with an LCG. Continue the counter from
+  // the running seed instead, so the random values do not depend on where the
+  // graphs are split.
+  uint64_t running_seed = GetRunningSeed(device);
+  torch::lazy::LazyGraphExecutor::DeviceContextArena::MarkStep(device);
+  SetRngSeed(device, running_seed);
 }
 
 torch::lazy::BackendDataPtr
@@ -186,7 +276,6 @@ XLAGraphExecutor::DeviceContextArena::GetBaseSeedData(
                                         at::TensorOptions(kSeedType));
   torch::lazy::BackendDataPtr device_data = TensorToXlaData(tensor, device);
   devctx->seed_ir_value = torch_xla::MakeNode<DeviceData>(device_data);
-  devctx->running_seed = devctx->seed;
   return torch_xla::DeviceData::Cast(devctx->seed_ir_value.node.get())->data();
 }
 
@@ -293,6 +382,13 @@ torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
   if (torch::lazy::IsSpecialScalar(value)) {
     return ScalarOp(std::move(value), type);
   }
+  if (ScalarPool::Get()->IsEnabled()) {
+    std::optional<torch::lazy::Value> ir_value =
+        ScalarPool::Get()->GetIrValue(value, type, device);
+    if (ir_value) {
+      return *ir_value;
+    }
+  }
   return GetDeviceDataIrValue(value, type, device);
 }
 
@@ -382,6 +478,14 @@ bool XLAGraphExecutor::GetAliasWithBufferDonorConfig() {
   return DeviceContextArena::Get()->GetAliasWithBufferDonorConfig();
 }
 
+void XLAGraphExecutor::SetAutoBufferDonationConfig(bool enable) {
+  DeviceContextArena::Get()->SetAutoBufferDonationConfig(enable);
+}
+
+bool XLAGraphExecutor::GetAutoBufferDonationConfig() {
+  return DeviceContextArena::Get()->GetAutoBufferDonationConfig();
+}
+
 std::string XLAGraphExecutor::DumpHloComputation(
     const std::vector<XLATensorPtr>& tensors, EmitMode mode) {
   std::vector<torch::lazy::Value> ir_values;
@@ -417,6 +521,8 @@ void XLAGraphExecutor::SyncTensorsGraph(std::vector<XLATensorPtr>* tensors,
   auto async =
       SyncTensorsGraphInternal(tensors, devices, config, warm_up_cache_only);
   if (wait && async != nullptr && !warm_up_cache_only) {
+    runtime::StepBreakdown::ScopedPhase phase(
+        runtime::StepBreakdown::Phase::kExecuteWait);
     async->mwait.Wait();
   }
 }
@@ -439,6 +545,8 @@ void XLAGraphExecutor::MarkStep(const torch::lazy::BackendDevice& device,
   // runtime::metrics::CreatePerformanceReport(). For more information, see
   // NOTE: [TORCH_LAZY_COUNTER v.s. XLA_COUNTER].
   XLA_COUNTER("MarkStep", 1);
+  runtime::StepBreakdown::Get()->EndStep();
+  ScalarPool::Get()->MarkStep(device);
   DeviceContextArena::Get()->MarkStep(device);
   if (reset_scope) {
     torch::lazy::ScopePusher::ResetScopes();
@@ -478,6 +586,8 @@ void XLAGraphExecutor::WaitDeviceOps(absl::Span<const std::string> devices) {
   // The DeviceLockerArena::Get()->LockDevices() API returns a vector of
   // torch::lazy::ExceptionCleanup object, which is going to be freed
   // immediately, turning this operation into a lock barrier.
+  runtime::StepBreakdown::ScopedPhase phase(
+      runtime::StepBreakdown::Phase::kExecuteWait);
   DeviceLockerArena::Get()->LockDevices(wait_devices);
   TF_VLOG(4) << "XLAGraphExecutor::WaitDeviceOps completed";
 }
@@ -486,10 +596,13 @@ std::vector<at::Tensor> XLAGraphExecutor::GetTensors(
     std::vector<XLATensorPtr>* tensors) {
   TF_VLOG(4) << "Trying to get the value of " << tensors->size()
              << " tensor(s)";
+  runtime::EventLog::ScopedReason scoped_reason("to_cpu");
   SyncTensorsConfig config;
   config.force_ltc_data = false;
   auto async = SyncTensorsGraphInternal(tensors, {}, config);
   if (async != nullptr) {
+    runtime::StepBreakdown::ScopedPhase phase(
+        runtime::StepBreakdown::Phase::kExecuteWait);
     async->mwait.Wait();
   }
   std::vector<torch::lazy::BackendDataPtr> tensors_data = GatherTensorsXlaData(
@@ -531,6 +644,7 @@ torch::lazy::hash_t XLAGraphExecutor::GetGraphHash(
   // The pytorch/torch_xla revisions are already included in coll.hash.
   torch::lazy::hash_t res_hash = coll.hash;
   MergeHash(torch::lazy::Hash(po_data.parameter_sequence), &res_hash);
+  MergeParameterMemoryKinds(po_data.parameters_data, &res_hash);
   if (GetAliasWithBufferDonorConfig()) {
     std::vector<size_t> buffer_donor_index =
         GetBufferDonorIndexFromUserConfig(po_data.parameters_data);
@@ -580,6 +694,16 @@ XLAGraphExecutor::ComputationCache* XLAGraphExecutor::GetComputationCache() {
   return computation_cache_;
 }
 
+std::optional<runtime::ComputationClient::ComputationStats>
+XLAGraphExecutor::GetComputationStats(const torch::lazy::hash_t& hash) {
+  ComputationCache::TypePtr cached_computation =
+      GetComputationCache()->Get(hash);
+  if (cached_computation == nullptr) {
+    return std::nullopt;
+  }
+  return cached_computation->stats;
+}
+
 void XLAGraphExecutor::ClearPendingIrs(
     std::vector<XLATensorPtr> tensors,
     const torch::lazy::BackendDevice& device) {
@@ -641,6 +765,18 @@ XLAGraphExecutor::SyncTensorCollection XLAGraphExecutor::CollectSyncTensors(
              torch::lazy::StringHash(TORCH_GITREV),
              torch::lazy::StringHash(XLA_GITREV)},
             &coll.hash);
+  // Graphs lowered with different HLO metadata levels are cached apart, so
+  // that changing the level applies to graphs which were already compiled.
+  HloMetadataLevel metadata_level = GetHloMetadataLevel();
+  if (metadata_level != HloMetadataLevel::kNone) {
+    MergeHash(torch::lazy::MHash(static_cast<int>(metadata_level)),
+              &coll.hash);
+  }
+  // Graphs rematerialized under different budgets are cached apart as well.
+  int64_t remat_budget = GetRematerializationBudget();
+  if (remat_budget > 0) {
+    MergeHash(torch::lazy::MHash(remat_budget), &coll.hash);
+  }
   coll.config = config;
   coll.device = *unique_device;
   coll.indices.reserve(tensors.size());
@@ -724,6 +860,8 @@ void XLAGraphExecutor::TensorCollectionBarrier(SyncTensorCollection* coll) {
                                   tsl::profiler::TraceMeLevel::kInfo);
   TF_VLOG(4) << "waiting barrier for device " << coll->device.toString()
              << " start";
+  runtime::StepBreakdown::ScopedPhase phase(
+      runtime::StepBreakdown::Phase::kExecuteWait);
   torch::lazy::LazyGraphExecutor::TensorCollectionBarrier(coll);
   TF_VLOG(4) << "waiting barrier for device " << coll->device.toString()
              << " done";
@@ -736,6 +874,7 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
   tsl::profiler::TraceMe activity("ExecuteComputationWithBarrier",
                                   tsl::profiler::TraceMeLevel::kInfo);
   MaybeDumpGraph("dynamo", hash);
+  ScalarPool::Get()->Flush();
   auto cachedComputation =
       XLAGraphExecutor::Get()->GetComputationCache()->Get(hash);
   TF_VLOG(5) << "Cached computation (hash: " << torch::lazy::HashToString(hash)
@@ -792,6 +931,8 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
     tsl::profiler::TraceMe activity("DeviceBarrier",
                                     tsl::profiler::TraceMeLevel::kInfo);
     TF_VLOG(5) << "Lock device " << device.toString() << "...";
+    runtime::StepBreakdown::ScopedPhase phase(
+        runtime::StepBreakdown::Phase::kExecuteWait);
     coll.unlocker = DeviceLockerArena::Get()->LockDevices({device});
     TF_VLOG(5) << "Locking device " << device.toString() << " Done!";
   }
@@ -823,16 +964,29 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
     }
   }
 
+  // The event is made on the calling thread, which has the Python frame.
+  std::optional<runtime::EventLog::Event> event;
+  bool first_execution = !cachedComputation->executed.exchange(true);
+  if (runtime::EventLog::Get()->IsEnabled()) {
+    event = MakeGraphEvent("execute", hash, device.toString());
+    event->cache = !first_execution ? "memory"
+                   : cachedComputation->from_persistent_cache ? "persistent"
+                                                              : "miss";
+  }
   std::shared_ptr<XLAGraphExecutor::Async> async = std::make_shared<Async>(
       &coll, std::move(arguments), placeholders, std::move(cachedComputation));
 
-  auto syncfn = [async, hash, sharding_specs]() {
+  auto syncfn = [async, hash, sharding_specs,
+                 buffer_site = GraphBufferSite(hash),
+                 event = std::move(event)]() mutable {
     try {
       tsl::profiler::TraceMe activity("ExecuteComputationWithBarrier_syncfn",
                                       tsl::profiler::TraceMeLevel::kInfo);
+      runtime::BufferTracker::ScopedSite scoped_site(buffer_site);
       TF_VLOG(3) << "Executing Dynamo IR graph hash "
                  << torch::lazy::HashToString(hash) << " on device "
                  << async->device << " ...";
+      int64_t execute_start_ns = runtime::sys_util::NowNs();
 
       std::vector<torch::lazy::BackendDataPtr> results;
       if (async->cached_computation->is_sharded) {
@@ -860,6 +1014,10 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
                    << torch::lazy::HashToString(hash) << " on device "
                    << async->device << " done!";
       }
+      if (event) {
+        AppendExecuteEvent(std::move(*event), execute_start_ns,
+                           async->parameters_data, results);
+      }
 
       // Updating placeholder with actual output handle.
       {
@@ -1100,12 +1258,25 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
   tsl::profiler::TraceMe activity("ScheduleSyncTensorsGraph",
                                   tsl::profiler::TraceMeLevel::kInfo);
   TensorCollectionBarrier(coll);
+  // The event is made on the calling thread, which has the Python frame.
+  std::optional<runtime::EventLog::Event> event;
+  bool first_execution = !cached_computation->executed.exchange(true);
+  if (runtime::EventLog::Get()->IsEnabled()) {
+    event = MakeGraphEvent("execute", coll->hash, coll->device.toString());
+    event->cache = !first_execution ? "memory"
+                   : cached_computation->from_persistent_cache ? "persistent"
+                                                               : "miss";
+  }
   std::shared_ptr<XLAGraphExecutor::Async> async = std::make_shared<Async>(
       coll, std::move(parameters_data), std::move(tensors_data),
       std::move(cached_computation));
   auto syncfn = [async, hash = coll->hash, sharding_specs = sharding_specs,
-                 use_eager_mode = UseEagerMode()]() {
+                 use_eager_mode = UseEagerMode(),
+                 buffer_site = GraphBufferSite(coll->hash),
+                 event = std::move(event)]() mutable {
     try {
+      runtime::BufferTracker::ScopedSite scoped_site(buffer_site);
+      int64_t execute_start_ns = runtime::sys_util::NowNs();
       std::vector<torch::lazy::BackendDataPtr> results;
       // Execute replicated if the compiled computation is partitioned.
       if (async->cached_computation->is_sharded) {
@@ -1145,6 +1316,10 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
                    << torch::lazy::HashToString(hash) << " on device "
                    << async->device << " done!";
       }
+      if (event) {
+        AppendExecuteEvent(std::move(*event), execute_start_ns,
+                           async->parameters_data, results);
+      }
       for (size_t i = 0; i < results.size(); ++i) {
         if (async->tensors_data[i] != nullptr) {
           async->tensors_data[i]->Assign(*results[i]);
@@ -1292,6 +1467,68 @@ std::vector<size_t> GetBufferDonorIndexForStepMarker(
   return buffer_donor_indexs;
 }
 
+// Outside of a step barrier, the buffers of the synced tensors can only be
+// donated if nothing else reads them after the execution. Starting from the
+// step marker candidates, drops the buffers which are the current data of
+// another live tensor, or which the pending IR of a live tensor that is not
+// part of this sync (or the alias of a view) refers to.
+std::vector<size_t> GetBufferDonorIndexFromLiveness(
+    const std::vector<XLATensorPtr>& tensors, absl::Span<const size_t> indices,
+    const torch::lazy::BackendDevice& device,
+    const std::vector<torch::lazy::BackendDataPtr>& parameters_data) {
+  std::vector<size_t> candidates =
+      GetBufferDonorIndexForStepMarker(tensors, indices, parameters_data);
+  if (candidates.empty()) {
+    return candidates;
+  }
+  std::unordered_map<const torch::lazy::BackendData*, size_t> candidate_data;
+  for (size_t i : candidates) {
+    candidate_data.emplace(parameters_data[i].get(), i);
+  }
+  std::unordered_set<int64_t> synced_tensor_ids;
+  for (size_t index : indices) {
+    synced_tensor_ids.insert(tensors[index]->GetUniqueId());
+  }
+
+  std::vector<const torch::lazy::Node*> roots;
+  for (const XLATensorPtr& tensor :
+       XLAGraphExecutor::Get()->GetLiveTensors(&device)) {
+    torch::lazy::BackendDataPtr handle = tensor->CurrentDataHandle();
+    if (handle != nullptr) {
+      candidate_data.erase(handle.get());
+    }
+    if (!synced_tensor_ids.count(tensor->GetUniqueId())) {
+      torch::lazy::Value ir_value = tensor->CurrentIrValue();
+      if (ir_value) {
+        roots.push_back(ir_value.node.get());
+      }
+    }
+    if (tensor->data()->view != nullptr) {
+      const std::shared_ptr<Alias>& alias = tensor->data()->view->alias();
+      roots.push_back(alias->ir_value().node.get());
+      for (const Alias::UpdateData& update : alias->updates()) {
+        roots.push_back(update.ir_value.node.get());
+      }
+    }
+  }
+  if (!roots.empty() && !candidate_data.empty()) {
+    for (const torch::lazy::Node* node :
+         torch::lazy::Util::ComputePostOrder(roots)) {
+      const DeviceData* device_data = DeviceData::Cast(node);
+      if (device_data != nullptr) {
+        candidate_data.erase(device_data->data().get());
+      }
+    }
+  }
+
+  std::vector<size_t> buffer_donor_indexs;
+  for (const auto& [data, index] : candidate_data) {
+    buffer_donor_indexs.push_back(index);
+  }
+  std::sort(buffer_donor_indexs.begin(), buffer_donor_indexs.end());
+  return buffer_donor_indexs;
+}
+
 std::vector<size_t> XLAGraphExecutor::GetBufferDonors(
     const std::vector<XLATensorPtr>& tensors, const SyncTensorCollection& coll,
     const std::vector<torch::lazy::BackendDataPtr>& parameters_data) {
@@ -1339,6 +1576,13 @@ std::vector<size_t> XLAGraphExecutor::GetBufferDonors(
     // turn everything into DEVICE_DATA, so we can activate aliasing.
     ltc_buffer_donor_indices = GetBufferDonorIndexForStepMarker(
         tensors, coll.indices, parameters_data);
+  } else if (coll.config.force_ltc_data && GetAutoBufferDonationConfig()) {
+    // Syncs which do not reset the tensor state, like the eager mode ones,
+    // still replace the IR of the synced tensors with the results. Of the
+    // buffers this frees, only the ones the liveness analysis proves unread
+    // after the execution are donated.
+    ltc_buffer_donor_indices = GetBufferDonorIndexFromLiveness(
+        tensors, coll.indices, coll.device, parameters_data);
   }
 
   std::vector<size_t> user_config_buffer_donor_indices;
@@ -1364,6 +1608,24 @@ std::vector<size_t> XLAGraphExecutor::GetBufferDonors(
                  user_config_buffer_donor_indices.cbegin(),
                  user_config_buffer_donor_indices.cend(),
                  std::back_inserter(buffer_donor_indices));
+  // The outputs are in device memory, and can't reuse the buffers kept in
+  // other memory spaces.
+  buffer_donor_indices.erase(
+      std::remove_if(buffer_donor_indices.begin(), buffer_donor_indices.end(),
+                     [&](size_t i) {
+                       return !UnwrapXlaData(parameters_data[i])
+                                   ->memory_kind()
+                                   .empty();
+                     }),
+      buffer_donor_indices.end());
+  if (!buffer_donor_indices.empty()) {
+    int64_t donated_bytes = 0;
+    for (size_t i : buffer_donor_indices) {
+      donated_bytes += xla::ShapeUtil::ByteSizeOf(
+          UnwrapXlaData(parameters_data[i])->shape());
+    }
+    TORCH_LAZY_VALUE_METRIC("DonatedBufferBytes", donated_bytes);
+  }
   return buffer_donor_indices;
 }
 
@@ -1389,17 +1651,52 @@ XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
             {{"graph_hash", torch::lazy::HashToString(coll.hash)}});
       },
       tsl::profiler::TraceMeLevel::kInfo);
+  runtime::StepBreakdown::ScopedPhase phase(
+      runtime::StepBreakdown::Phase::kLowering);
   static const size_t parameter_wrapping_threadshold =
       runtime::sys_util::GetEnvInt("XLA_PARAMETER_WRAPPING_THREADSHOLD", 3200);
   static const bool use_autosharding = ShardingUtil::GetAutoSharding();
+  static const size_t parallel_lowering_threads =
+      runtime::sys_util::GetEnvInt("XLA_PARALLEL_LOWERING_THREADS", 0);
+  static const size_t parallel_lowering_min_nodes =
+      runtime::sys_util::GetEnvInt("XLA_PARALLEL_LOWERING_MIN_NODES", 10000);
   std::string graph_name =
       (CurrentGraphName() != "") ? CurrentGraphName() : "SyncTensorsGraph";
+  std::string recompilation_diff;
+  std::string recompiled_node;
+  std::optional<RecompilationTracker::Diff> diff =
+      RecompilationTracker::Get()->Record(coll.hash, po_data->post_order);
+  if (diff) {
+    recompilation_diff = diff->ToString();
+    recompiled_node = diff->node;
+    TORCH_LAZY_COUNTER("RecompilationDiff", 1);
+    TF_VLOG(1) << recompilation_diff;
+  }
+  std::vector<torch::lazy::Output> roots;
+  roots.reserve(ir_values.size());
+  for (const torch::lazy::Value& ir_value : ir_values) {
+    roots.emplace_back(ir_value.node.get(), ir_value.index);
+  }
+  size_t lowering_threads =
+      po_data->post_order.size() >= parallel_lowering_min_nodes
+          ? parallel_lowering_threads
+          : 1;
+  RematerializationPlan remat_plan = PlanRematerialization(
+      po_data->post_order, roots, GetRematerializationBudget());
+  if (!remat_plan.empty()) {
+    TF_VLOG(3) << remat_plan.ToString();
+    TORCH_LAZY_VALUE_METRIC("RematerializedNodes", remat_plan.num_recomputes);
+    TORCH_LAZY_VALUE_METRIC(
+        "RematerializationSavedBytes",
+        remat_plan.peak_bytes - remat_plan.rematerialized_peak_bytes);
+    TORCH_LAZY_VALUE_METRIC("RematerializationExtraFlops",
+                            remat_plan.extra_flops);
+  }
   LoweringContext lowering_ctx(graph_name, coll.device, po_data->post_order,
-                               std::move(po_data->emission_map));
-  for (auto ir_value : ir_values) {
-    xla::XlaOp root = lowering_ctx.GetOutputOp(
-        torch::lazy::Output(ir_value.node.get(), ir_value.index));
-    lowering_ctx.AddResult(root);
+                               std::move(po_data->emission_map), roots,
+                               lowering_threads, &remat_plan);
+  for (const torch::lazy::Output& root : roots) {
+    lowering_ctx.AddResult(lowering_ctx.GetOutputOp(root));
   }
   // Always execute sharded when running in SPMD mode
   bool is_sharded = (coll.device == GetVirtualDevice()) || UseVirtualDevice();
@@ -1465,7 +1762,8 @@ XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
 
   DebugUtil::analyze_graph_execution_python_frame(
       DebugUtil::GraphAnalysisSource::Compilation,
-      /*graph_hash=*/coll.hash, /*program_shape=*/&program_shape);
+      /*graph_hash=*/coll.hash, /*program_shape=*/&program_shape,
+      recompilation_diff);
 
   TF_VLOG(3) << "Compiling IR graph hash "
              << torch::lazy::HashToString(coll.hash) << " on device "
@@ -1503,7 +1801,8 @@ XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
           /*emitted_nodes=*/lowering_ctx.GetEmittedNodeCount(),
           /*computation=*/computations.front(),
           /*parameters_data=*/std::move(po_data->parameters_data),
-          /*is_sharded=*/is_sharded};
+          /*is_sharded=*/is_sharded,
+          /*recompiled_node=*/std::move(recompiled_node)};
 }
 
 std::shared_ptr<XLAGraphExecutor::Async>
@@ -1512,6 +1811,8 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
     const SyncTensorsConfig& config, bool warm_up_cache_only) {
   tsl::profiler::TraceMe activity("SyncTensorsGraphInternal",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  runtime::StepBreakdown::ScopedPhase phase(
+      runtime::StepBreakdown::Phase::kHashing);
   SyncTensorCollection coll = CollectSyncTensors(*tensors, config);
   if (coll.indices.empty()) {
     // Enure previous execution is complete before exiting this
@@ -1535,8 +1836,11 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
   std::vector<torch::lazy::BackendDataPtr> tensor_data_vec;
   ExtractIRAndPrepareXlaData_(tensors, coll.config, coll.indices, ir_values,
                               tensor_data_vec);
+  // The graph may read scalars which are not transferred yet.
+  ScalarPool::Get()->Flush();
   PostOrderData po_data = RunPostOrder(ir_values, &coll);
   MergeHash(torch::lazy::Hash(po_data.parameter_sequence), &coll.hash);
+  MergeParameterMemoryKinds(po_data.parameters_data, &coll.hash);
 
   std::vector<size_t> buffer_donor_indices =
       GetBufferDonors(*tensors, coll, po_data.parameters_data);
@@ -1564,14 +1868,50 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
     // we have a cache hit, execution has been scheduled by TryRunCachedSync.
     return cache_res.second;
   }
+  int64_t compile_start_ns = runtime::sys_util::NowNs();
   CompilationResult compile_result = Compile(*tensors, devices, coll, &po_data,
                                              ir_values, buffer_donor_indices);
+  int64_t compile_time_ns = runtime::sys_util::NowNs() - compile_start_ns;
 
   TORCH_LAZY_VALUE_METRIC("TensorsGraphSize", compile_result.emitted_nodes);
   TF_VLOG(5) << "TensorsGraphSize=" << compile_result.emitted_nodes;
   auto cached_computation = std::make_shared<CachedComputation>(
       std::move(compile_result.computation), compile_result.is_sharded);
   GetComputationCache()->Add(coll.hash, cached_computation);
+  if (runtime::EventLog::Get()->IsEnabled()) {
+    runtime::EventLog::Event event = MakeGraphEvent(
+        "compile", coll.hash, compile_result.device.toString());
+    event.cache = "miss";
+    event.compile_time_us = compile_time_ns / 1000;
+    event.input_bytes =
+        std::max<int64_t>(cached_computation->stats.argument_size_in_bytes, 0);
+    event.output_bytes =
+        std::max<int64_t>(cached_computation->stats.output_size_in_bytes, 0);
+    event.num_parameters = compile_result.parameters_data.size();
+    int64_t logical_bytes = 0;
+    for (const torch::lazy::BackendDataPtr& data :
+         compile_result.parameters_data) {
+      const xla::Shape& shape = UnwrapXlaData(data)->shape();
+      event.num_scalar_parameters += shape.dimensions_size() == 0;
+      logical_bytes += xla::ShapeUtil::ByteSizeOf(shape);
+    }
+    xla::ShapeUtil::ForEachSubshape(
+        cached_computation->computation->program_shape().result(),
+        [&](const xla::Shape& subshape, const xla::ShapeIndex& index) {
+          if (subshape.IsArray()) {
+            logical_bytes += xla::ShapeUtil::ByteSizeOf(subshape);
+          }
+        });
+    // The sizes on the device are unknown to some runtimes. Under SPMD they
+    // are the sizes of one shard, which the logical shapes do not match.
+    if (event.input_bytes > 0 && event.output_bytes > 0 &&
+        !compile_result.is_sharded) {
+      event.padding_bytes = std::max<int64_t>(
+          event.input_bytes + event.output_bytes - logical_bytes, 0);
+    }
+    event.recompiled_node = std::move(compile_result.recompiled_node);
+    runtime::EventLog::Get()->Append(std::move(event));
+  }
 
   if (warm_up_cache_only) {
     return nullptr;
@@ -5,8 +5,10 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/lazy/core/ir_util.h>
 
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 
@@ -19,6 +21,7 @@
 #include "torch_xla/csrc/lowering_context.h"
 #include "torch_xla/csrc/runtime/cache.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/tensor.h"
 #include "torch_xla/csrc/torch_util.h"
@@ -102,6 +105,12 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
 
   bool GetAliasWithBufferDonorConfig();
 
+  // When enabled, syncs which are not step barriers donate the parameter
+  // buffers of the synced tensors that no other live tensor refers to.
+  void SetAutoBufferDonationConfig(bool enable);
+
+  bool GetAutoBufferDonationConfig();
+
   // Dumps the XLA HLO text of the computation accumulated in the graph which is
   // attached the tensors.
   // We don't use upstream DumpBackendComputation given we have our own format.
@@ -167,10 +176,21 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   struct CachedComputation {
     CachedComputation(runtime::ComputationClient::ComputationPtr computation,
                       bool is_sharded = false)
-        : computation(std::move(computation)), is_sharded(is_sharded) {}
+        : computation(std::move(computation)),
+          is_sharded(is_sharded),
+          stats(this->computation
+                    ? this->computation->get_computation_stats()
+                    : runtime::ComputationClient::ComputationStats()) {}
 
     runtime::ComputationClient::ComputationPtr computation;
     bool is_sharded;
+    // Collected once at compile or cache load time.
+    runtime::ComputationClient::ComputationStats stats;
+    // Whether the computation was loaded from the persistent cache, rather
+    // than compiled by this process.
+    bool from_persistent_cache = false;
+    // Set by the first execution, for the cache tier of the event log.
+    std::atomic<bool> executed{false};
   };
 
   using ComputationCache =
@@ -186,6 +206,11 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   ComputationCache* GetComputationCache();
   bool IsComputationCacheInitialized();
 
+  // Returns the stats of the cached computation with the given graph hash, if
+  // it is in the computation cache.
+  std::optional<runtime::ComputationClient::ComputationStats>
+  GetComputationStats(const torch::lazy::hash_t& hash);
+
   std::vector<torch::lazy::BackendDataPtr> ExecuteComputationWithBarrier(
       torch::lazy::hash_t hash, const std::vector<at::IValue>& graph_inputs,
       const torch::lazy::BackendDevice& device);
@@ -225,6 +250,8 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
     runtime::ComputationClient::ComputationPtr computation;
     std::vector<torch::lazy::BackendDataPtr> parameters_data;
     bool is_sharded = false;
+    // The first node which differs from the nearest graph compiled before.
+    std::string recompiled_node;
   };
 
   struct Async : public torch::lazy::LazyGraphExecutor::Async {
@@ -245,10 +272,13 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
     std::vector<XLATensorPtr> GetLiveTensors(
         const torch::lazy::BackendDevice* device);
 
-    // We override this to use our own + and * for torch::lazy::Value.
+    // We override this to return counter based seeds.
     torch::lazy::Value GetRngSeed(
         const torch::lazy::BackendDevice& device) final;
 
+    // Hides the base class MarkStep(), which reseeds the device.
+    void MarkStep(const torch::lazy::BackendDevice& device);
+
     torch::lazy::BackendDataPtr GetBaseSeedData(
         const torch::lazy::BackendDevice& device);
 
@@ -270,6 +300,12 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
       enable_user_config_aliasing_ = enable_alias;
     }
 
+    bool GetAutoBufferDonationConfig() { return enable_auto_donation_; }
+
+    void SetAutoBufferDonationConfig(bool enable) {
+      enable_auto_donation_ = enable;
+    }
+
     void SaveGraphAsString(
         torch::lazy::hash_t hash, absl::Span<const XLATensorPtr> tensors,
         const std::vector<size_t>* indices,
@@ -292,6 +328,8 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
                        torch::lazy::HashReducer>
         hash_to_output_shape_map_;
     bool enable_user_config_aliasing_ = false;
+    bool enable_auto_donation_ =
+        runtime::sys_util::GetEnvBool("XLA_AUTO_BUFFER_DONATION", false);
   };
 
   XLAGraphExecutor() = default;
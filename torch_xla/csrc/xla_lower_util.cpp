@@ -4,6 +4,7 @@
 #include <torch/csrc/lazy/core/util.h>
 
 #include <algorithm>
+#include <tuple>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -19,6 +20,7 @@
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/status.h"
 #include "torch_xla/csrc/tensor_util.h"
+#include "xla/hlo/builder/lib/approx_topk.h"
 #include "xla/hlo/builder/lib/arithmetic.h"
 #include "xla/hlo/builder/lib/comparators.h"
 #include "xla/hlo/builder/lib/constants.h"
@@ -273,7 +275,40 @@ xla::XlaOp XlaDenseScatter(xla::XlaOp input, xla::XlaOp index, xla::XlaOp src,
   });
 }
 
-std::vector<xla::XlaOp> BuildConditionIndices(xla::XlaOp condition) {
+// Resizes dimension 0 of a data dependent result to padded_size, with zeros in
+// the rows past length, so that the result has a static shape. Returns the
+// resized result and the number of valid rows it kept.
+std::vector<xla::XlaOp> PadConditionResult(xla::XlaOp result,
+                                           xla::XlaOp length,
+                                           int64_t padded_size) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(result);
+  int64_t size = shape.dimensions(0);
+  if (padded_size < size) {
+    result = xla::SliceInDim(result, 0, padded_size, 1, 0);
+  } else if (padded_size > size) {
+    result = xla::PadInDim(
+        result, xla::Zero(result.builder(), shape.element_type()), 0,
+        /*pad_lo=*/0, /*pad_hi=*/padded_size - size);
+  }
+  const xla::Shape& padded_shape = ShapeHelper::ShapeOfXlaOp(result);
+  xla::PrimitiveType length_type =
+      ShapeHelper::ShapeOfXlaOp(length).element_type();
+  xla::Shape iota_shape =
+      xla::ShapeUtil::MakeShape(length_type, padded_shape.dimensions());
+  xla::XlaOp valid = xla::Lt(xla::Iota(result.builder(), iota_shape, 0),
+                             length);
+  // The rows truncated past padded_size are not valid rows of the result.
+  xla::XlaOp kept_length = xla::Min(
+      length,
+      XlaHelpers::ScalarValue<int64_t>(padded_size, length_type,
+                                       result.builder()));
+  return {xla::Select(valid, result, xla::ZerosLike(result)), kept_length};
+}
+
+// With padded_size >= 0 the indices are padded with zeros to padded_size rows,
+// rather than having a dynamic dimension 0.
+std::vector<xla::XlaOp> BuildConditionIndices(xla::XlaOp condition,
+                                              int64_t padded_size = -1) {
   ConditionMaskData cmd = CreateConditionMaskData(condition);
   std::vector<xla::XlaOp> to_sort = {cmd.r1_condition_int};
   std::vector<xla::PrimitiveType> types_to_sort = {cmd.condition_int_type};
@@ -297,10 +332,244 @@ std::vector<xla::XlaOp> BuildConditionIndices(xla::XlaOp condition) {
   }
 
   xla::XlaOp result = xla::ConcatInDim(condition.builder(), to_concat, 1);
+  if (padded_size >= 0) {
+    return PadConditionResult(result, cmd.length, padded_size);
+  }
   xla::XlaOp result_padded = xla::SetDimensionSize(result, cmd.length, 0);
   return {result_padded, cmd.length};
 }
 
+// Moves the elements of the rank 1 input whose condition is set to the front,
+// keeping their order. Returns the moved input and the number of such
+// elements.
+std::pair<xla::XlaOp, xla::XlaOp> CompactR1(xla::XlaOp r1_input,
+                                            xla::XlaOp r1_condition) {
+  ConditionMaskData cmd = CreateConditionMaskData(r1_condition);
+  std::vector<xla::XlaOp> to_sort = {cmd.r1_condition_int, r1_input};
+  std::vector<xla::PrimitiveType> types_to_sort = {
+      cmd.condition_int_type, XlaHelpers::TypeOfXlaOp(r1_input)};
+  xla::XlaOp sorted = xla::Sort(
+      to_sort,
+      xla::CreateScalarGtComputation(types_to_sort, r1_input.builder()),
+      /*dimension=*/0,
+      /*is_stable=*/true);
+  return {xla::GetTupleElement(sorted, 1), cmd.length};
+}
+
+// A partial top-k is faster than a full sort only if k is a small fraction of
+// the size of the dimension.
+constexpr int64_t kPartialTopKMaxFraction = 8;
+
+bool UsePartialTopK(int64_t k, int64_t dim_size) {
+  return k * kPartialTopKMaxFraction <= dim_size;
+}
+
+// Returns the k largest (or smallest) values along dim, in sorted order, with
+// their S32 indices. xla::TopK works on the last dimension, so dim is swapped
+// with it if needed.
+std::pair<xla::XlaOp, xla::XlaOp> BuildPartialTopK(xla::XlaOp input, int64_t k,
+                                                   int64_t dim, bool largest) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  int64_t last_dim = shape.dimensions_size() - 1;
+  std::vector<int64_t> permutation = torch::lazy::Iota<int64_t>(last_dim + 1);
+  std::swap(permutation[dim], permutation[last_dim]);
+  if (dim != last_dim) {
+    input = xla::Transpose(input, permutation);
+  }
+  xla::XlaOp topk = xla::TopK(input, k, largest);
+  xla::XlaOp values = xla::GetTupleElement(topk, 0);
+  xla::XlaOp indices = xla::GetTupleElement(topk, 1);
+  if (dim != last_dim) {
+    // Swapping two dimensions is its own inverse permutation.
+    values = xla::Transpose(values, permutation);
+    indices = xla::Transpose(indices, permutation);
+  }
+  return {values, indices};
+}
+
+// Approximate top-k, which trades the given expected recall for speed on TPU.
+// Other backends compute the exact result.
+std::pair<xla::XlaOp, xla::XlaOp> BuildApproxTopK(xla::XlaOp input, int64_t k,
+                                                  int64_t dim, bool largest,
+                                                  float recall_target) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  xla::XlaBuilder* builder = input.builder();
+  xla::Shape iota_shape =
+      xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, shape.dimensions());
+  xla::XlaOp iota = xla::Iota(builder, iota_shape, dim);
+  xla::XlaComputation comparator =
+      largest ? xla::CreateScalarGtComputation(
+                    {shape.element_type(), xla::PrimitiveType::S32}, builder)
+              : xla::CreateScalarLtComputation(
+                    {shape.element_type(), xla::PrimitiveType::S32}, builder);
+  XlaHelpers::MinMax min_max = XlaHelpers::MinMaxValues(shape.element_type());
+  xla::XlaOp init_value = XlaHelpers::ScalarValue(
+      largest ? min_max.min : min_max.max, shape.element_type(), builder);
+  xla::XlaOp result = xla::ApproxTopK(
+      builder, {input, iota},
+      {init_value, xla::ConstantR0<int32_t>(builder, -1)}, k, dim, comparator,
+      recall_target, /*aggregate_to_topk=*/true);
+  return {xla::GetTupleElement(result, 0), xla::GetTupleElement(result, 1)};
+}
+
+// Splits the indices of params into the groups that a multi-tensor optimizer
+// step updates together. With packing, all the params of the same element type
+// form one group. Packing needs static shapes, and is skipped otherwise.
+std::vector<std::vector<size_t>> GroupOptimizerParams(
+    absl::Span<const xla::XlaOp> params, bool pack) {
+  bool packable = pack;
+  for (const xla::XlaOp& param : params) {
+    packable = packable && ShapeHelper::ShapeOfXlaOp(param).is_static();
+  }
+  std::vector<std::vector<size_t>> groups;
+  std::vector<xla::PrimitiveType> group_types;
+  for (size_t i = 0; i < params.size(); ++i) {
+    xla::PrimitiveType type =
+        ShapeHelper::ShapeOfXlaOp(params[i]).element_type();
+    auto it = std::find(group_types.begin(), group_types.end(), type);
+    if (!packable || it == group_types.end()) {
+      groups.push_back({i});
+      group_types.push_back(type);
+    } else {
+      groups[it - group_types.begin()].push_back(i);
+    }
+  }
+  return groups;
+}
+
+// Concatenates the flattened ops selected by group into one rank 1 buffer.
+xla::XlaOp PackFlat(absl::Span<const xla::XlaOp> ops,
+                    absl::Span<const size_t> group) {
+  std::vector<xla::XlaOp> flat_ops;
+  flat_ops.reserve(group.size());
+  for (size_t i : group) {
+    flat_ops.push_back(XlaHelpers::Flatten(ops[i]));
+  }
+  return xla::ConcatInDim(ops[group.front()].builder(), flat_ops, 0);
+}
+
+// Like PackFlat(), but broadcasts each scalar to the number of elements of the
+// matching tensor in like.
+xla::XlaOp PackBroadcast(absl::Span<const xla::XlaOp> scalars,
+                         absl::Span<const xla::XlaOp> like,
+                         absl::Span<const size_t> group) {
+  std::vector<xla::XlaOp> flat_ops;
+  flat_ops.reserve(group.size());
+  for (size_t i : group) {
+    flat_ops.push_back(xla::Broadcast(
+        scalars[i], {xla::ShapeUtil::ElementsIn(
+                        ShapeHelper::ShapeOfXlaOp(like[i]))}));
+  }
+  return xla::ConcatInDim(scalars[group.front()].builder(), flat_ops, 0);
+}
+
+// Splits a buffer built by PackFlat() back into ops shaped like the ones in
+// like.
+std::vector<xla::XlaOp> UnpackFlat(xla::XlaOp flat,
+                                   absl::Span<const xla::XlaOp> like,
+                                   absl::Span<const size_t> group) {
+  std::vector<xla::XlaOp> ops;
+  ops.reserve(group.size());
+  int64_t offset = 0;
+  for (size_t i : group) {
+    const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(like[i]);
+    int64_t size = xla::ShapeUtil::ElementsIn(shape);
+    ops.push_back(xla::Reshape(
+        xla::SliceInDim(flat, offset, offset + size, 1, 0),
+        shape.dimensions()));
+    offset += size;
+  }
+  return ops;
+}
+
+// Increments the step counter of an optimizer unless found_inf is set.
+xla::XlaOp IncrementStepIfFinite(xla::XlaOp found_inf, xla::XlaOp step) {
+  xla::PrimitiveType found_inf_type =
+      ShapeHelper::ShapeOfXlaOp(found_inf).element_type();
+  xla::XlaOp not_found_inf = xla::ConvertElementType(
+      xla::Eq(found_inf, xla::Zero(found_inf.builder(), found_inf_type)),
+      ShapeHelper::ShapeOfXlaOp(step).element_type());
+  return step + not_found_inf;
+}
+
+// Returns the IoU of every box of a [B, M, 4] tensor with every box of a
+// [B, K, 4] tensor, as a [B, M, K] tensor.
+xla::XlaOp BuildPairwiseIou(xla::XlaOp lhs, xla::XlaOp rhs) {
+  const xla::Shape& lhs_shape = ShapeHelper::ShapeOfXlaOp(lhs);
+  const xla::Shape& rhs_shape = ShapeHelper::ShapeOfXlaOp(rhs);
+  int64_t batch = lhs_shape.dimensions(0);
+  std::vector<int64_t> sizes = {batch, lhs_shape.dimensions(1),
+                                rhs_shape.dimensions(1)};
+  auto coordinate = [&](xla::XlaOp boxes, int64_t n, int64_t index,
+                        int64_t dim) {
+    xla::XlaOp values = xla::Reshape(
+        xla::SliceInDim(boxes, index, index + 1, 1, 2), {batch, n});
+    return xla::BroadcastInDim(values, sizes, {0, dim});
+  };
+  std::vector<xla::XlaOp> a;
+  std::vector<xla::XlaOp> b;
+  for (int64_t i = 0; i < 4; ++i) {
+    a.push_back(coordinate(lhs, sizes[1], i, 1));
+    b.push_back(coordinate(rhs, sizes[2], i, 2));
+  }
+  xla::XlaOp zero = xla::ZerosLike(a[0]);
+  xla::XlaOp width =
+      xla::Max(xla::Min(a[2], b[2]) - xla::Max(a[0], b[0]), zero);
+  xla::XlaOp height =
+      xla::Max(xla::Min(a[3], b[3]) - xla::Max(a[1], b[1]), zero);
+  xla::XlaOp intersection = width * height;
+  xla::XlaOp lhs_area = (a[2] - a[0]) * (a[3] - a[1]);
+  xla::XlaOp rhs_area = (b[2] - b[0]) * (b[3] - b[1]);
+  return intersection / (lhs_area + rhs_area - intersection);
+}
+
+// Reduces a boolean tensor with a logical or over the given dimensions.
+xla::XlaOp ReduceAny(xla::XlaOp input, absl::Span<const int64_t> dims) {
+  xla::XlaBuilder* builder = input.builder();
+  return xla::Reduce(
+      input, xla::ConstantR0<bool>(builder, false),
+      xla::CreateScalarOrComputation(xla::PrimitiveType::PRED, builder), dims);
+}
+
+// Clears the keep flag of the [B, T] tile boxes overlapping a kept box of the
+// same tile with a higher score. The flag of a box only depends on the flags
+// of the boxes before it, so iterating to a fixed point yields the greedy
+// selection, usually in a few iterations rather than T.
+xla::XlaOp BuildTileSelfSuppression(xla::XlaOp tile_boxes, xla::XlaOp tile_keep,
+                                    xla::XlaOp iou_threshold) {
+  xla::XlaBuilder* builder = tile_boxes.builder();
+  const xla::Shape& keep_shape = ShapeHelper::ShapeOfXlaOp(tile_keep);
+  int64_t batch = keep_shape.dimensions(0);
+  int64_t tile_size = keep_shape.dimensions(1);
+  std::vector<int64_t> sizes = {batch, tile_size, tile_size};
+  xla::Shape iota_shape =
+      xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, sizes);
+  xla::XlaOp overlaps = xla::And(
+      xla::Gt(BuildPairwiseIou(tile_boxes, tile_boxes), iou_threshold),
+      xla::Lt(xla::Iota(builder, iota_shape, 1),
+              xla::Iota(builder, iota_shape, 2)));
+
+  std::vector<xla::XlaOp> init_values = {
+      tile_keep, tile_keep, overlaps, xla::ConstantR0<bool>(builder, true)};
+  std::vector<xla::XlaOp> result = GetValueOrThrow(xla::WhileLoopHelper(
+      [](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        return values[3];
+      },
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        xla::XlaOp initial_keep = values[0];
+        xla::XlaOp keep = values[1];
+        xla::XlaOp overlaps = values[2];
+        xla::XlaOp suppressed = ReduceAny(
+            xla::And(overlaps, xla::BroadcastInDim(keep, sizes, {0, 1})), {1});
+        xla::XlaOp new_keep = xla::And(initial_keep, xla::Not(suppressed));
+        xla::XlaOp changed = ReduceAny(xla::Ne(new_keep, keep), {0, 1});
+        return std::vector<xla::XlaOp>{initial_keep, new_keep, overlaps,
+                                       changed};
+      },
+      init_values, "TileSelfSuppression", builder));
+  return result[1];
+}
+
 }  // namespace
 
 xla::XlaOp PadToSize(xla::XlaOp input, absl::Span<const int64_t> size,
@@ -327,26 +596,37 @@ std::vector<xla::XlaOp> CreateKthValue(xla::XlaOp input, int64_t k, int64_t dim,
   // Here 'k' is 1 based (1...).
   const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
   XLA_CHECK_LE(k, shape.dimensions(dim));
-  xla::Shape iota_shape =
-      xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, shape.dimensions());
-  xla::XlaOp iota = xla::Iota(input.builder(), iota_shape, dim);
-  xla::XlaOp sort_result = xla::Sort(
-      {input, iota},
-      xla::CreateScalarLtComputation(
-          {shape.element_type(), xla::PrimitiveType::S32}, input.builder()),
-      dim);
-
-  std::vector<int64_t> start_indices(shape.dimensions_size(), 0);
-  start_indices[dim] = k - 1;
-  std::vector<int64_t> limit_indices(shape.dimensions().begin(),
-                                     shape.dimensions().end());
-  limit_indices[dim] = k;
-  std::vector<int64_t> strides(shape.dimensions_size(), 1);
-
-  xla::XlaOp values = xla::Slice(xla::GetTupleElement(sort_result, 0),
-                                 start_indices, limit_indices, strides);
-  xla::XlaOp indices = xla::Slice(xla::GetTupleElement(sort_result, 1),
-                                  start_indices, limit_indices, strides);
+  int64_t dim_size = shape.dimensions(dim);
+  // The k-th smallest value is also the (n - k + 1)-th largest one, so either
+  // end of the dimension can be searched with a partial top-k.
+  int64_t kth_position = k - 1;
+  xla::XlaOp sorted_values;
+  xla::XlaOp sorted_indices;
+  if (!shape.is_dynamic_dimension(dim) && UsePartialTopK(k, dim_size)) {
+    std::tie(sorted_values, sorted_indices) =
+        BuildPartialTopK(input, k, dim, /*largest=*/false);
+  } else if (!shape.is_dynamic_dimension(dim) &&
+             UsePartialTopK(dim_size - k + 1, dim_size)) {
+    std::tie(sorted_values, sorted_indices) =
+        BuildPartialTopK(input, dim_size - k + 1, dim, /*largest=*/true);
+    kth_position = dim_size - k;
+  } else {
+    xla::Shape iota_shape =
+        xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, shape.dimensions());
+    xla::XlaOp iota = xla::Iota(input.builder(), iota_shape, dim);
+    xla::XlaOp sort_result = xla::Sort(
+        {input, iota},
+        xla::CreateScalarLtComputation(
+            {shape.element_type(), xla::PrimitiveType::S32}, input.builder()),
+        dim);
+    sorted_values = xla::GetTupleElement(sort_result, 0);
+    sorted_indices = xla::GetTupleElement(sort_result, 1);
+  }
+
+  xla::XlaOp values =
+      xla::SliceInDim(sorted_values, kth_position, kth_position + 1, 1, dim);
+  xla::XlaOp indices =
+      xla::SliceInDim(sorted_indices, kth_position, kth_position + 1, 1, dim);
   if (!keepdim) {
     auto reshape_sizes = torch::lazy::DropDimensions(
         runtime::util::ToVector<int64_t>(shape.dimensions()),
@@ -361,32 +641,36 @@ std::vector<xla::XlaOp> CreateKthValue(xla::XlaOp input, int64_t k, int64_t dim,
 }
 
 std::vector<xla::XlaOp> CreateTopK(xla::XlaOp input, int64_t k, int64_t dim,
-                                   bool largest, bool stable) {
+                                   bool largest, bool stable,
+                                   float recall_target) {
   // Here 'k' is 1 based (1...).
   const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
   XLA_CHECK_LE(k, shape.dimensions(dim));
-  xla::Shape iota_shape =
-      xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, shape.dimensions());
-  xla::XlaOp iota = xla::Iota(input.builder(), iota_shape, dim);
-  xla::XlaComputation comparator =
-      largest ? xla::CreateScalarGtComputation(
-                    {shape.element_type(), xla::PrimitiveType::S32},
-                    input.builder())
-              : xla::CreateScalarLtComputation(
-                    {shape.element_type(), xla::PrimitiveType::S32},
-                    input.builder());
-  xla::XlaOp sort_result = xla::Sort({input, iota}, comparator, dim, stable);
-
-  std::vector<int64_t> start_indices(shape.dimensions_size(), 0);
-  std::vector<int64_t> limit_indices(shape.dimensions().begin(),
-                                     shape.dimensions().end());
-  limit_indices[dim] = k;
-  std::vector<int64_t> strides(shape.dimensions_size(), 1);
-
-  xla::XlaOp values = xla::Slice(xla::GetTupleElement(sort_result, 0),
-                                 start_indices, limit_indices, strides);
-  xla::XlaOp indices = xla::Slice(xla::GetTupleElement(sort_result, 1),
-                                  start_indices, limit_indices, strides);
+  xla::XlaOp values;
+  xla::XlaOp indices;
+  if (recall_target < 1.0) {
+    std::tie(values, indices) =
+        BuildApproxTopK(input, k, dim, largest, recall_target);
+  } else if (!stable && !shape.is_dynamic_dimension(dim) &&
+             UsePartialTopK(k, shape.dimensions(dim))) {
+    std::tie(values, indices) = BuildPartialTopK(input, k, dim, largest);
+  } else {
+    xla::Shape iota_shape =
+        xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, shape.dimensions());
+    xla::XlaOp iota = xla::Iota(input.builder(), iota_shape, dim);
+    xla::XlaComputation comparator =
+        largest ? xla::CreateScalarGtComputation(
+                      {shape.element_type(), xla::PrimitiveType::S32},
+                      input.builder())
+                : xla::CreateScalarLtComputation(
+                      {shape.element_type(), xla::PrimitiveType::S32},
+                      input.builder());
+    xla::XlaOp sort_result = xla::Sort({input, iota}, comparator, dim, stable);
+    values =
+        xla::SliceInDim(xla::GetTupleElement(sort_result, 0), 0, k, 1, dim);
+    indices =
+        xla::SliceInDim(xla::GetTupleElement(sort_result, 1), 0, k, 1, dim);
+  }
   // aten::topk() wants Long tensors as indices.
   return {values,
           xla::ConvertElementType(indices, GetXlaPrimitiveTypeForCurrentDevice(
@@ -477,6 +761,34 @@ xla::XlaOp BuildDot(xla::XlaOp lhs, xla::XlaOp rhs) {
   return xla::Dot(lhs, rhs, &precision_config);
 }
 
+xla::XlaOp BuildBatchDot(xla::XlaOp lhs, int64_t lhs_dim, xla::XlaOp rhs,
+                         int64_t rhs_dim, xla::PrimitiveType type) {
+  int64_t rank = ShapeHelper::ShapeOfXlaOp(lhs).dimensions_size();
+  xla::DotDimensionNumbers dims;
+  for (int64_t i = 0; i < rank - 2; ++i) {
+    dims.add_lhs_batch_dimensions(i);
+    dims.add_rhs_batch_dimensions(i);
+  }
+  dims.add_lhs_contracting_dimensions(lhs_dim);
+  dims.add_rhs_contracting_dimensions(rhs_dim);
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  return xla::DotGeneral(lhs, rhs, dims, &precision_config, type);
+}
+
+xla::PrimitiveType GetAccumulationType(xla::PrimitiveType type) {
+  return type == xla::PrimitiveType::BF16 || type == xla::PrimitiveType::F16
+             ? xla::PrimitiveType::F32
+             : type;
+}
+
+LoopBlocks GetLoopBlocks(int64_t length, int64_t block_size) {
+  LoopBlocks blocks;
+  blocks.block_size = std::max<int64_t>(std::min(block_size, length), 1);
+  blocks.num_blocks = xla::CeilOfRatio(length, blocks.block_size);
+  return blocks;
+}
+
 xla::XlaOp BuildSigmoidBackward(xla::XlaOp grad_output, xla::XlaOp output,
                                 xla::XlaOp scalar_1) {
   return grad_output * (scalar_1 - output) * output;
@@ -809,28 +1121,116 @@ xla::XlaOp BuildCountNonzero(xla::XlaOp input, std::vector<int64_t> dims) {
   }
 }
 
-std::vector<xla::XlaOp> BuildNonZero(xla::XlaOp input) {
+std::vector<xla::XlaOp> BuildNonZero(xla::XlaOp input, int64_t padded_size) {
   const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
   return BuildConditionIndices(
-      xla::Ne(input, xla::Zero(input.builder(), input_shape.element_type())));
+      xla::Ne(input, xla::Zero(input.builder(), input_shape.element_type())),
+      padded_size);
 }
 
-std::vector<xla::XlaOp> BuildMaskedSelect(xla::XlaOp input, xla::XlaOp mask) {
+std::vector<xla::XlaOp> BuildMaskedSelect(xla::XlaOp input, xla::XlaOp mask,
+                                          int64_t padded_size) {
   xla::Shape input_shape;
   xla::XlaOp r1_input = XlaHelpers::Flatten(input, &input_shape);
   xla::XlaOp r1_bcast_mask = GetPromotedR1Mask(mask, input_shape);
-  ConditionMaskData cmd = CreateConditionMaskData(r1_bcast_mask);
-  std::vector<xla::XlaOp> to_sort = {cmd.r1_condition_int, r1_input};
-  std::vector<xla::PrimitiveType> types_to_sort = {cmd.condition_int_type,
-                                                   input_shape.element_type()};
-  xla::XlaOp sorted = xla::Sort(
-      to_sort, xla::CreateScalarGtComputation(types_to_sort, input.builder()),
-      /*dimension=*/0,
-      /*is_stable=*/true);
-  xla::XlaOp sorted_input = xla::GetTupleElement(sorted, 1);
+  auto [sorted_input, length] = CompactR1(r1_input, r1_bcast_mask);
+  if (padded_size >= 0) {
+    return PadConditionResult(sorted_input, length, padded_size);
+  }
   xla::XlaOp sorted_input_padded =
-      xla::SetDimensionSize(sorted_input, cmd.length, 0);
-  return {sorted_input_padded, cmd.length};
+      xla::SetDimensionSize(sorted_input, length, 0);
+  return {sorted_input_padded, length};
+}
+
+std::vector<xla::XlaOp> BuildPaddedUnique(xla::XlaOp input,
+                                          int64_t padded_size) {
+  xla::Shape input_shape;
+  xla::XlaOp r1_input = XlaHelpers::Flatten(input, &input_shape);
+  int64_t size = input_shape.dimensions(0);
+  xla::XlaBuilder* builder = input.builder();
+  xla::PrimitiveType size_type = GetShapeDimensionType(/*device=*/nullptr);
+  if (size == 0) {
+    return PadConditionResult(r1_input, xla::Zero(builder, size_type),
+                              padded_size);
+  }
+  xla::XlaOp sorted = xla::Sort(
+      {r1_input},
+      xla::CreateScalarLtComputation({input_shape.element_type()}, builder),
+      /*dimension=*/0);
+  // An element starts a new value if it differs from the one before it.
+  xla::XlaOp is_new = xla::ConcatInDim(
+      builder,
+      {xla::ConstantR1<bool>(builder, {true}),
+       xla::Ne(xla::SliceInDim(sorted, 1, size, 1, 0),
+               xla::SliceInDim(sorted, 0, size - 1, 1, 0))},
+      0);
+  auto [unique, length] = CompactR1(sorted, is_new);
+  return PadConditionResult(unique, MaybeConvertTo(length, size_type),
+                            padded_size);
+}
+
+std::vector<xla::XlaOp> BuildRowSparseCoalesce(xla::XlaOp rows,
+                                               xla::XlaOp values,
+                                               int64_t num_rows,
+                                               int64_t padding_idx) {
+  const xla::Shape& rows_shape = ShapeHelper::ShapeOfXlaOp(rows);
+  XLA_CHECK_EQ(rows_shape.dimensions_size(), 1) << rows_shape;
+  int64_t size = rows_shape.dimensions(0);
+  xla::PrimitiveType index_type = rows_shape.element_type();
+  xla::XlaBuilder* builder = rows.builder();
+  xla::PrimitiveType size_type = GetShapeDimensionType(/*device=*/nullptr);
+  if (size == 0) {
+    return {rows, values, xla::Zero(builder, size_type)};
+  }
+  // Rows outside of the table, and the padding row, are moved to num_rows so
+  // they sort last and the scatters applying the gradient drop them.
+  xla::XlaOp dropped_row =
+      XlaHelpers::ScalarValue<int64_t>(num_rows, index_type, builder);
+  xla::XlaOp keep = xla::And(xla::Ge(rows, xla::Zero(builder, index_type)),
+                             xla::Lt(rows, dropped_row));
+  if (padding_idx >= 0) {
+    keep = xla::And(
+        keep,
+        xla::Ne(rows, XlaHelpers::ScalarValue<int64_t>(padding_idx, index_type,
+                                                       builder)));
+  }
+  xla::XlaOp keys =
+      xla::Select(keep, rows, xla::Broadcast(dropped_row, {size}));
+  xla::XlaOp sorted = xla::Sort(
+      {keys, xla::Iota(builder, xla::PrimitiveType::S32, size)},
+      xla::CreateScalarLtComputation({index_type, xla::PrimitiveType::S32},
+                                     builder),
+      /*dimension=*/0, /*is_stable=*/true);
+  xla::XlaOp sorted_rows = xla::GetTupleElement(sorted, 0);
+  xla::XlaOp permutation = xla::GetTupleElement(sorted, 1);
+  // A row starts a new segment if it differs from the one before it. Segment
+  // i collects the values of the i-th distinct row.
+  xla::XlaOp is_new = xla::ConcatInDim(
+      builder,
+      {xla::ConstantR1<bool>(builder, {true}),
+       xla::Ne(xla::SliceInDim(sorted_rows, 1, size, 1, 0),
+               xla::SliceInDim(sorted_rows, 0, size - 1, 1, 0))},
+      0);
+  xla::XlaOp segment =
+      BuildCumulativeComputation(
+          xla::ConvertElementType(is_new, xla::PrimitiveType::S32), 0,
+          XlaHelpers::CreateAddComputation(xla::PrimitiveType::S32),
+          xla::Zero(builder, xla::PrimitiveType::S32)) -
+      xla::One(builder, xla::PrimitiveType::S32);
+  xla::XlaOp segment_indices = xla::Reshape(segment, {size, 1});
+  xla::XlaOp coalesced_values = CreateIndexUpdate(
+      xla::ZerosLike(values), segment_indices, 0,
+      xla::TorchIndexSelect(values, permutation, 0), NumericAddCombiner());
+  xla::XlaOp coalesced_rows =
+      CreateIndexUpdate(xla::Broadcast(dropped_row, {size}), segment_indices, 0,
+                        sorted_rows, nullptr);
+  xla::XlaOp is_kept_segment =
+      xla::And(is_new, xla::Lt(sorted_rows, dropped_row));
+  xla::XlaOp count = xla::ReduceAll(
+      xla::ConvertElementType(is_kept_segment, size_type),
+      xla::Zero(builder, size_type),
+      XlaHelpers::CreateAddComputation(size_type));
+  return {coalesced_rows, coalesced_values, count};
 }
 
 xla::XlaOp BuildMaskedScatter(xla::XlaOp input, xla::XlaOp mask,
@@ -1049,6 +1449,118 @@ std::vector<xla::XlaOp> BuildAdamOptimizerStep(
   return results;
 }
 
+std::vector<xla::XlaOp> BuildForeachSgdOptimizerStep(
+    const xla::XlaOp& found_inf, absl::Span<const xla::XlaOp> steps,
+    absl::Span<const xla::XlaOp> params, absl::Span<const xla::XlaOp> bufs,
+    absl::Span<const xla::XlaOp> d_ps, const xla::XlaOp& weight_decay,
+    const xla::XlaOp& momentum, const xla::XlaOp& lr,
+    const xla::XlaOp& dampening, bool use_weight_decay, bool use_momentum,
+    bool use_nesterov, bool pack) {
+  std::vector<xla::XlaOp> results(params.size() * 3);
+  for (const std::vector<size_t>& group : GroupOptimizerParams(params, pack)) {
+    // The scalar inputs are shared by all the params, so they are converted
+    // to the element type of each group.
+    xla::PrimitiveType type =
+        ShapeHelper::ShapeOfXlaOp(params[group.front()]).element_type();
+    std::vector<xla::XlaOp> new_params;
+    std::vector<xla::XlaOp> new_bufs;
+    if (group.size() == 1) {
+      size_t i = group.front();
+      std::vector<xla::XlaOp> step_results = BuildSgdOptimizerStep(
+          MaybeConvertTo(found_inf, type), MaybeConvertTo(steps[i], type),
+          params[i], bufs[i], d_ps[i], MaybeConvertTo(weight_decay, type),
+          MaybeConvertTo(momentum, type), MaybeConvertTo(lr, type),
+          MaybeConvertTo(dampening, type), use_weight_decay, use_momentum,
+          use_nesterov);
+      new_params = {step_results[1]};
+      new_bufs = {step_results[2]};
+    } else {
+      std::vector<xla::XlaOp> step_results = BuildSgdOptimizerStep(
+          MaybeConvertTo(found_inf, type),
+          MaybeConvertTo(PackBroadcast(steps, params, group), type),
+          PackFlat(params, group), PackFlat(bufs, group),
+          PackFlat(d_ps, group), MaybeConvertTo(weight_decay, type),
+          MaybeConvertTo(momentum, type), MaybeConvertTo(lr, type),
+          MaybeConvertTo(dampening, type), use_weight_decay, use_momentum,
+          use_nesterov);
+      new_params = UnpackFlat(step_results[1], params, group);
+      new_bufs = UnpackFlat(step_results[2], params, group);
+    }
+    for (size_t j = 0; j < group.size(); ++j) {
+      size_t i = group[j];
+      results[i * 3] = IncrementStepIfFinite(found_inf, steps[i]);
+      results[i * 3 + 1] = new_params[j];
+      results[i * 3 + 2] = new_bufs[j];
+    }
+  }
+  return results;
+}
+
+std::vector<xla::XlaOp> BuildForeachAdamOptimizerStep(
+    const xla::XlaOp& found_inf, absl::Span<const xla::XlaOp> steps,
+    absl::Span<const xla::XlaOp> params, absl::Span<const xla::XlaOp> grads,
+    absl::Span<const xla::XlaOp> exp_avgs,
+    absl::Span<const xla::XlaOp> exp_avg_sqs,
+    absl::Span<const xla::XlaOp> max_exp_avg_sqs, const xla::XlaOp& beta1,
+    const xla::XlaOp& beta2, const xla::XlaOp& lr,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw, bool maximize,
+    bool pack) {
+  size_t num_outputs = use_amsgrad ? 5 : 4;
+  std::vector<xla::XlaOp> results(params.size() * num_outputs);
+  for (const std::vector<size_t>& group : GroupOptimizerParams(params, pack)) {
+    // The scalar inputs are shared by all the params, so they are converted
+    // to the element type of each group.
+    xla::PrimitiveType type =
+        ShapeHelper::ShapeOfXlaOp(params[group.front()]).element_type();
+    xla::XlaOp step;
+    xla::XlaOp param;
+    xla::XlaOp grad;
+    xla::XlaOp exp_avg;
+    xla::XlaOp exp_avg_sq;
+    xla::XlaOp max_exp_avg_sq;
+    if (group.size() == 1) {
+      size_t i = group.front();
+      step = MaybeConvertTo(steps[i], type);
+      param = params[i];
+      grad = grads[i];
+      exp_avg = exp_avgs[i];
+      exp_avg_sq = exp_avg_sqs[i];
+      // The single tensor lowering ignores max_exp_avg_sq without amsgrad.
+      max_exp_avg_sq = use_amsgrad ? max_exp_avg_sqs[i] : exp_avg_sq;
+    } else {
+      step = MaybeConvertTo(PackBroadcast(steps, params, group), type);
+      param = PackFlat(params, group);
+      grad = PackFlat(grads, group);
+      exp_avg = PackFlat(exp_avgs, group);
+      exp_avg_sq = PackFlat(exp_avg_sqs, group);
+      max_exp_avg_sq =
+          use_amsgrad ? PackFlat(max_exp_avg_sqs, group) : exp_avg_sq;
+    }
+    if (maximize) {
+      grad = xla::Neg(grad);
+    }
+    std::vector<xla::XlaOp> step_results = BuildAdamOptimizerStep(
+        MaybeConvertTo(found_inf, type), step, param, grad, exp_avg,
+        exp_avg_sq, max_exp_avg_sq, MaybeConvertTo(beta1, type),
+        MaybeConvertTo(beta2, type), MaybeConvertTo(lr, type),
+        MaybeConvertTo(weight_decay, type), MaybeConvertTo(eps, type),
+        use_weight_decay, use_amsgrad, use_adamw);
+    for (size_t k = 1; k < num_outputs; ++k) {
+      std::vector<xla::XlaOp> unpacked =
+          group.size() == 1 ? std::vector<xla::XlaOp>{step_results[k]}
+                            : UnpackFlat(step_results[k], params, group);
+      for (size_t j = 0; j < group.size(); ++j) {
+        results[group[j] * num_outputs + k] = unpacked[j];
+      }
+    }
+    for (size_t i : group) {
+      results[i * num_outputs] = IncrementStepIfFinite(found_inf, steps[i]);
+    }
+  }
+  return results;
+}
+
 xla::XlaOp BuildXLogY(xla::XlaOp input, xla::XlaOp other) {
   // input and xla::Log(other) can have different types, need to promote
   // the multiply.
@@ -1590,4 +2102,239 @@ xla::XlaOp BuildNms(xla::XlaOp boxes, xla::XlaOp scores,
   return xla::SetDimensionSize(included_indices_first, included_boxes, 0);
 }
 
+std::vector<xla::XlaOp> BuildBatchedNms(xla::XlaOp boxes, xla::XlaOp scores,
+                                        xla::XlaOp classes,
+                                        xla::XlaOp valid_counts,
+                                        xla::XlaOp iou_threshold,
+                                        int64_t max_output_size,
+                                        int64_t tile_size) {
+  const xla::PrimitiveType XLAIndexType = xla::PrimitiveType::S32;
+  xla::XlaBuilder* builder = boxes.builder();
+
+  const xla::Shape& boxes_shape = ShapeHelper::ShapeOfXlaOp(boxes);
+  XLA_CHECK_EQ(boxes_shape.dimensions_size(), 3) << boxes_shape;
+  XLA_CHECK_EQ(boxes_shape.dimensions(2), 4) << boxes_shape;
+  int64_t batch = boxes_shape.dimensions(0);
+  int64_t num_boxes = boxes_shape.dimensions(1);
+  xla::PrimitiveType box_type = boxes_shape.element_type();
+  const xla::Shape& scores_shape = ShapeHelper::ShapeOfXlaOp(scores);
+  XLA_CHECK_EQ(scores_shape.dimensions_size(), 2) << scores_shape;
+  XLA_CHECK_EQ(scores_shape.dimensions(0), batch) << scores_shape;
+  XLA_CHECK_EQ(scores_shape.dimensions(1), num_boxes) << scores_shape;
+  XLA_CHECK_GT(tile_size, 0);
+
+  const xla::XlaOp ZERO = xla::Zero(builder, XLAIndexType);
+  const xla::XlaOp NONE = xla::ConstantR0<int32_t>(builder, -1);
+  std::vector<int64_t> output_sizes = {batch, max_output_size};
+  if (num_boxes == 0) {
+    return {xla::Broadcast(NONE, output_sizes),
+            xla::Broadcast(ZERO, {batch})};
+  }
+  tile_size = std::min(tile_size, num_boxes);
+  int64_t num_tiles = xla::CeilOfRatio(num_boxes, tile_size);
+  int64_t padded_size = num_tiles * tile_size;
+  std::vector<int64_t> sizes = {batch, num_boxes};
+  xla::Shape index_shape = xla::ShapeUtil::MakeShape(XLAIndexType, sizes);
+
+  // 1. Shift the boxes of each class by a multiple of the largest coordinate
+  //    of the image, so boxes of different classes never overlap.
+  xla::XlaOp max_coordinate = xla::Reduce(
+      boxes, xla::MinValue(builder, box_type),
+      xla::CreateScalarMaxComputation(box_type, builder), {1, 2});
+  xla::XlaOp class_offsets =
+      xla::ConvertElementType(classes, box_type) *
+      xla::BroadcastInDim(max_coordinate + xla::One(builder, box_type), sizes,
+                          {0});
+  xla::XlaOp shifted_boxes =
+      boxes + xla::BroadcastInDim(class_offsets, {batch, num_boxes, 4}, {0, 1});
+
+  // 2. Order the boxes of each image by decreasing score, the boxes past the
+  //    valid count of the image last.
+  xla::XlaOp positions = xla::Iota(builder, index_shape, 1);
+  xla::XlaOp valid = xla::Lt(
+      positions,
+      xla::BroadcastInDim(xla::ConvertElementType(valid_counts, XLAIndexType),
+                          sizes, {0}));
+  xla::XlaOp masked_scores = xla::Select(
+      valid, scores,
+      xla::Broadcast(xla::MinValue(builder, scores_shape.element_type()),
+                     sizes));
+  xla::XlaOp sorted_indices = xla::GetTupleElement(
+      xla::Sort({masked_scores, positions},
+                xla::CreateScalarGtComputation(
+                    {scores_shape.element_type(), XLAIndexType}, builder),
+                /*dimension=*/1, /*is_stable=*/true),
+      1);
+  xla::XlaOp sorted_boxes = xla::TorchGather(
+      shifted_boxes,
+      xla::BroadcastInDim(sorted_indices, {batch, num_boxes, 4}, {0, 1}),
+      /*dim=*/1, /*sparse=*/false);
+  xla::XlaOp sorted_valid =
+      xla::TorchGather(valid, sorted_indices, /*dim=*/1, /*sparse=*/false);
+
+  // 3. Pad to a whole number of tiles. The padding boxes are not kept.
+  int64_t padding = padded_size - num_boxes;
+  sorted_boxes = xla::PadInDim(sorted_boxes, xla::Zero(builder, box_type),
+                               /*dimno=*/1, /*pad_lo=*/0, /*pad_hi=*/padding);
+  xla::XlaOp keep =
+      xla::PadInDim(sorted_valid, xla::ConstantR0<bool>(builder, false),
+                    /*dimno=*/1, /*pad_lo=*/0, /*pad_hi=*/padding);
+  sorted_indices = xla::PadInDim(sorted_indices, NONE, /*dimno=*/1,
+                                 /*pad_lo=*/0, /*pad_hi=*/padding);
+
+  // 4. Settle the tiles in score order. The boxes of a tile are first
+  //    suppressed by the kept boxes of every earlier tile, one [B, T, T] IoU
+  //    block at a time, then among themselves. The full [N, N] IoU matrix is
+  //    never built.
+  std::vector<int64_t> tile_sizes = {batch, tile_size};
+  std::vector<int64_t> block_sizes = {batch, tile_size, tile_size};
+  std::vector<xla::XlaOp> init_values = {
+      ZERO, keep, sorted_boxes,
+      xla::ConvertElementType(iou_threshold, box_type)};
+  std::vector<xla::XlaOp> tile_result = GetValueOrThrow(xla::WhileLoopHelper(
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        return xla::Lt(values[0],
+                       xla::ConstantR0<int32_t>(builder, num_tiles));
+      },
+      [=](absl::Span<const xla::XlaOp> values, xla::XlaBuilder* builder) {
+        const xla::XlaOp ONE = xla::One(builder, XLAIndexType);
+        const xla::XlaOp ZERO = xla::Zero(builder, XLAIndexType);
+        const xla::XlaOp TILE = xla::ConstantR0<int32_t>(builder, tile_size);
+        xla::XlaOp tile = values[0];
+        xla::XlaOp keep = values[1];
+        xla::XlaOp boxes = values[2];
+        xla::XlaOp threshold = values[3];
+        xla::XlaOp start = tile * TILE;
+        xla::XlaOp tile_boxes = xla::DynamicSlice(boxes, {ZERO, start, ZERO},
+                                                  {batch, tile_size, 4});
+        xla::XlaOp tile_keep =
+            xla::DynamicSlice(keep, {ZERO, start}, tile_sizes);
+
+        std::vector<xla::XlaOp> inner_values = {
+            ZERO, tile, tile_keep, tile_boxes, keep, boxes, threshold};
+        std::vector<xla::XlaOp> inner_result =
+            GetValueOrThrow(xla::WhileLoopHelper(
+                [](absl::Span<const xla::XlaOp> values,
+                   xla::XlaBuilder* builder) {
+                  return xla::Lt(values[0], values[1]);
+                },
+                [=](absl::Span<const xla::XlaOp> values,
+                    xla::XlaBuilder* builder) {
+                  const xla::XlaOp ZERO = xla::Zero(builder, XLAIndexType);
+                  xla::XlaOp prior_tile = values[0];
+                  xla::XlaOp tile_keep = values[2];
+                  xla::XlaOp tile_boxes = values[3];
+                  xla::XlaOp keep = values[4];
+                  xla::XlaOp boxes = values[5];
+                  xla::XlaOp threshold = values[6];
+                  xla::XlaOp start =
+                      prior_tile * xla::ConstantR0<int32_t>(builder, tile_size);
+                  xla::XlaOp prior_boxes = xla::DynamicSlice(
+                      boxes, {ZERO, start, ZERO}, {batch, tile_size, 4});
+                  xla::XlaOp prior_keep =
+                      xla::DynamicSlice(keep, {ZERO, start}, tile_sizes);
+                  xla::XlaOp overlaps = xla::Gt(
+                      BuildPairwiseIou(prior_boxes, tile_boxes), threshold);
+                  xla::XlaOp suppressed = ReduceAny(
+                      xla::And(overlaps, xla::BroadcastInDim(
+                                             prior_keep, block_sizes, {0, 1})),
+                      {1});
+                  return std::vector<xla::XlaOp>{
+                      prior_tile + xla::One(builder, XLAIndexType),
+                      values[1],
+                      xla::And(tile_keep, xla::Not(suppressed)),
+                      tile_boxes,
+                      keep,
+                      boxes,
+                      threshold};
+                },
+                inner_values, "PriorTileSuppression", builder));
+        tile_keep =
+            BuildTileSelfSuppression(tile_boxes, inner_result[2], threshold);
+        return std::vector<xla::XlaOp>{
+            tile + ONE, xla::DynamicUpdateSlice(keep, tile_keep, {ZERO, start}),
+            boxes, threshold};
+      },
+      init_values, "BatchedNmsTileLoop", builder));
+  keep = tile_result[1];
+
+  // 5. Move the original indices of the kept boxes to the front, in score
+  //    order, and pad them to max_output_size with -1.
+  xla::XlaOp keep_int = xla::ConvertElementType(keep, XLAIndexType);
+  xla::XlaOp kept_indices = xla::GetTupleElement(
+      xla::Sort({keep_int, sorted_indices},
+                xla::CreateScalarGtComputation({XLAIndexType, XLAIndexType},
+                                               builder),
+                /*dimension=*/1, /*is_stable=*/true),
+      1);
+  if (max_output_size <= padded_size) {
+    kept_indices = xla::SliceInDim(kept_indices, 0, max_output_size, 1, 1);
+  } else {
+    kept_indices = xla::PadInDim(kept_indices, NONE, /*dimno=*/1, /*pad_lo=*/0,
+                                 /*pad_hi=*/max_output_size - padded_size);
+  }
+  xla::XlaOp num_selected = xla::Min(
+      xla::Reduce(keep_int, ZERO,
+                  xla::CreateScalarAddComputation(XLAIndexType, builder), {1}),
+      xla::ConstantR0<int32_t>(builder, max_output_size));
+  xla::XlaOp output_positions = xla::Iota(
+      builder, xla::ShapeUtil::MakeShape(XLAIndexType, output_sizes), 1);
+  kept_indices = xla::Select(
+      xla::Lt(output_positions,
+              xla::BroadcastInDim(num_selected, output_sizes, {0})),
+      kept_indices, xla::Broadcast(NONE, output_sizes));
+  return {kept_indices, num_selected};
+}
+
+xla::XlaOp BuildEmbeddingBagSegmentIds(xla::XlaOp offsets, int64_t num_bags,
+                                       int64_t num_indices) {
+  xla::XlaBuilder* builder = offsets.builder();
+  xla::PrimitiveType type = XlaHelpers::TypeOfXlaOp(offsets);
+  xla::Shape ids_shape = xla::ShapeUtil::MakeShape(type, {num_indices});
+  xla::XlaOp positions = xla::Iota(builder, ids_shape, 0);
+  xla::XlaOp bag_offsets = xla::SliceInDim(offsets, 0, num_bags, 1, 0);
+  xla::XlaOp one = xla::One(builder, type);
+  xla::XlaOp bags = XlaHelpers::ScalarValue<int64_t>(num_bags, type, builder);
+  // Binary search of the number of bags starting at or before each position,
+  // one bit of the result at a time.
+  xla::XlaOp num_started = xla::Zeros(builder, ids_shape);
+  int64_t step = 1;
+  while (step * 2 <= num_bags) {
+    step *= 2;
+  }
+  for (; num_bags > 0 && step > 0; step /= 2) {
+    xla::XlaOp candidate = xla::Add(
+        num_started, XlaHelpers::ScalarValue<int64_t>(step, type, builder));
+    xla::XlaOp probe = xla::Sub(xla::Min(candidate, bags), one);
+    xla::XlaOp probe_offsets = xla::TorchIndexSelect(bag_offsets, probe, 0);
+    xla::XlaOp take = xla::And(xla::Le(candidate, bags),
+                               xla::Le(probe_offsets, positions));
+    num_started = xla::Select(take, candidate, num_started);
+  }
+  return xla::Select(xla::Gt(num_started, xla::Zero(builder, type)),
+                     xla::Sub(num_started, one),
+                     xla::Broadcast(bags, {num_indices}));
+}
+
+xla::XlaOp BuildSegmentReduction(xla::XlaOp values, xla::XlaOp segment_ids,
+                                 int64_t num_segments,
+                                 const xla::XlaComputation& combiner,
+                                 xla::XlaOp init_value) {
+  const xla::Shape& values_shape = ShapeHelper::ShapeOfXlaOp(values);
+  std::vector<int64_t> output_sizes(values_shape.dimensions().begin(),
+                                    values_shape.dimensions().end());
+  output_sizes[0] = num_segments;
+  xla::ScatterDimensionNumbers dim_numbers;
+  dim_numbers.set_index_vector_dim(1);
+  for (int64_t dim = 1; dim < values_shape.dimensions_size(); ++dim) {
+    dim_numbers.add_update_window_dims(dim);
+  }
+  dim_numbers.add_inserted_window_dims(0);
+  dim_numbers.add_scatter_dims_to_operand_dims(0);
+  return xla::Scatter(
+      xla::Broadcast(init_value, output_sizes),
+      xla::Reshape(segment_ids, {values_shape.dimensions(0), 1}), values,
+      combiner, dim_numbers);
+}
+
 }  // namespace torch_xla
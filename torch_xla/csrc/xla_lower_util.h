@@ -17,8 +17,12 @@ xla::XlaOp PadToSize(xla::XlaOp input, absl::Span<const int64_t> size,
 std::vector<xla::XlaOp> CreateKthValue(xla::XlaOp input, int64_t k, int64_t dim,
                                        bool keepdim);
 
+// Lowers to a partial top-k when k is small compared to the size of dim, and
+// to a full sort otherwise. A recall_target below 1 selects the approximate
+// top-k algorithm, whose results may miss some of the top k values.
 std::vector<xla::XlaOp> CreateTopK(xla::XlaOp input, int64_t k, int64_t dim,
-                                   bool largest, bool stable);
+                                   bool largest, bool stable,
+                                   float recall_target = 1.0);
 
 xla::XlaOp CreateMatMul(xla::XlaOp lhs, xla::XlaOp rhs);
 
@@ -33,6 +37,25 @@ xla::XlaOp BuildCountNonzero(xla::XlaOp input, std::vector<int64_t> dim);
 
 xla::XlaOp BuildDot(xla::XlaOp lhs, xla::XlaOp rhs);
 
+// Batched matmul contracting lhs_dim of lhs with rhs_dim of rhs, with the
+// result in type. All but the last two dimensions are batch dimensions.
+xla::XlaOp BuildBatchDot(xla::XlaOp lhs, int64_t lhs_dim, xla::XlaOp rhs,
+                         int64_t rhs_dim, xla::PrimitiveType type);
+
+// Returns the type to accumulate sums and statistics of values of type in,
+// which is F32 for reduced precision inputs.
+xla::PrimitiveType GetAccumulationType(xla::PrimitiveType type);
+
+// Static sizes of a loop over a dimension of the given length in blocks. The
+// dimension is padded to num_blocks * block_size.
+struct LoopBlocks {
+  int64_t block_size = 0;
+  int64_t num_blocks = 0;
+};
+
+// The block size is clamped to [1, length].
+LoopBlocks GetLoopBlocks(int64_t length, int64_t block_size);
+
 xla::XlaOp BuildBernoulli(xla::XlaOp probability, xla::XlaOp seed,
                           xla::PrimitiveType type);
 
@@ -101,9 +124,29 @@ xla::XlaOp CreatePut(const torch::lazy::BackendDevice& device, xla::XlaOp input,
 xla::XlaOp BuildLinspace(const torch::lazy::BackendDevice& device,
                          xla::XlaOp start, xla::XlaOp end, int64_t steps);
 
-std::vector<xla::XlaOp> BuildNonZero(xla::XlaOp input);
-
-std::vector<xla::XlaOp> BuildMaskedSelect(xla::XlaOp input, xla::XlaOp mask);
+// The data dependent ops below return their result and the number of valid
+// rows in it. By default the result has a bounded dynamic dimension 0. With
+// padded_size >= 0 it has a static dimension 0 of padded_size instead, zero
+// filled past the valid rows and truncated if there are more valid rows, in
+// which case the returned number counts the rows kept.
+std::vector<xla::XlaOp> BuildNonZero(xla::XlaOp input,
+                                     int64_t padded_size = -1);
+
+std::vector<xla::XlaOp> BuildMaskedSelect(xla::XlaOp input, xla::XlaOp mask,
+                                          int64_t padded_size = -1);
+
+// Returns the sorted unique values of input, padded to padded_size.
+std::vector<xla::XlaOp> BuildPaddedUnique(xla::XlaOp input,
+                                          int64_t padded_size);
+
+// Sums the values of equal rows of a row-sparse tensor. Returns the distinct
+// rows in ascending order, their summed values and the number of distinct
+// rows, with the trailing slots holding num_rows. Rows outside of
+// [0, num_rows) and padding_idx, if not negative, are dropped.
+std::vector<xla::XlaOp> BuildRowSparseCoalesce(xla::XlaOp rows,
+                                               xla::XlaOp values,
+                                               int64_t num_rows,
+                                               int64_t padding_idx);
 
 xla::XlaOp BuildMaskedScatter(xla::XlaOp input, xla::XlaOp mask,
                               xla::XlaOp source);
@@ -134,6 +177,29 @@ std::vector<xla::XlaOp> BuildAdamOptimizerStep(
     const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
     bool use_weight_decay, bool use_amsgrad, bool use_adamw);
 
+// Multi-tensor variants of the optimizer steps above, which update all the
+// params in a single computation. The results are ordered by param, each with
+// the same outputs as the single tensor step. With pack set, params of the same
+// element type are updated as one flat buffer.
+std::vector<xla::XlaOp> BuildForeachSgdOptimizerStep(
+    const xla::XlaOp& found_inf, absl::Span<const xla::XlaOp> steps,
+    absl::Span<const xla::XlaOp> params, absl::Span<const xla::XlaOp> bufs,
+    absl::Span<const xla::XlaOp> d_ps, const xla::XlaOp& weight_decay,
+    const xla::XlaOp& momentum, const xla::XlaOp& lr,
+    const xla::XlaOp& dampening, bool use_weight_decay, bool use_momentum,
+    bool use_nesterov, bool pack);
+
+std::vector<xla::XlaOp> BuildForeachAdamOptimizerStep(
+    const xla::XlaOp& found_inf, absl::Span<const xla::XlaOp> steps,
+    absl::Span<const xla::XlaOp> params, absl::Span<const xla::XlaOp> grads,
+    absl::Span<const xla::XlaOp> exp_avgs,
+    absl::Span<const xla::XlaOp> exp_avg_sqs,
+    absl::Span<const xla::XlaOp> max_exp_avg_sqs, const xla::XlaOp& beta1,
+    const xla::XlaOp& beta2, const xla::XlaOp& lr,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw, bool maximize,
+    bool pack);
+
 xla::XlaOp BuildXLogY(xla::XlaOp input, xla::XlaOp other);
 
 xla::XlaOp BuildRoll(xla::XlaOp input, absl::Span<const int64_t> shifts,
@@ -162,10 +228,38 @@ std::vector<xla::XlaOp> BuildTpuCustomCall(
 xla::XlaOp BuildNms(xla::XlaOp boxes, xla::XlaOp scores,
                     xla::XlaOp iou_threshold);
 
+// Class-aware non-maximum suppression of a batch of images. boxes is
+// [B, N, 4] in (x1, y1, x2, y2) format, scores and classes are [B, N] and only
+// the first valid_counts[b] boxes of image b are considered. Boxes of
+// different classes never suppress each other. The IoU is computed in
+// [B, tile_size, tile_size] blocks. Returns the [B, max_output_size] indices
+// of the kept boxes in decreasing score order, padded with -1, and the [B]
+// number of kept boxes.
+std::vector<xla::XlaOp> BuildBatchedNms(xla::XlaOp boxes, xla::XlaOp scores,
+                                        xla::XlaOp classes,
+                                        xla::XlaOp valid_counts,
+                                        xla::XlaOp iou_threshold,
+                                        int64_t max_output_size,
+                                        int64_t tile_size);
+
 std::vector<xla::XlaOp> BuildGpuCustomCall(
     const std::vector<xla::XlaOp>& inputs, const xla::Shape& output_shape,
     const std::string& payload);
 
+// Returns the index of the bag each of the num_indices positions belongs to,
+// given the sorted start offsets of the first num_bags bags. Positions which
+// precede the first offset are mapped to num_bags. The search is vectorized
+// over all positions, and emits O(log(num_bags)) operations.
+xla::XlaOp BuildEmbeddingBagSegmentIds(xla::XlaOp offsets, int64_t num_bags,
+                                       int64_t num_indices);
+
+// Reduces the rows of values into num_segments rows, where row i is combined
+// into row segment_ids[i]. Rows with an out of range segment id are dropped.
+xla::XlaOp BuildSegmentReduction(xla::XlaOp values, xla::XlaOp segment_ids,
+                                 int64_t num_segments,
+                                 const xla::XlaComputation& combiner,
+                                 xla::XlaOp init_value);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_XLA_LOWER_UTIL_H_
@@ -0,0 +1,95 @@
+"""Attributes the live device buffers to the sites which created them.
+
+Tracking is off by default. Enable it with `enable()` or by setting
+`XLA_TRACK_BUFFERS=1`. Every buffer created afterwards is recorded with its
+size, device and site until it is freed. The site is the graph hash for graph
+outputs, or the runtime call (e.g. `TransferToDevice`) otherwise. When frame
+capture is enabled the innermost Python frame is appended to the site.
+
+To find what holds the memory which grows over a run:
+
+  buffer_tracker.enable()
+  before = buffer_tracker.snapshot()
+  train_step()
+  print(buffer_tracker.format_holders(
+      buffer_tracker.diff(before, buffer_tracker.snapshot())))
+"""
+
+import collections
+from typing import Dict, List, NamedTuple, Optional
+
+import torch_xla
+
+
+class Holder(NamedTuple):
+  site: str
+  device: str
+  count: int
+  size_in_bytes: int
+
+
+class Snapshot(NamedTuple):
+  buffers: List[Dict]
+
+  def holders(self) -> List[Holder]:
+    return _group(self.buffers)
+
+
+def enable(capture_frames: bool = False) -> None:
+  """Starts tracking the buffers created from now on."""
+  torch_xla._XLAC._xla_set_buffer_tracking(True, capture_frames)
+
+
+def disable() -> None:
+  """Stops tracking and forgets the tracked buffers."""
+  torch_xla._XLAC._xla_set_buffer_tracking(False)
+
+
+def is_enabled() -> bool:
+  return torch_xla._XLAC._xla_buffer_tracking_enabled()
+
+
+def snapshot() -> Snapshot:
+  """Returns the tracked buffers which are currently alive."""
+  return Snapshot(torch_xla._XLAC._xla_live_buffers())
+
+
+def _group(buffers) -> List[Holder]:
+  counts = collections.Counter()
+  sizes = collections.Counter()
+  for buffer in buffers:
+    key = (buffer['site'], buffer['device'])
+    counts[key] += 1
+    sizes[key] += buffer['size_in_bytes']
+  holders = [
+      Holder(site, device, counts[(site, device)], size)
+      for (site, device), size in sizes.items()
+  ]
+  return sorted(holders, key=lambda holder: -holder.size_in_bytes)
+
+
+def top_holders(n: int = 10, snap: Optional[Snapshot] = None) -> List[Holder]:
+  """Returns the `n` sites holding the most live buffer bytes per device."""
+  if snap is None:
+    snap = snapshot()
+  return snap.holders()[:n]
+
+
+def diff(before: Snapshot, after: Snapshot) -> List[Holder]:
+  """Returns the holders of the buffers alive in `after` but not in `before`.
+
+  These are the buffers created between the two snapshots which are still
+  alive, the candidates for a leak when the snapshots are taken at the same
+  point of consecutive steps.
+  """
+  before_ids = set(buffer['id'] for buffer in before.buffers)
+  return _group(
+      [buffer for buffer in after.buffers if buffer['id'] not in before_ids])
+
+
+def format_holders(holders: List[Holder]) -> str:
+  lines = []
+  for holder in holders:
+    lines.append(f'{holder.size_in_bytes / 2**20:12.3f} MiB '
+                 f'{holder.count:6d} buffers  {holder.device}  {holder.site}')
+  return '\n'.join(lines)
@@ -0,0 +1,86 @@
+"""Records the graph compilations and executions in an append-only log.
+
+The log is off by default. Enable it with `enable(path)` or by setting
+`XLA_EVENT_LOG=<path>`. A background thread appends one JSON object per line
+for every compilation and execution, with the graph hash, the reason of the
+sync (`mark_step`, `sync`, `item`, `print`, `to_cpu`, `fallback`, `warm_up` or
+`other`), the user Python frame which triggered it, the compile or execute time
+in microseconds, the input and output bytes, the cache tier (`miss`, `memory`
+or `persistent`) and the device.
+
+To find what recompiles, after or even during a run:
+
+  print(event_log.report('/tmp/xla_events.jsonl'))
+
+The performance analyzers rank the problems found in the events, like frames
+which recompile, `.item()` calls inside loops or large transfers during the
+steps, by their estimated cost, either on a recorded log or live on the recent
+events of the process:
+
+  print(event_log.analysis_report('/tmp/xla_events.jsonl'))
+"""
+
+from typing import Dict, List, Optional
+
+import torch_xla
+import torch_xla.utils.utils as xu
+
+
+def enable(path: Optional[str] = None) -> None:
+  """Appends the events from now on to the file at `path`.
+
+  Without a path, only the recent events are kept in memory, for the live
+  analysis.
+  """
+  if path is None:
+    torch_xla._XLAC._xla_set_event_log_in_memory(True)
+  else:
+    torch_xla._XLAC._xla_set_event_log(path)
+
+
+def disable() -> None:
+  """Writes the pending events and stops logging.
+
+  The recent events stay in memory when `PT_XLA_DEBUG=1`, as at startup.
+  """
+  torch_xla._XLAC._xla_set_event_log('')
+  torch_xla._XLAC._xla_set_event_log_in_memory(
+      xu.getenv_as('PT_XLA_DEBUG', bool, False))
+
+
+def path() -> str:
+  """Returns the path of the log, or an empty string if it is disabled."""
+  return torch_xla._XLAC._xla_event_log_path()
+
+
+def flush() -> None:
+  """Blocks until the events logged so far are written."""
+  torch_xla._XLAC._xla_flush_event_log()
+
+
+def read(path: str) -> List[Dict]:
+  """Returns the events of the log at `path`, skipping malformed lines."""
+  return torch_xla._XLAC._xla_read_event_log(path)
+
+
+def report(path: str) -> str:
+  """Returns a report of the log at `path`.
+
+  The frames and graphs which compiled the most come first.
+  """
+  return torch_xla._XLAC._xla_event_log_report(path)
+
+
+def analyze(path: Optional[str] = None) -> List[Dict]:
+  """Returns the performance findings of the log at `path`, most costly first.
+
+  Without a path, analyzes the recent events of this process. Each finding has
+  the `analyzer` which found it, a `description`, a `suggestion` and its
+  `estimated_cost_us`.
+  """
+  return torch_xla._XLAC._xla_performance_findings(path or '')
+
+
+def analysis_report(path: Optional[str] = None) -> str:
+  """Returns a report of the findings of `analyze(path)`."""
+  return torch_xla._XLAC._xla_performance_findings_report(path or '')
@@ -84,3 +84,94 @@ def short_metrics_report(counter_names: list = None, metric_names: list = None):
 def executed_fallback_ops():
   """Retrieves a list of operations that were run in fallback mode."""
   return torch_xla._XLAC._get_executed_fallback_ops()
+
+
+def executed_fallback_ops_time():
+  """Retrieves the total time, in nanoseconds, spent on each operation that was
+  run in fallback mode, including the device transfers."""
+  return torch_xla._XLAC._get_executed_fallback_ops_time()
+
+
+def computation_stats(graph):
+  """Returns the memory and cost stats of a compiled graph.
+
+  Args:
+    graph: The graph hash returned by `torch_xla._XLAC._get_graph_hash`, or the
+      list of tensors whose pending graph to look up.
+
+  Returns:
+    A dict with the argument, output, alias, temp and generated code sizes in
+    bytes, and the estimated flops, transcendentals and bytes accessed, or None
+    if the graph is not in the computation cache. Values the runtime cannot
+    report are -1.
+  """
+  if not isinstance(graph, bytes):
+    graph = torch_xla._XLAC._get_graph_hash(graph)
+  return torch_xla._XLAC._get_computation_stats(graph)
+
+
+def recompilation_diffs():
+  """Returns how the recently compiled graphs differ from the graphs before.
+
+  Every compilation records a fingerprint of the graph, and compares it with
+  the fingerprints of the last `XLA_RECOMPILATION_HISTORY` graphs. The history
+  defaults to 8 graphs with `PT_XLA_DEBUG=1`, and is off otherwise.
+
+  Returns:
+    A list of dicts, oldest first, with the hashes and node counts of the
+    compiled graph and of its nearest previous graph, the position of the first
+    differing node in their post orders, the descriptions of the two nodes, the
+    Python frame which created the new node (with `XLA_IR_DEBUG=1`) and a
+    readable `report`.
+  """
+  return torch_xla._XLAC._xla_recompilation_diffs()
+
+
+def clear_recompilation_diffs():
+  """Forgets the recorded graph fingerprints and diffs."""
+  torch_xla._XLAC._xla_clear_recompilation_diffs()
+
+
+_STEP_PHASES = ('tracing', 'hashing', 'lowering', 'compile',
+                'transfer_to_device', 'execute_wait', 'transfer_from_device')
+
+
+def step_breakdown():
+  """Returns where the wall time of the recent steps went.
+
+  A step spans from one `torch_xla.sync()` to the next. The `tracing` phase is
+  the host time outside of the other phases, spent in the Python code and
+  recording the IR. `execute_wait` is the time the host waits for the device.
+
+  Returns:
+    A list of dicts, oldest first, with the `step_time` and the time of each
+    phase of the step in nanoseconds.
+  """
+  return torch_xla._XLAC._xla_step_breakdown()
+
+
+def step_breakdown_report(num_steps: int = None):
+  """Returns the share of each phase in the recent steps.
+
+  Args:
+    num_steps (int): The number of most recent steps to report. Defaults to
+      all the recorded steps.
+  """
+  steps = step_breakdown()
+  if num_steps is not None:
+    steps = steps[-num_steps:]
+  total = sum(step['step_time'] for step in steps)
+  if total <= 0:
+    return 'No step recorded\n'
+  shares = {
+      phase: sum(step[phase] for step in steps) / total
+      for phase in _STEP_PHASES
+  }
+  lines = [
+      f'Steps: {len(steps)}, mean step time: {total / len(steps) / 1e6:.3f} ms'
+  ]
+  lines += [f'  {phase}: {share:.1%}' for phase, share in shares.items()]
+  top = max(shares, key=shares.get)
+  lines.append('Device-bound' if top == 'execute_wait' else
+               f'Host-bound, mostly in {top}')
+  return '\n'.join(lines) + '\n'
@@ -0,0 +1,55 @@
+"""Shape-stable, class-aware non-maximum suppression of a batch of images.
+
+`torchvision.ops.batched_nms` runs on one image at a time and returns a data
+dependent number of boxes, so detection post-processing usually loops over
+the images in Python and compiles a graph per distinct box count.
+`batched_nms` here handles the whole [B, N, 4] batch in one op, with a
+per-image count of valid boxes, and returns a static [B, max_output_size]
+result. The IoU is computed in [B, tile_size, tile_size] blocks rather than
+as a full [N, N] matrix.
+"""
+
+from typing import Optional, Tuple
+
+import torch
+import torch_xla
+
+
+def batched_nms(boxes: torch.Tensor,
+                scores: torch.Tensor,
+                iou_threshold: float,
+                max_output_size: int,
+                classes: Optional[torch.Tensor] = None,
+                valid_counts: Optional[torch.Tensor] = None,
+                tile_size: int = 512) -> Tuple[torch.Tensor, torch.Tensor]:
+  """Greedy NMS of each image of a batch, per class.
+
+  Args:
+    boxes: [B, N, 4] boxes in (x1, y1, x2, y2) format, with non-negative
+      coordinates when `classes` is given.
+    scores: [B, N] box scores.
+    iou_threshold: boxes with an IoU above it with a kept box of the same
+      class and a higher score are discarded.
+    max_output_size: number of kept boxes returned per image.
+    classes: optional [B, N] integer class of each box. Boxes of different
+      classes never suppress each other. All boxes share a class by default.
+    valid_counts: optional [B] number of leading valid boxes of each image.
+      All N boxes are valid by default.
+    tile_size: number of boxes per IoU block.
+
+  Returns:
+    The [B, max_output_size] int32 indices of the kept boxes of each image,
+    by decreasing score and padded with -1, and the [B] int32 number of kept
+    boxes.
+  """
+  batch, num_boxes = scores.shape
+  if classes is None:
+    classes = torch.zeros_like(scores, dtype=torch.int32)
+  if valid_counts is None:
+    valid_counts = torch.full((batch,),
+                              num_boxes,
+                              dtype=torch.int32,
+                              device=scores.device)
+  return torch_xla._XLAC._xla_batched_nms(boxes, scores, classes, valid_counts,
+                                          iou_threshold, max_output_size,
+                                          tile_size)
@@ -0,0 +1,71 @@
+"""Padded variants of data dependent ops.
+
+`torch.nonzero`, `torch.masked_select` and `torch.unique` have output sizes
+that depend on the data. On XLA that either forces the ops that consume them
+into dynamic shapes, or syncs the size to the host and compiles a new graph
+for every distinct size.
+
+The functions here return a result with a static number of rows instead,
+zero filled past the valid rows, together with a scalar tensor holding the
+valid count. With a `bound`, the result has exactly `bound` rows and tracing
+never syncs; rows past the bound are dropped and not counted. Without one, the
+valid count is synced and rounded up to a power of two, so a model compiles for
+a small, fixed set of sizes. The `DynamicPaddingRecompilesAvoided` counter reports the
+syncs whose exact size was new but whose padded size was already seen.
+
+The `masked_*` helpers reduce a padded result using only its valid rows.
+"""
+
+from typing import Optional, Tuple
+
+import torch
+import torch_xla
+
+
+def nonzero(input: torch.Tensor,
+            bound: Optional[int] = None) -> Tuple[torch.Tensor, torch.Tensor]:
+  """Padded `torch.nonzero(input)`. Returns `(indices, count)`."""
+  return torch_xla._XLAC._xla_nonzero_padded(input,
+                                             -1 if bound is None else bound)
+
+
+def masked_select(
+    input: torch.Tensor,
+    mask: torch.Tensor,
+    bound: Optional[int] = None) -> Tuple[torch.Tensor, torch.Tensor]:
+  """Padded `torch.masked_select(input, mask)`. Returns `(values, count)`."""
+  return torch_xla._XLAC._xla_masked_select_padded(
+      input, mask, -1 if bound is None else bound)
+
+
+def unique(input: torch.Tensor,
+           bound: Optional[int] = None) -> Tuple[torch.Tensor, torch.Tensor]:
+  """Padded `torch.unique(input, sorted=True)`. Returns `(values, count)`."""
+  return torch_xla._XLAC._xla_unique_padded(input,
+                                            -1 if bound is None else bound)
+
+
+def valid_mask(padded: torch.Tensor, count: torch.Tensor) -> torch.Tensor:
+  """Returns a boolean mask of the valid rows of a padded result."""
+  rows = torch.arange(padded.shape[0], device=padded.device)
+  mask = rows < count
+  return mask.reshape(mask.shape + (1,) * (padded.dim() - 1))
+
+
+def masked_sum(padded: torch.Tensor, count: torch.Tensor) -> torch.Tensor:
+  """Sums the valid rows of a padded result."""
+  return torch.where(
+      valid_mask(padded, count), padded, torch.zeros_like(padded)).sum(0)
+
+
+def masked_mean(padded: torch.Tensor, count: torch.Tensor) -> torch.Tensor:
+  """Averages the valid rows of a padded result."""
+  return masked_sum(padded, count) / count.clamp(min=1).to(padded.dtype)
+
+
+def masked_max(padded: torch.Tensor, count: torch.Tensor) -> torch.Tensor:
+  """Returns the maximum over the valid rows of a padded result."""
+  lowest = torch.full_like(padded, torch.finfo(padded.dtype).min
+                           if padded.is_floating_point() else
+                           torch.iinfo(padded.dtype).min)
+  return torch.where(valid_mask(padded, count), padded, lowest).amax(0)
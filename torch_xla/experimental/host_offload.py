@@ -0,0 +1,83 @@
+"""Keeps tensors in the host memory of the device between steps.
+
+PJRT devices can have several memory spaces, identified by their kind: the
+default "device" memory, and usually "pinned_host" or "unpinned_host" memory.
+`offload` moves the data of materialized tensors to host memory, where it stays
+until the tensors are updated. The graphs reading them take them in the host
+memory space, and XLA moves them to device memory where they are used. This
+keeps state which is read once per step, like the optimizer state, out of the
+device memory between the steps:
+
+  optimizer.step()
+  torch_xla.sync()
+  host_offload.offload_optimizer_state(optimizer)
+
+Within a graph, `place_to_host` and `place_to_device` move activations to the
+host memory after their forward uses, and back before their backward uses.
+"""
+
+from typing import Iterable, List, Optional
+
+import torch
+import torch_xla
+from torch_xla.experimental.stablehlo_custom_call import (place_to_device,
+                                                          place_to_host)
+
+_HOST_MEMORY_KINDS = ('pinned_host', 'unpinned_host')
+
+
+def memory_kinds(device: Optional[torch.device] = None) -> List[str]:
+  """Returns the memory kinds of `device`, starting with its default one."""
+  return torch_xla._XLAC._xla_memory_kinds(str(device) if device else '')
+
+
+def host_memory_kind(device: Optional[torch.device] = None) -> Optional[str]:
+  """Returns the host memory kind of `device`, or None if it has none."""
+  kinds = memory_kinds(device)
+  for kind in _HOST_MEMORY_KINDS:
+    if kind in kinds:
+      return kind
+  return None
+
+
+def memory_kind(tensor: torch.Tensor) -> str:
+  """Returns the memory kind holding the data of `tensor`.
+
+  The kind is empty if the data is in the default memory of the device, or if
+  the tensor is not materialized.
+  """
+  return torch_xla._XLAC._xla_get_memory_kind(tensor)
+
+
+def offload(tensors: Iterable[torch.Tensor],
+            kind: Optional[str] = None) -> None:
+  """Materializes `tensors` and moves their data to host memory."""
+  tensors = list(tensors)
+  if not tensors:
+    return
+  kind = kind or host_memory_kind(tensors[0].device)
+  if kind is None:
+    raise RuntimeError(f'{tensors[0].device} has no host memory space')
+  torch_xla._XLAC._xla_move_to_memory_kind(tensors, kind)
+
+
+def load(tensors: Iterable[torch.Tensor]) -> None:
+  """Moves the data of `tensors` back to the default memory of the device."""
+  tensors = list(tensors)
+  if tensors:
+    default_kind = memory_kinds(tensors[0].device)[0]
+    torch_xla._XLAC._xla_move_to_memory_kind(tensors, default_kind)
+
+
+def offload_optimizer_state(optimizer: torch.optim.Optimizer,
+                            kind: Optional[str] = None) -> None:
+  """Moves the tensors of the state of `optimizer` to host memory.
+
+  The updated state of a step is produced in device memory, so this is called
+  after every step.
+  """
+  offload([
+      value for state in optimizer.state.values()
+      for value in state.values()
+      if isinstance(value, torch.Tensor) and value.device.type == 'xla'
+  ], kind)
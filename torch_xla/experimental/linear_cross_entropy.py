@@ -0,0 +1,64 @@
+"""Cross entropy fused with the output projection of a language model head.
+
+`F.cross_entropy(hidden @ weight.T, target)` materializes the (tokens, vocab)
+logits, their log-softmax and their gradient. For large vocabularies these
+dominate the memory of a training step. `linear_cross_entropy` computes the
+same loss over blocks of `vocab_block` classes, carrying a running logsumexp
+and the target logit, and its backward recomputes each block of logits from
+the saved logsumexp. Only (tokens, vocab_block) logits are live at a time.
+"""
+
+import torch
+import torch_xla
+
+_REDUCTIONS = {'none': 0, 'mean': 1, 'sum': 2}
+
+
+class _LinearCrossEntropy(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, hidden, weight, target, reduction, ignore_index,
+              vocab_block):
+    loss, logsumexp = torch_xla._XLAC._xla_linear_cross_entropy(
+        hidden, weight, target, reduction, ignore_index, vocab_block)
+    ctx.save_for_backward(hidden, weight, target, logsumexp)
+    ctx.reduction = reduction
+    ctx.ignore_index = ignore_index
+    ctx.vocab_block = vocab_block
+    return loss
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    hidden, weight, target, logsumexp = ctx.saved_tensors
+    grad_hidden, grad_weight = (
+        torch_xla._XLAC._xla_linear_cross_entropy_backward(
+            grad_output, hidden, weight, target, logsumexp, ctx.reduction,
+            ctx.ignore_index, ctx.vocab_block))
+    return grad_hidden, grad_weight, None, None, None, None
+
+
+def linear_cross_entropy(hidden: torch.Tensor,
+                         weight: torch.Tensor,
+                         target: torch.Tensor,
+                         ignore_index: int = -100,
+                         reduction: str = 'mean',
+                         vocab_block: int = 8192) -> torch.Tensor:
+  """Computes `F.cross_entropy(hidden @ weight.T, target)` blockwise.
+
+  Args:
+    hidden: (..., H) activations.
+    weight: (V, H) output projection.
+    target: (...) class indices.
+    ignore_index: target value which does not contribute to the loss.
+    reduction: 'none', 'mean' or 'sum', as in `F.cross_entropy`.
+    vocab_block: number of classes processed per step.
+  """
+  if reduction not in _REDUCTIONS:
+    raise ValueError(f'Unsupported reduction: {reduction}')
+  batch_shape = target.shape
+  loss = _LinearCrossEntropy.apply(
+      hidden.reshape(-1, hidden.shape[-1]), weight, target.reshape(-1),
+      _REDUCTIONS[reduction], ignore_index, vocab_block)
+  if reduction == 'none':
+    loss = loss.reshape(batch_shape)
+  return loss
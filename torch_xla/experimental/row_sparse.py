@@ -0,0 +1,153 @@
+"""Row-sparse gradients for embedding tables.
+
+The gradient of `F.embedding` is dense: the backward scatters the output
+gradient into a zero filled tensor the size of the whole table, and the
+optimizer then reads and writes every row of it. For large tables with few
+rows touched per step that traffic dominates the step.
+
+`embedding` here leaves `weight.grad` unset and instead records the gradient
+on `weight.row_sparse_grad` as a `RowSparseGrad`, the distinct touched rows
+and their summed gradients. The update helpers (`sgd_step_`, `adam_step_`)
+and `all_reduce` only touch those rows, and `densify` recovers the dense
+gradient when needed.
+
+A `RowSparseGrad` has a static number of slots, the number of looked up
+indices, so its shape does not depend on the data. The slots past `count`
+hold row `num_rows`, one past the end of the table, which the scatters into
+the table drop on XLA.
+"""
+
+from typing import Optional, Tuple
+
+import torch
+import torch.nn.functional as F
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+
+class RowSparseGrad:
+  """The rows of a tensor with `num_rows` rows which hold nonzero values."""
+
+  def __init__(self, rows: torch.Tensor, values: torch.Tensor,
+               count: torch.Tensor, num_rows: int):
+    self.rows = rows
+    self.values = values
+    self.count = count
+    self.num_rows = num_rows
+
+  def __add__(self, other: 'RowSparseGrad') -> 'RowSparseGrad':
+    assert self.num_rows == other.num_rows
+    return coalesce(
+        torch.cat([self.rows, other.rows]),
+        torch.cat([self.values, other.values]), self.num_rows)
+
+  def densify(self) -> torch.Tensor:
+    return densify(self)
+
+
+def coalesce(rows: torch.Tensor,
+             values: torch.Tensor,
+             num_rows: int,
+             padding_idx: Optional[int] = None) -> RowSparseGrad:
+  """Sums the values of equal rows.
+
+  This is the row-sparse form of
+  `torch.zeros(num_rows, ...).index_put_((rows,), values, accumulate=True)`.
+  Rows outside of `[0, num_rows)` and `padding_idx` are dropped.
+  """
+  rows, values, count = torch_xla._XLAC._xla_row_sparse_coalesce(
+      rows, values, num_rows, -1 if padding_idx is None else padding_idx)
+  return RowSparseGrad(rows, values, count, num_rows)
+
+
+def densify(grad: RowSparseGrad) -> torch.Tensor:
+  """Returns the dense tensor `grad` represents."""
+  dense = grad.values.new_zeros((grad.num_rows,) + grad.values.shape[1:])
+  return dense.index_put_((grad.rows,), grad.values, accumulate=True)
+
+
+class _Embedding(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, input, weight, padding_idx):
+    ctx.save_for_backward(input)
+    ctx.weight = weight
+    ctx.padding_idx = padding_idx
+    return F.embedding(input, weight, padding_idx)
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    input, = ctx.saved_tensors
+    weight = ctx.weight
+    grad = coalesce(
+        input.reshape(-1), grad_output.reshape(-1, weight.shape[1]),
+        weight.shape[0], ctx.padding_idx)
+    previous = getattr(weight, 'row_sparse_grad', None)
+    weight.row_sparse_grad = grad if previous is None else previous + grad
+    return None, None, None
+
+
+def embedding(input: torch.Tensor,
+              weight: torch.Tensor,
+              padding_idx: Optional[int] = None) -> torch.Tensor:
+  """`F.embedding` recording a row-sparse gradient on `weight`.
+
+  Gradients of repeated backward passes are summed into
+  `weight.row_sparse_grad`. Clear it with `zero_grad(weight)`.
+  """
+  if padding_idx is not None and padding_idx < 0:
+    padding_idx += weight.shape[0]
+  return _Embedding.apply(input, weight, padding_idx)
+
+
+def zero_grad(weight: torch.Tensor) -> None:
+  weight.row_sparse_grad = None
+
+
+def all_reduce(grad: RowSparseGrad,
+               groups=None,
+               pin_layout: bool = True) -> RowSparseGrad:
+  """Sums a row-sparse gradient across replicas.
+
+  Gathers the rows and values of every replica rather than reducing the dense
+  table, so the traffic scales with the number of touched rows.
+  """
+  rows = xm.all_gather(grad.rows, dim=0, groups=groups, pin_layout=pin_layout)
+  values = xm.all_gather(
+      grad.values, dim=0, groups=groups, pin_layout=pin_layout)
+  return coalesce(rows, values, grad.num_rows)
+
+
+@torch.no_grad()
+def sgd_step_(weight: torch.Tensor, grad: RowSparseGrad, lr: float) -> None:
+  """Applies `weight -= lr * grad` to the rows of `grad` only."""
+  weight.index_put_((grad.rows,), grad.values * -lr, accumulate=True)
+
+
+@torch.no_grad()
+def adam_step_(weight: torch.Tensor,
+               exp_avg: torch.Tensor,
+               exp_avg_sq: torch.Tensor,
+               grad: RowSparseGrad,
+               step: int,
+               lr: float,
+               betas: Tuple[float, float] = (0.9, 0.999),
+               eps: float = 1e-8) -> None:
+  """Lazy Adam: updates the moments and weights of the rows of `grad` only.
+
+  Rows without a gradient keep their moments, as in `torch.optim.SparseAdam`.
+  `step` is the 1-based step count used for the bias correction.
+  """
+  beta1, beta2 = betas
+  # The padding slots gather the last row and write to the dropped row.
+  gather_rows = grad.rows.clamp(max=grad.num_rows - 1)
+  m = exp_avg.index_select(0, gather_rows)
+  v = exp_avg_sq.index_select(0, gather_rows)
+  m = m * beta1 + grad.values * (1 - beta1)
+  v = v * beta2 + grad.values * grad.values * (1 - beta2)
+  step_size = lr / (1 - beta1**step)
+  denom = (v / (1 - beta2**step)).sqrt() + eps
+  update = weight.index_select(0, gather_rows) - step_size * m / denom
+  exp_avg.index_put_((grad.rows,), m)
+  exp_avg_sq.index_put_((grad.rows,), v)
+  weight.index_put_((grad.rows,), update)
@@ -40,19 +40,11 @@ def extract_custom_call_outputs_shape_dtype(n: torch.fx.Node):
 
 
 def _place_to_host_impl(a: torch.Tensor):
-  return stablehlo_custom_call(
-      [a],
-      "annotate_device_placement", [a.shape], [a.dtype],
-      has_side_effect=True,
-      frontend_attributes={"_xla_buffer_placement": "pinned_host"})
+  return torch_xla._XLAC._xla_memory_placement(a, "pinned_host")
 
 
 def _place_to_device_impl(a: torch.Tensor):
-  return stablehlo_custom_call(
-      [a],
-      "annotate_device_placement", [a.shape], [a.dtype],
-      has_side_effect=True,
-      frontend_attributes={"_xla_buffer_placement": "device"})
+  return torch_xla._XLAC._xla_memory_placement(a, "device")
 
 
 @torch.library.custom_op("xla::place_to_host", mutates_args=())
@@ -183,6 +183,57 @@ def quantized_matmul(x: torch.Tensor,
   return out
 
 
+def pack_int4(w: torch.Tensor) -> torch.Tensor:
+  """Packs int4 values held in int8 two per byte along dimension 1.
+
+  The even element of each pair goes to the low nibble, which is the layout
+  `weight_only_quantized_matmul` expects with `bits=4`.
+  """
+  assert w.dtype == torch.int8, f"Expected torch.int8, got {w.dtype}."
+  assert w.shape[1] % 2 == 0, (
+      f"Dimension 1 should be even to pack int4 pairs, got {w.shape}.")
+  low = w[:, 0::2]
+  high = w[:, 1::2]
+  return (low & 0xF) | (high << 4)
+
+
+def unpack_int4(w: torch.Tensor) -> torch.Tensor:
+  """Inverse of `pack_int4`."""
+  low = (w << 4) >> 4
+  high = w >> 4
+  return torch.stack([low, high], dim=2).reshape(w.shape[0], w.shape[1] * 2,
+                                                 *w.shape[2:])
+
+
+def weight_only_quantized_matmul(x: torch.Tensor,
+                                 w: torch.Tensor,
+                                 scaler: torch.Tensor,
+                                 zero_point: torch.Tensor = None,
+                                 bits: int = 8,
+                                 block_size: int = -1) -> torch.Tensor:
+  """Matmul with a quantized weight, dequantized inside the dot on XLA.
+
+  Unlike `quantized_matmul`, int4 weights stay packed two per byte in device
+  memory, and the full precision weight is never materialized.
+
+  Args:
+      x: torch.Tensor - Activation of Matmul [..., in_channel].
+      w: torch.Tensor - torch.int8 weight, laid out as in `quantized_matmul`.
+         With bits=4, packed along dimension 1 with `pack_int4`.
+      scaler: torch.Tensor - Weight scaler, as in `quantized_matmul`.
+      zero_point: Optional[torch.Tensor] - Zero point, as in `quantized_matmul`.
+      bits: 8, or 4 for packed int4 weights.
+      block_size: The blocksize for blockwise quantization, -1 for per-channel
+                  quantization.
+  """
+  if x.device.type == 'xla':
+    return torch_xla._XLAC._xla_weight_only_quantized_matmul(
+        x, w, scaler, zero_point, bits, block_size)
+  if bits == 4:
+    w = unpack_int4(w)
+  return quantized_matmul(x, w, scaler, zero_point, block_size=block_size)
+
+
 class XlaQuantizedLinear(torch.nn.Module):
 
   def __init__(self,